@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AOBlurReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static inline int clampCoord(int v, int size)
+{
+    return std::min(std::max(v, 0), size - 1);
+}
+
+int aoBlurStepForRate(uint8_t rate)
+{
+    switch (rate)
+    {
+    case 0:
+        return 0;
+    case 2:
+        return 2;
+    case 3:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+void blurAOBruteForce(const float* occlusion, const float* depth, int width, int height,
+                      int radius, float depthThreshold, float* result)
+{
+    for (int py = 0; py < height; ++py)
+    {
+        for (int px = 0; px < width; ++px)
+        {
+            float center = depth[px + py * width];
+            float sum = occlusion[px + py * width];
+            int n = 1;
+
+            for (int x = -radius; x < radius; ++x)
+            {
+                for (int y = -radius; y < radius; ++y)
+                {
+                    size_t idx = clampCoord(px + x, width) + clampCoord(py + y, height) * size_t(width);
+                    if (std::abs(depth[idx] - center) < depthThreshold)
+                    {
+                        sum += occlusion[idx];
+                        ++n;
+                    }
+                }
+            }
+            result[px + py * width] = sum / float(n);
+        }
+    }
+}
+
+static void blurAOPass(const float* input, const float* depth, int width, int height,
+                       int radius, float depthThreshold, float* result, bool vertical,
+                       const uint8_t* shadingRateImage, int rateWidth, int rateTexelWidth, int rateTexelHeight)
+{
+    radius = std::min(radius, AO_BLUR_MAX_RADIUS);
+
+    for (int py = 0; py < height; ++py)
+    {
+        for (int px = 0; px < width; ++px)
+        {
+            size_t center = px + py * size_t(width);
+
+            int step = 1;
+            if (shadingRateImage)
+            {
+                step = aoBlurStepForRate(shadingRateImage[px / rateTexelWidth + (py / rateTexelHeight) * rateWidth]);
+            }
+
+            //
+            // At full rate the center is summed twice, once up front and
+            // once as tap 0, like in the loop of composite.frag. Coarse
+            // tiles take every step-th tap with weight step on a grid
+            // through the center, so the center is only summed as tap 0.
+            //
+            // pixels without invocations keep their value
+            float sum = step > 1 ? 0.0f : input[center];
+            float n = step > 1 ? 0.0f : 1.0f;
+            if (step > 0)
+            {
+                for (int t = -(radius / step) * step; t < radius; t += step)
+                {
+                    int sx = vertical ? px : clampCoord(px + t, width);
+                    int sy = vertical ? clampCoord(py + t, height) : py;
+                    size_t idx = sx + sy * size_t(width);
+                    if (std::abs(depth[idx] - depth[center]) < depthThreshold)
+                    {
+                        sum += input[idx] * float(step);
+                        n += float(step);
+                    }
+                }
+            }
+            result[center] = sum / n;
+        }
+    }
+}
+
+void blurAOSeparable(const float* occlusion, const float* depth, int width, int height,
+                     int radius, float depthThreshold, float* result,
+                     const uint8_t* shadingRateImage, int rateWidth,
+                     int rateTexelWidth, int rateTexelHeight)
+{
+    std::vector<float> horizontal(size_t(width) * height);
+
+    blurAOPass(occlusion, depth, width, height, radius, depthThreshold, horizontal.data(), false,
+               shadingRateImage, rateWidth, rateTexelWidth, rateTexelHeight);
+    blurAOPass(horizontal.data(), depth, width, height, radius, depthThreshold, result, true,
+               shadingRateImage, rateWidth, rateTexelWidth, rateTexelHeight);
+}
+
+AOBlurError compareAO(const float* a, const float* b, size_t count)
+{
+    AOBlurError error;
+    if (count == 0)
+    {
+        return error;
+    }
+
+    double sumAbs = 0.0;
+    double sumSquared = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float diff = std::abs(a[i] - b[i]);
+        error.maxAbs = std::max(error.maxAbs, diff);
+        sumAbs += diff;
+        sumSquared += double(diff) * diff;
+    }
+    error.meanAbs = float(sumAbs / count);
+    error.rmse = float(std::sqrt(sumSquared / count));
+
+    return error;
+}
@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// CPU versions of the AO blurs: the brute force loop in composite.frag and
+// a separable, depth-aware blur that skips taps along the shading rate
+// image, compared by tools/ao_blur_compare. The sample has no AO pass, so
+// neither runs on the GPU. All images are width * height floats, row
+// major, clamp to edge addressing.
+//
+
+// the line cache of a compute version in shared memory would limit the radius of the separable blur
+static const int AO_BLUR_MAX_RADIUS = 16;
+
+// (2r)^2 loop of composite.frag, radius is used as is
+void blurAOBruteForce(const float* occlusion, const float* depth, int width, int height,
+                      int radius, float depthThreshold, float* result);
+
+// Two separable passes, radius is clamped to AO_BLUR_MAX_RADIUS.
+// shadingRateImage is optional (nullptr), otherwise it holds
+// rateWidth * ceil(height / rateTexelHeight) palette indices.
+void blurAOSeparable(const float* occlusion, const float* depth, int width, int height,
+                     int radius, float depthThreshold, float* result,
+                     const uint8_t* shadingRateImage = nullptr, int rateWidth = 0,
+                     int rateTexelWidth = 1, int rateTexelHeight = 1);
+
+// tap distance used for a palette entry, 0 means the pixel is not blurred
+int aoBlurStepForRate(uint8_t rate);
+
+struct AOBlurError
+{
+    float maxAbs = 0.0f;
+    float meanAbs = 0.0f;
+    float rmse = 0.0f;
+};
+
+AOBlurError compareAO(const float* a, const float* b, size_t count);
@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CaptureWriter.h"
+
+#include <cstdio>
+#include <vector>
+
+CaptureWriter::CaptureWriter(std::function<void(size_t)> release)
+    : m_release(std::move(release))
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::begin(const std::string& directory)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending)
+        {
+            return false;
+        }
+    }
+
+    // the writer only reads the directory and the counts while a frame is pending
+    m_directory = directory;
+    m_framesWritten = 0;
+    m_framesDropped = 0;
+    m_bytesWritten = 0;
+    m_writeFailed = false;
+    m_failedFrame = 0;
+
+    if (!m_thread.joinable())
+    {
+        m_stop = false;
+        m_thread = std::thread(&CaptureWriter::threadMain, this);
+    }
+    return true;
+}
+
+void CaptureWriter::push(size_t id, const CaptureFrame& frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({ id, frame });
+        ++m_pending;
+    }
+    m_condition.notify_one();
+}
+
+void CaptureWriter::drop(uint32_t count)
+{
+    m_framesDropped += count;
+}
+
+void CaptureWriter::close()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+}
+
+bool CaptureWriter::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending != 0;
+}
+
+void CaptureWriter::threadMain()
+{
+    for (;;)
+    {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+            entry = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        // after a failed write the rest is skipped, and like the failed frame counted as dropped
+        if (m_writeFailed)
+        {
+            ++m_framesDropped;
+        }
+        else if (writeFrame(entry.frame))
+        {
+            ++m_framesWritten;
+        }
+        else
+        {
+            m_failedFrame = entry.frame.frameIndex;
+            m_writeFailed = true;
+            ++m_framesDropped;
+        }
+
+        // counted and released before it stops being pending, so begin() sees the final counts
+        m_release(entry.id);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_pending;
+    }
+}
+
+bool CaptureWriter::writeFrame(const CaptureFrame& frame)
+{
+    char name[64];
+    std::vector<uint8_t> row;
+    bool ok = true;
+
+    //
+    // GL images start with the bottom row, the files with the top one.
+    //
+    snprintf(name, sizeof(name), "/frame%06u_color.ppm", frame.frameIndex);
+    FILE* file = fopen((m_directory + name).c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", frame.width, frame.height);
+    row.resize(size_t(frame.width) * 3);
+    for (uint32_t y = frame.height; y-- > 0;)
+    {
+        const uint8_t* rgba = frame.color + size_t(y) * frame.width * 4;
+        for (uint32_t x = 0; x < frame.width; ++x)
+        {
+            row[x * 3 + 0] = rgba[x * 4 + 0];
+            row[x * 3 + 1] = rgba[x * 4 + 1];
+            row[x * 3 + 2] = rgba[x * 4 + 2];
+        }
+        ok &= fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    ok &= fclose(file) == 0;
+    m_bytesWritten += uint64_t(row.size()) * frame.height;
+
+    if (!ok || !frame.rates)
+    {
+        return ok;
+    }
+
+    snprintf(name, sizeof(name), "/frame%06u_rate.pgm", frame.frameIndex);
+    file = fopen((m_directory + name).c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    fprintf(file, "P5\n%u %u\n255\n", frame.rateWidth, frame.rateHeight);
+    for (uint32_t y = frame.rateHeight; y-- > 0;)
+    {
+        ok &= fwrite(frame.rates + size_t(y) * frame.rateWidth, 1, frame.rateWidth, file) == frame.rateWidth;
+    }
+    ok &= fclose(file) == 0;
+    m_bytesWritten += uint64_t(frame.rateWidth) * frame.rateHeight;
+    return ok;
+}
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//
+// The writer thread of FrameCapture, without GL so tools/capture_writer_check
+// can test it. Frames are queued with the memory they live in and written as
+// binary PPM (color) and PGM (raw palette entries of the rate image); the
+// memory is handed back through the release callback once the writer is done
+// with it. After a failed write the rest of the capture is skipped and, like
+// the failed frame, counted as dropped.
+//
+// A capture owns its directory and counts: begin() refuses to start a new one
+// while frames of the previous one are still queued or being written.
+//
+
+// one frame in memory, rows bottom first as GL reads them back
+struct CaptureFrame
+{
+    uint32_t frameIndex = 0;
+    const uint8_t* color = nullptr;     // RGBA8
+    uint32_t width = 0;
+    uint32_t height = 0;
+    const uint8_t* rates = nullptr;     // palette entries, or nullptr
+    uint32_t rateWidth = 0;
+    uint32_t rateHeight = 0;
+};
+
+class CaptureWriter
+{
+public:
+    // release(id) is called on the writer thread once it no longer reads the frame pushed with id
+    explicit CaptureWriter(std::function<void(size_t)> release);
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // starts a capture into directory with zeroed counts, false while frames are pending
+    bool begin(const std::string& directory);
+    void push(size_t id, const CaptureFrame& frame);
+    // frames of the capture that never reached the writer
+    void drop(uint32_t count = 1);
+    // writes the pending frames and ends the thread
+    void close();
+
+    bool isBusy() const;
+
+    uint32_t getFramesWritten() const { return m_framesWritten; }
+    uint32_t getFramesDropped() const { return m_framesDropped; }
+    uint64_t getBytesWritten() const { return m_bytesWritten; }
+    bool hasWriteFailed() const { return m_writeFailed; }
+    uint32_t getFailedFrame() const { return m_failedFrame; }
+
+private:
+    struct Entry
+    {
+        size_t id;
+        CaptureFrame frame;
+    };
+
+    void threadMain();
+    bool writeFrame(const CaptureFrame& frame);
+
+    std::function<void(size_t)> m_release;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Entry> m_queue;          // guarded by m_mutex
+    uint32_t m_pending = 0;             // queued or being written, guarded by m_mutex
+    bool m_stop = false;
+
+    // only changed by begin() while nothing is pending, read by the writer
+    std::string m_directory;
+
+    std::atomic<uint32_t> m_framesWritten{ 0 };
+    std::atomic<uint32_t> m_framesDropped{ 0 };
+    std::atomic<uint64_t> m_bytesWritten{ 0 };
+    std::atomic<bool> m_writeFailed{ false };
+    std::atomic<uint32_t> m_failedFrame{ 0 };
+};
@@ -0,0 +1,155 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DepthOfFieldRater.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <string>
+#include <vector>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+// must match dof_rates.comp.glsl
+static const GLuint COMPOSE_GROUP_SIZE = 8;
+static const GLint LOCATION_FRAMEBUFFER_SIZE = 0;
+static const GLint LOCATION_TEXEL_SIZE = 1;
+static const GLint LOCATION_PROJECTION = 2;
+static const GLint LOCATION_RATE_IMAGE_SIZE = 0;
+static const GLint LOCATION_LENS = 1;
+static const GLint LOCATION_COC_THRESHOLDS = 2;
+static const GLint LOCATION_RATE_COST = 3;
+
+DepthOfFieldRater::DepthOfFieldRater()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+
+    m_reduceProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define DOF_PASS 1\n", "dof_rates.comp.glsl"));
+    m_composeProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define DOF_PASS 2\n", "dof_rates.comp.glsl"));
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading depth of field rate shaders\n");
+    }
+
+    glCreateSamplers(1, &m_nearestSampler);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+DepthOfFieldRater::~DepthOfFieldRater()
+{
+    m_progManager.deletePrograms();
+    glDeleteSamplers(1, &m_nearestSampler);
+    nvgl::deleteTexture(m_rangeTexture);
+    nvgl::deleteTexture(m_composedTexture);
+}
+
+void DepthOfFieldRater::resize(uint32_t width, uint32_t height)
+{
+    if (width == m_width && height == m_height)
+    {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_hasRanges = false;
+
+    nvgl::newTexture(m_rangeTexture, GL_TEXTURE_2D);
+    glTextureStorage2D(m_rangeTexture, 1, GL_RG32F, width, height);
+
+    nvgl::newTexture(m_composedTexture, GL_TEXTURE_2D);
+    glTextureStorage2D(m_composedTexture, 1, GL_R8UI, width, height);
+}
+
+void DepthOfFieldRater::reduce(GLuint depthTexture, uint32_t framebufferWidth, uint32_t framebufferHeight,
+                               uint32_t texelWidth, uint32_t texelHeight, const glm::mat4& projection)
+{
+    uint32_t tilesX = (framebufferWidth + texelWidth - 1) / texelWidth;
+    uint32_t tilesY = (framebufferHeight + texelHeight - 1) / texelHeight;
+    resize(tilesX, tilesY);
+
+    m_timer.begin();
+
+    GLuint program = m_progManager.get(m_reduceProgram);
+    glUseProgram(program);
+    glProgramUniform2i(program, LOCATION_FRAMEBUFFER_SIZE, framebufferWidth, framebufferHeight);
+    glProgramUniform2i(program, LOCATION_TEXEL_SIZE, texelWidth, texelHeight);
+    glProgramUniform2f(program, LOCATION_PROJECTION, projection[2][2], projection[3][2]);
+
+    glBindTextureUnit(0, depthTexture);
+    glBindImageTexture(0, m_rangeTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+
+    // one workgroup per tile
+    glDispatchCompute(tilesX, tilesY, 1);
+
+    // the ranges are fetched by the compose pass of the next frame
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+
+    m_timer.end();
+    m_hasRanges = true;
+}
+
+GLuint DepthOfFieldRater::compose(GLuint sourceRates, uint32_t width, uint32_t height, const DepthOfFieldSettings& settings,
+                                  const RateCostModel& cost)
+{
+    if (!m_hasRanges || width != m_width || height != m_height)
+    {
+        return sourceRates;
+    }
+
+    GLuint program = m_progManager.get(m_composeProgram);
+    glUseProgram(program);
+    glProgramUniform2i(program, LOCATION_RATE_IMAGE_SIZE, width, height);
+    glProgramUniform2f(program, LOCATION_LENS, settings.focusDistance, settings.infinityBlurPixels);
+    glProgramUniform2f(program, LOCATION_COC_THRESHOLDS, settings.cocThresholds[0], settings.cocThresholds[1]);
+    glProgramUniform1fv(program, LOCATION_RATE_COST, RATE_STATS_MAX_ENTRIES, cost.invocationsPerPixel);
+
+    glBindTextureUnit(0, sourceRates);
+    glBindTextureUnit(1, m_rangeTexture);
+    glBindSampler(0, m_nearestSampler);
+    glBindSampler(1, m_nearestSampler);
+    glBindImageTexture(0, m_composedTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+
+    glDispatchCompute((width + COMPOSE_GROUP_SIZE - 1) / COMPOSE_GROUP_SIZE, (height + COMPOSE_GROUP_SIZE - 1) / COMPOSE_GROUP_SIZE, 1);
+
+    // read as shading rate image or as the source of the edge refinement
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+    glBindSampler(0, 0);
+    glBindSampler(1, 0);
+    glBindTextureUnit(1, 0);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+
+    return m_composedTexture;
+}
+
+void DepthOfFieldRater::reloadShaders()
+{
+    m_progManager.reloadPrograms();
+}
@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+#include <glm/glm.hpp>
+
+#include "DepthOfFieldReference.h"
+#include "GpuTimer.h"
+
+//
+// GPU side of the depth of field rates (see DepthOfFieldReference.h):
+// reduce() stores the nearest and farthest distance of each shading rate
+// image tile of a frame, compose() turns them into rates and composes them
+// with the rate image of the next frame.
+//
+class DepthOfFieldRater
+{
+public:
+    DepthOfFieldRater();
+    ~DepthOfFieldRater();
+
+    DepthOfFieldRater(const DepthOfFieldRater&) = delete;
+    DepthOfFieldRater& operator=(const DepthOfFieldRater&) = delete;
+
+    // after the scene pass, projection is the one the depth buffer was rendered with
+    void reduce(GLuint depthTexture, uint32_t framebufferWidth, uint32_t framebufferHeight, uint32_t texelWidth,
+                uint32_t texelHeight, const glm::mat4& projection);
+
+    // returns the composed copy of sourceRates, or sourceRates itself until
+    // there are depth ranges of a matching size
+    GLuint compose(GLuint sourceRates, uint32_t width, uint32_t height, const DepthOfFieldSettings& settings,
+                   const RateCostModel& cost);
+
+    // forget the depth ranges, e.g. when the generator is switched off
+    void invalidate() { m_hasRanges = false; }
+
+    // GPU time of both passes of the last finished frame
+    double getMilliseconds() const { return m_timer.getMilliseconds(); }
+
+    void reloadShaders();
+
+private:
+    void resize(uint32_t width, uint32_t height);
+
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_reduceProgram;
+    nvgl::ProgramID m_composeProgram;
+
+    // the rate images are integer textures, which are incomplete with the default linear filters
+    GLuint m_nearestSampler = 0;
+    GLuint m_rangeTexture = 0;
+    GLuint m_composedTexture = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    bool m_hasRanges = false;
+
+    GpuTimer m_timer;
+};
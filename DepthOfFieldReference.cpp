@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DepthOfFieldReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DOF_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define DOF_USE_SSE2 0
+#endif
+
+float getCircleOfConfusion(float distance, const DepthOfFieldSettings& settings)
+{
+    return settings.infinityBlurPixels * std::fabs(distance - settings.focusDistance) / distance;
+}
+
+// distance to the eye of a depth below 1, same as in EdgeRefinementReference.cpp
+static float linearDepth(float depth, float projA, float projB)
+{
+    return projB / (depth * 2.0f - 1.0f + projA);
+}
+
+void reduceTileDepthRanges(const float* depth, uint32_t width, uint32_t height, float projA, float projB,
+                           uint32_t texelWidth, uint32_t texelHeight, TileDepthRange* ranges)
+{
+    const uint32_t tilesX = (width + texelWidth - 1) / texelWidth;
+    const uint32_t tilesY = (height + texelHeight - 1) / texelHeight;
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    TileDepthRange empty;
+    empty.nearest = infinity;
+    std::fill(ranges, ranges + size_t(tilesX) * tilesY, empty);
+
+#if DOF_USE_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 a = _mm_set1_ps(projA);
+    const __m128 b = _mm_set1_ps(projB);
+    const __m128 far = _mm_set1_ps(infinity);
+#endif
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const float* row = depth + size_t(y) * width;
+        TileDepthRange* tileRow = ranges + size_t(y / texelHeight) * tilesX;
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+        {
+            uint32_t x = tileX * texelWidth;
+            uint32_t end = std::min(x + texelWidth, width);
+            float nearest = infinity;
+            float farthest = 0.0f;
+
+#if DOF_USE_SSE2
+            //
+            // Four pixels at a time with the operations of linearDepth() in
+            // the same order, so both paths round alike. The background
+            // (depth 1, and anything that is not below 1 like in the scalar
+            // loop) is masked to infinity for the minimum and to 0 for the
+            // maximum.
+            //
+            if (x + 4 <= end)
+            {
+                __m128 nearest4 = far;
+                __m128 farthest4 = _mm_setzero_ps();
+                for (; x + 4 <= end; x += 4)
+                {
+                    __m128 d = _mm_loadu_ps(row + x);
+                    __m128 z = _mm_div_ps(b, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(d, two), one), a));
+                    __m128 background = _mm_cmpnlt_ps(d, one);
+                    nearest4 = _mm_min_ps(_mm_or_ps(_mm_and_ps(background, far), _mm_andnot_ps(background, z)), nearest4);
+                    farthest4 = _mm_max_ps(_mm_andnot_ps(background, z), farthest4);
+                }
+                float lanes[8];
+                _mm_storeu_ps(lanes, nearest4);
+                _mm_storeu_ps(lanes + 4, farthest4);
+                nearest = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+                farthest = std::max(std::max(lanes[4], lanes[5]), std::max(lanes[6], lanes[7]));
+            }
+#endif
+
+            for (; x < end; ++x)
+            {
+                if (row[x] < 1.0f)
+                {
+                    float z = linearDepth(row[x], projA, projB);
+                    nearest = std::min(nearest, z);
+                    farthest = std::max(farthest, z);
+                }
+            }
+
+            TileDepthRange& range = tileRow[tileX];
+            range.nearest = std::min(range.nearest, nearest);
+            range.farthest = std::max(range.farthest, farthest);
+        }
+    }
+
+    for (size_t i = 0; i < size_t(tilesX) * tilesY; ++i)
+    {
+        if (ranges[i].nearest == infinity)
+        {
+            ranges[i] = TileDepthRange();
+        }
+    }
+}
+
+uint8_t getDepthOfFieldRate(const TileDepthRange& range, const DepthOfFieldSettings& settings)
+{
+    if (range.farthest <= 0.0f)
+    {
+        return RATE_1X1;
+    }
+
+    // the circle of confusion grows away from the focus on both sides, a range across it has a sharp pixel
+    float coc = 0.0f;
+    if (settings.focusDistance < range.nearest)
+    {
+        coc = getCircleOfConfusion(range.nearest, settings);
+    }
+    else if (settings.focusDistance > range.farthest)
+    {
+        coc = getCircleOfConfusion(range.farthest, settings);
+    }
+    return coc >= settings.cocThresholds[1] ? RATE_4X4 : coc >= settings.cocThresholds[0] ? RATE_2X2 : RATE_1X1;
+}
+
+uint8_t composeRates(uint8_t source, uint8_t other, const RateCostModel& cost)
+{
+    if (source >= RATE_STATS_MAX_ENTRIES || other >= RATE_STATS_MAX_ENTRIES)
+    {
+        return source;
+    }
+    return cost.invocationsPerPixel[other] < cost.invocationsPerPixel[source] ? other : source;
+}
+
+void applyDepthOfFieldRates(const uint8_t* rates, const TileDepthRange* ranges, size_t count,
+                            const DepthOfFieldSettings& settings, const RateCostModel& cost, uint8_t* composed)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        composed[i] = settings.enabled ? composeRates(rates[i], getDepthOfFieldRate(ranges[i], settings), cost) : rates[i];
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ShadingRateImage.h"
+#include "ShadingRateStats.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Shading rates from a depth of field model: tiles that the lens blurs
+// anyway tolerate coarser shading. The depth buffer of the previous frame
+// is reduced to the nearest and farthest distance per shading rate image
+// tile, the smallest circle of confusion over that range picks a rate. The
+// rate is composed with the one of another generator (the foveation rings)
+// through the palette cost model: the entry with fewer invocations per
+// pixel wins, as either generator alone would accept it. The GPU version
+// lives in dof_rates.comp.glsl, the functions here are the CPU reference of
+// both passes.
+//
+
+struct DepthOfFieldSettings
+{
+    bool enabled = false;
+    // distance to the eye that is in focus
+    float focusDistance = 3.0f;
+    // circle of confusion diameter in pixels of a point at infinity, the
+    // thin lens model reduces to coc(z) = infinityBlur * |z - focus| / z
+    float infinityBlurPixels = 8.0f;
+    // smallest circle of confusion in pixels for 2x2 and for 4x4
+    float cocThresholds[2] = { 2.0f, 4.0f };
+};
+
+// distances to the eye, both 0 for tiles without geometry
+struct TileDepthRange
+{
+    float nearest = 0.0f;
+    float farthest = 0.0f;
+};
+
+float getCircleOfConfusion(float distance, const DepthOfFieldSettings& settings);
+
+// depth holds the window depth of a width x height framebuffer, bottom row
+// first; projA and projB are projection[2][2] and projection[3][2] of the
+// perspective projection it was rendered with. ranges has one entry per
+// texel of the shading rate image covering the framebuffer.
+void reduceTileDepthRanges(const float* depth, uint32_t width, uint32_t height, float projA, float projB,
+                           uint32_t texelWidth, uint32_t texelHeight, TileDepthRange* ranges);
+
+// RATE_1X1 for tiles without geometry, which leaves any composed rate as it is
+uint8_t getDepthOfFieldRate(const TileDepthRange& range, const DepthOfFieldSettings& settings);
+
+// the entry with fewer invocations per pixel, source on ties and for entries outside the model
+uint8_t composeRates(uint8_t source, uint8_t other, const RateCostModel& cost);
+
+void applyDepthOfFieldRates(const uint8_t* rates, const TileDepthRange* ranges, size_t count,
+                            const DepthOfFieldSettings& settings, const RateCostModel& cost, uint8_t* composed);
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EdgeRefinementReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+const char* EDGE_POLICY_NAMES[EDGE_POLICY_COUNT] = { "Off", "Refine edges", "Refine edges, coarsen interiors" };
+
+// distance to the eye, 0 for the background
+static float linearDepth(float depth, float projA, float projB)
+{
+    return depth >= 1.0f ? 0.0f : projB / (depth * 2.0f - 1.0f + projA);
+}
+
+static bool isDepthEdge(float z, float neighbour, float threshold)
+{
+    // exactly one of them is background, or both are geometry with a jump in between
+    if ((z == 0.0f) != (neighbour == 0.0f))
+    {
+        return true;
+    }
+    return z != 0.0f && std::fabs(z - neighbour) > threshold * std::min(z, neighbour);
+}
+
+static bool isCrease(float before, float z, float after, float threshold)
+{
+    return before != 0.0f && after != 0.0f && std::fabs(before - 2.0f * z + after) > threshold * z;
+}
+
+void classifyTileEdges(const float* depth, uint32_t width, uint32_t height, float projA, float projB,
+                       uint32_t texelWidth, uint32_t texelHeight, const EdgeRefinementSettings& settings, uint8_t* classes)
+{
+    const uint32_t tilesX = (width + texelWidth - 1) / texelWidth;
+    const uint32_t tilesY = (height + texelHeight - 1) / texelHeight;
+
+    std::vector<float> z(size_t(width) * height);
+    for (size_t i = 0; i < z.size(); ++i)
+    {
+        z[i] = linearDepth(depth[i], projA, projB);
+    }
+    auto at = [&](uint32_t x, uint32_t y) { return z[size_t(y) * width + x]; };
+
+    std::fill(classes, classes + size_t(tilesX) * tilesY, uint8_t(EDGE_TILE_BACKGROUND));
+
+    //
+    // A pixel is on a silhouette if it forms a depth edge with any of its
+    // four neighbours, so both sides of the edge are refined, also across
+    // tile borders. Background pixels only count as the far side of an edge.
+    //
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float center = at(x, y);
+            uint8_t pixelClass = center == 0.0f ? EDGE_TILE_BACKGROUND : EDGE_TILE_INTERIOR;
+
+            bool silhouette = (x > 0 && isDepthEdge(center, at(x - 1, y), settings.depthThreshold))
+                || (x + 1 < width && isDepthEdge(center, at(x + 1, y), settings.depthThreshold))
+                || (y > 0 && isDepthEdge(center, at(x, y - 1), settings.depthThreshold))
+                || (y + 1 < height && isDepthEdge(center, at(x, y + 1), settings.depthThreshold));
+
+            if (silhouette)
+            {
+                pixelClass = EDGE_TILE_SILHOUETTE;
+            }
+            else if (center != 0.0f)
+            {
+                bool crease = (x > 0 && x + 1 < width && isCrease(at(x - 1, y), center, at(x + 1, y), settings.creaseThreshold))
+                    || (y > 0 && y + 1 < height && isCrease(at(x, y - 1), center, at(x, y + 1), settings.creaseThreshold));
+                if (crease)
+                {
+                    pixelClass = EDGE_TILE_CREASE;
+                }
+            }
+
+            uint8_t& tileClass = classes[(y / texelHeight) * tilesX + x / texelWidth];
+            tileClass = std::max(tileClass, pixelClass);
+        }
+    }
+}
+
+uint8_t refineRate(uint8_t rate, uint8_t tileClass, const EdgeRefinementSettings& settings)
+{
+    // palette entries 1 to 3 are ordered from fine to coarse, culled tiles stay culled
+    if (settings.policy == EDGE_POLICY_OFF || rate == RATE_NO_INVOCATIONS || rate > RATE_4X4)
+    {
+        return rate;
+    }
+
+    switch (tileClass)
+    {
+    case EDGE_TILE_SILHOUETTE:
+        return std::min(rate, settings.silhouetteRate);
+    case EDGE_TILE_CREASE:
+        return std::min(rate, settings.creaseRate);
+    case EDGE_TILE_INTERIOR:
+        return settings.policy == EDGE_POLICY_REFINE_AND_COARSEN ? std::min(uint8_t(rate + 1), uint8_t(RATE_4X4)) : rate;
+    default:
+        return rate;
+    }
+}
+
+void refineRates(const uint8_t* rates, const uint8_t* classes, size_t count,
+                 const EdgeRefinementSettings& settings, uint8_t* refined)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        refined[i] = refineRate(rates[i], classes[i], settings);
+    }
+}
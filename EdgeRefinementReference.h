@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ShadingRateImage.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Refinement of a shading rate image by the depth buffer of the previous
+// frame: tiles on silhouettes (depth discontinuities) and creases (normal
+// discontinuities, found as spikes of the second derivative of the linear
+// depth) are forced to finer rates, flat interiors may go coarser. The GPU
+// version lives in edge_refine.comp.glsl, the functions here are the CPU
+// reference of the same classification and merge.
+//
+
+// per tile, ordered by priority
+enum EdgeTileClass : uint8_t
+{
+    EDGE_TILE_BACKGROUND = 0,   // nothing was rendered, the tile keeps its rate
+    EDGE_TILE_INTERIOR = 1,
+    EDGE_TILE_CREASE = 2,
+    EDGE_TILE_SILHOUETTE = 3,
+};
+
+enum EdgeRefinementPolicy
+{
+    EDGE_POLICY_OFF = 0,
+    EDGE_POLICY_REFINE = 1,                 // silhouettes and creases finer, everything else unchanged
+    EDGE_POLICY_REFINE_AND_COARSEN = 2,     // also interiors one step coarser, at most 4x4
+    EDGE_POLICY_COUNT
+};
+
+extern const char* EDGE_POLICY_NAMES[EDGE_POLICY_COUNT];
+
+struct EdgeRefinementSettings
+{
+    int policy = EDGE_POLICY_OFF;
+    // relative jump of the linear depth between neighbouring pixels
+    float depthThreshold = 0.05f;
+    // relative second difference of the linear depth across a pixel
+    float creaseThreshold = 0.01f;
+    // coarsest rate on silhouette and crease tiles, palette entries
+    uint8_t silhouetteRate = RATE_1X1;
+    uint8_t creaseRate = RATE_2X2;
+};
+
+// depth holds the window depth of a width x height framebuffer, bottom row
+// first; projA and projB are projection[2][2] and projection[3][2] of the
+// perspective projection it was rendered with. classes has one entry per
+// texel of the shading rate image covering the framebuffer.
+void classifyTileEdges(const float* depth, uint32_t width, uint32_t height, float projA, float projB,
+                       uint32_t texelWidth, uint32_t texelHeight, const EdgeRefinementSettings& settings, uint8_t* classes);
+
+uint8_t refineRate(uint8_t rate, uint8_t tileClass, const EdgeRefinementSettings& settings);
+
+void refineRates(const uint8_t* rates, const uint8_t* classes, size_t count,
+                 const EdgeRefinementSettings& settings, uint8_t* refined);
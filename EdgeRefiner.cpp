@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "EdgeRefiner.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <string>
+#include <vector>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+// must match edge_refine.comp.glsl
+static const GLuint MERGE_GROUP_SIZE = 8;
+static const GLint LOCATION_FRAMEBUFFER_SIZE = 0;
+static const GLint LOCATION_TEXEL_SIZE = 1;
+static const GLint LOCATION_PROJECTION = 2;
+static const GLint LOCATION_THRESHOLDS = 3;
+static const GLint LOCATION_RATE_IMAGE_SIZE = 0;
+static const GLint LOCATION_POLICY = 1;
+static const GLint LOCATION_EDGE_RATES = 2;
+
+EdgeRefiner::EdgeRefiner()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+
+    m_classifyProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define EDGE_PASS 1\n", "edge_refine.comp.glsl"));
+    m_mergeProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define EDGE_PASS 2\n", "edge_refine.comp.glsl"));
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading edge refinement shaders\n");
+    }
+
+    glCreateSamplers(1, &m_nearestSampler);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+EdgeRefiner::~EdgeRefiner()
+{
+    m_progManager.deletePrograms();
+    glDeleteSamplers(1, &m_nearestSampler);
+    nvgl::deleteTexture(m_classTexture);
+    nvgl::deleteTexture(m_refinedTexture);
+}
+
+void EdgeRefiner::resize(uint32_t width, uint32_t height)
+{
+    if (width == m_width && height == m_height)
+    {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_hasClasses = false;
+
+    nvgl::newTexture(m_classTexture, GL_TEXTURE_2D);
+    glTextureStorage2D(m_classTexture, 1, GL_R8UI, width, height);
+
+    nvgl::newTexture(m_refinedTexture, GL_TEXTURE_2D);
+    glTextureStorage2D(m_refinedTexture, 1, GL_R8UI, width, height);
+}
+
+void EdgeRefiner::classify(GLuint depthTexture, uint32_t framebufferWidth, uint32_t framebufferHeight, uint32_t texelWidth,
+                           uint32_t texelHeight, const glm::mat4& projection, const EdgeRefinementSettings& settings)
+{
+    uint32_t tilesX = (framebufferWidth + texelWidth - 1) / texelWidth;
+    uint32_t tilesY = (framebufferHeight + texelHeight - 1) / texelHeight;
+    resize(tilesX, tilesY);
+
+    m_timer.begin();
+
+    GLuint program = m_progManager.get(m_classifyProgram);
+    glUseProgram(program);
+    glProgramUniform2i(program, LOCATION_FRAMEBUFFER_SIZE, framebufferWidth, framebufferHeight);
+    glProgramUniform2i(program, LOCATION_TEXEL_SIZE, texelWidth, texelHeight);
+    glProgramUniform2f(program, LOCATION_PROJECTION, projection[2][2], projection[3][2]);
+    glProgramUniform2f(program, LOCATION_THRESHOLDS, settings.depthThreshold, settings.creaseThreshold);
+
+    glBindTextureUnit(0, depthTexture);
+    glBindImageTexture(0, m_classTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+
+    // one workgroup per tile
+    glDispatchCompute(tilesX, tilesY, 1);
+
+    // the classes are fetched by the merge pass of the next frame
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+
+    m_timer.end();
+    m_hasClasses = true;
+}
+
+GLuint EdgeRefiner::refine(GLuint sourceRates, uint32_t width, uint32_t height, const EdgeRefinementSettings& settings)
+{
+    if (!m_hasClasses || width != m_width || height != m_height)
+    {
+        return sourceRates;
+    }
+
+    GLuint program = m_progManager.get(m_mergeProgram);
+    glUseProgram(program);
+    glProgramUniform2i(program, LOCATION_RATE_IMAGE_SIZE, width, height);
+    glProgramUniform1i(program, LOCATION_POLICY, settings.policy);
+    glProgramUniform2ui(program, LOCATION_EDGE_RATES, settings.silhouetteRate, settings.creaseRate);
+
+    glBindTextureUnit(0, sourceRates);
+    glBindTextureUnit(1, m_classTexture);
+    glBindSampler(0, m_nearestSampler);
+    glBindSampler(1, m_nearestSampler);
+    glBindImageTexture(0, m_refinedTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+
+    glDispatchCompute((width + MERGE_GROUP_SIZE - 1) / MERGE_GROUP_SIZE, (height + MERGE_GROUP_SIZE - 1) / MERGE_GROUP_SIZE, 1);
+
+    // the refined image is read as shading rate image, which goes through the texture path
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+    glBindSampler(0, 0);
+    glBindSampler(1, 0);
+    glBindTextureUnit(1, 0);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+
+    return m_refinedTexture;
+}
+
+void EdgeRefiner::reloadShaders()
+{
+    m_progManager.reloadPrograms();
+}
@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+#include <glm/glm.hpp>
+
+#include "EdgeRefinementReference.h"
+#include "GpuTimer.h"
+
+//
+// GPU side of the edge refinement (see EdgeRefinementReference.h):
+// classify() reduces the depth buffer of a frame to one EdgeTileClass per
+// shading rate image texel, refine() merges those classes into the rate
+// image of the next frame.
+//
+class EdgeRefiner
+{
+public:
+    EdgeRefiner();
+    ~EdgeRefiner();
+
+    EdgeRefiner(const EdgeRefiner&) = delete;
+    EdgeRefiner& operator=(const EdgeRefiner&) = delete;
+
+    // after the scene pass, projection is the one the depth buffer was rendered with
+    void classify(GLuint depthTexture, uint32_t framebufferWidth, uint32_t framebufferHeight, uint32_t texelWidth,
+                  uint32_t texelHeight, const glm::mat4& projection, const EdgeRefinementSettings& settings);
+
+    // returns the refined copy of sourceRates, or sourceRates itself until
+    // there are tile classes of a matching size
+    GLuint refine(GLuint sourceRates, uint32_t width, uint32_t height, const EdgeRefinementSettings& settings);
+
+    // forget the tile classes, e.g. when the scene changes completely
+    void invalidate() { m_hasClasses = false; }
+
+    // GPU time of both passes of the last finished frame
+    double getMilliseconds() const { return m_timer.getMilliseconds(); }
+
+    void reloadShaders();
+
+private:
+    void resize(uint32_t width, uint32_t height);
+
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_classifyProgram;
+    nvgl::ProgramID m_mergeProgram;
+
+    // the rate images are integer textures, which are incomplete with the default linear filters
+    GLuint m_nearestSampler = 0;
+    GLuint m_classTexture = 0;
+    GLuint m_refinedTexture = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    bool m_hasClasses = false;
+
+    GpuTimer m_timer;
+};
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FoveationController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void FoveationController::reset(float scale)
+{
+    m_scale = scale;
+    m_filtered = 0.0;
+    m_hasMeasurement = false;
+}
+
+float FoveationController::update(double measuredMilliseconds)
+{
+    if (measuredMilliseconds <= 0.0 || m_settings.targetMilliseconds <= 0.0f)
+    {
+        return m_scale;
+    }
+
+    if (!m_hasMeasurement)
+    {
+        m_filtered = measuredMilliseconds;
+        m_hasMeasurement = true;
+    }
+    else
+    {
+        m_filtered += m_settings.smoothing * (measuredMilliseconds - m_filtered);
+    }
+
+    // positive if we are too slow -> shrink the full rate area
+    float error = float(std::log(m_filtered / m_settings.targetMilliseconds));
+    if (std::abs(error) < m_settings.deadband)
+    {
+        return m_scale;
+    }
+
+    float step = std::min(std::max(-m_settings.gain * error, -m_settings.maxStep), m_settings.maxStep);
+    m_scale = std::min(std::max(m_scale * std::exp(step), m_settings.minScale), m_settings.maxScale);
+
+    return m_scale;
+}
+
+FoveationParams FoveationController::apply(const FoveationParams& base) const
+{
+    //
+    // Only the boundaries between two shading rates move. A boundary to
+    // RATE_NO_INVOCATIONS is the lens cut-off, scaling it would blank the
+    // image at low scales instead of coarsening it, so it stays at its base
+    // radius and the scaled rings are clamped against it.
+    //
+    const int RING_COUNT = 3;
+    bool isCutoff[RING_COUNT];
+    for (int i = 0; i < RING_COUNT; ++i)
+    {
+        isCutoff[i] = base.rates[i] == RATE_NO_INVOCATIONS || base.rates[i + 1] == RATE_NO_INVOCATIONS;
+    }
+
+    FoveationParams params = base;
+    for (int i = 0; i < RING_COUNT; ++i)
+    {
+        if (isCutoff[i])
+        {
+            continue;
+        }
+
+        // the nearest cut-offs inside and outside of this boundary
+        float lower = 0.0f;
+        float upper = std::numeric_limits<float>::max();
+        for (int j = i - 1; j >= 0; --j)
+        {
+            if (isCutoff[j])
+            {
+                lower = base.radii[j];
+                break;
+            }
+        }
+        for (int j = i + 1; j < RING_COUNT; ++j)
+        {
+            if (isCutoff[j])
+            {
+                upper = base.radii[j];
+                break;
+            }
+        }
+        params.radii[i] = std::min(std::max(base.radii[i] * m_scale, lower), upper);
+    }
+    return params;
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ShadingRateImage.h"
+
+//
+// Closed-loop controller that scales the foveation radii so that the
+// measured GPU time of the scene pass approaches a target. Pure CPU, the
+// caller feeds one measurement per update() and applies the returned
+// scale via apply().
+//
+// The cost grows roughly with the area inside the rings, i.e. multiplicatively
+// with the scale, so the loop integrates the log of the time ratio into the
+// log of the scale:
+//   log(scale) -= gain * log(filtered / target)
+// - an exponential moving average on the measurement hides timer noise,
+// - a dead band around the target avoids hunting when close enough,
+// - the change per update is limited, which together with the low gain
+//   damps the response to the couple of frames of latency between changing
+//   the rate image and seeing its cost in the timer,
+// - the scale is clamped, so there is no windup at the limits.
+//
+class FoveationController
+{
+public:
+    struct Settings
+    {
+        float targetMilliseconds = 8.0f;
+        float minScale = 0.25f;
+        float maxScale = 4.0f;
+        float gain = 0.05f;      // fraction of the log error corrected per update
+        float smoothing = 0.5f;  // weight of a new measurement in the moving average
+        float deadband = 0.02f;  // relative error treated as on target
+        float maxStep = 0.05f;   // max change of log(scale) per update
+    };
+
+    void reset(float scale = 1.0f);
+
+    // feeds one GPU time measurement and returns the new radius scale
+    float update(double measuredMilliseconds);
+
+    float getScale() const { return m_scale; }
+    double getFilteredMilliseconds() const { return m_filtered; }
+
+    // base radii of the shading rings scaled by the current scale, the
+    // boundaries to RATE_NO_INVOCATIONS (lens cut-off) stay where they are
+    FoveationParams apply(const FoveationParams& base) const;
+
+    Settings m_settings;
+
+private:
+    float m_scale = 1.0f;
+    double m_filtered = 0.0;
+    bool m_hasMeasurement = false;
+};
@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FoveationPresets.h"
+
+#include <cstdio>
+#include <cstring>
+
+static bool fail(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+bool loadFoveationPresets(const std::string& filename, FoveationPresets& presets, std::string* error)
+{
+    presets = FoveationPresets();
+
+    FILE* file = fopen(filename.c_str(), "r");
+    if (!file)
+    {
+        return fail(error, "could not open " + filename);
+    }
+
+    bool hasVersion = false;
+    int defaultIndex = 0;
+    int lineNumber = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file))
+    {
+        ++lineNumber;
+        char* comment = strchr(line, '#');
+        if (comment)
+        {
+            *comment = 0;
+        }
+
+        char keyword[32] = {};
+        if (sscanf(line, "%31s", keyword) != 1)
+        {
+            continue;
+        }
+
+        int version = 0;
+        if (sscanf(line, " vrs_foveation_presets %d", &version) == 1)
+        {
+            if (version != FOVEATION_PRESETS_VERSION)
+            {
+                fclose(file);
+                return fail(error, filename + ": unsupported version " + std::to_string(version));
+            }
+            hasVersion = true;
+            continue;
+        }
+        if (!hasVersion)
+        {
+            break;
+        }
+
+        FoveationPreset preset;
+        unsigned rates[4] = {};
+        if (sscanf(line, " default %d", &defaultIndex) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, " preset %f %f %f %u %u %u %u %f %f", &preset.params.radii[0], &preset.params.radii[1],
+                &preset.params.radii[2], &rates[0], &rates[1], &rates[2], &rates[3], &preset.invocationsPerPixel, &preset.psnr) != 9)
+        {
+            fclose(file);
+            return fail(error, filename + ":" + std::to_string(lineNumber) + ": malformed line");
+        }
+
+        bool valid = preset.params.radii[0] <= preset.params.radii[1] && preset.params.radii[1] <= preset.params.radii[2];
+        for (int i = 0; i < 4; ++i)
+        {
+            valid = valid && rates[i] <= RATE_4X4;
+            preset.params.rates[i] = uint8_t(rates[i]);
+        }
+        if (!valid)
+        {
+            fclose(file);
+            return fail(error, filename + ":" + std::to_string(lineNumber) + ": radii must ascend, rates must be palette entries");
+        }
+        presets.presets.push_back(preset);
+    }
+    fclose(file);
+
+    if (!hasVersion)
+    {
+        return fail(error, filename + ": not a foveation preset file");
+    }
+    if (presets.presets.empty())
+    {
+        return fail(error, filename + ": no presets");
+    }
+    if (defaultIndex < 0 || size_t(defaultIndex) >= presets.presets.size())
+    {
+        return fail(error, filename + ": default preset out of range");
+    }
+    presets.defaultIndex = size_t(defaultIndex);
+    return true;
+}
+
+bool writeFoveationPresets(const std::string& filename, const FoveationPresets& presets, std::string* error)
+{
+    FILE* file = fopen(filename.c_str(), "w");
+    if (!file)
+    {
+        return fail(error, "could not create " + filename);
+    }
+
+    fprintf(file, "# written by tools/foveation_tuner, sorted by cost\n");
+    fprintf(file, "vrs_foveation_presets %d\n", FOVEATION_PRESETS_VERSION);
+    fprintf(file, "default %zu\n", presets.defaultIndex);
+    fprintf(file, "# radius0 radius1 radius2 rate0 rate1 rate2 rate3 invocations_per_pixel psnr_db\n");
+    for (const FoveationPreset& preset : presets.presets)
+    {
+        const FoveationParams& params = preset.params;
+        fprintf(file, "preset %.4f %.4f %.4f %u %u %u %u %.5f %.3f\n", params.radii[0], params.radii[1], params.radii[2],
+            params.rates[0], params.rates[1], params.rates[2], params.rates[3], preset.invocationsPerPixel, preset.psnr);
+    }
+
+    bool ok = ferror(file) == 0;
+    ok &= fclose(file) == 0;
+    return ok ? true : fail(error, "writing " + filename + " failed");
+}
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ShadingRateImage.h"
+
+#include <string>
+#include <vector>
+
+//
+// Foveation parameters searched offline by tools/foveation_tuner: the
+// Pareto front of predicted cost against image quality, sorted by cost.
+// Nothing in here touches OpenGL.
+//
+// Text format, '#' starts a comment:
+//   vrs_foveation_presets 1
+//   default <index>
+//   preset <radius0> <radius1> <radius2> <rate0> <rate1> <rate2> <rate3> <invocations per pixel> <psnr in dB>
+//
+
+static const int FOVEATION_PRESETS_VERSION = 1;
+
+struct FoveationPreset
+{
+    FoveationParams params;
+    // predicted fragment shader invocations per pixel, 1 is full rate
+    float invocationsPerPixel = 1.0f;
+    // against the full rate reference frames the tuner was given
+    float psnr = 0.0f;
+};
+
+struct FoveationPresets
+{
+    std::vector<FoveationPreset> presets;
+    // the tuner's recommendation, the knee of the front
+    size_t defaultIndex = 0;
+};
+
+bool loadFoveationPresets(const std::string& filename, FoveationPresets& presets, std::string* error);
+bool writeFoveationPresets(const std::string& filename, const FoveationPresets& presets, std::string* error);
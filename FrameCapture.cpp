@@ -0,0 +1,264 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameCapture.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <filesystem>
+
+static const GLbitfield READBACK_FLAGS = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// persistently mapped for reading, grown in place when the capture size changes
+static void reserveReadbackBuffer(GLuint& buffer, const uint8_t*& pointer, uint64_t& capacity, uint64_t size)
+{
+    if (size <= capacity)
+    {
+        return;
+    }
+
+    if (buffer)
+    {
+        glUnmapNamedBuffer(buffer);
+        nvgl::deleteBuffer(buffer);
+    }
+
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, GLsizeiptr(size), nullptr, READBACK_FLAGS | GL_CLIENT_STORAGE_BIT);
+    pointer = static_cast<const uint8_t*>(glMapNamedBufferRange(buffer, 0, GLsizeiptr(size), READBACK_FLAGS));
+    capacity = size;
+}
+
+FrameCapture::FrameCapture()
+    : m_writer([this](size_t index) { releaseSlot(index); })
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    close();
+}
+
+bool FrameCapture::start(const std::string& directory, uint32_t frameCount, uint32_t ringSize)
+{
+    //
+    // The slots of the previous capture still belong to it, with its
+    // directory and counts, until they are written.
+    //
+    if (isBusy())
+    {
+        LOGW("the previous capture is still being written\n");
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        LOGE("could not create the capture directory %s\n", directory.c_str());
+        return false;
+    }
+
+    if (m_slots.size() != ringSize)
+    {
+        close();
+        m_slots.resize(ringSize);
+    }
+
+    m_writer.begin(directory);
+    m_framesRemaining = frameCount;
+    m_framesRequested = 0;
+    m_failureReported = false;
+    return true;
+}
+
+void FrameCapture::stop()
+{
+    m_framesRemaining = 0;
+}
+
+void FrameCapture::close()
+{
+    m_framesRemaining = 0;
+    m_writer.close();
+
+    // readbacks still in flight are lost, the writer is done with everything else
+    for (Slot& slot : m_slots)
+    {
+        if (slot.fence)
+        {
+            glDeleteSync(slot.fence);
+            m_writer.drop();
+        }
+        if (slot.colorBuffer)
+        {
+            glUnmapNamedBuffer(slot.colorBuffer);
+            nvgl::deleteBuffer(slot.colorBuffer);
+        }
+        if (slot.rateBuffer)
+        {
+            glUnmapNamedBuffer(slot.rateBuffer);
+            nvgl::deleteBuffer(slot.rateBuffer);
+        }
+        slot = Slot();
+    }
+}
+
+bool FrameCapture::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Slot& slot : m_slots)
+    {
+        if (slot.state != SLOT_FREE)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t FrameCapture::getRingBytes() const
+{
+    uint64_t bytes = 0;
+    for (const Slot& slot : m_slots)
+    {
+        bytes += slot.colorCapacity + slot.rateCapacity;
+    }
+    return bytes;
+}
+
+void FrameCapture::update(uint32_t frameIndex, GLuint colorTexture, uint32_t width, uint32_t height,
+                          GLuint rateTexture, uint32_t rateWidth, uint32_t rateHeight)
+{
+    if (m_slots.empty())
+    {
+        return;
+    }
+
+    retireReadbacks();
+
+    if (m_writer.hasWriteFailed() && !m_failureReported)
+    {
+        LOGE("writing frame %u of the capture failed, skipping the rest\n", m_writer.getFailedFrame());
+        m_failureReported = true;
+    }
+
+    if (m_framesRemaining == 0)
+    {
+        return;
+    }
+    --m_framesRemaining;
+    ++m_framesRequested;
+
+    Slot* freeSlot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Slot& slot : m_slots)
+        {
+            if (slot.state == SLOT_FREE)
+            {
+                freeSlot = &slot;
+                break;
+            }
+        }
+    }
+
+    if (!freeSlot)
+    {
+        // the GPU or the disk are more than a ring behind, waiting here would skew the timings
+        m_writer.drop();
+        return;
+    }
+
+    readback(*freeSlot, frameIndex, colorTexture, width, height, rateTexture, rateWidth, rateHeight);
+}
+
+void FrameCapture::retireReadbacks()
+{
+    for (size_t i = 0; i < m_slots.size(); ++i)
+    {
+        Slot& slot = m_slots[i];
+        if (!slot.fence || glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            continue;
+        }
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            slot.state = SLOT_WRITING;
+        }
+
+        // the writer reads straight out of the mappings
+        CaptureFrame frame;
+        frame.frameIndex = slot.frameIndex;
+        frame.color = slot.colorPointer;
+        frame.width = slot.width;
+        frame.height = slot.height;
+        frame.rates = slot.rateWidth ? slot.ratePointer : nullptr;
+        frame.rateWidth = slot.rateWidth;
+        frame.rateHeight = slot.rateHeight;
+        m_writer.push(i, frame);
+    }
+}
+
+void FrameCapture::releaseSlot(size_t index)
+{
+    // on the writer thread; the render thread does not touch the slot until it is free again
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_slots[index].state = SLOT_FREE;
+}
+
+void FrameCapture::readback(Slot& slot, uint32_t frameIndex, GLuint colorTexture, uint32_t width, uint32_t height,
+                            GLuint rateTexture, uint32_t rateWidth, uint32_t rateHeight)
+{
+    // only the render thread touches free slots, the writer does not look at them
+    slot.frameIndex = frameIndex;
+    slot.width = width;
+    slot.height = height;
+    slot.rateWidth = rateTexture ? rateWidth : 0;
+    slot.rateHeight = rateTexture ? rateHeight : 0;
+
+    uint64_t colorSize = uint64_t(width) * height * 4;
+    uint64_t rateSize = uint64_t(slot.rateWidth) * slot.rateHeight;
+    reserveReadbackBuffer(slot.colorBuffer, slot.colorPointer, slot.colorCapacity, colorSize);
+
+    //
+    // The textures can be larger than the captured region, scene_color for
+    // example is allocated at window size and only the scaled framebuffer
+    // is rendered, so read just the region and not the whole level.
+    //
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.colorBuffer);
+    glGetTextureSubImage(colorTexture, 0, 0, 0, 0, GLsizei(width), GLsizei(height), 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                         GLsizei(colorSize), nullptr);
+    if (rateSize)
+    {
+        reserveReadbackBuffer(slot.rateBuffer, slot.ratePointer, slot.rateCapacity, rateSize);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.rateBuffer);
+        glGetTextureSubImage(rateTexture, 0, 0, 0, 0, GLsizei(slot.rateWidth), GLsizei(slot.rateHeight), 1, GL_RED_INTEGER,
+                             GL_UNSIGNED_BYTE, GLsizei(rateSize), nullptr);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    slot.state = SLOT_READBACK;
+}
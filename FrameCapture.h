@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include "CaptureWriter.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Captures the color target and the bound shading rate image of a range of
+// frames to disk without stalling the render loop:
+// - each frame is read back into a slot of a small ring of persistently
+//   mapped pixel pack buffers, guarded by a fence,
+// - once the fence signaled, the slot is handed to the CaptureWriter
+//   thread, which encodes it straight out of the mapping and frees it again,
+// - if no slot is free, because the GPU or the disk are behind, the frame
+//   is dropped and counted instead of waiting.
+//
+// So the memory is bounded by the ring. Colors are written as binary PPM
+// (the input of tools/foveation_tuner), rate images as binary PGM holding
+// the raw palette entries. A new capture can only start once every slot of
+// the previous one is free again.
+//
+class FrameCapture
+{
+public:
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // captures the next frameCount frames into directory, false while isBusy()
+    bool start(const std::string& directory, uint32_t frameCount, uint32_t ringSize = 4);
+    // no new readbacks, the ones in flight are still written
+    void stop();
+    // waits for the writer and frees the buffers, needs the GL context
+    void close();
+
+    // once per frame after rendering, also after stop() to retire the readbacks
+    // in flight; reads the lower left width x height of colorTexture and
+    // rateWidth x rateHeight of rateTexture, an R8UI texture or 0
+    void update(uint32_t frameIndex, GLuint colorTexture, uint32_t width, uint32_t height,
+                GLuint rateTexture, uint32_t rateWidth, uint32_t rateHeight);
+
+    bool isCapturing() const { return m_framesRemaining > 0; }
+    bool isBusy() const;
+
+    uint32_t getFramesRequested() const { return m_framesRequested; }
+    uint32_t getFramesWritten() const { return m_writer.getFramesWritten(); }
+    uint32_t getFramesDropped() const { return m_writer.getFramesDropped(); }
+    uint64_t getBytesWritten() const { return m_writer.getBytesWritten(); }
+    uint64_t getRingBytes() const;
+    bool hasWriteFailed() const { return m_writer.hasWriteFailed(); }
+
+private:
+    enum SlotState
+    {
+        SLOT_FREE,
+        SLOT_READBACK,   // waiting for the fence
+        SLOT_WRITING,    // owned by the writer thread
+    };
+
+    struct Slot
+    {
+        SlotState state = SLOT_FREE;
+        GLsync fence = nullptr;
+        uint32_t frameIndex = 0;
+
+        GLuint colorBuffer = 0;
+        const uint8_t* colorPointer = nullptr;
+        uint64_t colorCapacity = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        GLuint rateBuffer = 0;
+        const uint8_t* ratePointer = nullptr;
+        uint64_t rateCapacity = 0;
+        uint32_t rateWidth = 0;
+        uint32_t rateHeight = 0;
+    };
+
+    void retireReadbacks();
+    void readback(Slot& slot, uint32_t frameIndex, GLuint colorTexture, uint32_t width, uint32_t height,
+                  GLuint rateTexture, uint32_t rateWidth, uint32_t rateHeight);
+    void releaseSlot(size_t index);
+
+    std::vector<Slot> m_slots;
+    mutable std::mutex m_mutex;      // guards the slot states
+    uint32_t m_framesRemaining = 0;
+    uint32_t m_framesRequested = 0;
+    bool m_failureReported = false;
+
+    // last, so its thread ends before the slots go away
+    CaptureWriter m_writer;
+};
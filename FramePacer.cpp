@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cassert>
+
+// std::min takes it by reference, which needs a definition without optimizations
+const uint32_t FramePacer::MAX_FRAMES_IN_FLIGHT;
+
+void FramePacer::setFramesInFlight(uint32_t frames)
+{
+    m_framesInFlight = std::min(std::max(frames, 1u), MAX_FRAMES_IN_FLIGHT);
+}
+
+uint32_t FramePacer::beginFrame(double time)
+{
+    m_current = FrameTimes();
+    m_current.start = time;
+    return m_currentFrame;
+}
+
+bool FramePacer::getFrameToWaitFor(uint32_t& frame) const
+{
+    // the new frame counts once it is submitted
+    if (m_pendingFrames < m_framesInFlight)
+    {
+        return false;
+    }
+    return getOldestPendingFrame(frame);
+}
+
+bool FramePacer::getOldestPendingFrame(uint32_t& frame) const
+{
+    if (!m_pendingFrames)
+    {
+        return false;
+    }
+    frame = m_currentFrame - m_pendingFrames;
+    return true;
+}
+
+void FramePacer::completeFrame(uint32_t frame, double completeTime)
+{
+    uint32_t oldest = 0;
+    if (!getOldestPendingFrame(oldest) || frame != oldest)
+    {
+        assert(!"frames complete in submission order");
+        return;
+    }
+
+    //
+    // The completion time comes from a different clock than the others, a
+    // conversion error must not show up as a negative latency.
+    //
+    const FrameTimes& times = m_pending[getSlot(frame)];
+    completeTime = std::max(completeTime, times.submitted);
+
+    Latency& latency = m_history[m_completedFrames % HISTORY_SIZE];
+    latency.throttleWait = times.throttled - times.start;
+    latency.inputToSubmit = times.submitted - times.latched;
+    latency.submitToComplete = completeTime - times.submitted;
+    latency.inputToComplete = completeTime - times.latched;
+
+    --m_pendingFrames;
+    ++m_completedFrames;
+}
+
+void FramePacer::endThrottle(double time)
+{
+    assert(m_pendingFrames < m_framesInFlight);
+    m_current.throttled = time;
+    // in case the input is never latched
+    m_current.latched = time;
+}
+
+void FramePacer::latchInput(double time)
+{
+    m_current.latched = time;
+}
+
+void FramePacer::submitFrame(double time)
+{
+    m_current.submitted = time;
+    m_pending[getSlot(m_currentFrame)] = m_current;
+    ++m_pendingFrames;
+    ++m_currentFrame;
+}
+
+bool FramePacer::getLatency(Latency& average, Latency& maximum) const
+{
+    uint32_t count = uint32_t(std::min<uint64_t>(m_completedFrames, HISTORY_SIZE));
+    if (!count)
+    {
+        return false;
+    }
+
+    average = Latency();
+    maximum = Latency();
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Latency& latency = m_history[i];
+        average.throttleWait += latency.throttleWait;
+        average.inputToSubmit += latency.inputToSubmit;
+        average.submitToComplete += latency.submitToComplete;
+        average.inputToComplete += latency.inputToComplete;
+        maximum.throttleWait = std::max(maximum.throttleWait, latency.throttleWait);
+        maximum.inputToSubmit = std::max(maximum.inputToSubmit, latency.inputToSubmit);
+        maximum.submitToComplete = std::max(maximum.submitToComplete, latency.submitToComplete);
+        maximum.inputToComplete = std::max(maximum.inputToComplete, latency.inputToComplete);
+    }
+    average.throttleWait /= count;
+    average.inputToSubmit /= count;
+    average.submitToComplete /= count;
+    average.inputToComplete /= count;
+    return true;
+}
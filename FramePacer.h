@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+//
+// Frames-in-flight throttling and input latency bookkeeping of the render
+// loop. Pure CPU: the caller owns the fences and the clocks and reports the
+// times, so the same logic runs against the GL fences of GLDemo and against
+// the simulated GPU of tools/frame_pacing_sim. All times are seconds of one
+// CPU clock, GPU completion times have to be converted by the caller.
+//
+// Per frame:
+//   beginFrame()           before the throttle
+//   getFrameToWaitFor()    while true, block until that frame is done on the
+//   completeFrame()        GPU and report when it finished
+//   endThrottle()          the CPU may start working on the frame
+//   latchInput()           camera and gaze were sampled
+//   submitFrame()          the last command of the frame was flushed
+// Frames finish in submission order. Finished frames can also be picked up
+// without blocking, by polling the one getOldestPendingFrame() returns.
+//
+class FramePacer
+{
+public:
+    static const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    static const uint32_t HISTORY_SIZE = 64;    // completed frames the latency covers
+
+    struct Latency
+    {
+        double throttleWait = 0.0;      // frame start until the throttle let it go
+        double inputToSubmit = 0.0;     // input latched until the frame was submitted
+        double submitToComplete = 0.0;  // submitted until the GPU finished it
+        double inputToComplete = 0.0;   // what the latched input waits for in total
+    };
+
+    // submitted frames the GPU may be behind, 1 serializes CPU and GPU
+    void setFramesInFlight(uint32_t frames);
+    uint32_t getFramesInFlight() const { return m_framesInFlight; }
+
+    // returns the index of the new frame
+    uint32_t beginFrame(double time);
+    // the oldest pending frame, as long as too many are pending to start a new one
+    bool getFrameToWaitFor(uint32_t& frame) const;
+    bool getOldestPendingFrame(uint32_t& frame) const;
+    // only for the oldest pending frame
+    void completeFrame(uint32_t frame, double completeTime);
+    void endThrottle(double time);
+    void latchInput(double time);
+    void submitFrame(double time);
+
+    uint32_t getCurrentFrame() const { return m_currentFrame; }
+    uint32_t getPendingFrames() const { return m_pendingFrames; }
+    uint64_t getCompletedFrames() const { return m_completedFrames; }
+
+    // fence or query slot of a frame, not in use by any other pending frame
+    static uint32_t getSlot(uint32_t frame) { return frame % MAX_FRAMES_IN_FLIGHT; }
+
+    // over the last HISTORY_SIZE completed frames, false before the first one
+    bool getLatency(Latency& average, Latency& maximum) const;
+
+private:
+    struct FrameTimes
+    {
+        double start = 0.0;
+        double throttled = 0.0;
+        double latched = 0.0;
+        double submitted = 0.0;
+    };
+
+    // the slot of the current frame may still be pending until the throttle is done
+    FrameTimes m_current;
+    FrameTimes m_pending[MAX_FRAMES_IN_FLIGHT];
+    Latency m_history[HISTORY_SIZE];
+
+    uint32_t m_framesInFlight = 2;
+    uint32_t m_currentFrame = 0;
+    uint32_t m_pendingFrames = 0;
+    uint64_t m_completedFrames = 0;
+};
@@ -27,10 +27,37 @@
 #include "imgui/backends/imgui_impl_gl.h"
 #include "imgui/imgui_helper.h"
 
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "GpuTimer.h"
 #include "Pipeline.h"
+#include "RenderQueue.h"
+#include "SceneTransforms.h"
+#include "SessionTrace.h"
+#include "ShadingRateImage.h"
+#include "TessellatedTorus.h"
 #include "Torus.h"
+#include "UnifiedDraws.h"
+#include "Upscaler.h"
+#include "common.h"
 
+#include "nvpsystem.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstring>
 #include <memory>
+#include <vector>
+
+// what renderTori() draws the tori with
+enum TorusPath
+{
+    TORUS_PATH_VERTEX,          // the index buffer of Torus
+    TORUS_PATH_TESSELLATION,    // the patches of TessellatedTorus
+    TORUS_PATH_MESHLETS,        // the meshlets of Torus, culled by the task shader
+    TORUS_PATH_COUNT
+};
 
 template <class PIPELINE>
 class GLDemo : public nvgl::AppWindowProfilerGL
@@ -57,22 +84,102 @@ protected:
     virtual void reloadShaders() {};
     nvh::CameraControl m_control;
 
+    // session traces, derived classes add their own settings
+    virtual void storeTraceSettings(TraceSettings& settings);
+    virtual void applyTraceSettings(const TraceSettings& settings);
+
     std::unique_ptr< PIPELINE > m_pipeline = nullptr;
 
     // torus related:
-    void renderTori(uint32_t numberOfTori);
+    // the scene program has to match the path: a tessellated permutation for
+    // TORUS_PATH_TESSELLATION, a meshShader one for TORUS_PATH_MESHLETS.
+    // unified sets the buffers of the vertex path by GPU address, if supported
+    void renderTori(uint32_t numberOfTori, TorusPath path = TORUS_PATH_VERTEX, bool unified = false);
+    // model matrix and color of each torus, on a grid fitting the window
+    void placeTori(uint32_t numberOfTori, std::vector<vertexload::InstanceData>& instances);
+    std::vector<vertexload::InstanceData> m_torusInstances;
+    // draw order of the tori, front to back with m_sortDraws, grid order otherwise
+    RenderQueue m_renderQueue;
+    bool m_sortDraws = true;
+    double m_sortMilliseconds = 0.0;
     Torus m_torus;
+    TessellatedTorus m_tessellatedTorus;
+    UnifiedDraws m_unifiedDraws;
     int m_torusTessellationN;
     int m_torusTessellationM;
     int m_numberOfTori = 16;
     int m_fragmentLoad = 16;
 
+    // UI windows hiding the scene: call setNextPanelOpaque() before and
+    // addOpaquePanel() inside each ImGui::Begin() block
+    void setNextPanelOpaque();
+    void addOpaquePanel();
+    // the panels of this frame in framebuffer pixels with a bottom-left origin,
+    // without the pixels that still show through the upscaler
+    void getOpaquePanelRects(std::vector<PixelRect>& rects);
+    bool m_opaquePanels = false;
+
+    GLuint getSceneDepthTexture() const { return m_textures.scene_depthstencil; }
+
+    // the shading rate image to capture along with the color target, 0 for none
+    virtual GLuint getCaptureRateImage(uint32_t& width, uint32_t& height) { return 0; }
+
+    // Samples the camera and the gaze, once per frame. With the late latch,
+    // renderFrame calls this right before the work that depends on either,
+    // otherwise it already happened after the UI. The gaze is the cursor in
+    // 0..1 framebuffer coordinates with a bottom-left origin.
+    void latchInput();
+    glm::vec2 m_gaze = glm::vec2(0.5f);
+
 private:
     void clearFrameBuffer();
     void blitFrameBufferToScreen();
 
     double m_uiTime = 0.0;
 
+    // content regions of the opaque UI windows in window pixels with a top-left origin
+    std::vector<PixelRect> m_uiPanels;
+
+    // framebuffer scaling:
+    std::unique_ptr< Upscaler > m_upscaler = nullptr;
+    int m_upscaleFilter = UPSCALE_NEAREST;
+    float m_upscaleSharpness = 1.0f;
+    GpuTimer m_blitTimer;
+
+    // session recording and fixed timestep replay:
+    void processTraceUI();
+    void recordTraceFrame();
+    bool replayTraceFrame(double& time);
+    std::string getTraceFilename() const { return NVPSystem::exePath() + PROJECT_NAME ".trace"; }
+    SessionTraceWriter m_traceWriter;
+    SessionTraceReader m_traceReader;
+    uint32_t m_traceFrameIndex = 0;
+    uint32_t m_replayedFrames = 0;
+    std::chrono::high_resolution_clock::time_point m_replayStart;
+
+    // frames in flight and input latency:
+    void throttleFrames();
+    void completeFrame(uint32_t frame);
+    void submitFrame();
+    void processLatencyUI();
+    static double getCpuSeconds();
+    FramePacer m_framePacer;
+    GLsync m_frameFences[FramePacer::MAX_FRAMES_IN_FLIGHT] = {};
+    GLuint m_frameEndQueries[FramePacer::MAX_FRAMES_IN_FLIGHT] = {};
+    double m_gpuClockOffset = 0.0;  // seconds from the GPU timestamps to getCpuSeconds()
+    int m_framesInFlight = 2;
+    bool m_lateInputLatch = true;
+    bool m_inputLatched = false;
+    bool m_replayingFrame = false;
+
+    // frame capture to disk:
+    void processCaptureUI();
+    void captureFrame();
+    std::string getCaptureDirectory() const { return NVPSystem::exePath() + PROJECT_NAME "_capture"; }
+    FrameCapture m_frameCapture;
+    int m_captureFrameCount = 60;
+    uint32_t m_frameCounter = 0;    // names the captured files
+
     // init and resize:
     bool initFramebuffers(int width, int height);
     void initCameraControl();
@@ -112,6 +219,8 @@ bool GLDemo<PIPELINE>::begin()
 
     initCameraControl();
 
+    m_upscaler = std::make_unique< Upscaler >();
+
     bool initOK = true;
     initOK &= initFramebuffers(getWindowWidth(), getWindowHeight());
 
@@ -121,27 +230,164 @@ bool GLDemo<PIPELINE>::begin()
 template <class PIPELINE>
 void GLDemo<PIPELINE>::think(double time)
 {
+    throttleFrames();
+
     ImGui::NewFrame();
     processUI(time);
 
-    m_control.processActions({m_windowState.m_winSize[0],m_windowState.m_winSize[1]},
-        glm::vec2(m_windowState.m_mouseCurrent[0], m_windowState.m_mouseCurrent[1]),
-        m_windowState.m_mouseButtonFlags, m_windowState.m_mouseWheel);
+    // a replayed frame overrides the camera and all settings, including UI changes made above
+    m_replayingFrame = replayTraceFrame(time);
+    m_inputLatched = false;
+    if (!m_lateInputLatch)
+    {
+        latchInput();
+    }
 
     clearFrameBuffer();
 
     renderFrame(time, getFramebufferWidth(), getFramebufferHeight(), m_fbo);
+    latchInput();
+
+    captureFrame();
 
     blitFrameBufferToScreen();
 
     ImGui::Render();
     ImGui::RenderDrawDataGL(ImGui::GetDrawData());
     ImGui::EndFrame();
+
+    submitFrame();
+}
+
+template <class PIPELINE>
+double GLDemo<PIPELINE>::getCpuSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::throttleFrames()
+{
+    m_framePacer.setFramesInFlight(uint32_t(m_framesInFlight));
+    m_framePacer.beginFrame(getCpuSeconds());
+
+    // frames the GPU finished meanwhile, then block until few enough are queued
+    uint32_t frame = 0;
+    while (m_framePacer.getOldestPendingFrame(frame)
+        && glClientWaitSync(m_frameFences[FramePacer::getSlot(frame)], 0, 0) != GL_TIMEOUT_EXPIRED)
+    {
+        completeFrame(frame);
+    }
+    while (m_framePacer.getFrameToWaitFor(frame))
+    {
+        while (glClientWaitSync(m_frameFences[FramePacer::getSlot(frame)], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+        {
+            LOGW("still waiting for frame %u\n", frame);
+        }
+        completeFrame(frame);
+    }
+
+    //
+    // The GPU timestamps of the frame ends are converted to the CPU clock by
+    // the offset between both clocks, sampled back to back. The GPU time is
+    // read without waiting for the queued commands.
+    //
+    GLint64 gpuNanoseconds = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNanoseconds);
+    double now = getCpuSeconds();
+    m_gpuClockOffset = now - double(gpuNanoseconds) * 1.0e-9;
+
+    m_framePacer.endThrottle(now);
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::completeFrame(uint32_t frame)
+{
+    uint32_t slot = FramePacer::getSlot(frame);
+
+    // the fence signaled, the timestamp written before it is available
+    GLuint64 gpuNanoseconds = 0;
+    glGetQueryObjectui64v(m_frameEndQueries[slot], GL_QUERY_RESULT, &gpuNanoseconds);
+    m_framePacer.completeFrame(frame, double(gpuNanoseconds) * 1.0e-9 + m_gpuClockOffset);
+
+    glDeleteSync(m_frameFences[slot]);
+    m_frameFences[slot] = nullptr;
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::submitFrame()
+{
+    if (!m_frameEndQueries[0])
+    {
+        glCreateQueries(GL_TIMESTAMP, FramePacer::MAX_FRAMES_IN_FLIGHT, m_frameEndQueries);
+    }
+
+    uint32_t slot = FramePacer::getSlot(m_framePacer.getCurrentFrame());
+    glQueryCounter(m_frameEndQueries[slot], GL_TIMESTAMP);
+    m_frameFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // submitted means handed to the GPU, not just recorded by the driver
+    glFlush();
+    m_framePacer.submitFrame(getCpuSeconds());
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::latchInput()
+{
+    if (m_inputLatched)
+    {
+        return;
+    }
+    m_inputLatched = true;
+
+    if (!m_replayingFrame)
+    {
+        //
+        // The window state is from the event poll before think(), the
+        // cursor is read again so a late latch also sees where it moved
+        // while the CPU waited on the throttle and built the frame.
+        //
+        double cursorX = m_windowState.m_mouseCurrent[0];
+        double cursorY = m_windowState.m_mouseCurrent[1];
+        glfwGetCursorPos(m_internal, &cursorX, &cursorY);
+
+        m_control.processActions({m_windowState.m_winSize[0],m_windowState.m_winSize[1]},
+            glm::vec2(float(cursorX), float(cursorY)),
+            m_windowState.m_mouseButtonFlags, m_windowState.m_mouseWheel);
+
+        m_gaze.x = glm::clamp(float(cursorX) / float(std::max(getWindowWidth(), 1)), 0.0f, 1.0f);
+        m_gaze.y = glm::clamp(1.0f - float(cursorY) / float(std::max(getWindowHeight(), 1)), 0.0f, 1.0f);
+    }
+
+    recordTraceFrame();
+
+    m_framePacer.latchInput(getCpuSeconds());
 }
 
 template <class PIPELINE>
 void GLDemo<PIPELINE>::end()
 {
+    std::string error;
+    if (!m_traceWriter.close(&error))
+    {
+        LOGE("%s\n", error.c_str());
+    }
+    m_traceReader.close();
+    m_frameCapture.close();
+    for (GLsync& fence : m_frameFences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_frameEndQueries[0])
+    {
+        glDeleteQueries(FramePacer::MAX_FRAMES_IN_FLIGHT, m_frameEndQueries);
+        m_frameEndQueries[0] = 0;
+    }
+    m_upscaler = nullptr;
     ImGui::ShutdownGL();
 }
 
@@ -160,87 +406,452 @@ void GLDemo<PIPELINE>::processUI(double time)
     imgui_io.DisplaySize = ImVec2(getWindowWidth(), getWindowHeight());
 
     m_uiTime = time;
+    m_uiPanels.clear();
 
     ImGui::SetNextWindowPos({30, 30}, ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowSize(ImGuiH::dpiScaled(450, 0), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
     if (ImGui::Begin("NVIDIA " PROJECT_NAME, nullptr))
     {
+        addOpaquePanel();
         ImGui::SliderInt("Framebuffer scaling", &m_framebufferScaling, 1, 16);
+        ImGui::Combo("Upscaling filter", &m_upscaleFilter, UPSCALE_FILTER_NAMES, UPSCALE_FILTER_COUNT);
+        if (m_upscaleFilter == UPSCALE_EDGE_ADAPTIVE)
+        {
+            ImGui::SliderFloat("Sharpness", &m_upscaleSharpness, 0.0f, 2.0f);
+        }
+        if (m_framebufferScaling > 1 && m_upscaleFilter != UPSCALE_NEAREST)
+        {
+            ImGui::Text("Upscale pass: %.3f ms, present blit: %.3f ms", m_upscaler->getMilliseconds(), m_blitTimer.getMilliseconds());
+        }
+        else
+        {
+            ImGui::Text("Present blit: %.3f ms", m_blitTimer.getMilliseconds());
+        }
 
         if (ImGui::Button("Reload Shader"))
         {
             m_pipeline->reloadShaders();
+            m_upscaler->reloadShaders();
             reloadShaders();
         }
+
+        processLatencyUI();
+        processTraceUI();
+        processCaptureUI();
     }
     ImGui::End();
 }
 
-template<class PIPELINE>
-void GLDemo<PIPELINE>::renderTori(uint32_t numberOfTori)
+template <class PIPELINE>
+void GLDemo<PIPELINE>::processLatencyUI()
+{
+    ImGui::Separator();
+
+    ImGui::SliderInt("Frames in flight", &m_framesInFlight, 1, int(FramePacer::MAX_FRAMES_IN_FLIGHT));
+    ImGui::Checkbox("Late input latch", &m_lateInputLatch);
+
+    //
+    // Times of the frames the GPU finished last, as seen by the latched
+    // input. Presenting the image adds the swap and scanout on top of the
+    // GPU completion.
+    //
+    FramePacer::Latency average;
+    FramePacer::Latency maximum;
+    if (m_framePacer.getLatency(average, maximum))
+    {
+        ImGui::Text("Throttle wait: %.2f ms (max %.2f)", average.throttleWait * 1000.0, maximum.throttleWait * 1000.0);
+        ImGui::Text("Input to submit: %.2f ms (max %.2f)", average.inputToSubmit * 1000.0, maximum.inputToSubmit * 1000.0);
+        ImGui::Text("Submit to GPU complete: %.2f ms (max %.2f)", average.submitToComplete * 1000.0, maximum.submitToComplete * 1000.0);
+        ImGui::Text("Input to GPU complete: %.2f ms (max %.2f)", average.inputToComplete * 1000.0, maximum.inputToComplete * 1000.0);
+    }
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::processCaptureUI()
 {
-    m_torus.setBufferState();
+    ImGui::Separator();
 
-    float num = (float)numberOfTori;
-    int width = m_windowState.m_winSize[0];
-    int height = m_windowState.m_winSize[1];
+    if (m_frameCapture.isCapturing())
+    {
+        if (ImGui::Button("Stop capture"))
+        {
+            m_frameCapture.stop();
+        }
+    }
+    else if (m_frameCapture.isBusy())
+    {
+        // the frames of the previous capture still count towards it
+        ImGui::TextUnformatted("Writing the captured frames...");
+    }
+    else
+    {
+        if (ImGui::Button("Capture frames"))
+        {
+            m_frameCapture.start(getCaptureDirectory(), uint32_t(m_captureFrameCount));
+        }
+        ImGui::SameLine();
+        ImGui::SliderInt("##capture frames", &m_captureFrameCount, 1, 1000, "%d frames", ImGuiSliderFlags_Logarithmic);
+    }
+
+    if (m_frameCapture.getFramesRequested())
+    {
+        ImGui::Text("Captured %u of %u frames, %u dropped, %.1f MB written", m_frameCapture.getFramesWritten(),
+            m_frameCapture.getFramesRequested(), m_frameCapture.getFramesDropped(),
+            m_frameCapture.getBytesWritten() / (1024.0 * 1024.0));
+        if (m_frameCapture.hasWriteFailed())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Writing to %s failed", getCaptureDirectory().c_str());
+        }
+    }
+}
 
-    // distribute num tori into an numX x numY pattern
-    // with numX * numY > num, numX = aspect * numY
+template <class PIPELINE>
+void GLDemo<PIPELINE>::captureFrame()
+{
+    uint32_t rateWidth = 0;
+    uint32_t rateHeight = 0;
+    GLuint rateTexture = m_frameCapture.isCapturing() ? getCaptureRateImage(rateWidth, rateHeight) : 0;
 
-    float aspect = (float)width / (float)height;
+    m_frameCapture.update(m_frameCounter++, m_textures.scene_color, getFramebufferWidth(), getFramebufferHeight(),
+        rateTexture, rateWidth, rateHeight);
+}
 
-    size_t numX = static_cast<size_t>(ceil(sqrt(num * aspect)));
-    size_t numY = static_cast<size_t>((float)numX / aspect);
-    if (numX * numY < num)
+template <class PIPELINE>
+void GLDemo<PIPELINE>::setNextPanelOpaque()
+{
+    if (m_opaquePanels)
     {
-        ++numY;
+        ImGui::SetNextWindowBgAlpha(1.0f);
     }
-    float rx = 1.0f;                     // radius of ring
-    float ry = 1.0f;
-    float dx = 1.0f;                     // ring distance
-    float dy = 1.5f;
-    float sx = (numX - 1) * dx + 2 * rx; // array size 
-    float sy = (numY - 1) * dy + 2 * ry;
+}
 
-    float x0 = -sx / 2.0f + rx;
-    float y0 = -sy / 2.0f + ry;
+template <class PIPELINE>
+void GLDemo<PIPELINE>::addOpaquePanel()
+{
+    if (!m_opaquePanels)
+    {
+        return;
+    }
 
-    float scale = std::min(1.f / sx, 1.f / sy) * 0.8f;
+    // only the content region, the title bar and the rounded corners may be translucent
+    ImVec2 pos = ImGui::GetWindowPos();
+    ImVec2 contentMin = ImGui::GetWindowContentRegionMin();
+    ImVec2 contentMax = ImGui::GetWindowContentRegionMax();
+
+    PixelRect rect;
+    rect.x0 = pos.x + contentMin.x;
+    rect.y0 = pos.y + contentMin.y;
+    rect.x1 = pos.x + contentMax.x;
+    rect.y1 = pos.y + contentMax.y;
+    m_uiPanels.push_back(rect);
+}
 
-    size_t torusIndex = 0;
-    for (size_t i = 0; i < numY && torusIndex < num; ++i)
+template <class PIPELINE>
+void GLDemo<PIPELINE>::getOpaquePanelRects(std::vector<PixelRect>& rects)
+{
+    rects.clear();
+    if (!m_opaquePanels)
     {
-        for (size_t j = 0; j < numX && torusIndex < num; ++j)
+        return;
+    }
+
+    //
+    // The framebuffer is stretched over the window, a framebuffer pixel is
+    // hidden if all window pixels it covers are. The filtered upscalers
+    // also read up to two framebuffer pixels around each window pixel.
+    //
+    float scaleX = float(getFramebufferWidth()) / float(getWindowWidth());
+    float scaleY = float(getFramebufferHeight()) / float(getWindowHeight());
+    float margin = (m_framebufferScaling > 1 && m_upscaleFilter != UPSCALE_NEAREST) ? 2.0f : 0.0f;
+    float framebufferHeight = float(getFramebufferHeight());
+
+    for (const PixelRect& panel : m_uiPanels)
+    {
+        PixelRect rect;
+        rect.x0 = panel.x0 * scaleX + margin;
+        rect.x1 = panel.x1 * scaleX - margin;
+        rect.y0 = framebufferHeight - panel.y1 * scaleY + margin;
+        rect.y1 = framebufferHeight - panel.y0 * scaleY - margin;
+        if (rect.x0 < rect.x1 && rect.y0 < rect.y1)
+        {
+            rects.push_back(rect);
+        }
+    }
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::processTraceUI()
+{
+    ImGui::Separator();
+
+    if (m_traceWriter.isOpen())
+    {
+        ImGui::Text("Recording frame %u", m_traceWriter.getFrameCount());
+        std::string error;
+        if (ImGui::Button("Stop recording") && m_traceWriter.close(&error))
+        {
+            LOGI("recorded %u frames to %s\n", m_traceFrameIndex, getTraceFilename().c_str());
+        }
+        else if (!error.empty())
+        {
+            LOGE("%s\n", error.c_str());
+        }
+    }
+    else if (m_traceReader.isOpen())
+    {
+        ImGui::Text("Replaying frame %u", m_replayedFrames);
+        if (ImGui::Button("Stop replay"))
+        {
+            m_traceReader.close();
+        }
+    }
+    else
+    {
+        std::string error;
+        if (ImGui::Button("Record session"))
+        {
+            m_traceFrameIndex = 0;
+            m_traceWriter.open(getTraceFilename(), 1.0f / 60.0f, &error);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Replay session") && m_traceReader.open(getTraceFilename(), &error))
+        {
+            m_replayedFrames = 0;
+        }
+        if (!error.empty())
+        {
+            LOGE("%s\n", error.c_str());
+        }
+    }
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::recordTraceFrame()
+{
+    if (!m_traceWriter.isOpen())
+    {
+        return;
+    }
+
+    TraceFrame frame;
+    frame.frameIndex = m_traceFrameIndex++;
+    frame.windowWidth = uint16_t(getWindowWidth());
+    frame.windowHeight = uint16_t(getWindowHeight());
+    frame.framebufferWidth = uint16_t(getFramebufferWidth());
+    frame.framebufferHeight = uint16_t(getFramebufferHeight());
+    for (int i = 0; i < 16; ++i)
+    {
+        frame.viewMatrix[i] = m_control.m_viewMatrix[i / 4][i % 4];
+    }
+    frame.gaze[0] = m_gaze.x;
+    frame.gaze[1] = m_gaze.y;
+
+    TraceSettings settings;
+    storeTraceSettings(settings);
+
+    m_traceWriter.record(frame, settings);
+}
+
+template <class PIPELINE>
+bool GLDemo<PIPELINE>::replayTraceFrame(double& time)
+{
+    if (!m_traceReader.isOpen())
+    {
+        return false;
+    }
+
+    TraceFrame frame;
+    TraceSettings settings;
+    std::string error;
+    if (!m_traceReader.next(frame, settings, &error))
+    {
+        if (!error.empty())
         {
-            float y = y0 + i * dy;
-            float x = x0 + j * dx;
+            LOGE("%s, replay stopped\n", error.c_str());
+        }
+        // wall clock time of the whole replay, for A/B comparisons of settings baked into the code
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_replayStart).count();
+        LOGI("replayed %u frames in %.3f s, %.3f ms per frame\n", m_replayedFrames, seconds,
+            m_replayedFrames ? seconds * 1000.0 / m_replayedFrames : 0.0);
+        m_traceReader.close();
+        return false;
+    }
 
-            float rotationAngle = (j % 2 ? -1.0f : 1.0f) * 45.0f * glm::pi<float>() / 180.0f;
-            glm::mat4 modelMatrix =
-                glm::scale(glm::mat4(1.0f), glm::vec3(scale))
-                * glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.0f))
-                * glm::rotate(glm::mat4(1.f), rotationAngle, glm::vec3(1, 0, 0));
+    if (m_replayedFrames == 0)
+    {
+        m_replayStart = std::chrono::high_resolution_clock::now();
+        if (frame.windowWidth != getWindowWidth() || frame.windowHeight != getWindowHeight())
+        {
+            LOGW("trace was recorded at %dx%d, the window is %dx%d, frames will differ\n",
+                frame.windowWidth, frame.windowHeight, getWindowWidth(), getWindowHeight());
+        }
+    }
+    ++m_replayedFrames;
 
-            m_pipeline->setModelMatrix(modelMatrix);
+    applyTraceSettings(settings);
+    for (int i = 0; i < 16; ++i)
+    {
+        m_control.m_viewMatrix[i / 4][i % 4] = frame.viewMatrix[i];
+    }
+    m_gaze = glm::vec2(clampTraceSetting(frame.gaze[0], 0.0f, 1.0f), clampTraceSetting(frame.gaze[1], 0.0f, 1.0f));
 
-            // Use colors light blue and green
-            int colorIndex = torusIndex % 5;
-            glm::vec3 color(0, .7f, 1);
-            if (colorIndex == 4) {
-                color = glm::vec3(0, 1, 0);
-            }
+    // fixed timestep, independent of how long the frames actually took
+    time = double(frame.frameIndex) * m_traceReader.getTimestep();
 
-            m_pipeline->setObjectColor(color);
+    return true;
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::storeTraceSettings(TraceSettings& settings)
+{
+    settings.framebufferScaling = m_framebufferScaling;
+    settings.upscaleFilter = m_upscaleFilter;
+    settings.upscaleSharpness = m_upscaleSharpness;
+    settings.numberOfTori = m_numberOfTori;
+    settings.fragmentLoad = m_fragmentLoad;
+    settings.torusTessellationN = m_torusTessellationN;
+    settings.torusTessellationM = m_torusTessellationM;
+    settings.opaquePanels = m_opaquePanels ? 1 : 0;
+    settings.sortDraws = m_sortDraws ? 1 : 0;
+}
+
+template <class PIPELINE>
+void GLDemo<PIPELINE>::applyTraceSettings(const TraceSettings& settings)
+{
+    // the ranges of the UI controls, the draw submission sweep goes up to 100k tori
+    m_framebufferScaling = clampTraceSetting(settings.framebufferScaling, 1, 16);
+    m_upscaleFilter = clampTraceSetting(settings.upscaleFilter, 0, int(UPSCALE_FILTER_COUNT) - 1);
+    m_upscaleSharpness = clampTraceSetting(settings.upscaleSharpness, 0.0f, 2.0f);
+    m_numberOfTori = clampTraceSetting(settings.numberOfTori, 1, 100000);
+    m_fragmentLoad = clampTraceSetting(settings.fragmentLoad, 1, 250);
+    m_torusTessellationN = clampTraceSetting(settings.torusTessellationN, 3, 64);
+    m_torusTessellationM = clampTraceSetting(settings.torusTessellationM, 3, 64);
+    m_opaquePanels = settings.opaquePanels != 0;
+    m_sortDraws = settings.sortDraws != 0;
+
+    if (m_torusTessellationM != m_torus.getTessellationM()
+        || m_torusTessellationN != m_torus.getTessellationN())
+    {
+        m_torus.setTessellation(m_torusTessellationN, m_torusTessellationM);
+    }
+}
+
+template<class PIPELINE>
+void GLDemo<PIPELINE>::placeTori(uint32_t numberOfTori, std::vector<vertexload::InstanceData>& instances)
+{
+    int width = m_windowState.m_winSize[0];
+    int height = m_windowState.m_winSize[1];
+    placeTorusGrid(numberOfTori, (float)width / (float)height, instances);
+}
+
+template<class PIPELINE>
+void GLDemo<PIPELINE>::renderTori(uint32_t numberOfTori, TorusPath path, bool unified)
+{
+    // the other paths read storage buffers or their own patches
+    unified = unified && path == TORUS_PATH_VERTEX && UnifiedDraws::isSupported();
+
+    switch (path)
+    {
+    case TORUS_PATH_TESSELLATION:
+        m_tessellatedTorus.setBufferState();
+        break;
+    case TORUS_PATH_MESHLETS:
+        m_torus.setMeshletBufferState();
+        break;
+    default:
+        if (unified)
+        {
+            m_torus.setUnifiedBufferState();
+            m_unifiedDraws.begin(m_pipeline->getSceneBuffer(), m_pipeline->getSceneBufferIndex(), sizeof(m_pipeline->sceneData),
+                m_pipeline->getObjectBufferIndex(), sizeof(m_pipeline->objectData), numberOfTori);
+        }
+        else
+        {
+            m_torus.setBufferState();
+        }
+        break;
+    }
+
+    placeTori(numberOfTori, m_torusInstances);
+
+    //
+    // All tori share the program and the mesh, the key orders them front to
+    // back by the view depth of their center, so the nearer tori fill the
+    // depth buffer before the ones behind them get shaded. The green object
+    // rule selects the viewport, and with it the palette, per primitive in
+    // the vertex shader. There is no state change between green and blue
+    // tori, so the palette field stays 0, grouping by it would only cost
+    // depth order (see tools/overdraw_estimate).
+    //
+    auto sortStart = std::chrono::high_resolution_clock::now();
+    m_renderQueue.clear();
+    m_renderQueue.reserve(m_torusInstances.size());
+    const glm::mat4& viewMatrix = m_control.m_viewMatrix;
+    for (size_t torusIndex = 0; torusIndex < m_torusInstances.size(); ++torusIndex)
+    {
+        uint64_t key = 0;
+        if (m_sortDraws)
+        {
+            glm::vec4 center = viewMatrix * m_torusInstances[torusIndex].model[3];
+            key = makeDrawKey(DRAW_PASS_OPAQUE, 0, uint32_t(path), 0, -center.z);
+        }
+        m_renderQueue.push(key, uint32_t(torusIndex));
+    }
+    m_renderQueue.sort();
+    m_sortMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+
+    const std::vector<RenderQueue::Item>& draws = m_renderQueue.getItems();
+    for (size_t drawIndex = 0; drawIndex < draws.size(); ++drawIndex)
+    {
+        const vertexload::InstanceData& instance = m_torusInstances[draws[drawIndex].index];
+        m_pipeline->setModelMatrix(instance.model);
+        m_pipeline->setObjectColor(glm::vec3(instance.color));
+        if (unified)
+        {
+            // no upload and no bind, the draw only gets the address of its object data
+            m_pipeline->prepareObjectData();
+            m_unifiedDraws.setObject(uint32_t(drawIndex), &m_pipeline->objectData);
+        }
+        else
+        {
             m_pipeline->updateObjectUniforms();
+        }
 
+        switch (path)
+        {
+        case TORUS_PATH_TESSELLATION:
+            m_tessellatedTorus.draw();
+            break;
+        case TORUS_PATH_MESHLETS:
+            m_torus.drawMeshlets();
+            break;
+        default:
             m_torus.draw();
-
-            ++torusIndex;
+            break;
         }
     }
 
-    m_torus.unsetBufferState();
+    switch (path)
+    {
+    case TORUS_PATH_TESSELLATION:
+        m_tessellatedTorus.unsetBufferState();
+        break;
+    case TORUS_PATH_MESHLETS:
+        m_torus.unsetMeshletBufferState();
+        break;
+    default:
+        if (unified)
+        {
+            m_unifiedDraws.end();
+            m_torus.unsetUnifiedBufferState();
+        }
+        else
+        {
+            m_torus.unsetBufferState();
+        }
+        break;
+    }
 }
 
 template <class PIPELINE>
@@ -257,10 +868,32 @@ void GLDemo<PIPELINE>::clearFrameBuffer()
 template <class PIPELINE>
 void GLDemo<PIPELINE>::blitFrameBufferToScreen()
 {
+    GLuint readFbo = m_fbo;
+    int readWidth = getFramebufferWidth();
+    int readHeight = getFramebufferHeight();
+
+    if (m_framebufferScaling > 1 && m_upscaleFilter != UPSCALE_NEAREST)
+    {
+        const nvgl::ProfilerGL::Section profile(m_profiler, "Upscale");
+
+        // filter into a window sized texture, the blit below then is a 1:1 copy
+        m_upscaler->upscale(UpscaleFilter(m_upscaleFilter), m_textures.scene_color,
+            readWidth, readHeight, getWindowWidth(), getWindowHeight(), m_upscaleSharpness);
+
+        readFbo = m_upscaler->getOutputFramebuffer();
+        readWidth = getWindowWidth();
+        readHeight = getWindowHeight();
+    }
+
+    const nvgl::ProfilerGL::Section profile(m_profiler, "Present");
+    m_blitTimer.begin();
+
     // blit to background
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, getFramebufferWidth(), getFramebufferHeight(), 0, 0, getWindowWidth(), getWindowHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBlitFramebuffer(0, 0, readWidth, readHeight, 0, 0, getWindowWidth(), getWindowHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    m_blitTimer.end();
 }
 
 template <class PIPELINE>
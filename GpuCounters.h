@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+#include <vector>
+
+//
+// A few uint counters the shaders of a pass increment, read back through a
+// small ring of persistently mapped buffers guarded by fences, so reading a
+// result never stalls the pipeline. Same ring as GpuTimer, the values lag a
+// few frames behind.
+//
+class GpuCounters
+{
+public:
+    explicit GpuCounters(uint32_t count)
+        : m_count(count)
+    {
+    }
+    GpuCounters(const GpuCounters&) = delete;
+    GpuCounters& operator=(const GpuCounters&) = delete;
+
+    ~GpuCounters()
+    {
+        for (GLsync& fence : m_fences)
+        {
+            if (fence)
+            {
+                glDeleteSync(fence);
+            }
+        }
+        if (m_buffer)
+        {
+            glUnmapNamedBuffer(m_buffer);
+            nvgl::deleteBuffer(m_buffer);
+        }
+    }
+
+    // zeroes the counters of this interval and binds them to a storage buffer binding
+    void begin(GLuint binding)
+    {
+        if (!m_buffer)
+        {
+            // offsets of storage buffer bindings need to be aligned, 256 covers all implementations
+            m_stride = (GLsizeiptr(m_count * sizeof(uint32_t)) + 255) & ~GLsizeiptr(255);
+            glCreateBuffers(1, &m_buffer);
+            glNamedBufferStorage(m_buffer, RING_SIZE * m_stride, nullptr, MAP_FLAGS);
+            m_pointer = static_cast<const uint8_t*>(glMapNamedBufferRange(m_buffer, 0, RING_SIZE * m_stride, MAP_FLAGS));
+            m_values.assign(m_count, 0);
+        }
+
+        int slot = m_frame % RING_SIZE;
+        if (m_fences[slot])
+        {
+            // only happens if the GPU is more than RING_SIZE intervals behind
+            resolve(slot);
+        }
+
+        GLuint zero = 0;
+        glClearNamedBufferSubData(m_buffer, GL_R32UI, slot * m_stride, m_count * sizeof(uint32_t), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_buffer, slot * m_stride, m_count * sizeof(uint32_t));
+    }
+
+    void end(GLuint binding)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+        // the atomics become visible through the mapping once the fence has signaled
+        glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+        int slot = m_frame % RING_SIZE;
+        m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++m_frame;
+
+        // pick up all finished intervals, oldest first
+        for (int i = RING_SIZE - 1; i > 0; --i)
+        {
+            if (m_frame < i)
+            {
+                continue;
+            }
+            int older = (m_frame - i) % RING_SIZE;
+            if (m_fences[older] && glClientWaitSync(m_fences[older], 0, 0) != GL_TIMEOUT_EXPIRED)
+            {
+                resolve(older);
+            }
+        }
+    }
+
+    // the counters of the most recent finished interval, all zero before the first one
+    uint32_t getValue(uint32_t index) const { return index < m_values.size() ? m_values[index] : 0; }
+
+    // increases whenever the values changed
+    uint32_t getResultCount() const { return m_resultCount; }
+
+private:
+    static const int RING_SIZE = 4;
+    static const GLbitfield MAP_FLAGS = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    void resolve(int slot)
+    {
+        while (glClientWaitSync(m_fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+        {
+        }
+        glDeleteSync(m_fences[slot]);
+        m_fences[slot] = nullptr;
+
+        const uint32_t* values = reinterpret_cast<const uint32_t*>(m_pointer + slot * m_stride);
+        m_values.assign(values, values + m_count);
+        ++m_resultCount;
+    }
+
+    uint32_t m_count = 0;
+    GLuint m_buffer = 0;
+    GLsizeiptr m_stride = 0;
+    const uint8_t* m_pointer = nullptr;
+    GLsync m_fences[RING_SIZE] = {};
+    int m_frame = 0;
+    std::vector<uint32_t> m_values;
+    uint32_t m_resultCount = 0;
+};
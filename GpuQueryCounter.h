@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+
+//
+// Counts between begin() and end() with a small ring of queries like
+// GpuTimer, by default the primitives generated after the tessellator and
+// before clipping (GL_PRIMITIVES_GENERATED), or with GL_SAMPLES_PASSED the
+// samples that pass the depth and stencil tests. Unlike the timestamps
+// these queries cannot be nested, queries of different targets can overlap.
+//
+class GpuQueryCounter
+{
+public:
+    explicit GpuQueryCounter(GLenum target = GL_PRIMITIVES_GENERATED)
+        : m_target(target)
+    {
+    }
+    GpuQueryCounter(const GpuQueryCounter&) = delete;
+    GpuQueryCounter& operator=(const GpuQueryCounter&) = delete;
+
+    ~GpuQueryCounter()
+    {
+        if (m_queries[0])
+        {
+            glDeleteQueries(RING_SIZE, m_queries);
+        }
+    }
+
+    void begin()
+    {
+        if (!m_queries[0])
+        {
+            glCreateQueries(m_target, RING_SIZE, m_queries);
+        }
+
+        int slot = m_frame % RING_SIZE;
+        if (m_pending[slot])
+        {
+            // only happens if the GPU is more than RING_SIZE intervals behind
+            resolve(slot);
+        }
+        glBeginQuery(m_target, m_queries[slot]);
+    }
+
+    void end()
+    {
+        int slot = m_frame % RING_SIZE;
+        glEndQuery(m_target);
+        m_pending[slot] = true;
+        ++m_frame;
+
+        // pick up all finished intervals, oldest first
+        for (int i = RING_SIZE - 1; i > 0; --i)
+        {
+            if (m_frame < i)
+            {
+                continue;
+            }
+            int older = (m_frame - i) % RING_SIZE;
+            if (!m_pending[older])
+            {
+                continue;
+            }
+            GLint available = 0;
+            glGetQueryObjectiv(m_queries[older], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                resolve(older);
+            }
+        }
+    }
+
+    // count of the most recent finished interval
+    uint64_t getValue() const { return m_value; }
+
+    // increases whenever getValue() got a new value
+    uint32_t getResultCount() const { return m_resultCount; }
+
+private:
+    static const int RING_SIZE = 4;
+
+    void resolve(int slot)
+    {
+        GLuint64 value = 0;
+        glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &value);
+        m_value = value;
+        m_pending[slot] = false;
+        ++m_resultCount;
+    }
+
+    GLenum m_target = GL_PRIMITIVES_GENERATED;
+    GLuint m_queries[RING_SIZE] = {};
+    bool m_pending[RING_SIZE] = {};
+    int m_frame = 0;
+    uint64_t m_value = 0;
+    uint32_t m_resultCount = 0;
+};
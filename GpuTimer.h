@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+//
+// Measures the GPU time between begin() and end() with a small ring of
+// GL_TIMESTAMP queries, so reading a result never stalls the pipeline.
+// Timestamps (rather than GL_TIME_ELAPSED) allow timers to be nested.
+//
+class GpuTimer
+{
+public:
+    GpuTimer() = default;
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    ~GpuTimer()
+    {
+        if (m_queries[0][0])
+        {
+            glDeleteQueries(RING_SIZE * 2, &m_queries[0][0]);
+        }
+    }
+
+    void begin()
+    {
+        if (!m_queries[0][0])
+        {
+            glCreateQueries(GL_TIMESTAMP, RING_SIZE * 2, &m_queries[0][0]);
+        }
+
+        int slot = m_frame % RING_SIZE;
+        if (m_pending[slot])
+        {
+            // only happens if the GPU is more than RING_SIZE intervals behind
+            resolve(slot);
+        }
+        glQueryCounter(m_queries[slot][0], GL_TIMESTAMP);
+    }
+
+    void end()
+    {
+        int slot = m_frame % RING_SIZE;
+        glQueryCounter(m_queries[slot][1], GL_TIMESTAMP);
+        m_pending[slot] = true;
+        ++m_frame;
+
+        // pick up all finished intervals, oldest first
+        for (int i = RING_SIZE - 1; i > 0; --i)
+        {
+            if (m_frame < i)
+            {
+                continue;
+            }
+            int older = (m_frame - i) % RING_SIZE;
+            if (!m_pending[older])
+            {
+                continue;
+            }
+            GLint available = 0;
+            glGetQueryObjectiv(m_queries[older][1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                resolve(older);
+            }
+        }
+    }
+
+    // time of the most recent finished interval
+    double getMilliseconds() const { return m_milliseconds; }
+
+    // increases whenever getMilliseconds() got a new value
+    uint32_t getResultCount() const { return m_resultCount; }
+
+private:
+    static const int RING_SIZE = 4;
+
+    void resolve(int slot)
+    {
+        GLuint64 start = 0;
+        GLuint64 stop = 0;
+        glGetQueryObjectui64v(m_queries[slot][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(m_queries[slot][1], GL_QUERY_RESULT, &stop);
+        m_milliseconds = double(stop - start) / 1000000.0;
+        m_pending[slot] = false;
+        ++m_resultCount;
+    }
+
+    GLuint m_queries[RING_SIZE][2] = {};
+    bool m_pending[RING_SIZE] = {};
+    int m_frame = 0;
+    double m_milliseconds = 0.0;
+    uint32_t m_resultCount = 0;
+};
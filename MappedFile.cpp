@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+    {
+        close();
+        return false;
+    }
+    m_size = size_t(size.QuadPart);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file)
+    {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+
+    m_file = ::open(filename.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(m_file, &info) != 0 || info.st_size == 0)
+    {
+        close();
+        return false;
+    }
+
+    void* data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    // the file is read front to back
+    madvise(data, size_t(info.st_size), MADV_SEQUENTIAL);
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = size_t(info.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    if (m_file >= 0)
+    {
+        ::close(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+
+#endif
@@ -0,0 +1,319 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MaterialReference.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* const MATERIAL_PRECISION_NAMES[NUM_MATERIAL_PRECISIONS] = { "fp32", "fp16", "fp16 accumulator",
+                                                                         "fp16 everywhere" };
+
+float roundToHalf(float value)
+{
+    float magnitude = std::fabs(value);
+    if (std::isnan(value) || magnitude == 0.0f)
+    {
+        return value;
+    }
+    // halfway between the largest half (65504) and the next power of two rounds to infinity
+    if (magnitude >= 65520.0f)
+    {
+        return std::copysign(INFINITY, value);
+    }
+    // 10 fraction bits, below the smallest normal (2^-14) the spacing stays 2^-24
+    int exponent = 0;
+    std::frexp(magnitude, &exponent);
+    float spacing = std::ldexp(1.0f, std::max(exponent - 11, -24));
+    return std::copysign(std::nearbyint(magnitude / spacing) * spacing, value);
+}
+
+namespace
+{
+// one rounding per operation
+struct Half
+{
+    float v = 0.0f;
+
+    Half() = default;
+    Half(float value) : v(roundToHalf(value)) {}
+};
+
+Half operator+(Half a, Half b) { return Half(a.v + b.v); }
+Half operator-(Half a, Half b) { return Half(a.v - b.v); }
+Half operator*(Half a, Half b) { return Half(a.v * b.v); }
+Half operator/(Half a, Half b) { return Half(a.v / b.v); }
+
+float toFloat(float value) { return value; }
+float toFloat(Half value) { return value.v; }
+
+// the built-in functions are exact or evaluated in fp32 and rounded once
+template <class T> T floorT(T x) { return T(std::floor(toFloat(x))); }
+template <class T> T fractT(T x) { return x - floorT(x); }
+template <class T> T maxT(T a, T b) { return toFloat(a) >= toFloat(b) ? a : b; }
+template <class T> T minT(T a, T b) { return toFloat(a) <= toFloat(b) ? a : b; }
+template <class T> T stepT(T edge, T x) { return T(toFloat(x) >= toFloat(edge) ? 1.0f : 0.0f); }
+template <class T> T mixT(T a, T b, T t) { return a + (b - a) * t; }
+
+template <class T> struct Vec3T
+{
+    T v[3];
+};
+template <class T> struct Vec4T
+{
+    T v[4];
+};
+
+// FAST32_hash_3D
+template <class T>
+void fast32Hash3D(Vec3T<T> gridcell, Vec3T<T> v1Mask, Vec3T<T> v2Mask, Vec4T<T>& hash0, Vec4T<T>& hash1,
+                  Vec4T<T>& hash2)
+{
+    const T OFFSET[2] = { T(50.0f), T(161.0f) };
+    const T DOMAIN = T(69.0f);
+    const T SOMELARGEFLOATS[3] = { T(635.298681f), T(682.357502f), T(668.926525f) };
+    const T ZINC[3] = { T(48.500388f), T(65.294118f), T(63.934599f) };
+
+    // truncate the domain
+    Vec3T<T> gridcellInc1;
+    for (int i = 0; i < 3; ++i)
+    {
+        gridcell.v[i] = gridcell.v[i] - floorT(gridcell.v[i] * T(1.0f / 69.0f)) * DOMAIN;
+        gridcellInc1.v[i] = stepT(gridcell.v[i], DOMAIN - T(1.5f)) * (gridcell.v[i] + T(1.0f));
+    }
+
+    // compute x*x*y*y for the 4 corners
+    T P[4] = { gridcell.v[0] + OFFSET[0], gridcell.v[1] + OFFSET[1], gridcellInc1.v[0] + OFFSET[0],
+               gridcellInc1.v[1] + OFFSET[1] };
+    for (T& p : P)
+    {
+        p = p * p;
+    }
+    T V[4] = { mixT(P[0], P[2], v1Mask.v[0]), mixT(P[1], P[3], v1Mask.v[1]), mixT(P[0], P[2], v2Mask.v[0]),
+               mixT(P[1], P[3], v2Mask.v[1]) };
+    T corners[4] = { P[0] * P[1], V[0] * V[1], V[2] * V[3], P[2] * P[3] };
+
+    // get the lowz and highz mods
+    T lowzMods[3];
+    T highzMods[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        lowzMods[i] = T(1.0f) / (SOMELARGEFLOATS[i] + gridcell.v[2] * ZINC[i]);
+        highzMods[i] = T(1.0f) / (SOMELARGEFLOATS[i] + gridcellInc1.v[2] * ZINC[i]);
+    }
+    const T* v1Mods = toFloat(v1Mask.v[2]) < 0.5f ? lowzMods : highzMods;
+    const T* v2Mods = toFloat(v2Mask.v[2]) < 0.5f ? lowzMods : highzMods;
+
+    // compute the final hash
+    Vec4T<T>* hashes[3] = { &hash0, &hash1, &hash2 };
+    for (int i = 0; i < 3; ++i)
+    {
+        const T mods[4] = { lowzMods[i], v1Mods[i], v2Mods[i], highzMods[i] };
+        for (int c = 0; c < 4; ++c)
+        {
+            hashes[i]->v[c] = fractT(corners[c] * mods[c]);
+        }
+    }
+}
+
+// Simplex3D_GetCornerVectors
+template <class T>
+void simplex3DCornerVectors(Vec3T<T> P, Vec3T<T>& Pi, Vec3T<T>& Pi1, Vec3T<T>& Pi2, Vec4T<T> v1234[3])
+{
+    const T SKEWFACTOR = T(1.0f / 3.0f);
+    const T UNSKEWFACTOR = T(1.0f / 6.0f);
+    const T SIMPLEX_CORNER_POS = T(0.5f);
+    const T SIMPLEX_PYRAMID_HEIGHT = T(0.70710678118654752440084436210485f);
+
+    for (T& p : P.v)
+    {
+        p = p * SIMPLEX_PYRAMID_HEIGHT;
+    }
+
+    // find the vectors to the corners of the simplex pyramid
+    T skew = P.v[0] * SKEWFACTOR + P.v[1] * SKEWFACTOR + P.v[2] * SKEWFACTOR;
+    for (int i = 0; i < 3; ++i)
+    {
+        Pi.v[i] = floorT(P.v[i] + skew);
+    }
+    T unskew = Pi.v[0] * UNSKEWFACTOR + Pi.v[1] * UNSKEWFACTOR + Pi.v[2] * UNSKEWFACTOR;
+    T x0[3];
+    T g[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        x0[i] = P.v[i] - Pi.v[i] + unskew;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        g[i] = stepT(x0[(i + 1) % 3], x0[i]);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        T l = T(1.0f) - g[(i + 2) % 3];
+        Pi1.v[i] = minT(g[i], l);
+        Pi2.v[i] = maxT(g[i], l);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        v1234[i].v[0] = x0[i];
+        v1234[i].v[1] = x0[i] - Pi1.v[i] + UNSKEWFACTOR;
+        v1234[i].v[2] = x0[i] - Pi2.v[i] + SKEWFACTOR;
+        v1234[i].v[3] = x0[i] - SIMPLEX_CORNER_POS;
+    }
+}
+
+// SimplexPerlin3D with the lattice and the hash in TL, the surflets in TS
+template <class TL, class TS> float simplexPerlin3DT(const glm::vec3& position)
+{
+    Vec3T<TL> P = { { TL(position.x), TL(position.y), TL(position.z) } };
+    Vec3T<TL> Pi;
+    Vec3T<TL> Pi1;
+    Vec3T<TL> Pi2;
+    Vec4T<TL> v1234[3];
+    simplex3DCornerVectors(P, Pi, Pi1, Pi2, v1234);
+
+    Vec4T<TL> hash[3];
+    fast32Hash3D(Pi, Pi1, Pi2, hash[0], hash[1], hash[2]);
+
+    // centered in the type of the hash, then converted
+    TS h[3][4];
+    TS v[3][4];
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            h[i][c] = TS(toFloat(hash[i].v[c] - TL(0.49999f)));
+            v[i][c] = TS(toFloat(v1234[i].v[c]));
+        }
+    }
+
+    TS sum = TS(0.0f);
+    for (int c = 0; c < 4; ++c)
+    {
+        // evaluate gradients
+        TS lengthSquared = h[0][c] * h[0][c] + h[1][c] * h[1][c] + h[2][c] * h[2][c];
+        TS gradient = TS(1.0f / std::sqrt(toFloat(lengthSquared))) * (h[0][c] * v[0][c] + h[1][c] * v[1][c] + h[2][c] * v[2][c]);
+
+        // evaluate surflet. f(x)=(0.5-x*x)^3
+        TS weight = v[0][c] * v[0][c] + v[1][c] * v[1][c] + v[2][c] * v[2][c];
+        weight = maxT(TS(0.5f) - weight, TS(0.0f));
+        weight = weight * weight * weight;
+
+        sum = c == 0 ? weight * gradient : sum + weight * gradient;
+    }
+
+    const float FINAL_NORMALIZATION = 37.837227241611314102871574478976f;
+    return toFloat(sum) * FINAL_NORMALIZATION;
+}
+
+// calcNoise with the sum and the smoothstep in TA
+template <class TA> float calcNoiseT(float noise, int iterations)
+{
+    // every iteration evaluates the same noise, the shader is a load generator
+    TA term = TA(noise / float(iterations));
+    TA value = TA(0.0f);
+    for (int i = 0; i < iterations; ++i)
+    {
+        TA next = value + term;
+        if (toFloat(next) == toFloat(value))
+        {
+            break;  // the sum stalled, the remaining iterations do not change it
+        }
+        value = next;
+    }
+
+    // smoothstep(-0.1, 0.1, value)
+    TA t = TA(std::min(std::max(toFloat((value - TA(-0.1f)) / (TA(0.1f) - TA(-0.1f))), 0.0f), 1.0f));
+    return toFloat(t * t * (TA(3.0f) - TA(2.0f) * t));
+}
+}  // namespace
+
+float simplexPerlin3D(const glm::vec3& position, MaterialPrecision precision)
+{
+    switch (precision)
+    {
+    case MATERIAL_FLOAT:
+        return simplexPerlin3DT<float, float>(position);
+    case MATERIAL_HALF_EVERYWHERE:
+        return simplexPerlin3DT<Half, Half>(position);
+    default:
+        return simplexPerlin3DT<float, Half>(position);
+    }
+}
+
+float calcNoise(const glm::vec3& modelPos, int iterations, MaterialPrecision precision)
+{
+    // modelPos*20, rounded like the lattice
+    glm::vec3 position = modelPos * 20.0f;
+    if (precision == MATERIAL_HALF_EVERYWHERE)
+    {
+        position = glm::vec3(roundToHalf(position.x), roundToHalf(position.y), roundToHalf(position.z));
+    }
+
+    float noise = simplexPerlin3D(position, precision);
+    if (precision == MATERIAL_FLOAT || precision == MATERIAL_HALF)
+    {
+        return calcNoiseT<float>(noise, iterations);
+    }
+    return calcNoiseT<Half>(noise, iterations);
+}
+
+glm::vec4 calculateLight(const glm::vec3& normal, const glm::vec3& eyeDir, const glm::vec3& lightDir,
+                         const glm::vec3& objColor, MaterialPrecision precision)
+{
+    if (precision == MATERIAL_FLOAT)
+    {
+        // ambient + diffuse + specular
+        float nDotL = normal.x * lightDir.x + normal.y * lightDir.y + normal.z * lightDir.z;
+        float diffuse = std::max(nDotL, 0.0f) / 1.5f;
+        float reflected[3] = { 2.0f * nDotL * normal.x - lightDir.x, 2.0f * nDotL * normal.y - lightDir.y,
+                               2.0f * nDotL * normal.z - lightDir.z };
+        float specular = std::pow(
+            std::max(eyeDir.x * reflected[0] + eyeDir.y * reflected[1] + eyeDir.z * reflected[2], 0.0f), 10.0f);
+        return glm::vec4(objColor.x * 0.25f + diffuse * objColor.x + specular * 0.8f,
+                         objColor.y * 0.25f + diffuse * objColor.y + specular * 0.8f,
+                         objColor.z * 0.25f + diffuse * objColor.z + specular * 0.8f, 1.0f + diffuse + specular);
+    }
+
+    // calculateLightHalf
+    Half n[3] = { normal.x, normal.y, normal.z };
+    Half e[3] = { eyeDir.x, eyeDir.y, eyeDir.z };
+    Half l[3] = { lightDir.x, lightDir.y, lightDir.z };
+    Half color[3] = { objColor.x, objColor.y, objColor.z };
+
+    Half nDotL = n[0] * l[0] + n[1] * l[1] + n[2] * l[2];
+    Half diffuse = Half(std::max(nDotL.v, 0.0f)) / Half(1.5f);
+    Half twoNDotL = Half(2.0f) * nDotL;
+    Half reflected[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        reflected[i] = n[i] * twoNDotL - l[i];
+    }
+    Half specular = Half(std::max((e[0] * reflected[0] + e[1] * reflected[1] + e[2] * reflected[2]).v, 0.0f));
+    Half s2 = specular * specular;
+    Half s4 = s2 * s2;
+    Half s8 = s4 * s4;
+    Half s10 = s8 * s2;
+
+    float result[4];
+    for (int i = 0; i < 3; ++i)
+    {
+        result[i] = (color[i] * Half(0.25f) + diffuse * color[i] + s10 * Half(0.8f)).v;
+    }
+    result[3] = (Half(1.0f) + diffuse + s10).v;
+    return glm::vec4(result[0], result[1], result[2], result[3]);
+}
@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+//
+// CPU port of the procedural material of scene.frag.glsl: SimplexPerlin3D
+// of noise.glsl, calcNoise and calculateLight. Every operation the shader
+// does in float16 is done in fp32 here and rounded to the nearest half,
+// which is what the hardware returns for a single operation. Fused
+// multiply-adds of the GPU round once where this rounds twice, the error
+// analysis of tools/material_precision is slightly pessimistic for that.
+//
+
+enum MaterialPrecision
+{
+    MATERIAL_FLOAT,                 // the fp32 shader
+    MATERIAL_HALF,                  // the HALF_PRECISION permutation: fp16 surflets and lighting
+    MATERIAL_HALF_ACCUMULATOR,      // as above with the sum of calcNoise in fp16 too
+    MATERIAL_HALF_EVERYWHERE,       // also the lattice and the hash in fp16
+    NUM_MATERIAL_PRECISIONS,
+};
+
+extern const char* const MATERIAL_PRECISION_NAMES[NUM_MATERIAL_PRECISIONS];
+
+// round to nearest even float16, including overflow to infinity and subnormals
+float roundToHalf(float value);
+
+// noise in -1..1
+float simplexPerlin3D(const glm::vec3& position, MaterialPrecision precision);
+
+// modelPos is the interpolated model_pos / 2, iterations is the fragment load * 100
+float calcNoise(const glm::vec3& modelPos, int iterations, MaterialPrecision precision);
+
+// the directions are normalized
+glm::vec4 calculateLight(const glm::vec3& normal, const glm::vec3& eyeDir, const glm::vec3& lightDir,
+                         const glm::vec3& objColor, MaterialPrecision precision);
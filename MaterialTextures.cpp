@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MaterialTextures.h"
+
+#include <glm/glm.hpp>
+#include "common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// layout of the bricks in one texture repeat, all sizes relative to the texture size
+static const uint32_t BRICK_ROWS = 16;
+static const uint32_t BRICKS_PER_ROW = 8;
+static const float MORTAR_WIDTH = 0.06f;    // of the brick height
+static const float BEVEL_WIDTH = 0.12f;
+static const float NORMAL_STRENGTH = 4.0f;
+
+static uint32_t hashUint(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static float hashUnit(uint32_t x, uint32_t y, uint32_t seed)
+{
+    return float(hashUint(x ^ hashUint(y ^ hashUint(seed)))) / 4294967295.0f;
+}
+
+// smooth value noise with a lattice of period x period cells, so it tiles with the texture
+static float valueNoise(float x, float y, uint32_t period, uint32_t seed)
+{
+    float fx = std::floor(x);
+    float fy = std::floor(y);
+    uint32_t x0 = uint32_t(fx) % period;
+    uint32_t y0 = uint32_t(fy) % period;
+    uint32_t x1 = (x0 + 1) % period;
+    uint32_t y1 = (y0 + 1) % period;
+    float tx = x - fx;
+    float ty = y - fy;
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    ty = ty * ty * (3.0f - 2.0f * ty);
+
+    float a = hashUnit(x0, y0, seed) + (hashUnit(x1, y0, seed) - hashUnit(x0, y0, seed)) * tx;
+    float b = hashUnit(x0, y1, seed) + (hashUnit(x1, y1, seed) - hashUnit(x0, y1, seed)) * tx;
+    return a + (b - a) * ty;
+}
+
+static uint8_t toUnorm8(float value)
+{
+    return uint8_t(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+//
+// Brick wall with a grain that has detail down to single texels, so that
+// every mip level actually differs from the next one. Row 0 is v = 0.
+//
+static void generateMaterial(uint32_t size, std::vector<uint8_t>& albedo, std::vector<uint8_t>& normal)
+{
+    std::vector<float> height(size_t(size) * size);
+    albedo.resize(height.size() * 4);
+    normal.resize(height.size() * 2);
+
+    float brickHeight = float(size) / float(BRICK_ROWS);
+    float brickWidth = float(size) / float(BRICKS_PER_ROW);
+    float mortar = MORTAR_WIDTH * brickHeight;
+    float bevel = BEVEL_WIDTH * brickHeight;
+
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        uint32_t row = uint32_t(float(y) / brickHeight);
+        float localY = float(y) + 0.5f - float(row) * brickHeight;
+        float shift = (row & 1) ? brickWidth * 0.5f : 0.0f;
+
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            float shiftedX = std::fmod(float(x) + 0.5f + shift, float(size));
+            uint32_t column = uint32_t(shiftedX / brickWidth);
+            float localX = shiftedX - float(column) * brickWidth;
+
+            float edge = std::min(std::min(localX, brickWidth - localX), std::min(localY, brickHeight - localY));
+            float brick = std::min(std::max((edge - mortar) / bevel, 0.0f), 1.0f);
+
+            float grain = 0.5f * valueNoise(float(x) / 64.0f, float(y) / 64.0f, size / 64, 1)
+                + 0.3f * valueNoise(float(x) / 8.0f, float(y) / 8.0f, size / 8, 2)
+                + 0.2f * hashUnit(x, y, 3);
+
+            size_t index = size_t(y) * size + x;
+            height[index] = brick * (0.8f + 0.2f * grain) + (1.0f - brick) * 0.1f * grain;
+
+            float tint = 0.8f + 0.4f * hashUnit(column, row, 4);
+            float shade = 0.75f + 0.5f * grain;
+            float r = (0.55f * tint * brick + 0.62f * (1.0f - brick)) * shade;
+            float g = (0.23f * tint * brick + 0.60f * (1.0f - brick)) * shade;
+            float b = (0.16f * tint * brick + 0.56f * (1.0f - brick)) * shade;
+            albedo[index * 4 + 0] = toUnorm8(r);
+            albedo[index * 4 + 1] = toUnorm8(g);
+            albedo[index * 4 + 2] = toUnorm8(b);
+            albedo[index * 4 + 3] = 255;
+        }
+    }
+
+    // tangent space normals from the height, x along u and y along v
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        uint32_t up = (y + 1) % size;
+        uint32_t down = (y + size - 1) % size;
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            uint32_t right = (x + 1) % size;
+            uint32_t left = (x + size - 1) % size;
+            float dx = (height[size_t(y) * size + right] - height[size_t(y) * size + left]) * 0.5f * NORMAL_STRENGTH;
+            float dy = (height[size_t(up) * size + x] - height[size_t(down) * size + x]) * 0.5f * NORMAL_STRENGTH;
+            float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+
+            size_t index = size_t(y) * size + x;
+            normal[index * 2 + 0] = toUnorm8(-dx / length * 0.5f + 0.5f);
+            normal[index * 2 + 1] = toUnorm8(-dy / length * 0.5f + 0.5f);
+        }
+    }
+}
+
+MaterialTextures::MaterialTextures(uint32_t size)
+    : m_size(size)
+{
+    m_mipLevels = 1;
+    while ((size >> m_mipLevels) > 0)
+    {
+        ++m_mipLevels;
+    }
+
+    std::vector<uint8_t> albedo;
+    std::vector<uint8_t> normal;
+    generateMaterial(size, albedo, normal);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    nvgl::newTexture(m_albedo, GL_TEXTURE_2D);
+    glTextureStorage2D(m_albedo, m_mipLevels, GL_RGBA8, size, size);
+    glTextureSubImage2D(m_albedo, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, albedo.data());
+    glGenerateTextureMipmap(m_albedo);
+
+    nvgl::newTexture(m_normal, GL_TEXTURE_2D);
+    glTextureStorage2D(m_normal, m_mipLevels, GL_RG8, size, size);
+    glTextureSubImage2D(m_normal, 0, 0, 0, size, size, GL_RG, GL_UNSIGNED_BYTE, normal.data());
+    glGenerateTextureMipmap(m_normal);
+
+    // trilinear rather than anisotropic, the traffic estimate assumes one footprint per fetch
+    glCreateSamplers(1, &m_sampler);
+    glSamplerParameteri(m_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(m_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+MaterialTextures::~MaterialTextures()
+{
+    glDeleteSamplers(1, &m_sampler);
+    nvgl::deleteTexture(m_albedo);
+    nvgl::deleteTexture(m_normal);
+}
+
+void MaterialTextures::bind()
+{
+    glBindTextureUnit(TEX_ALBEDO, m_albedo);
+    glBindTextureUnit(TEX_NORMAL, m_normal);
+    glBindSampler(TEX_ALBEDO, m_sampler);
+    glBindSampler(TEX_NORMAL, m_sampler);
+}
+
+void MaterialTextures::unbind()
+{
+    glBindTextureUnit(TEX_ALBEDO, 0);
+    glBindTextureUnit(TEX_NORMAL, 0);
+    glBindSampler(TEX_ALBEDO, 0);
+    glBindSampler(TEX_NORMAL, 0);
+}
+
+void MaterialTextures::beginTrafficMeasurement()
+{
+    m_traffic.begin(SSBO_TEXTURE_TRAFFIC);
+}
+
+void MaterialTextures::endTrafficMeasurement()
+{
+    m_traffic.end(SSBO_TEXTURE_TRAFFIC);
+}
+
+double MaterialTextures::getTrafficBytes() const
+{
+    return double(m_traffic.getValue(0)) / double(TEXTURE_TRAFFIC_UNITS) * double(BYTES_PER_TEXEL);
+}
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include "GpuCounters.h"
+
+#include <cstdint>
+
+//
+// Textures of the textured scene material: a brick albedo (RGBA8) and a
+// tangent space normal map (RG8, z is reconstructed), generated on the CPU
+// with full mip chains so no asset files are needed. How much of them the
+// scene reads depends on the mip levels its fetches end up in, which the
+// scene program estimates in its MEASURE_TEXTURE_TRAFFIC permutation; the
+// estimate is read back a few frames later without stalling.
+//
+class MaterialTextures
+{
+public:
+    explicit MaterialTextures(uint32_t size = 2048);
+    ~MaterialTextures();
+
+    MaterialTextures(const MaterialTextures&) = delete;
+    MaterialTextures& operator=(const MaterialTextures&) = delete;
+
+    // binds both textures with a trilinear, repeating sampler to TEX_ALBEDO and TEX_NORMAL
+    void bind();
+    void unbind();
+
+    // zeroes a counter and binds it to SSBO_TEXTURE_TRAFFIC for the scene pass
+    void beginTrafficMeasurement();
+    void endTrafficMeasurement();
+
+    // estimated bytes read from both textures by the most recent finished measurement
+    double getTrafficBytes() const;
+
+    // increases whenever getTrafficBytes() got a new value
+    uint32_t getTrafficResultCount() const { return m_traffic.getResultCount(); }
+
+    uint32_t getSize() const { return m_size; }
+    uint32_t getMipLevels() const { return m_mipLevels; }
+
+    // one albedo and one normal texel
+    static const uint32_t BYTES_PER_TEXEL = 4 + 2;
+
+private:
+    uint32_t m_size = 0;
+    uint32_t m_mipLevels = 0;
+    GLuint m_albedo = 0;
+    GLuint m_normal = 0;
+    GLuint m_sampler = 0;
+
+    GpuCounters m_traffic{ 1 };
+};
@@ -0,0 +1,186 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MeshBlob.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(MeshBlobHeader) == 56, "MeshBlobHeader is part of the file format");
+static_assert(sizeof(MeshBlobVertex) == 24, "MeshBlobVertex is part of the file format");
+static_assert(sizeof(MeshBlobMesh) == 56, "MeshBlobMesh is part of the file format");
+
+static uint64_t alignUp(uint64_t value)
+{
+    return (value + MESH_BLOB_ALIGNMENT - 1) & ~(MESH_BLOB_ALIGNMENT - 1);
+}
+
+static bool fail(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+//////////// MeshBlob ////////////
+
+bool MeshBlob::open(const std::string& filename, std::string* error)
+{
+    close();
+
+    if (!m_file.open(filename))
+    {
+        return fail(error, "could not open " + filename);
+    }
+
+    const uint64_t fileSize = m_file.size();
+    if (fileSize < sizeof(MeshBlobHeader))
+    {
+        close();
+        return fail(error, filename + " is too small");
+    }
+
+    const MeshBlobHeader* header = reinterpret_cast<const MeshBlobHeader*>(m_file.data());
+    if (memcmp(header->magic, MESH_BLOB_MAGIC, sizeof(MESH_BLOB_MAGIC)) != 0 || header->version != MESH_BLOB_VERSION)
+    {
+        close();
+        return fail(error, filename + " is not a mesh blob of this version");
+    }
+
+    // all sizes are checked against the file before any stream is used,
+    // the counts are bounded by the file size, so the products cannot overflow
+    auto inFile = [fileSize](uint64_t offset, uint64_t count, uint64_t stride) {
+        return offset <= fileSize && count <= (fileSize - offset) / stride;
+    };
+    if (!inFile(header->meshTableOffset, header->meshCount, sizeof(MeshBlobMesh))
+        || !inFile(header->vertexOffset, header->vertexCount, sizeof(MeshBlobVertex))
+        || !inFile(header->indexOffset, header->indexCount, sizeof(uint32_t))
+        || header->vertexOffset % MESH_BLOB_ALIGNMENT != 0
+        || header->indexOffset % MESH_BLOB_ALIGNMENT != 0
+        || header->meshTableOffset % alignof(MeshBlobMesh) != 0)
+    {
+        close();
+        return fail(error, filename + " has streams outside of the file");
+    }
+
+    const MeshBlobMesh* meshes = reinterpret_cast<const MeshBlobMesh*>(m_file.data() + header->meshTableOffset);
+    for (uint32_t i = 0; i < header->meshCount; ++i)
+    {
+        const MeshBlobMesh& mesh = meshes[i];
+        if (uint64_t(mesh.firstIndex) + mesh.indexCount > header->indexCount
+            || uint64_t(mesh.baseVertex) + mesh.vertexCount > header->vertexCount
+            || mesh.indexCount % 3 != 0)
+        {
+            close();
+            return fail(error, filename + ": mesh " + std::to_string(i) + " is out of range");
+        }
+    }
+
+    // the indices are relative to the base vertex of their mesh, one outside of its vertex
+    // range would make the draw read another mesh's vertices or past the vertex buffer
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(m_file.data() + header->indexOffset);
+    for (uint32_t i = 0; i < header->meshCount; ++i)
+    {
+        const MeshBlobMesh& mesh = meshes[i];
+        const uint32_t* end = indices + mesh.firstIndex + mesh.indexCount;
+        if (std::find_if(indices + mesh.firstIndex, end, [&mesh](uint32_t index) { return index >= mesh.vertexCount; }) != end)
+        {
+            close();
+            return fail(error, filename + ": mesh " + std::to_string(i) + " has indices outside of its vertices");
+        }
+    }
+
+    m_header = header;
+    m_meshes = meshes;
+    return true;
+}
+
+void MeshBlob::close()
+{
+    m_file.close();
+    m_header = nullptr;
+    m_meshes = nullptr;
+}
+
+//////////// writing ////////////
+
+void computeMeshBounds(MeshBlobMesh& mesh, const std::vector<MeshBlobVertex>& vertices)
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        mesh.boundsMin[c] = FLT_MAX;
+        mesh.boundsMax[c] = -FLT_MAX;
+    }
+    for (uint32_t v = mesh.baseVertex; v < mesh.baseVertex + mesh.vertexCount; ++v)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            mesh.boundsMin[c] = std::min(mesh.boundsMin[c], vertices[v].position[c]);
+            mesh.boundsMax[c] = std::max(mesh.boundsMax[c], vertices[v].position[c]);
+        }
+    }
+}
+
+bool writeMeshBlob(const std::string& filename, const std::vector<MeshBlobMesh>& meshes,
+                   const std::vector<MeshBlobVertex>& vertices, const std::vector<uint32_t>& indices,
+                   std::string* error)
+{
+    MeshBlobHeader header = {};
+    memcpy(header.magic, MESH_BLOB_MAGIC, sizeof(header.magic));
+    header.version = MESH_BLOB_VERSION;
+    header.meshCount = uint32_t(meshes.size());
+    header.meshTableOffset = sizeof(MeshBlobHeader);
+    header.vertexOffset = alignUp(header.meshTableOffset + meshes.size() * sizeof(MeshBlobMesh));
+    header.vertexCount = vertices.size();
+    header.indexOffset = alignUp(header.vertexOffset + vertices.size() * sizeof(MeshBlobVertex));
+    header.indexCount = indices.size();
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file)
+    {
+        return fail(error, "could not create " + filename);
+    }
+
+    uint64_t written = 0;
+    bool ok = true;
+    auto write = [&](const void* data, uint64_t size) {
+        ok = ok && (size == 0 || fwrite(data, 1, size_t(size), file) == size);
+        written += size;
+    };
+    auto pad = [&](uint64_t offset) {
+        static const uint8_t zeros[MESH_BLOB_ALIGNMENT] = {};
+        write(zeros, offset - written);
+    };
+
+    write(&header, sizeof(header));
+    write(meshes.data(), meshes.size() * sizeof(MeshBlobMesh));
+    pad(header.vertexOffset);
+    write(vertices.data(), vertices.size() * sizeof(MeshBlobVertex));
+    pad(header.indexOffset);
+    write(indices.data(), indices.size() * sizeof(uint32_t));
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        return fail(error, "writing " + filename + " failed");
+    }
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Pre-baked binary mesh scene (".vmb"), produced offline by tools/meshbaker
+// and memory-mapped at runtime. All streams start at MESH_BLOB_ALIGNMENT, so
+// they can be copied page by page straight from the mapping into a GPU
+// staging buffer, and offsets relative to the stream are valid buffer offsets.
+// Nothing in here touches OpenGL.
+//
+// Layout, all values in native byte order:
+//   MeshBlobHeader
+//   MeshBlobMesh[meshCount]        at meshTableOffset
+//   MeshBlobVertex[vertexCount]    at vertexOffset
+//   uint32_t[indexCount]           at indexOffset
+//
+
+static const char MESH_BLOB_MAGIC[4] = { 'V', 'M', 'B', 'L' };
+static const uint32_t MESH_BLOB_VERSION = 1;
+static const uint64_t MESH_BLOB_ALIGNMENT = 256;
+
+struct MeshBlobHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t meshCount;
+    uint32_t reserved;
+    uint64_t meshTableOffset;
+    uint64_t vertexOffset;
+    uint64_t vertexCount;
+    uint64_t indexOffset;
+    uint64_t indexCount;
+};
+
+// interleaved, matches the VERTEX_POS / VERTEX_NORMAL attributes
+struct MeshBlobVertex
+{
+    float position[3];
+    float normal[3];
+};
+
+struct MeshBlobMesh
+{
+    uint32_t firstIndex;    // into the index stream
+    uint32_t indexCount;
+    uint32_t baseVertex;    // added to the indices of this mesh
+    uint32_t vertexCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    float color[4];         // material base color
+};
+
+class MeshBlob
+{
+public:
+    // maps the file and validates the header, the mesh table and the indices of
+    // each mesh against its vertex range, the vertex stream is not touched
+    bool open(const std::string& filename, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    const MeshBlobHeader& getHeader() const { return *m_header; }
+
+    uint32_t getMeshCount() const { return m_header->meshCount; }
+    const MeshBlobMesh* getMeshes() const { return m_meshes; }
+
+    const uint8_t* getVertexData() const { return m_file.data() + m_header->vertexOffset; }
+    uint64_t getVertexDataSize() const { return m_header->vertexCount * sizeof(MeshBlobVertex); }
+    const uint8_t* getIndexData() const { return m_file.data() + m_header->indexOffset; }
+    uint64_t getIndexDataSize() const { return m_header->indexCount * sizeof(uint32_t); }
+
+    size_t getFileSize() const { return m_file.size(); }
+
+private:
+    MappedFile m_file;
+    const MeshBlobHeader* m_header = nullptr;
+    const MeshBlobMesh* m_meshes = nullptr;
+};
+
+// computes the bounds of mesh from its vertex range
+void computeMeshBounds(MeshBlobMesh& mesh, const std::vector<MeshBlobVertex>& vertices);
+
+// writes meshes, whose ranges refer to the shared vertex and index streams
+bool writeMeshBlob(const std::string& filename, const std::vector<MeshBlobMesh>& meshes,
+                   const std::vector<MeshBlobVertex>& vertices, const std::vector<uint32_t>& indices,
+                   std::string* error = nullptr);
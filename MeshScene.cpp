@@ -0,0 +1,263 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MeshScene.h"
+
+#include "MeshBlob.h"
+#include "common.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+static const GLsizeiptr STAGING_SIZE = 16 * 1024 * 1024;
+
+MeshScene::~MeshScene()
+{
+    destroy();
+
+    for (GLsync& fence : m_stagingFences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+        }
+    }
+    if (m_stagingBuffer)
+    {
+        glUnmapNamedBuffer(m_stagingBuffer);
+        nvgl::deleteBuffer(m_stagingBuffer);
+    }
+}
+
+void MeshScene::destroy()
+{
+    nvgl::deleteBuffer(m_vbo);
+    nvgl::deleteBuffer(m_ibo);
+    nvgl::deleteBuffer(m_instanceBuffer);
+    m_meshes.clear();
+    m_instanceCount = 0;
+}
+
+void MeshScene::createStagingBuffer()
+{
+    if (m_stagingBuffer)
+    {
+        return;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+    glCreateBuffers(1, &m_stagingBuffer);
+    glNamedBufferStorage(m_stagingBuffer, STAGING_SIZE, nullptr, flags);
+    m_stagingPointer = static_cast<uint8_t*>(glMapNamedBufferRange(m_stagingBuffer, 0, STAGING_SIZE, flags | GL_MAP_FLUSH_EXPLICIT_BIT));
+}
+
+bool MeshScene::load(const std::string& filename)
+{
+    destroy();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    MeshBlob blob;
+    std::string error;
+    if (!blob.open(filename, &error))
+    {
+        LOGE("%s\n", error.c_str());
+        return false;
+    }
+
+    createStagingBuffer();
+
+    // immutable device buffers, only ever written by the copies from the staging buffer
+    glCreateBuffers(1, &m_vbo);
+    glNamedBufferStorage(m_vbo, std::max<uint64_t>(blob.getVertexDataSize(), 1), nullptr, 0);
+    glCreateBuffers(1, &m_ibo);
+    glNamedBufferStorage(m_ibo, std::max<uint64_t>(blob.getIndexDataSize(), 1), nullptr, 0);
+
+    m_uploadBytes = 0;
+    upload(m_vbo, blob.getVertexData(), blob.getVertexDataSize());
+    upload(m_ibo, blob.getIndexData(), blob.getIndexDataSize());
+
+    // wait for the last copy, so the measured time covers the whole upload
+    GLsync lastFence = m_stagingFences[m_stagingHalf ^ 1];
+    if (lastFence)
+    {
+        glClientWaitSync(lastFence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+    }
+
+    for (uint32_t i = 0; i < blob.getMeshCount(); ++i)
+    {
+        const MeshBlobMesh& blobMesh = blob.getMeshes()[i];
+        if (blobMesh.indexCount == 0)
+        {
+            continue;
+        }
+
+        glm::vec3 boundsMin(blobMesh.boundsMin[0], blobMesh.boundsMin[1], blobMesh.boundsMin[2]);
+        glm::vec3 boundsMax(blobMesh.boundsMax[0], blobMesh.boundsMax[1], blobMesh.boundsMax[2]);
+
+        Mesh mesh;
+        mesh.firstIndex = blobMesh.firstIndex;
+        mesh.indexCount = blobMesh.indexCount;
+        mesh.baseVertex = blobMesh.baseVertex;
+        mesh.firstInstance = 0;
+        mesh.instanceCount = 0;
+        mesh.center = (boundsMin + boundsMax) * 0.5f;
+        mesh.radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-6f);
+        mesh.color = glm::vec4(blobMesh.color[0], blobMesh.color[1], blobMesh.color[2], blobMesh.color[3]);
+        m_meshes.push_back(mesh);
+    }
+
+    m_uploadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    LOGI("loaded %s: %zu meshes, %.2f MB in %.2f ms (%.1f MB/s)\n", filename.c_str(), m_meshes.size(),
+        m_uploadBytes / (1024.0 * 1024.0), m_uploadMilliseconds,
+        m_uploadMilliseconds > 0.0 ? m_uploadBytes / (1024.0 * 1024.0) / (m_uploadMilliseconds / 1000.0) : 0.0);
+
+    return isLoaded();
+}
+
+void MeshScene::upload(GLuint buffer, const uint8_t* data, uint64_t size)
+{
+    const GLsizeiptr halfSize = STAGING_SIZE / 2;
+
+    for (uint64_t offset = 0; offset < size; offset += halfSize)
+    {
+        GLsizeiptr chunk = GLsizeiptr(std::min<uint64_t>(halfSize, size - offset));
+        GLintptr stagingOffset = m_stagingHalf * halfSize;
+
+        // the GPU may still copy out of this half from the previous round
+        GLsync& fence = m_stagingFences[m_stagingHalf];
+        if (fence)
+        {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(-1));
+            glDeleteSync(fence);
+        }
+
+        // straight from the mapped file into the mapped staging buffer, the only CPU copy
+        memcpy(m_stagingPointer + stagingOffset, data + offset, size_t(chunk));
+        glFlushMappedNamedBufferRange(m_stagingBuffer, stagingOffset, chunk);
+        glCopyNamedBufferSubData(m_stagingBuffer, buffer, stagingOffset, GLintptr(offset), chunk);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_stagingHalf ^= 1;
+        m_uploadBytes += uint64_t(chunk);
+    }
+}
+
+void MeshScene::setInstances(uint32_t count, float aspect)
+{
+    if (!isLoaded() || (count == m_instanceCount && aspect == m_instanceAspect))
+    {
+        return;
+    }
+    m_instanceCount = count;
+    m_instanceAspect = aspect;
+
+    // same grid as the tori in GLDemo::renderTori()
+    float num = float(count);
+    uint32_t numX = uint32_t(std::ceil(std::sqrt(num * aspect)));
+    uint32_t numY = std::max(uint32_t(float(numX) / aspect), 1u);
+    if (numX * numY < count)
+    {
+        ++numY;
+    }
+    float sx = float(numX);
+    float sy = float(numY);
+    float scale = std::min(1.0f / sx, 1.0f / sy) * 0.8f;
+
+    // instances are grouped by mesh, so each mesh is one draw call over a contiguous range
+    std::vector<vertexload::InstanceData> instances(count);
+    uint32_t meshCount = uint32_t(m_meshes.size());
+    uint32_t firstInstance = 0;
+    for (uint32_t m = 0; m < meshCount; ++m)
+    {
+        Mesh& mesh = m_meshes[m];
+        mesh.firstInstance = firstInstance;
+        mesh.instanceCount = count / meshCount + (m < count % meshCount ? 1 : 0);
+
+        glm::mat4 normalize = glm::scale(glm::mat4(1.0f), glm::vec3(0.5f / mesh.radius))
+            * glm::translate(glm::mat4(1.0f), -mesh.center);
+
+        for (uint32_t i = 0; i < mesh.instanceCount; ++i)
+        {
+            // interleave the meshes over the grid
+            uint32_t cell = i * meshCount + m;
+            float x = (float(cell % numX) + 0.5f) - sx * 0.5f;
+            float y = (float(cell / numX) + 0.5f) - sy * 0.5f;
+            float rotationAngle = float(cell % 8) * glm::pi<float>() / 4.0f;
+
+            vertexload::InstanceData& instance = instances[firstInstance + i];
+            instance.model = glm::scale(glm::mat4(1.0f), glm::vec3(scale))
+                * glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f))
+                * glm::rotate(glm::mat4(1.0f), rotationAngle, glm::vec3(0, 1, 0))
+                * normalize;
+            instance.color = mesh.color;
+        }
+        firstInstance += mesh.instanceCount;
+    }
+
+    nvgl::newBuffer(m_instanceBuffer);
+    glNamedBufferData(m_instanceBuffer, std::max<size_t>(instances.size(), 1) * sizeof(vertexload::InstanceData),
+        instances.data(), GL_STATIC_DRAW);
+}
+
+void MeshScene::draw(GLuint positionLocation, GLuint normalLocation)
+{
+    if (!isLoaded() || m_instanceCount == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, sizeof(MeshBlobVertex), NV_BUFFER_OFFSET(offsetof(MeshBlobVertex, position)));
+    glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, sizeof(MeshBlobVertex), NV_BUFFER_OFFSET(offsetof(MeshBlobVertex, normal)));
+    glEnableVertexAttribArray(positionLocation);
+    glEnableVertexAttribArray(normalLocation);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, m_instanceBuffer);
+
+    for (const Mesh& mesh : m_meshes)
+    {
+        if (mesh.instanceCount)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                NV_BUFFER_OFFSET(mesh.firstIndex * sizeof(uint32_t)), mesh.instanceCount, mesh.baseVertex, mesh.firstInstance);
+        }
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray(positionLocation);
+    glDisableVertexAttribArray(normalLocation);
+}
+
+uint64_t MeshScene::getTriangleCount() const
+{
+    uint64_t triangles = 0;
+    for (const Mesh& mesh : m_meshes)
+    {
+        triangles += uint64_t(mesh.indexCount / 3) * mesh.instanceCount;
+    }
+    return triangles;
+}
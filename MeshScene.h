@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Scene of meshes from a pre-baked blob (see MeshBlob.h), drawn instanced
+// with one draw call per mesh. Needs the instanced scene program
+// (ScenePermutation::instanced), which reads the per-instance transforms and
+// colors from SSBO_INSTANCES.
+//
+class MeshScene
+{
+public:
+    MeshScene() = default;
+    ~MeshScene();
+
+    MeshScene(const MeshScene&) = delete;
+    MeshScene& operator=(const MeshScene&) = delete;
+
+    // maps the blob and streams it to the GPU through the persistent staging buffer
+    bool load(const std::string& filename);
+    bool isLoaded() const { return !m_meshes.empty(); }
+
+    // distributes count instances over the meshes on a grid fitting the aspect ratio
+    void setInstances(uint32_t count, float aspect);
+
+    void draw(GLuint positionLocation, GLuint normalLocation);
+
+    uint64_t getTriangleCount() const;
+    double getUploadMilliseconds() const { return m_uploadMilliseconds; }
+    uint64_t getUploadBytes() const { return m_uploadBytes; }
+
+private:
+    struct Mesh
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t baseVertex;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+        glm::vec3 center;
+        float radius;
+        glm::vec4 color;
+    };
+
+    void createStagingBuffer();
+    void upload(GLuint buffer, const uint8_t* data, uint64_t size);
+    void destroy();
+
+    std::vector<Mesh> m_meshes;
+
+    GLuint m_vbo = 0;
+    GLuint m_ibo = 0;
+    GLuint m_instanceBuffer = 0;
+    uint32_t m_instanceCount = 0;
+    float m_instanceAspect = 0.0f;
+
+    // persistently mapped, used as two halves so the CPU fills one while the
+    // GPU copies out of the other
+    GLuint m_stagingBuffer = 0;
+    uint8_t* m_stagingPointer = nullptr;
+    GLsync m_stagingFences[2] = {};
+    uint32_t m_stagingHalf = 0;
+
+    double m_uploadMilliseconds = 0.0;
+    uint64_t m_uploadBytes = 0;
+};
@@ -0,0 +1,402 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <tuple>
+
+// normal cones wider than this (about 84 degrees) are not worth testing
+static const float MIN_CONE_DOT = 0.1f;
+
+void MeshletMesh::clear()
+{
+    meshlets.clear();
+    bounds.clear();
+    vertexIndices.clear();
+    primitiveIndices.clear();
+}
+
+static glm::vec3 getPosition(const float* positions, size_t stride, uint32_t index)
+{
+    const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + index * stride);
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+// unit normal of a counter-clockwise triangle, zero if it is degenerate
+static glm::vec3 getTriangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    glm::vec3 normal = glm::cross(b - a, c - a);
+    float length = glm::length(normal);
+    return length > 1e-20f ? normal / length : glm::vec3(0.0f);
+}
+
+static MeshletBounds computeBounds(const float* positions, size_t stride, const std::vector<uint32_t>& vertices,
+                                   const std::vector<uint8_t>& triangles)
+{
+    MeshletBounds bounds;
+
+    // sphere around the center of the bounding box, a few percent larger than the optimum at most for these patches
+    glm::vec3 minimum = getPosition(positions, stride, vertices[0]);
+    glm::vec3 maximum = minimum;
+    for (uint32_t vertex : vertices)
+    {
+        glm::vec3 p = getPosition(positions, stride, vertex);
+        minimum = glm::min(minimum, p);
+        maximum = glm::max(maximum, p);
+    }
+    bounds.center = (minimum + maximum) * 0.5f;
+    bounds.radius = 0.0f;
+    for (uint32_t vertex : vertices)
+    {
+        bounds.radius = std::max(bounds.radius, glm::length(getPosition(positions, stride, vertex) - bounds.center));
+    }
+
+    glm::vec3 normalSum(0.0f);
+    std::vector<glm::vec3> normals;
+    normals.reserve(triangles.size() / 3);
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        glm::vec3 normal = getTriangleNormal(getPosition(positions, stride, vertices[triangles[i + 0]]),
+                                             getPosition(positions, stride, vertices[triangles[i + 1]]),
+                                             getPosition(positions, stride, vertices[triangles[i + 2]]));
+        if (normal != glm::vec3(0.0f))
+        {
+            normals.push_back(normal);
+            normalSum += normal;
+        }
+    }
+
+    bounds.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    bounds.coneCutoff = 1.0f;
+    float sumLength = glm::length(normalSum);
+    if (normals.empty() || sumLength < 1e-6f)
+    {
+        return bounds;
+    }
+    glm::vec3 axis = normalSum / sumLength;
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+    if (minDot > MIN_CONE_DOT)
+    {
+        // sine of the cone's half angle, see MeshletBounds
+        bounds.coneAxis = axis;
+        bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+    return bounds;
+}
+
+static void appendMeshlet(const float* positions, size_t stride, std::vector<uint32_t>& vertices, std::vector<uint8_t>& triangles,
+                          std::vector<int16_t>& localIndex, MeshletMesh& result)
+{
+    Meshlet meshlet;
+    meshlet.vertexOffset = uint32_t(result.vertexIndices.size());
+    meshlet.primitiveOffset = uint32_t(result.primitiveIndices.size());
+    meshlet.vertexCount = uint32_t(vertices.size());
+    meshlet.primitiveCount = uint32_t(triangles.size() / 3);
+
+    result.meshlets.push_back(meshlet);
+    result.bounds.push_back(computeBounds(positions, stride, vertices, triangles));
+    result.vertexIndices.insert(result.vertexIndices.end(), vertices.begin(), vertices.end());
+    result.primitiveIndices.insert(result.primitiveIndices.end(), triangles.begin(), triangles.end());
+    // the shaders read the primitive indices as uints
+    result.primitiveIndices.resize((result.primitiveIndices.size() + 3) & ~size_t(3), 0);
+
+    for (uint32_t vertex : vertices)
+    {
+        localIndex[vertex] = -1;
+    }
+    vertices.clear();
+    triangles.clear();
+}
+
+void buildMeshlets(const float* positions, size_t positionStride, size_t vertexCount, const uint32_t* indices,
+                   size_t indexCount, const MeshletLimits& limits, MeshletMesh& result)
+{
+    result.clear();
+
+    const size_t triangleCount = indexCount / 3;
+    const size_t maxVertices = std::max(3u, std::min(limits.maxVertices, 256u));
+    const size_t maxPrimitives = std::max(limits.maxPrimitives, 1u);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // the triangles around each vertex, as ranges of one array
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++adjacencyOffsets[indices[i] + 1];
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        adjacency[cursor[indices[i]]++] = uint32_t(i / 3);
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        centroids[t] = (getPosition(positions, positionStride, indices[t * 3 + 0])
+            + getPosition(positions, positionStride, indices[t * 3 + 1])
+            + getPosition(positions, positionStride, indices[t * 3 + 2])) / 3.0f;
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<int16_t> localIndex(vertexCount, -1);
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+    std::vector<uint32_t> candidates;   // triangles sharing a vertex with the meshlet
+    std::vector<uint32_t> candidateOf(triangleCount, ~0u);  // the meshlet a triangle is a candidate of
+    glm::vec3 centroidSum(0.0f);
+    uint32_t nextSeed = ~0u;            // a neighbour of the previous meshlet
+    size_t firstUnemitted = 0;
+
+    vertices.reserve(maxVertices);
+    triangles.reserve(maxPrimitives * 3);
+
+    for (;;)
+    {
+        // the candidate adding the fewest vertices, on ties the one nearest to the meshlet
+        uint32_t best = ~0u;
+        size_t bestNewVertices = 4;
+        float bestDistance = 0.0f;
+        glm::vec3 center = triangles.empty() ? glm::vec3(0.0f) : centroidSum / float(triangles.size() / 3);
+
+        size_t kept = 0;
+        for (size_t c = 0; c < candidates.size(); ++c)
+        {
+            uint32_t triangle = candidates[c];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            candidates[kept++] = triangle;
+
+            uint32_t i0 = indices[triangle * 3 + 0];
+            uint32_t i1 = indices[triangle * 3 + 1];
+            uint32_t i2 = indices[triangle * 3 + 2];
+            size_t newVertices = (localIndex[i0] < 0 ? 1 : 0) + (localIndex[i1] < 0 && i1 != i0 ? 1 : 0)
+                + (localIndex[i2] < 0 && i2 != i0 && i2 != i1 ? 1 : 0);
+            if (vertices.size() + newVertices > maxVertices)
+            {
+                continue;
+            }
+            glm::vec3 offset = centroids[triangle] - center;
+            float distance = glm::dot(offset, offset);
+            if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance))
+            {
+                best = triangle;
+                bestNewVertices = newVertices;
+                bestDistance = distance;
+            }
+        }
+        candidates.resize(kept);
+
+        if (best == ~0u)
+        {
+            if (!triangles.empty())
+            {
+                // full, or nothing connected is left: continue next to this meshlet
+                nextSeed = candidates.empty() ? ~0u : candidates[0];
+                appendMeshlet(positions, positionStride, vertices, triangles, localIndex, result);
+                candidates.clear();
+                centroidSum = glm::vec3(0.0f);
+                continue;
+            }
+            if (nextSeed != ~0u && !emitted[nextSeed])
+            {
+                best = nextSeed;
+            }
+            else
+            {
+                while (firstUnemitted < triangleCount && emitted[firstUnemitted])
+                {
+                    ++firstUnemitted;
+                }
+                if (firstUnemitted == triangleCount)
+                {
+                    break;
+                }
+                best = uint32_t(firstUnemitted);
+            }
+        }
+
+        emitted[best] = 1;
+        centroidSum += centroids[best];
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t vertex = indices[best * 3 + k];
+            if (localIndex[vertex] < 0)
+            {
+                localIndex[vertex] = int16_t(vertices.size());
+                vertices.push_back(vertex);
+                for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; ++a)
+                {
+                    uint32_t triangle = adjacency[a];
+                    if (!emitted[triangle] && candidateOf[triangle] != result.meshlets.size())
+                    {
+                        candidateOf[triangle] = uint32_t(result.meshlets.size());
+                        candidates.push_back(triangle);
+                    }
+                }
+            }
+            triangles.push_back(uint8_t(localIndex[vertex]));
+        }
+
+        if (triangles.size() / 3 == maxPrimitives)
+        {
+            nextSeed = ~0u;
+            for (uint32_t triangle : candidates)
+            {
+                if (!emitted[triangle])
+                {
+                    nextSeed = triangle;
+                    break;
+                }
+            }
+            appendMeshlet(positions, positionStride, vertices, triangles, localIndex, result);
+            candidates.clear();
+            centroidSum = glm::vec3(0.0f);
+        }
+    }
+}
+
+static bool fail(std::string* error, const char* format, size_t a, size_t b = 0)
+{
+    if (error)
+    {
+        char text[256];
+        snprintf(text, sizeof(text), format, a, b);
+        *error = text;
+    }
+    return false;
+}
+
+// the same triangle starting at its smallest index, the winding stays
+static std::tuple<uint32_t, uint32_t, uint32_t> canonicalTriangle(uint32_t a, uint32_t b, uint32_t c)
+{
+    if (b < a && b <= c)
+    {
+        return std::make_tuple(b, c, a);
+    }
+    if (c < a && c < b)
+    {
+        return std::make_tuple(c, a, b);
+    }
+    return std::make_tuple(a, b, c);
+}
+
+bool validateMeshlets(const MeshletMesh& mesh, const float* positions, size_t positionStride, size_t vertexCount,
+                      const uint32_t* indices, size_t indexCount, const MeshletLimits& limits, std::string* error)
+{
+    if (mesh.bounds.size() != mesh.meshlets.size())
+    {
+        return fail(error, "%zu bounds for %zu meshlets", mesh.bounds.size(), mesh.meshlets.size());
+    }
+
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> expected;
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> found;
+    expected.reserve(indexCount / 3);
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        expected.push_back(canonicalTriangle(indices[i], indices[i + 1], indices[i + 2]));
+    }
+    found.reserve(expected.size());
+
+    for (size_t m = 0; m < mesh.meshlets.size(); ++m)
+    {
+        const Meshlet& meshlet = mesh.meshlets[m];
+        const MeshletBounds& bounds = mesh.bounds[m];
+        if (meshlet.vertexCount == 0 || meshlet.vertexCount > limits.maxVertices || meshlet.vertexCount > 256)
+        {
+            return fail(error, "meshlet %zu has %zu vertices", m, meshlet.vertexCount);
+        }
+        if (meshlet.primitiveCount == 0 || meshlet.primitiveCount > limits.maxPrimitives)
+        {
+            return fail(error, "meshlet %zu has %zu primitives", m, meshlet.primitiveCount);
+        }
+        if (size_t(meshlet.vertexOffset) + meshlet.vertexCount > mesh.vertexIndices.size()
+            || meshlet.primitiveOffset % 4 != 0
+            || size_t(meshlet.primitiveOffset) + meshlet.primitiveCount * 3 > mesh.primitiveIndices.size())
+        {
+            return fail(error, "meshlet %zu is out of range", m);
+        }
+
+        // relative to the size of the meshlet, the sphere is computed in float
+        const float tolerance = 1e-5f * (bounds.radius + glm::length(bounds.center)) + 1e-7f;
+        for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+        {
+            uint32_t vertex = mesh.vertexIndices[meshlet.vertexOffset + v];
+            if (vertex >= vertexCount)
+            {
+                return fail(error, "meshlet %zu references vertex %zu", m, vertex);
+            }
+            if (glm::length(getPosition(positions, positionStride, vertex) - bounds.center) > bounds.radius + tolerance)
+            {
+                return fail(error, "vertex %zu is outside of the sphere of meshlet %zu", vertex, m);
+            }
+        }
+
+        const float minDot = bounds.coneCutoff < 1.0f ? std::sqrt(1.0f - bounds.coneCutoff * bounds.coneCutoff) : -1.0f;
+        for (uint32_t p = 0; p < meshlet.primitiveCount; ++p)
+        {
+            const uint8_t* local = &mesh.primitiveIndices[meshlet.primitiveOffset + p * 3];
+            if (local[0] >= meshlet.vertexCount || local[1] >= meshlet.vertexCount || local[2] >= meshlet.vertexCount)
+            {
+                return fail(error, "primitive %zu of meshlet %zu has an invalid local index", p, m);
+            }
+            uint32_t a = mesh.vertexIndices[meshlet.vertexOffset + local[0]];
+            uint32_t b = mesh.vertexIndices[meshlet.vertexOffset + local[1]];
+            uint32_t c = mesh.vertexIndices[meshlet.vertexOffset + local[2]];
+            found.push_back(canonicalTriangle(a, b, c));
+
+            glm::vec3 normal = getTriangleNormal(getPosition(positions, positionStride, a), getPosition(positions, positionStride, b),
+                                                 getPosition(positions, positionStride, c));
+            if (normal != glm::vec3(0.0f) && glm::dot(normal, bounds.coneAxis) < minDot - 1e-4f)
+            {
+                return fail(error, "primitive %zu is outside of the normal cone of meshlet %zu", p, m);
+            }
+        }
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(found.begin(), found.end());
+    if (found.size() != expected.size())
+    {
+        return fail(error, "%zu triangles in the meshlets, %zu in the mesh", found.size(), expected.size());
+    }
+    for (size_t i = 0; i < found.size(); ++i)
+    {
+        if (found[i] != expected[i])
+        {
+            return fail(error, "triangle %zu of the sorted mesh is missing or has a different winding", i);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Splits an indexed triangle mesh into meshlets of a bounded number of
+// vertices and primitives for the mesh shader path (scene.task.glsl,
+// scene.mesh.glsl), along with the bounding sphere and normal cone of each
+// meshlet for culling. Meshlets are grown greedily over shared vertices, so
+// they stay compact and their cones narrow. Nothing in here touches OpenGL,
+// tools/meshlet_bench benchmarks and validates the builder on its own.
+//
+
+struct MeshletLimits
+{
+    uint32_t maxVertices = 64;      // at most 256, the local indices are bytes
+    uint32_t maxPrimitives = 126;
+};
+
+// laid out like the uvec4 the shaders read
+struct Meshlet
+{
+    uint32_t vertexOffset;      // into MeshletMesh::vertexIndices
+    uint32_t primitiveOffset;   // in bytes into MeshletMesh::primitiveIndices, a multiple of 4
+    uint32_t vertexCount;
+    uint32_t primitiveCount;
+};
+
+// laid out like the two vec4 the shaders read. The meshlet is back facing
+// for every eye position with
+//   dot(center - eye, coneAxis) >= coneCutoff * length(center - eye) + radius
+// a cutoff of 1 disables the test.
+struct MeshletBounds
+{
+    glm::vec3 center;
+    float radius;
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+static_assert(sizeof(Meshlet) == 16 && sizeof(MeshletBounds) == 32, "meshlets are read as uvec4 and vec4 pairs");
+
+struct MeshletMesh
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;      // one per meshlet
+    std::vector<uint32_t> vertexIndices;    // into the vertices of the source mesh
+    std::vector<uint8_t> primitiveIndices;  // three local vertex indices per triangle, padded per meshlet
+
+    void clear();
+};
+
+// positions are vertexCount float triples, positionStride bytes apart; the
+// winding of the triangles is kept, counter-clockwise is front facing
+void buildMeshlets(const float* positions, size_t positionStride, size_t vertexCount, const uint32_t* indices,
+                   size_t indexCount, const MeshletLimits& limits, MeshletMesh& result);
+
+// checks the limits and ranges, that each source triangle is in exactly one
+// meshlet with its winding, and that the bounds contain all vertices and
+// normals; describes the first problem in error
+bool validateMeshlets(const MeshletMesh& mesh, const float* positions, size_t positionStride, size_t vertexCount,
+                      const uint32_t* indices, size_t indexCount, const MeshletLimits& limits, std::string* error = nullptr);
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OITRenderer.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+OITRenderer::OITRenderer()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+    m_progManager.registerInclude("common.h", "common.h");
+
+    m_resolveProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "passthrough.vert"),
+        nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "oit_resolve.frag.glsl"));
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading OIT resolve shaders\n");
+    }
+
+    nvgl::newBuffer(m_sceneUbo);
+    glNamedBufferData(m_sceneUbo, sizeof(sceneData), nullptr, GL_DYNAMIC_DRAW);
+}
+
+OITRenderer::~OITRenderer()
+{
+    m_progManager.deletePrograms();
+    nvgl::deleteBuffer(m_sceneUbo);
+    nvgl::deleteBuffer(m_fragments);
+    nvgl::deleteTexture(m_heads);
+}
+
+void OITRenderer::resize(int width, int height)
+{
+    if (width == m_width && height == m_height)
+    {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+
+    nvgl::newTexture(m_heads, GL_TEXTURE_2D);
+    glTextureStorage2D(m_heads, 1, GL_R32UI, width, height);
+}
+
+void OITRenderer::setCapacity(uint32_t fragments)
+{
+    if (fragments == m_capacity && m_fragments)
+    {
+        return;
+    }
+    m_capacity = fragments;
+
+    nvgl::deleteBuffer(m_fragments);
+    glCreateBuffers(1, &m_fragments);
+    glNamedBufferStorage(m_fragments, GLsizeiptr(std::max(fragments, 1u)) * BYTES_PER_FRAGMENT, nullptr, 0);
+}
+
+void OITRenderer::beginStore()
+{
+    GLuint listEnd = OIT_LIST_END;
+    glClearTexImage(m_heads, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &listEnd);
+    glBindImageTexture(IMAGE_OIT_HEADS, m_heads, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_OIT_NODES, m_fragments);
+    m_counters.begin(SSBO_OIT_COUNTERS);
+
+    sceneData.sampleBufferSizeInSamples = int(m_capacity);
+    glNamedBufferSubData(m_sceneUbo, 0, sizeof(sceneData), &sceneData);
+    glBindBufferBase(GL_UNIFORM_BUFFER, UBO_SCENE, m_sceneUbo);
+
+    // the lists take the place of the color and depth writes
+    glDepthMask(GL_FALSE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+}
+
+void OITRenderer::endStore()
+{
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void OITRenderer::resolve(int width, int height)
+{
+    m_resolveTimer.begin();
+
+    glUseProgram(m_progManager.get(m_resolveProgram));
+    glBindBufferBase(GL_UNIFORM_BUFFER, UBO_SCENE, m_sceneUbo);
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glUseProgram(0);
+
+    m_resolveTimer.end();
+
+    glBindImageTexture(IMAGE_OIT_HEADS, 0, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_OIT_NODES, 0);
+    m_counters.end(SSBO_OIT_COUNTERS);
+}
+
+uint32_t OITRenderer::getStoredFragments() const
+{
+    return std::min(m_counters.getValue(0), m_capacity);
+}
+
+uint32_t OITRenderer::getOverflowFragments() const
+{
+    uint32_t allocated = m_counters.getValue(0);
+    return allocated > m_capacity ? allocated - m_capacity : 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "GpuCounters.h"
+#include "GpuTimer.h"
+
+#include <cstdint>
+
+//
+// Order independent transparency with per-pixel linked lists in a bounded
+// fragment buffer. The OIT_STORE permutation of the scene program appends
+// one node per fragment shader invocation to the list of the pixel its
+// fragment starts at, so a coarse 2x2 fragment takes one node for four
+// pixels. When the buffer is full, fragments are dropped and counted instead
+// of growing it. resolve() keeps the maxSamplesForBlending nearest fragments
+// of each pixel and blends them over the framebuffer.
+//
+class OITRenderer
+{
+public:
+    OITRenderer();
+    ~OITRenderer();
+
+    OITRenderer(const OITRenderer&) = delete;
+    OITRenderer& operator=(const OITRenderer&) = delete;
+
+    // size of the list heads, no-op if unchanged
+    void resize(int width, int height);
+
+    // size of the fragment buffer in fragments, reallocated if changed
+    void setCapacity(uint32_t fragments);
+    uint32_t getCapacity() const { return m_capacity; }
+
+    // clears the lists and binds them for the scene pass, which gets sceneData
+    // as its scene UBO and writes neither color nor depth until endStore()
+    void beginStore();
+    void endStore();
+
+    // blends the lists over the currently bound framebuffer at full rate
+    void resolve(int width, int height);
+
+    void reloadShaders() { m_progManager.reloadPrograms(); }
+
+    vertexload::OITSceneData sceneData = {};
+
+    // of the most recent finished frame
+    uint32_t getStoredFragments() const;
+    uint32_t getOverflowFragments() const;
+    // stored, but beyond maxSamplesForBlending of their pixel
+    uint32_t getDroppedFragments() const { return m_counters.getValue(1); }
+    // increases whenever the values above changed
+    uint32_t getResultCount() const { return m_counters.getResultCount(); }
+
+    // fragment buffer and list heads
+    uint64_t getAllocatedBytes() const { return uint64_t(m_capacity) * BYTES_PER_FRAGMENT + uint64_t(m_width) * m_height * sizeof(uint32_t); }
+
+    double getResolveMilliseconds() const { return m_resolveTimer.getMilliseconds(); }
+
+    // color, depth, next and size + coverage, must match scene.frag.glsl
+    static const uint32_t BYTES_PER_FRAGMENT = 16;
+
+private:
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_resolveProgram;
+
+    GLuint m_sceneUbo = 0;
+    GLuint m_heads = 0;
+    GLuint m_fragments = 0;
+    uint32_t m_capacity = 0;
+    int m_width = 0;
+    int m_height = 0;
+
+    // fragments allocated (including the ones that did not fit) and dropped at resolve
+    GpuCounters m_counters{ 2 };
+
+    GpuTimer m_resolveTimer;
+};
@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OcclusionCuller.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <string>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+// must match occlusion_cull.comp.glsl
+static const GLuint REDUCE_GROUP_SIZE = 8;
+static const GLint LOCATION_SOURCE_SIZE = 0;
+static const GLint LOCATION_FROM_DEPTH = 1;
+static const GLint LOCATION_VIEW_PROJ = 0;
+static const GLint LOCATION_PYRAMID_VIEW_PROJ = 1;
+static const GLint LOCATION_BOUNDS_MIN = 2;
+static const GLint LOCATION_BOUNDS_MAX = 3;
+static const GLint LOCATION_OBJECT_COUNT = 4;
+static const GLint LOCATION_PHASE = 5;
+static const GLint LOCATION_PYRAMID_SIZE = 6;
+static const GLint LOCATION_PYRAMID_LEVELS = 7;
+
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+OcclusionCuller::OcclusionCuller()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+
+    m_reduceProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define CULL_PASS 1\n", "occlusion_cull.comp.glsl"));
+    m_cullProgram = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, "#define CULL_PASS 2\n", "occlusion_cull.comp.glsl"));
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading occlusion culling shaders\n");
+    }
+
+    glCreateBuffers(1, &m_drawBuffer);
+    glNamedBufferStorage(m_drawBuffer, 2 * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_STORAGE_BIT);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    m_progManager.deletePrograms();
+    nvgl::deleteBuffer(m_objectBuffer);
+    nvgl::deleteBuffer(m_visibleBuffer);
+    nvgl::deleteBuffer(m_statusBuffer);
+    nvgl::deleteBuffer(m_drawBuffer);
+    nvgl::deleteTexture(m_pyramid);
+}
+
+void OcclusionCuller::setObjects(const std::vector<vertexload::InstanceData>& objects, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    m_objectCount = uint32_t(objects.size());
+    m_boundsMin = boundsMin;
+    m_boundsMax = boundsMax;
+
+    if (m_objectCount > m_objectCapacity)
+    {
+        m_objectCapacity = std::max(m_objectCount, m_objectCapacity * 2);
+        GLsizeiptr size = GLsizeiptr(m_objectCapacity) * sizeof(vertexload::InstanceData);
+
+        nvgl::newBuffer(m_objectBuffer);
+        glNamedBufferStorage(m_objectBuffer, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+        nvgl::newBuffer(m_visibleBuffer);
+        glNamedBufferStorage(m_visibleBuffer, size, nullptr, 0);
+        nvgl::newBuffer(m_statusBuffer);
+        glNamedBufferStorage(m_statusBuffer, GLsizeiptr(m_objectCapacity) * sizeof(uint32_t), nullptr, 0);
+    }
+    if (m_objectCount)
+    {
+        glNamedBufferSubData(m_objectBuffer, 0, m_objectCount * sizeof(vertexload::InstanceData), objects.data());
+    }
+}
+
+void OcclusionCuller::resize(uint32_t width, uint32_t height)
+{
+    if (width == m_width && height == m_height)
+    {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_levelCount = getDepthPyramidLevelCount(width, height);
+    m_hasPyramid = false;
+
+    // the levels of the pyramid round up, GL's round down: a power of two base has room for all of them
+    glm::uvec2 size = getDepthPyramidStorageSize(width, height);
+    nvgl::newTexture(m_pyramid, GL_TEXTURE_2D);
+    glTextureStorage2D(m_pyramid, m_levelCount, GL_R32F, size.x, size.y);
+    glTextureParameteri(m_pyramid, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTextureParameteri(m_pyramid, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+void OcclusionCuller::buildPyramid(GLuint depthTexture)
+{
+    GLuint program = m_progManager.get(m_reduceProgram);
+    glUseProgram(program);
+    glBindTextureUnit(TEX_CULL_DEPTH, depthTexture);
+
+    glm::uvec2 sourceSize(m_width, m_height);
+    for (uint32_t level = 0; level < m_levelCount; ++level)
+    {
+        glm::uvec2 size = getDepthPyramidLevelSize(m_width, m_height, level);
+        glProgramUniform2i(program, LOCATION_SOURCE_SIZE, sourceSize.x, sourceSize.y);
+        glProgramUniform1i(program, LOCATION_FROM_DEPTH, level == 0 ? 1 : 0);
+        if (level > 0)
+        {
+            glBindImageTexture(IMAGE_CULL_SOURCE, m_pyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        }
+        glBindImageTexture(IMAGE_CULL_TARGET, m_pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glDispatchCompute((size.x + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, (size.y + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE, 1);
+
+        // the next level loads this one
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        sourceSize = size;
+    }
+
+    // the cull pass fetches the levels as texture
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindImageTexture(IMAGE_CULL_SOURCE, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    glBindImageTexture(IMAGE_CULL_TARGET, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glBindTextureUnit(TEX_CULL_DEPTH, 0);
+    glUseProgram(0);
+
+    m_hasPyramid = true;
+}
+
+void OcclusionCuller::cull(int phase)
+{
+    GLuint program = m_progManager.get(m_cullProgram);
+    glUseProgram(program);
+    glProgramUniformMatrix4fv(program, LOCATION_VIEW_PROJ, 1, GL_FALSE, &m_viewProj[0][0]);
+    glProgramUniformMatrix4fv(program, LOCATION_PYRAMID_VIEW_PROJ, 1, GL_FALSE, &m_pyramidViewProj[0][0]);
+    glProgramUniform3fv(program, LOCATION_BOUNDS_MIN, 1, &m_boundsMin[0]);
+    glProgramUniform3fv(program, LOCATION_BOUNDS_MAX, 1, &m_boundsMax[0]);
+    glProgramUniform1ui(program, LOCATION_OBJECT_COUNT, m_objectCount);
+    glProgramUniform1i(program, LOCATION_PHASE, phase);
+    glProgramUniform2i(program, LOCATION_PYRAMID_SIZE, m_width, m_height);
+    glProgramUniform1i(program, LOCATION_PYRAMID_LEVELS, m_hasPyramid ? m_levelCount : 0);
+
+    glBindTextureUnit(TEX_CULL_DEPTH, m_pyramid);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_OBJECTS, m_objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, m_visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_STATUS, m_statusBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_DRAWS, m_drawBuffer);
+
+    // one more group than needed in the second phase is fine, invocation 0 always writes the base instance
+    glDispatchCompute(std::max((m_objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1u), 1, 1);
+
+    // the draws read the commands and the compacted objects, the second phase the status
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_DRAWS, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_STATUS, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_CULL_OBJECTS, 0);
+    glBindTextureUnit(TEX_CULL_DEPTH, 0);
+    glUseProgram(0);
+}
+
+void OcclusionCuller::cullFirstPhase(const glm::mat4& viewProj, uint32_t width, uint32_t height)
+{
+    resize(width, height);
+    m_viewProj = viewProj;
+
+    // no objects drawn yet, the commands only get their instance counts from the GPU
+    DrawElementsIndirectCommand commands[2] = {};
+    for (DrawElementsIndirectCommand& command : commands)
+    {
+        command.count = m_indexCount;
+    }
+    glNamedBufferSubData(m_drawBuffer, 0, sizeof(commands), commands);
+
+    m_counters.begin(SSBO_CULL_STATS);
+    cull(0);
+}
+
+void OcclusionCuller::drawPhase(int phase)
+{
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_drawBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, m_visibleBuffer);
+
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NV_BUFFER_OFFSET(phase * sizeof(DrawElementsIndirectCommand)));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INSTANCES, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void OcclusionCuller::cullSecondPhase(GLuint depthTexture)
+{
+    // what the first phase drew, with the current matrix
+    buildPyramid(depthTexture);
+    m_pyramidViewProj = m_viewProj;
+
+    cull(1);
+    m_counters.end(SSBO_CULL_STATS);
+}
+
+void OcclusionCuller::endFrame(GLuint depthTexture)
+{
+    // the first phase of the next frame tests against everything drawn in this one
+    buildPyramid(depthTexture);
+    m_pyramidViewProj = m_viewProj;
+}
+
+void OcclusionCuller::reloadShaders()
+{
+    m_progManager.reloadPrograms();
+}
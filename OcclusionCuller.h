@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+#include <glm/glm.hpp>
+
+#include "common.h"
+#include "GpuCounters.h"
+#include "OcclusionCullingReference.h"
+
+#include <cstdint>
+#include <vector>
+
+//
+// GPU side of the occlusion culling (see OcclusionCullingReference.h) for
+// many copies of one indexed mesh. Per frame:
+//   cullFirstPhase()   frustum and the pyramid of the previous frame
+//   drawPhase(0)       the survivors, through an indirect draw
+//   cullSecondPhase()  the pyramid of what phase 0 drew, for the objects it rejected
+//   drawPhase(1)       the newly visible ones
+//   endFrame()         the pyramid of the finished depth, for the next frame
+// The survivors are compacted into SSBO_INSTANCES, the scene program has to
+// be an instanced permutation.
+//
+class OcclusionCuller
+{
+public:
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // call again whenever the objects change, boundsMin and boundsMax are the same for all objects in their model space
+    void setObjects(const std::vector<vertexload::InstanceData>& objects, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    // the indexed mesh of the draws, from the element buffer bound when drawing
+    void setMesh(GLuint indexCount) { m_indexCount = indexCount; }
+
+    void cullFirstPhase(const glm::mat4& viewProj, uint32_t width, uint32_t height);
+    // with the vertex and element buffers of the mesh bound
+    void drawPhase(int phase);
+    // depthTexture holds what drawPhase(0) rendered
+    void cullSecondPhase(GLuint depthTexture);
+    void endFrame(GLuint depthTexture);
+
+    // forget the pyramid, the next first phase draws everything in the frustum
+    void invalidate() { m_hasPyramid = false; }
+
+    // objects per OcclusionResult of the most recent finished frame, lagging a few frames behind
+    uint32_t getCount(OcclusionResult result) const { return m_counters.getValue(result); }
+    uint32_t getResultCount() const { return m_counters.getResultCount(); }
+
+    void reloadShaders();
+
+private:
+    void resize(uint32_t width, uint32_t height);
+    void buildPyramid(GLuint depthTexture);
+    void cull(int phase);
+
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_reduceProgram;
+    nvgl::ProgramID m_cullProgram;
+
+    GLuint m_objectBuffer = 0;          // SSBO_CULL_OBJECTS
+    GLuint m_visibleBuffer = 0;         // SSBO_INSTANCES while drawing
+    GLuint m_statusBuffer = 0;
+    GLuint m_drawBuffer = 0;            // two DrawElementsIndirectCommands
+    uint32_t m_objectCapacity = 0;
+    uint32_t m_objectCount = 0;
+    glm::vec3 m_boundsMin = glm::vec3(0.0f);
+    glm::vec3 m_boundsMax = glm::vec3(0.0f);
+    GLuint m_indexCount = 0;
+
+    GLuint m_pyramid = 0;               // R32F, level 0 at half the framebuffer
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_levelCount = 0;
+    bool m_hasPyramid = false;
+    glm::mat4 m_pyramidViewProj = glm::mat4(1.0f);
+    glm::mat4 m_viewProj = glm::mat4(1.0f);
+
+    GpuCounters m_counters{ 4 };
+};
@@ -0,0 +1,196 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OcclusionCullingReference.h"
+
+#include <algorithm>
+
+uint32_t getDepthPyramidLevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    glm::uvec2 size = getDepthPyramidLevelSize(width, height, 0);
+    while (size.x > 1 || size.y > 1)
+    {
+        size = (size + 1u) / 2u;
+        ++count;
+    }
+    return count;
+}
+
+glm::uvec2 getDepthPyramidLevelSize(uint32_t width, uint32_t height, uint32_t level)
+{
+    // rounding up at each level keeps texel x of level l covering the pixels
+    // [x << (l + 1), (x + 1) << (l + 1)), the same as a single division
+    glm::uvec2 size(std::max(width, 1u), std::max(height, 1u));
+    for (uint32_t i = 0; i <= level; ++i)
+    {
+        size = (size + 1u) / 2u;
+    }
+    return size;
+}
+
+glm::uvec2 getDepthPyramidStorageSize(uint32_t width, uint32_t height)
+{
+    glm::uvec2 size = getDepthPyramidLevelSize(width, height, 0);
+    glm::uvec2 storage(1u);
+    while (storage.x < size.x)
+    {
+        storage.x *= 2;
+    }
+    while (storage.y < size.y)
+    {
+        storage.y *= 2;
+    }
+    return storage;
+}
+
+void buildDepthPyramid(const float* depth, uint32_t width, uint32_t height, DepthPyramid& pyramid)
+{
+    uint32_t levelCount = getDepthPyramidLevelCount(width, height);
+    pyramid.width = width;
+    pyramid.height = height;
+    pyramid.sizes.resize(levelCount);
+    pyramid.levels.resize(levelCount);
+
+    const float* source = depth;
+    glm::uvec2 sourceSize(width, height);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        glm::uvec2 size = getDepthPyramidLevelSize(width, height, level);
+        std::vector<float>& texels = pyramid.levels[level];
+        texels.resize(size_t(size.x) * size.y);
+        pyramid.sizes[level] = size;
+
+        // the odd last row and column only have one source texel in that direction
+        for (uint32_t y = 0; y < size.y; ++y)
+        {
+            for (uint32_t x = 0; x < size.x; ++x)
+            {
+                uint32_t x0 = x * 2;
+                uint32_t y0 = y * 2;
+                uint32_t x1 = std::min(x0 + 1, sourceSize.x - 1);
+                uint32_t y1 = std::min(y0 + 1, sourceSize.y - 1);
+                texels[size_t(y) * size.x + x] = std::max(std::max(source[size_t(y0) * sourceSize.x + x0], source[size_t(y0) * sourceSize.x + x1]),
+                                                          std::max(source[size_t(y1) * sourceSize.x + x0], source[size_t(y1) * sourceSize.x + x1]));
+            }
+        }
+
+        source = texels.data();
+        sourceSize = size;
+    }
+}
+
+static void getClipCorners(const glm::mat4& modelViewProj, const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec4 corners[8])
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+        corners[i] = modelViewProj * glm::vec4(corner, 1.0f);
+    }
+}
+
+bool isOutsideFrustum(const glm::mat4& modelViewProj, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    glm::vec4 corners[8];
+    getClipCorners(modelViewProj, boundsMin, boundsMax, corners);
+
+    // one bit per plane a corner is outside of, the box is outside if all corners share one
+    uint32_t outside = 0x3f;
+    for (const glm::vec4& c : corners)
+    {
+        outside &= (c.x < -c.w ? 0x01u : 0u) | (c.x > c.w ? 0x02u : 0u) | (c.y < -c.w ? 0x04u : 0u)
+            | (c.y > c.w ? 0x08u : 0u) | (c.z < -c.w ? 0x10u : 0u) | (c.z > c.w ? 0x20u : 0u);
+    }
+    return outside != 0;
+}
+
+bool isOccluded(const DepthPyramid& pyramid, const glm::mat4& modelViewProj, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    if (pyramid.levels.empty())
+    {
+        return false;
+    }
+
+    glm::vec4 corners[8];
+    getClipCorners(modelViewProj, boundsMin, boundsMax, corners);
+
+    glm::vec2 ndcMin(1.0f);
+    glm::vec2 ndcMax(-1.0f);
+    float nearest = 1.0f;
+    for (const glm::vec4& c : corners)
+    {
+        if (c.w <= 0.0f || c.z < -c.w)
+        {
+            return false;
+        }
+        glm::vec3 ndc = glm::vec3(c) / c.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc.x, ndc.y));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc.x, ndc.y));
+        nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+    if (ndcMin.x < -1.0f || ndcMin.y < -1.0f || ndcMax.x > 1.0f || ndcMax.y > 1.0f)
+    {
+        return false;
+    }
+
+    // pixels under the rectangle, then the finest level where they span at most 2x2 texels
+    glm::vec2 size(float(pyramid.width), float(pyramid.height));
+    glm::uvec2 pixelMin = glm::min(glm::uvec2((ndcMin * 0.5f + 0.5f) * size), glm::uvec2(pyramid.width - 1, pyramid.height - 1));
+    glm::uvec2 pixelMax = glm::min(glm::uvec2((ndcMax * 0.5f + 0.5f) * size), glm::uvec2(pyramid.width - 1, pyramid.height - 1));
+
+    uint32_t level = 0;
+    while (level + 1 < pyramid.levels.size()
+           && (((pixelMax.x >> (level + 1)) - (pixelMin.x >> (level + 1))) > 1 || ((pixelMax.y >> (level + 1)) - (pixelMin.y >> (level + 1))) > 1))
+    {
+        ++level;
+    }
+
+    glm::uvec2 texelMin(pixelMin.x >> (level + 1), pixelMin.y >> (level + 1));
+    glm::uvec2 texelMax(pixelMax.x >> (level + 1), pixelMax.y >> (level + 1));
+    const std::vector<float>& texels = pyramid.levels[level];
+    uint32_t levelWidth = pyramid.sizes[level].x;
+
+    float farthest = 0.0f;
+    for (uint32_t y = texelMin.y; y <= texelMax.y; ++y)
+    {
+        for (uint32_t x = texelMin.x; x <= texelMax.x; ++x)
+        {
+            farthest = std::max(farthest, texels[size_t(y) * levelWidth + x]);
+        }
+    }
+    return nearest > farthest;
+}
+
+OcclusionResult cullFirstPhase(const DepthPyramid* oldPyramid, const glm::mat4& oldModelViewProj, const glm::mat4& modelViewProj,
+                               const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    if (isOutsideFrustum(modelViewProj, boundsMin, boundsMax))
+    {
+        return OCCLUSION_OUTSIDE_FRUSTUM;
+    }
+    return oldPyramid && isOccluded(*oldPyramid, oldModelViewProj, boundsMin, boundsMax) ? OCCLUSION_OCCLUDED : OCCLUSION_VISIBLE;
+}
+
+OcclusionResult cullSecondPhase(OcclusionResult firstPhase, const DepthPyramid& newPyramid, const glm::mat4& modelViewProj,
+                                const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    if (firstPhase != OCCLUSION_OCCLUDED)
+    {
+        return firstPhase;
+    }
+    return isOccluded(newPyramid, modelViewProj, boundsMin, boundsMax) ? OCCLUSION_OCCLUDED : OCCLUSION_VISIBLE_LATE;
+}
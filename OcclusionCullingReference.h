@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//
+// Two phase occlusion culling of objects with a hierarchical depth buffer
+// (Hi-Z). Each level of the pyramid holds the farthest depth of the 2x2
+// texels below it, level 0 the farthest of 2x2 pixels. An object is
+// occluded if the nearest depth of its bounds lies behind the farthest
+// depth under their screen rectangle. The GPU version lives in
+// occlusion_cull.comp.glsl, the functions here are the CPU reference of the
+// same pyramid and the same tests.
+//
+
+// of one object, ordered like the counters of OcclusionCuller
+enum OcclusionResult : uint32_t
+{
+    OCCLUSION_VISIBLE = 0,          // drawn in the first phase
+    OCCLUSION_VISIBLE_LATE = 1,     // occluded in the old depth, but not in the new one: drawn in the second phase
+    OCCLUSION_OCCLUDED = 2,         // occluded in both
+    OCCLUSION_OUTSIDE_FRUSTUM = 3,
+};
+
+struct DepthPyramid
+{
+    uint32_t width = 0;             // of the depth buffer it was built from
+    uint32_t height = 0;
+    std::vector<glm::uvec2> sizes;  // per level
+    std::vector<std::vector<float>> levels;
+};
+
+// level 0 is half the framebuffer, rounded up, down to 1x1
+uint32_t getDepthPyramidLevelCount(uint32_t width, uint32_t height);
+glm::uvec2 getDepthPyramidLevelSize(uint32_t width, uint32_t height, uint32_t level);
+
+// level 0 of the texture holding the pyramid: the size of level 0 rounded
+// up to a power of two. GL halves mip levels rounding down, from this base
+// each of its levels holds the level of the pyramid and it has exactly
+// getDepthPyramidLevelCount of them. The texels beyond are never read.
+glm::uvec2 getDepthPyramidStorageSize(uint32_t width, uint32_t height);
+
+// depth holds the window depth of a width x height framebuffer, bottom row first
+void buildDepthPyramid(const float* depth, uint32_t width, uint32_t height, DepthPyramid& pyramid);
+
+// all corners of the box are outside one of the clip planes
+bool isOutsideFrustum(const glm::mat4& modelViewProj, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+// modelViewProj has to be the one the depth of the pyramid was rendered
+// with. Boxes crossing the near plane or the border of the screen are never
+// occluded, the pyramid knows nothing about the part outside.
+bool isOccluded(const DepthPyramid& pyramid, const glm::mat4& modelViewProj, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+// first phase: against the pyramid of the previous frame (null on the
+// first frame) with the matrix of the previous frame; returns visible,
+// occluded or outside the frustum of the current modelViewProj
+OcclusionResult cullFirstPhase(const DepthPyramid* oldPyramid, const glm::mat4& oldModelViewProj, const glm::mat4& modelViewProj,
+                               const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+// second phase: objects occluded in the first one against the pyramid of
+// the depth the first phase rendered, visible late or still occluded
+OcclusionResult cullSecondPhase(OcclusionResult firstPhase, const DepthPyramid& newPyramid, const glm::mat4& modelViewProj,
+                                const glm::vec3& boundsMin, const glm::vec3& boundsMax);
@@ -21,6 +21,8 @@
 #include "nvgl/programmanager_gl.hpp"
 #include "nvgl/base_gl.hpp"
 
+#include "SceneTransforms.h"
+
 extern std::vector<std::string> defaultSearchPaths;
 
 template <class SCENE_DATA, class OBJECT_DATA>
@@ -63,7 +65,7 @@ public:
         m_projectionMatrix = viewMatrix;
     }
 
-    void reloadShaders()
+    virtual void reloadShaders()
     {
         m_progManager.reloadPrograms();
     }
@@ -74,6 +76,13 @@ public:
     }
     virtual void updateSceneUniforms();
     virtual void updateObjectUniforms();
+    // fills objectData from the matrices without uploading it, for callers
+    // that put the object data of many draws into their own buffer
+    virtual void prepareObjectData();
+
+    GLuint getSceneBuffer() const { return m_sceneUbo; }
+    GLuint getSceneBufferIndex() const { return m_sceneBufferIndex; }
+    GLuint getObjectBufferIndex() const { return m_objectBufferIndex; }
 
     SCENE_DATA sceneData;
     OBJECT_DATA objectData;
@@ -100,13 +109,16 @@ inline void Pipeline<SCENE_DATA, OBJECT_DATA>::updateSceneUniforms()
     glBindBufferBase(GL_UNIFORM_BUFFER, m_sceneBufferIndex, m_sceneUbo);
 }
 
+template<class SCENE_DATA, class OBJECT_DATA>
+inline void Pipeline<SCENE_DATA, OBJECT_DATA>::prepareObjectData()
+{
+    buildObjectMatrices(m_modelMatrix, m_viewMatrix, m_projectionMatrix, objectData);
+}
+
 template<class SCENE_DATA, class OBJECT_DATA>
 inline void Pipeline<SCENE_DATA, OBJECT_DATA>::updateObjectUniforms()
 {
-    objectData.model = m_modelMatrix;
-    objectData.modelView = m_viewMatrix * m_modelMatrix;
-    objectData.modelViewIT = glm::transpose(glm::inverse(objectData.modelView));
-    objectData.modelViewProj = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
+    prepareObjectData();
 
     glNamedBufferSubData(m_objectUbo, 0, sizeof(OBJECT_DATA), &objectData);
 
@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProgramCache.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+static const uint32_t PROGRAM_CACHE_MAGIC = 0x43425056; // "VPBC"
+static const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+};
+
+ProgramCache::ProgramCache(const std::string& directory)
+    : m_directory(directory)
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    std::string driver;
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const char* value = (const char*)glGetString(name);
+        driver += value ? value : "";
+        driver += '\n';
+    }
+    m_driverHash = hash(driver);
+}
+
+uint64_t ProgramCache::hash(const void* data, size_t size, uint64_t seed)
+{
+    // FNV-1a
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::string ProgramCache::getFilename(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)(key ^ m_driverHash));
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+GLuint ProgramCache::load(uint64_t key)
+{
+    std::string filename = getFilename(key);
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (!file)
+    {
+        return 0;
+    }
+
+    ProgramCacheHeader header = {};
+    std::vector<uint8_t> binary;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == PROGRAM_CACHE_MAGIC
+        && header.version == PROGRAM_CACHE_VERSION
+        && header.key == (key ^ m_driverHash);
+    if (valid)
+    {
+        binary.resize(header.binarySize);
+        valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if (!valid)
+    {
+        LOGW("Ignoring invalid program cache file %s\n", filename.c_str());
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), GLsizei(binary.size()));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        // the driver is allowed to reject binaries at any time, compile from source instead
+        glDeleteProgram(program);
+        std::error_code error;
+        std::filesystem::remove(filename, error);
+        return 0;
+    }
+
+    return program;
+}
+
+bool ProgramCache::store(uint64_t key, GLuint program)
+{
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> binary(size);
+    GLenum format = 0;
+    glGetProgramBinary(program, size, nullptr, &format, binary.data());
+
+    ProgramCacheHeader header = {};
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key ^ m_driverHash;
+    header.binaryFormat = format;
+    header.binarySize = uint32_t(size);
+
+    std::string filename = getFilename(key);
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(binary.data(), 1, binary.size(), file) == binary.size();
+    fclose(file);
+
+    return written;
+}
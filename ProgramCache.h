@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+#include <string>
+
+//
+// On-disk cache of linked programs via glGetProgramBinary / glProgramBinary.
+// Entries are keyed by a caller provided 64 bit hash (sources + defines),
+// which gets combined with the driver identification, so a driver update
+// or a different GPU never picks up a stale binary.
+//
+class ProgramCache
+{
+public:
+    // needs a current context to query the driver strings
+    explicit ProgramCache(const std::string& directory);
+
+    // returns a linked program or 0 if there is no usable binary for key
+    GLuint load(uint64_t key);
+
+    // stores the binary of a linked program, returns false if the driver does not provide one
+    bool store(uint64_t key, GLuint program);
+
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+    static uint64_t hash(const std::string& text, uint64_t seed = 14695981039346656037ull)
+    {
+        return hash(text.data(), text.size(), seed);
+    }
+
+private:
+    std::string getFilename(uint64_t key) const;
+
+    std::string m_directory;
+    uint64_t m_driverHash = 0;
+};
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RateOverlay.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+// must match rate_overlay.frag.glsl
+static const GLint LOCATION_MODE = 0;
+static const GLint LOCATION_RATE_TEXEL_SIZE = 1;
+static const GLint LOCATION_SHADING_RATE_ACTIVE = 2;
+static const GLint LOCATION_OPACITY = 3;
+static const GLint LOCATION_MAX_INVOCATIONS = 4;
+
+RateOverlay::RateOverlay()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+
+    m_program = m_progManager.createProgram(
+        nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "passthrough.vert"),
+        nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "rate_overlay.frag.glsl"));
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading overlay shaders\n");
+    }
+
+    // integer textures are only complete with nearest filtering
+    glCreateSamplers(1, &m_nearestSampler);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+RateOverlay::~RateOverlay()
+{
+    m_progManager.deletePrograms();
+    glDeleteSamplers(1, &m_nearestSampler);
+    nvgl::deleteTexture(m_invocationCounts);
+}
+
+void RateOverlay::resize(int width, int height)
+{
+    if (width == m_width && height == m_height)
+    {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+
+    nvgl::newTexture(m_invocationCounts, GL_TEXTURE_2D);
+    glTextureStorage2D(m_invocationCounts, 1, GL_R32UI, width, height);
+}
+
+void RateOverlay::beginInvocationCounting()
+{
+    GLuint zero = 0;
+    glClearTexImage(m_invocationCounts, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindImageTexture(IMAGE_UNIT_INVOCATION_COUNTS, m_invocationCounts, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+}
+
+void RateOverlay::endInvocationCounting()
+{
+    glBindImageTexture(IMAGE_UNIT_INVOCATION_COUNTS, 0, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void RateOverlay::draw(Mode mode, GLuint shadingRateImage, GLint rateTexelWidth, GLint rateTexelHeight, int width, int height)
+{
+    if (mode == OVERLAY_OFF)
+    {
+        return;
+    }
+
+    GLuint program = m_progManager.get(m_program);
+    glUseProgram(program);
+    glProgramUniform1i(program, LOCATION_MODE, mode);
+    glProgramUniform2i(program, LOCATION_RATE_TEXEL_SIZE, std::max(rateTexelWidth, 1), std::max(rateTexelHeight, 1));
+    glProgramUniform1i(program, LOCATION_SHADING_RATE_ACTIVE, shadingRateImage ? 1 : 0);
+    glProgramUniform1f(program, LOCATION_OPACITY, m_opacity);
+    glProgramUniform1f(program, LOCATION_MAX_INVOCATIONS, m_maxInvocations);
+
+    glBindTextureUnit(0, shadingRateImage);
+    glBindTextureUnit(1, m_invocationCounts);
+    glBindSampler(0, m_nearestSampler);
+    glBindSampler(1, m_nearestSampler);
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    glBindSampler(0, 0);
+    glBindSampler(1, 0);
+    glBindTextureUnit(0, 0);
+    glBindTextureUnit(1, 0);
+    glUseProgram(0);
+}
+
+glm::vec3 RateOverlay::heatColor(float t)
+{
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    if (t < 0.5f)
+    {
+        return glm::mix(glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), t * 2.0f);
+    }
+    return glm::mix(glm::vec3(0, 1, 0), glm::vec3(1, 0, 0), t * 2.0f - 1.0f);
+}
+
+std::vector<RateOverlay::LegendEntry> RateOverlay::getLegend(Mode mode) const
+{
+    std::vector<LegendEntry> legend;
+
+    if (mode == OVERLAY_SHADING_RATE)
+    {
+        legend.push_back({ heatColor(1.0f), "1x1 (1 invocation per pixel)" });
+        legend.push_back({ heatColor(0.5f), "2x2 (1/4 invocation per pixel)" });
+        legend.push_back({ heatColor(0.0f), "4x4 (1/16 invocation per pixel)" });
+        legend.push_back({ glm::vec3(0.2f), "no invocations" });
+    }
+    else if (mode == OVERLAY_INVOCATIONS)
+    {
+        const int steps = 5;
+        for (int i = steps - 1; i >= 0; --i)
+        {
+            float t = float(i) / float(steps - 1);
+            char label[64];
+            snprintf(label, sizeof(label), "%s%.2f invocations per pixel", i == steps - 1 ? ">= " : "", t * m_maxInvocations);
+            legend.push_back({ heatColor(t), label });
+        }
+    }
+
+    return legend;
+}
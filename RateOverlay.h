@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+//
+// Fullscreen heatmap of the shading cost on top of the rendered scene.
+// OVERLAY_SHADING_RATE reads the bound shading rate image and needs nothing
+// from the scene program. OVERLAY_INVOCATIONS shows the fragment shader
+// invocations per pixel (including overdraw and per-primitive rates), which
+// the scene program only writes in its COUNT_INVOCATIONS permutation.
+//
+// Only the invocations of the scene pass itself can count themselves: a
+// separate pass would count its own invocations, with a different depth
+// state and without the per-primitive rates of the scene program. Off and
+// OVERLAY_SHADING_RATE draw with the unchanged scene program and add no
+// cost to it. Switching to OVERLAY_INVOCATIONS compiles the counting
+// permutation once, later switches find it in the permutation cache.
+//
+class RateOverlay
+{
+public:
+    enum Mode
+    {
+        OVERLAY_OFF = 0,
+        OVERLAY_SHADING_RATE = 1,
+        OVERLAY_INVOCATIONS = 2,
+        OVERLAY_MODE_COUNT
+    };
+
+    struct LegendEntry
+    {
+        glm::vec3 color;
+        std::string label;
+    };
+
+    RateOverlay();
+    ~RateOverlay();
+
+    // size of the invocation count image, no-op if unchanged
+    void resize(int width, int height);
+
+    // zeroes the counts and binds them to IMAGE_UNIT_INVOCATION_COUNTS for the scene pass
+    void beginInvocationCounting();
+    void endInvocationCounting();
+
+    // blends the heatmap over the currently bound framebuffer,
+    // shadingRateImage 0 means VRS is disabled (everything at 1x1)
+    void draw(Mode mode, GLuint shadingRateImage, GLint rateTexelWidth, GLint rateTexelHeight, int width, int height);
+
+    std::vector<LegendEntry> getLegend(Mode mode) const;
+
+    float m_opacity = 0.6f;
+    float m_maxInvocations = 2.0f; // invocations per pixel shown as red
+
+    // must match scene.frag.glsl
+    static const GLuint IMAGE_UNIT_INVOCATION_COUNTS = 0;
+
+private:
+    static glm::vec3 heatColor(float t);
+
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_program;
+
+    GLuint m_invocationCounts = 0;
+    GLuint m_nearestSampler = 0;
+    int m_width = 0;
+    int m_height = 0;
+};
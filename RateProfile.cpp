@@ -0,0 +1,217 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RateProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(RateProfileHeader) == 32, "RateProfileHeader is part of the file format");
+
+static uint64_t maskStride(uint32_t width, uint32_t height)
+{
+    return (uint64_t(width) * height + 3) & ~uint64_t(3);
+}
+
+static bool fail(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+uint64_t RateProfile::getFileSize(uint32_t eyeCount, uint32_t width, uint32_t height)
+{
+    return sizeof(RateProfileHeader) + eyeCount * (maskStride(width, height) + uint64_t(width) * height * sizeof(float));
+}
+
+bool RateProfile::open(const std::string& filename, std::string* error)
+{
+    close();
+
+    if (!m_file.open(filename))
+    {
+        return fail(error, "could not open " + filename);
+    }
+
+    const RateProfileHeader* header = reinterpret_cast<const RateProfileHeader*>(m_file.data());
+    if (m_file.size() < sizeof(RateProfileHeader)
+        || memcmp(header->magic, RATE_PROFILE_MAGIC, sizeof(RATE_PROFILE_MAGIC)) != 0
+        || header->version != RATE_PROFILE_VERSION)
+    {
+        close();
+        return fail(error, filename + " is not a rate profile of this version");
+    }
+    if (header->eyeCount < 1 || header->eyeCount > 2 || header->width == 0 || header->height == 0
+        || header->width > 65536 || header->height > 65536
+        || getFileSize(header->eyeCount, header->width, header->height) != m_file.size())
+    {
+        close();
+        return fail(error, filename + " has an invalid size");
+    }
+
+    m_header = header;
+    return true;
+}
+
+void RateProfile::close()
+{
+    m_file.close();
+    m_header = nullptr;
+    for (Resampled& resampled : m_resampled)
+    {
+        resampled = Resampled();
+    }
+}
+
+const uint8_t* RateProfile::getMask(uint32_t eye) const
+{
+    return m_file.data() + sizeof(RateProfileHeader) + eye * maskStride(m_header->width, m_header->height);
+}
+
+const float* RateProfile::getDensity(uint32_t eye) const
+{
+    uint64_t masks = m_header->eyeCount * maskStride(m_header->width, m_header->height);
+    uint64_t offset = sizeof(RateProfileHeader) + masks + uint64_t(eye) * m_header->width * m_header->height * sizeof(float);
+    return reinterpret_cast<const float*>(m_file.data() + offset);
+}
+
+const std::vector<uint8_t>& RateProfile::getRates(uint32_t width, uint32_t height)
+{
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        if (m_resampled[i].width == width && m_resampled[i].height == height && !m_resampled[i].rates.empty())
+        {
+            m_lastResampled = i;
+            return m_resampled[i].rates;
+        }
+    }
+
+    // replaces the older of the two
+    m_lastResampled ^= 1;
+    Resampled& resampled = m_resampled[m_lastResampled];
+    resampled.width = width;
+    resampled.height = height;
+    std::vector<uint8_t>& rates = resampled.rates;
+    rates.assign(size_t(width) * height, RATE_NO_INVOCATIONS);
+
+    uint32_t eyeCount = m_header->eyeCount;
+    for (uint32_t eye = 0; eye < eyeCount; ++eye)
+    {
+        uint32_t x0 = width * eye / eyeCount;
+        uint32_t x1 = width * (eye + 1) / eyeCount;
+        resampleRateProfileEye(getMask(eye), getDensity(eye), m_header->width, m_header->height,
+            m_header->densityThresholds, rates.data(), width, x0, x1 - x0, height);
+    }
+    return rates;
+}
+
+void resampleRateProfileEye(const uint8_t* mask, const float* density, uint32_t sourceWidth, uint32_t sourceHeight,
+                            const float densityThresholds[2], uint8_t* rates, uint32_t pitch, uint32_t x0,
+                            uint32_t regionWidth, uint32_t height)
+{
+    // finer rates have lower palette entries, RATE_NO_INVOCATIONS aside
+    auto finer = [](uint8_t a, uint8_t b) -> uint8_t {
+        if (a == RATE_NO_INVOCATIONS) return b;
+        if (b == RATE_NO_INVOCATIONS) return a;
+        return std::min(a, b);
+    };
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        // source rows overlapped by the target row, at least one
+        uint32_t sy0 = uint32_t(uint64_t(y) * sourceHeight / height);
+        uint32_t sy1 = std::max(sy0 + 1, uint32_t((uint64_t(y + 1) * sourceHeight + height - 1) / height));
+
+        for (uint32_t x = 0; x < regionWidth; ++x)
+        {
+            uint32_t sx0 = uint32_t(uint64_t(x) * sourceWidth / regionWidth);
+            uint32_t sx1 = std::max(sx0 + 1, uint32_t((uint64_t(x + 1) * sourceWidth + regionWidth - 1) / regionWidth));
+
+            uint8_t maskRate = RATE_NO_INVOCATIONS;
+            float maxDensity = 0.0f;
+            for (uint32_t sy = sy0; sy < sy1; ++sy)
+            {
+                for (uint32_t sx = sx0; sx < sx1; ++sx)
+                {
+                    size_t index = size_t(sy) * sourceWidth + sx;
+                    if (mask[index] != RATE_NO_INVOCATIONS)
+                    {
+                        maskRate = finer(maskRate, mask[index]);
+                        maxDensity = std::max(maxDensity, density[index]);
+                    }
+                }
+            }
+
+            uint8_t rate = RATE_NO_INVOCATIONS;
+            if (maskRate != RATE_NO_INVOCATIONS)
+            {
+                uint8_t densityRate = maxDensity >= densityThresholds[0] ? RATE_1X1
+                                    : maxDensity >= densityThresholds[1] ? RATE_2X2 : RATE_4X4;
+                rate = std::min(maskRate, densityRate);
+            }
+            rates[size_t(y) * pitch + x0 + x] = rate;
+        }
+    }
+}
+
+bool writeRateProfile(const std::string& filename, const RateProfileHeader& header,
+                      const std::vector<std::vector<uint8_t>>& masks, const std::vector<std::vector<float>>& densities,
+                      std::string* error)
+{
+    size_t texels = size_t(header.width) * header.height;
+    if (masks.size() != header.eyeCount || densities.size() != header.eyeCount)
+    {
+        return fail(error, "need a mask and a density map per eye");
+    }
+    for (uint32_t eye = 0; eye < header.eyeCount; ++eye)
+    {
+        if (masks[eye].size() != texels || densities[eye].size() != texels)
+        {
+            return fail(error, "mask or density map of eye " + std::to_string(eye) + " has the wrong size");
+        }
+    }
+
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file)
+    {
+        return fail(error, "could not create " + filename);
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    const uint8_t padding[4] = {};
+    for (const auto& mask : masks)
+    {
+        ok = ok && fwrite(mask.data(), 1, texels, file) == texels;
+        size_t pad = size_t(maskStride(header.width, header.height) - texels);
+        ok = ok && (pad == 0 || fwrite(padding, 1, pad, file) == pad);
+    }
+    for (const auto& density : densities)
+    {
+        ok = ok && fwrite(density.data(), sizeof(float), texels, file) == texels;
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        return fail(error, "writing " + filename + " failed");
+    }
+    return true;
+}
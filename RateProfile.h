@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "MappedFile.h"
+#include "ShadingRateImage.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Lens matched shading rate profile of a head mounted display (".vrp"),
+// generated offline by tools/rateprofile_gen and memory-mapped at runtime.
+// Nothing in here touches OpenGL.
+//
+// Per eye the file holds, at its own resolution:
+// - a rate mask of palette entries (see ShadingRatePaletteEntry):
+//   RATE_NO_INVOCATIONS where no pixel reaches the display, otherwise the
+//   coarsest rate allowed there,
+// - a density map: display pixels per rendered pixel, 1 where the lens
+//   maps the rendered image 1:1, smaller where the lens compresses it.
+//
+// The density picks the rate via the thresholds in the header, the mask
+// clamps it. With two eyes, eye 0 covers the left and eye 1 the right half
+// of the shading rate image.
+//
+// Layout, all values in native byte order:
+//   RateProfileHeader
+//   per eye: uint8_t mask[width * height], padded to 4 bytes
+//   per eye: float density[width * height]
+//
+
+static const char RATE_PROFILE_MAGIC[4] = { 'V', 'R', 'P', 'F' };
+static const uint32_t RATE_PROFILE_VERSION = 1;
+
+struct RateProfileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t eyeCount;      // 1 or 2
+    uint32_t width;         // per eye
+    uint32_t height;
+    // density at or above densityThresholds[0] is shaded at 1x1, at or above [1] at 2x2, below at 4x4
+    float densityThresholds[2];
+    uint32_t reserved;
+};
+
+class RateProfile
+{
+public:
+    bool open(const std::string& filename, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    const RateProfileHeader& getHeader() const { return *m_header; }
+    const uint8_t* getMask(uint32_t eye) const;
+    const float* getDensity(uint32_t eye) const;
+
+    // the profile as a width x height shading rate image, computed on the first
+    // request of a resolution. The current and the previous resolution are
+    // kept, resizing a window only computes each new size once and does not
+    // pile up images; the reference is valid until the next getRates().
+    const std::vector<uint8_t>& getRates(uint32_t width, uint32_t height);
+
+    // size in bytes of a profile file
+    static uint64_t getFileSize(uint32_t eyeCount, uint32_t width, uint32_t height);
+
+private:
+    MappedFile m_file;
+    const RateProfileHeader* m_header = nullptr;
+
+    struct Resampled
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> rates;
+    };
+    Resampled m_resampled[2];
+    uint32_t m_lastResampled = 0;   // the one returned last
+};
+
+//
+// Resamples one eye into the region [x0, x0 + regionWidth) x [0, height) of
+// rates (with a row pitch of pitch), conservatively: each target texel takes
+// the finest rate and the highest density of all source texels it overlaps,
+// and only gets RATE_NO_INVOCATIONS if all of them are invisible.
+//
+void resampleRateProfileEye(const uint8_t* mask, const float* density, uint32_t sourceWidth, uint32_t sourceHeight,
+                            const float densityThresholds[2], uint8_t* rates, uint32_t pitch, uint32_t x0,
+                            uint32_t regionWidth, uint32_t height);
+
+bool writeRateProfile(const std::string& filename, const RateProfileHeader& header,
+                      const std::vector<std::vector<uint8_t>>& masks, const std::vector<std::vector<float>>& densities,
+                      std::string* error = nullptr);
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint64_t makeDrawKey(uint32_t pass, uint32_t permutation, uint32_t mesh, uint32_t palette, float depth)
+{
+    uint32_t depthBits = 0;
+    if (depth > 0.0f)
+    {
+        memcpy(&depthBits, &depth, sizeof(depthBits));
+    }
+    return (uint64_t(pass & 0xf) << 60) | (uint64_t(permutation & 0xfff) << 48) | (uint64_t(mesh & 0xfff) << 36)
+        | (uint64_t(palette & 0xf) << 32) | depthBits;
+}
+
+void RenderQueue::sort()
+{
+    m_sortPasses = 0;
+
+    const size_t count = m_items.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // one histogram per byte, all from one pass over the keys
+    uint32_t histograms[8][256] = {};
+    for (const Item& item : m_items)
+    {
+        uint64_t key = item.key;
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            ++histograms[byte][(key >> (byte * 8)) & 0xff];
+        }
+    }
+
+    m_scratch.resize(count);
+    Item* source = m_items.data();
+    Item* target = m_scratch.data();
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        uint32_t* histogram = histograms[byte];
+        const int shift = byte * 8;
+
+        // every key has this byte, the pass would not move anything
+        if (histogram[(source[0].key >> shift) & 0xff] == count)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Item& item = source[i];
+            target[histogram[(item.key >> shift) & 0xff]++] = item;
+        }
+
+        std::swap(source, target);
+        ++m_sortPasses;
+    }
+
+    if (source != m_items.data())
+    {
+        m_items.swap(m_scratch);
+    }
+}
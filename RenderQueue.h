@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// The draws of one pass in submission order, sorted by a 64 bit key per
+// draw. Pure CPU: the caller builds the keys with makeDrawKey(), pushes one
+// item per draw, sorts, and submits in the order of getItems().
+//
+// The key puts the state that is most expensive to change on top, so equal
+// state ends up adjacent, and the view depth at the bottom, so the draws
+// within equal state go front to back and the depth test rejects what is
+// hidden before it is shaded. Most significant first:
+//   63..60  pass           e.g. opaque before transparent
+//   59..48  permutation    scene program
+//   47..36  mesh           vertex and index buffers
+//   35..32  palette        shading rate palette the draw selects
+//   31..0   depth          bits of a non-negative float order like the float
+//
+// sort() is a stable LSD radix sort over the bytes of the key. A byte that
+// is the same in all keys, typically pass, permutation and mesh of a scene
+// with one program and one mesh, is skipped without a pass over the items.
+//
+enum DrawPass
+{
+    DRAW_PASS_OPAQUE = 0,
+    DRAW_PASS_TRANSPARENT = 1,
+};
+
+// depth is the distance along the view direction, negative values and NaN count as 0
+uint64_t makeDrawKey(uint32_t pass, uint32_t permutation, uint32_t mesh, uint32_t palette, float depth);
+
+class RenderQueue
+{
+public:
+    struct Item
+    {
+        uint64_t key;
+        uint32_t index;     // of the draw in the caller's list
+    };
+
+    void clear() { m_items.clear(); }
+    void reserve(size_t count) { m_items.reserve(count); }
+    void push(uint64_t key, uint32_t index) { m_items.push_back({ key, index }); }
+
+    void sort();
+
+    const std::vector<Item>& getItems() const { return m_items; }
+    size_t size() const { return m_items.size(); }
+
+    // radix passes the last sort() needed, 0 to 8
+    uint32_t getSortPasses() const { return m_sortPasses; }
+
+private:
+    std::vector<Item> m_items;
+    std::vector<Item> m_scratch;
+    uint32_t m_sortPasses = 0;
+};
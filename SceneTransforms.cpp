@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SceneTransforms.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+void placeTorusGrid(uint32_t numberOfTori, float aspect, std::vector<vertexload::InstanceData>& instances)
+{
+    float num = (float)numberOfTori;
+
+    // distribute num tori into an numX x numY pattern
+    // with numX * numY > num, numX = aspect * numY
+
+    size_t numX = static_cast<size_t>(ceil(sqrt(num * aspect)));
+    size_t numY = static_cast<size_t>((float)numX / aspect);
+    if (numX * numY < num)
+    {
+        ++numY;
+    }
+    float rx = 1.0f;                     // radius of ring
+    float ry = 1.0f;
+    float dx = 1.0f;                     // ring distance
+    float dy = 1.5f;
+    float sx = (numX - 1) * dx + 2 * rx; // array size 
+    float sy = (numY - 1) * dy + 2 * ry;
+
+    float x0 = -sx / 2.0f + rx;
+    float y0 = -sy / 2.0f + ry;
+
+    float scale = std::min(1.f / sx, 1.f / sy) * 0.8f;
+
+    instances.resize(numberOfTori);
+    size_t torusIndex = 0;
+    for (size_t i = 0; i < numY && torusIndex < num; ++i)
+    {
+        for (size_t j = 0; j < numX && torusIndex < num; ++j)
+        {
+            float y = y0 + i * dy;
+            float x = x0 + j * dx;
+
+            float rotationAngle = (j % 2 ? -1.0f : 1.0f) * 45.0f * glm::pi<float>() / 180.0f;
+            vertexload::InstanceData& instance = instances[torusIndex];
+            instance.model =
+                glm::scale(glm::mat4(1.0f), glm::vec3(scale))
+                * glm::translate(glm::mat4(1.f), glm::vec3(x, y, 0.0f))
+                * glm::rotate(glm::mat4(1.f), rotationAngle, glm::vec3(1, 0, 0));
+
+            // Use colors light blue and green
+            int colorIndex = torusIndex % 5;
+            instance.color = glm::vec4(0, .7f, 1, 1);
+            if (colorIndex == 4) {
+                instance.color = glm::vec4(0, 1, 0, 1);
+            }
+
+            ++torusIndex;
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include "common.h"
+
+#include <cstdint>
+#include <vector>
+
+//
+// The per-object transforms of the tori without the GL side, shared by
+// GLDemo, Pipeline and tools/cpu_bench. Nothing in here touches OpenGL.
+//
+
+// distributes the tori over a grid with the aspect ratio of the window,
+// alternately tilted, every fifth one green
+void placeTorusGrid(uint32_t numberOfTori, float aspect, std::vector<vertexload::InstanceData>& instances);
+
+// the matrices of the object UBO
+template <class OBJECT_DATA>
+inline void buildObjectMatrices(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, OBJECT_DATA& data)
+{
+    data.model = model;
+    data.modelView = view * model;
+    data.modelViewIT = glm::transpose(glm::inverse(data.modelView));
+    data.modelViewProj = projection * view * model;
+}
@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SessionTrace.h"
+
+#include <cstring>
+
+static bool fail(std::string* error, const std::string& message)
+{
+    if (error)
+    {
+        *error = message;
+    }
+    return false;
+}
+
+//////////// SessionTraceWriter ////////////
+
+SessionTraceWriter::~SessionTraceWriter()
+{
+    close();
+}
+
+bool SessionTraceWriter::open(const std::string& filename, float timestep, std::string* error)
+{
+    close();
+
+    m_file = fopen(filename.c_str(), "wb");
+    if (!m_file)
+    {
+        return fail(error, "could not create trace " + filename);
+    }
+
+    TraceHeader header;
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.settingsSize = sizeof(TraceSettings);
+    header.timestep = timestep;
+
+    m_pending.clear();
+    append(&header, sizeof(header));
+
+    m_stop = false;
+    m_writeFailed = false;
+    m_hasSettings = false;
+    m_frameCount = 0;
+    m_thread = std::thread(&SessionTraceWriter::threadMain, this);
+
+    return true;
+}
+
+bool SessionTraceWriter::close(std::string* error)
+{
+    if (!m_file)
+    {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+
+    bool ok = !m_writeFailed && fclose(m_file) == 0;
+    m_file = nullptr;
+    return ok || fail(error, "writing the trace failed, it is incomplete");
+}
+
+void SessionTraceWriter::record(const TraceFrame& frame, const TraceSettings& settings)
+{
+    if (!m_file)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (!m_hasSettings || memcmp(&settings, &m_lastSettings, sizeof(TraceSettings)) != 0)
+    {
+        m_lastSettings = settings;
+        m_hasSettings = true;
+        append(&TRACE_TAG_SETTINGS, 1);
+        append(&settings, sizeof(settings));
+    }
+
+    append(&TRACE_TAG_FRAME, 1);
+    append(&frame, sizeof(frame));
+    ++m_frameCount;
+
+    lock.unlock();
+    m_condition.notify_one();
+}
+
+void SessionTraceWriter::append(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_pending.insert(m_pending.end(), bytes, bytes + size);
+}
+
+void SessionTraceWriter::threadMain()
+{
+    // swapped with m_pending, so both keep their capacity and the steady state does not allocate
+    std::vector<uint8_t> writing;
+
+    for (;;)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            std::swap(writing, m_pending);
+            stop = m_stop;
+        }
+
+        if (!writing.empty() && !m_writeFailed)
+        {
+            m_writeFailed = fwrite(writing.data(), 1, writing.size(), m_file) != writing.size();
+        }
+        writing.clear();
+
+        if (stop)
+        {
+            // record() is not called concurrently with close(), nothing can be left behind
+            fflush(m_file);
+            return;
+        }
+    }
+}
+
+//////////// SessionTraceReader ////////////
+
+bool SessionTraceReader::open(const std::string& filename, std::string* error)
+{
+    close();
+
+    if (!m_file.open(filename))
+    {
+        return fail(error, "could not open trace " + filename);
+    }
+
+    if (!read(&m_header, sizeof(m_header))
+        || memcmp(m_header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0
+        || m_header.version != TRACE_VERSION
+        || m_header.settingsSize != sizeof(TraceSettings)
+        || !(m_header.timestep > 0.0f))
+    {
+        close();
+        return fail(error, filename + " is not a trace of this version");
+    }
+
+    rewind();
+    return true;
+}
+
+void SessionTraceReader::close()
+{
+    m_file.close();
+    m_offset = 0;
+    m_header = {};
+}
+
+void SessionTraceReader::rewind()
+{
+    m_offset = sizeof(TraceHeader);
+    m_hasSettings = false;
+    m_settings = TraceSettings();
+}
+
+bool SessionTraceReader::next(TraceFrame& frame, TraceSettings& settings, std::string* error)
+{
+    uint8_t tag;
+    while (read(&tag, 1))
+    {
+        size_t recordOffset = m_offset - 1;
+        bool complete = false;
+        if (tag == TRACE_TAG_SETTINGS)
+        {
+            complete = read(&m_settings, sizeof(m_settings));
+            m_hasSettings = m_hasSettings || complete;
+        }
+        else if (tag == TRACE_TAG_FRAME && m_hasSettings)
+        {
+            complete = read(&frame, sizeof(frame));
+            if (complete)
+            {
+                settings = m_settings;
+                return true;
+            }
+        }
+
+        if (!complete)
+        {
+            // a truncated or unknown record, or a frame before any settings
+            m_offset = m_file.size();
+            return fail(error, "corrupt trace record at offset " + std::to_string(recordOffset));
+        }
+    }
+    return false;
+}
+
+bool SessionTraceReader::read(void* data, size_t size)
+{
+    if (!m_file.isOpen() || m_file.size() - m_offset < size)
+    {
+        return false;
+    }
+    memcpy(data, m_file.data() + m_offset, size);
+    m_offset += size;
+    return true;
+}
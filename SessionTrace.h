@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// Binary trace of an interactive session, so that different VRS
+// configurations can be compared on exactly the same frames. Nothing in
+// here touches OpenGL.
+//
+// Layout, all values in native byte order:
+//   TraceHeader
+//   records: one tag byte followed by the payload of the tag
+//     TRACE_TAG_SETTINGS  TraceSettings, only written when they changed
+//     TRACE_TAG_FRAME     TraceFrame
+//
+
+// everything the UI can change that affects the rendered frames
+struct TraceSettings
+{
+    // GLDemo
+    int32_t framebufferScaling = 1;
+    int32_t upscaleFilter = 0;
+    float upscaleSharpness = 1.0f;
+    int32_t numberOfTori = 16;
+    int32_t fragmentLoad = 16;
+    int32_t torusTessellationN = 0;
+    int32_t torusTessellationM = 0;
+    uint8_t opaquePanels = 0;
+    uint8_t sortDraws = 1;
+    uint8_t padding[2] = {};    // no implicit padding, the settings are compared with memcmp
+
+    // VRSDemo
+    int32_t sceneMode = 0;
+    int32_t meshInstances = 0;
+    int32_t shadingMode = 0;
+    int32_t overlayMode = 0;
+    uint8_t activateShadingRate = 1;
+    uint8_t fullShadingRateForGreenObjects = 1;
+    uint8_t dynamicFoveation = 0;
+    uint8_t useShaderPermutations = 1;
+    float targetMilliseconds = 8.0f;
+    float foveationRadii[3] = {};
+    uint8_t foveationRates[4] = {};
+    int32_t edgePolicy = 0;
+    float edgeThresholds[2] = {};
+    uint8_t edgeRates[2] = {};
+    uint8_t texturedMaterial = 0;
+    uint8_t measureTextureTraffic = 0;
+    float lodBiasScale = 0.5f;
+    int32_t oitCapacityMillions = 4;
+    int32_t oitMaxSamples = 8;
+    uint8_t oitVisualizeSampleCount = 0;
+    uint8_t oitVisualizeShadingRate = 0;
+    uint8_t oitPadding[2] = {};
+    uint8_t torusPath = 0;                  // TorusPath
+    uint8_t tessellationRateDriven = 1;
+    uint8_t meshletConeCulling = 1;
+    uint8_t unifiedDraws = 0;
+    int32_t tessellationPatches[2] = {};    // around the ring, around the tube
+    float tessellationTargetPixels = 8.0f;
+    float tessellationMaxFactor = 32.0f;
+    uint8_t occlusionCulling = 0;
+    uint8_t halfPrecisionMaterial = 0;
+    uint8_t depthOfFieldRates = 0;
+    uint8_t gazeFoveation = 0;
+    float depthOfFieldLens[2] = { 3.0f, 8.0f };         // focus distance, blur at infinity in pixels
+    float depthOfFieldThresholds[2] = { 2.0f, 4.0f };   // circle of confusion for 2x2, for 4x4
+};
+
+struct TraceFrame
+{
+    uint32_t frameIndex = 0;
+    uint16_t windowWidth = 0;
+    uint16_t windowHeight = 0;
+    uint16_t framebufferWidth = 0;
+    uint16_t framebufferHeight = 0;
+    float viewMatrix[16] = {};
+    float gaze[2] = { 0.5f, 0.5f };    // latched with the camera, see GLDemo::latchInput
+};
+
+struct TraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t settingsSize;  // guards against a changed TraceSettings without a version bump
+    float timestep;         // seconds per frame during replay
+};
+
+static const char TRACE_MAGIC[4] = { 'V', 'R', 'S', 'T' };
+static const uint32_t TRACE_VERSION = 15;
+static const uint8_t TRACE_TAG_SETTINGS = 'S';
+static const uint8_t TRACE_TAG_FRAME = 'F';
+
+// The reader only checks the framing of the records. Replayed settings are
+// clamped to the range of their UI control before they are used, NaN ends
+// up at the low end.
+template <class T>
+inline T clampTraceSetting(T value, T low, T high)
+{
+    return value >= low ? (value <= high ? value : high) : low;
+}
+
+//
+// Records are serialized into a memory buffer on the calling thread; a
+// writer thread swaps that buffer out and does the file I/O, so the render
+// loop never waits for the disk.
+//
+class SessionTraceWriter
+{
+public:
+    SessionTraceWriter() = default;
+    ~SessionTraceWriter();
+
+    SessionTraceWriter(const SessionTraceWriter&) = delete;
+    SessionTraceWriter& operator=(const SessionTraceWriter&) = delete;
+
+    bool open(const std::string& filename, float timestep, std::string* error = nullptr);
+    // flushes all pending records and joins the writer thread, false if writing failed
+    bool close(std::string* error = nullptr);
+    bool isOpen() const { return m_file != nullptr; }
+
+    void record(const TraceFrame& frame, const TraceSettings& settings);
+
+    uint32_t getFrameCount() const { return m_frameCount; }
+
+private:
+    void append(const void* data, size_t size);
+    void threadMain();
+
+    FILE* m_file = nullptr;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<uint8_t> m_pending;  // filled by record(), guarded by m_mutex
+    bool m_stop = false;
+    bool m_writeFailed = false;
+
+    TraceSettings m_lastSettings;
+    bool m_hasSettings = false;
+    uint32_t m_frameCount = 0;
+};
+
+//
+// Reads a trace through a memory mapping, one frame at a time.
+//
+class SessionTraceReader
+{
+public:
+    bool open(const std::string& filename, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // returns false at the end of the trace or on a corrupt record, only the
+    // latter sets error. settings are the ones in effect for the returned frame.
+    bool next(TraceFrame& frame, TraceSettings& settings, std::string* error = nullptr);
+
+    void rewind();
+
+    float getTimestep() const { return m_header.timestep; }
+
+private:
+    bool read(void* data, size_t size);
+
+    MappedFile m_file;
+    TraceHeader m_header = {};
+    size_t m_offset = 0;
+
+    TraceSettings m_settings;
+    bool m_hasSettings = false;
+};
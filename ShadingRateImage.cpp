@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShadingRateImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void fillFoveationRates(uint8_t* data, uint32_t width, uint32_t height,
+                        float centerX, float centerY, const FoveationParams& params)
+{
+    //////////// ShadingRateSample ////////////
+    // 
+    // Creates the data for a 'foveation' shading rate imaage. It will have a
+    // high resolution at the given center and a lower rate further away from
+    // the center. At the edges we also use the SHADE_NO_PIXELS_NV rate
+    // which will discard the full block. This is useful for areas in HMDs
+    // which won't end up on the screen anyway due to the lens distortions.
+    //
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        float fy = y / (float)height;
+
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float fx = x / (float)width;
+
+            float d = std::sqrt((fx - centerX) * (fx - centerX) + (fy - centerY) * (fy - centerY));
+
+            uint8_t rate = params.rates[3];
+            if (d < params.radii[0])
+            {
+                rate = params.rates[0];
+            }
+            else if (d < params.radii[1])
+            {
+                rate = params.rates[1];
+            }
+            else if (d < params.radii[2])
+            {
+                rate = params.rates[2];
+            }
+            data[x + y * width] = rate;
+        }
+    }
+}
+
+void fillConstantRates(uint8_t* data, uint32_t width, uint32_t height, uint8_t value)
+{
+    memset(data, value, size_t(width) * height);
+}
+
+RateRect diffRates(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height)
+{
+    uint32_t minX = width;
+    uint32_t minY = height;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* rowA = a + size_t(y) * width;
+        const uint8_t* rowB = b + size_t(y) * width;
+        if (memcmp(rowA, rowB, width) == 0)
+        {
+            continue;
+        }
+
+        uint32_t first = 0;
+        while (rowA[first] == rowB[first])
+        {
+            ++first;
+        }
+        uint32_t last = width - 1;
+        while (rowA[last] == rowB[last])
+        {
+            --last;
+        }
+
+        minX = std::min(minX, first);
+        maxX = std::max(maxX, last);
+        minY = std::min(minY, y);
+        maxY = y;
+    }
+
+    RateRect rect;
+    if (minY < height)
+    {
+        rect.x = minX;
+        rect.y = minY;
+        rect.width = maxX - minX + 1;
+        rect.height = maxY - minY + 1;
+    }
+    return rect;
+}
+
+RateRect stampRateRects(uint8_t* data, uint32_t width, uint32_t height, uint32_t texelWidth, uint32_t texelHeight,
+                        uint32_t framebufferWidth, uint32_t framebufferHeight, const PixelRect* rects, size_t rectCount, uint8_t value)
+{
+    // texels beyond the framebuffer have no pixels and are left alone
+    uint32_t tilesX = std::min(width, (framebufferWidth + texelWidth - 1) / texelWidth);
+    uint32_t tilesY = std::min(height, (framebufferHeight + texelHeight - 1) / texelHeight);
+
+    uint32_t minX = tilesX;
+    uint32_t minY = tilesY;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+
+    for (size_t i = 0; i < rectCount; ++i)
+    {
+        const PixelRect& rect = rects[i];
+
+        //
+        // A texel is covered if the rect contains its first and its last
+        // pixel. The texels in the last row and column are clipped to the
+        // framebuffer, so a rect reaching past the edge covers them as soon
+        // as it covers their visible part.
+        //
+        uint32_t beginX = uint32_t(std::ceil(std::max(rect.x0, 0.0f) / float(texelWidth)));
+        uint32_t beginY = uint32_t(std::ceil(std::max(rect.y0, 0.0f) / float(texelHeight)));
+        uint32_t endX = rect.x1 >= float(framebufferWidth) ? tilesX : uint32_t(std::floor(std::max(rect.x1, 0.0f) / float(texelWidth)));
+        uint32_t endY = rect.y1 >= float(framebufferHeight) ? tilesY : uint32_t(std::floor(std::max(rect.y1, 0.0f) / float(texelHeight)));
+        endX = std::min(endX, tilesX);
+        endY = std::min(endY, tilesY);
+
+        if (beginX >= endX || beginY >= endY)
+        {
+            continue;
+        }
+
+        for (uint32_t y = beginY; y < endY; ++y)
+        {
+            memset(data + size_t(y) * width + beginX, value, endX - beginX);
+        }
+
+        minX = std::min(minX, beginX);
+        minY = std::min(minY, beginY);
+        maxX = std::max(maxX, endX - 1);
+        maxY = std::max(maxY, endY - 1);
+    }
+
+    RateRect stamped;
+    if (minX < tilesX && minY < tilesY)
+    {
+        stamped.x = minX;
+        stamped.y = minY;
+        stamped.width = maxX - minX + 1;
+        stamped.height = maxY - minY + 1;
+    }
+    return stamped;
+}
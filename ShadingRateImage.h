@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// CPU side generation of shading rate image content. Nothing in here
+// touches OpenGL, VRSDemo uploads the results.
+//
+
+// entries of palette 0 as set up in VRSDemo::setupShadingRatePalette()
+enum ShadingRatePaletteEntry : uint8_t
+{
+    RATE_NO_INVOCATIONS = 0,
+    RATE_1X1 = 1,
+    RATE_2X2 = 2,
+    RATE_4X4 = 3,
+};
+
+struct FoveationParams
+{
+    // distance from the center, relative to the image size, at which the
+    // rate changes to the next entry of rates[]
+    float radii[3] = { 0.15f, 0.3f, 0.45f };
+    // palette entry per ring, rates[3] is used beyond radii[2]
+    uint8_t rates[4] = { RATE_1X1, RATE_2X2, RATE_4X4, RATE_NO_INVOCATIONS };
+};
+
+// sub-rectangle of a shading rate image in texels
+struct RateRect
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    bool isEmpty() const { return width == 0 || height == 0; }
+};
+
+// rectangle in framebuffer pixels, covering [x0, x1) x [y0, y1)
+struct PixelRect
+{
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+};
+
+// concentric rings around (centerX, centerY), given in 0..1 image coordinates
+void fillFoveationRates(uint8_t* data, uint32_t width, uint32_t height,
+                        float centerX, float centerY, const FoveationParams& params);
+
+void fillConstantRates(uint8_t* data, uint32_t width, uint32_t height, uint8_t value);
+
+// bounding rectangle of all texels that differ between a and b
+RateRect diffRates(const uint8_t* a, const uint8_t* b, uint32_t width, uint32_t height);
+
+// Sets all texels to value whose pixels inside the framebuffer are covered
+// by one of the rects. Partially covered texels keep their rate, so no
+// visible pixel loses its invocations. Returns the bounding rectangle of
+// the stamped texels.
+RateRect stampRateRects(uint8_t* data, uint32_t width, uint32_t height, uint32_t texelWidth, uint32_t texelHeight,
+                        uint32_t framebufferWidth, uint32_t framebufferHeight, const PixelRect* rects, size_t rectCount, uint8_t value);
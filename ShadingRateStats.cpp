@@ -0,0 +1,221 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ShadingRateStats.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RATE_STATS_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define RATE_STATS_USE_SSE2 0
+#endif
+
+uint32_t countRates(const uint8_t* data, uint32_t count, uint32_t histogram[RATE_STATS_MAX_ENTRIES])
+{
+    uint32_t i = 0;
+    uint32_t invalid = 0;
+
+#if RATE_STATS_USE_SSE2
+    //
+    // One compare per palette entry and 16 texels. The byte counters of the
+    // compares (-1 per match) are summed for at most 255 iterations, then
+    // folded into the histogram with a sum of absolute differences.
+    //
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= count)
+    {
+        uint32_t blocks = std::min<uint32_t>((count - i) / 16, 255);
+
+        __m128i counters[RATE_STATS_MAX_ENTRIES];
+        for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+        {
+            counters[e] = zero;
+        }
+
+        for (uint32_t b = 0; b < blocks; ++b, i += 16)
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+            {
+                counters[e] = _mm_sub_epi8(counters[e], _mm_cmpeq_epi8(values, _mm_set1_epi8(char(e))));
+            }
+        }
+
+        // whatever matched no entry is outside the palette
+        uint32_t valid = 0;
+        for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+        {
+            __m128i sums = _mm_sad_epu8(counters[e], zero);
+            uint32_t sum = uint32_t(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+            histogram[e] += sum;
+            valid += sum;
+        }
+        invalid += blocks * 16 - valid;
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (data[i] < RATE_STATS_MAX_ENTRIES)
+        {
+            histogram[data[i]]++;
+        }
+        else
+        {
+            invalid++;
+        }
+    }
+
+    return invalid;
+}
+
+void ShadingRateStats::setLayout(uint32_t width, uint32_t height, uint32_t texelWidth, uint32_t texelHeight,
+                                 uint32_t framebufferWidth, uint32_t framebufferHeight)
+{
+    m_width = width;
+    m_height = height;
+    m_texelWidth = std::max(texelWidth, 1u);
+    m_texelHeight = std::max(texelHeight, 1u);
+    m_framebufferWidth = framebufferWidth;
+    m_framebufferHeight = framebufferHeight;
+
+    std::fill(std::begin(m_pixels), std::end(m_pixels), int64_t(0));
+    m_invalidPixels = 0;
+}
+
+void ShadingRateStats::build(const uint8_t* data)
+{
+    std::fill(std::begin(m_pixels), std::end(m_pixels), int64_t(0));
+    m_invalidPixels = 0;
+
+    RateRect all;
+    all.width = m_width;
+    all.height = m_height;
+    accumulate(data, all, 1);
+}
+
+void ShadingRateStats::update(const uint8_t* oldData, const uint8_t* newData, const RateRect& dirty)
+{
+    if (dirty.isEmpty())
+    {
+        return;
+    }
+    accumulate(oldData, dirty, -1);
+    accumulate(newData, dirty, 1);
+}
+
+void ShadingRateStats::accumulate(const uint8_t* data, const RateRect& rect, int64_t sign)
+{
+    if (rect.isEmpty() || m_width == 0 || m_height == 0)
+    {
+        return;
+    }
+
+    // pixels of the framebuffer covered by the texels of a column / row, clipped at the framebuffer edge
+    auto coveredWidth = [this](uint32_t x) -> int64_t {
+        return int64_t(std::min(m_texelWidth, m_framebufferWidth - std::min(m_framebufferWidth, x * m_texelWidth)));
+    };
+    auto coveredHeight = [this](uint32_t y) -> int64_t {
+        return int64_t(std::min(m_texelHeight, m_framebufferHeight - std::min(m_framebufferHeight, y * m_texelHeight)));
+    };
+
+    // the columns inside the framebuffer cover full texels and are counted together, the
+    // partial one at its edge and any beyond it one by one
+    uint32_t endX = rect.x + rect.width;
+    uint32_t fullEndX = std::max(rect.x, std::min(endX, m_framebufferWidth / m_texelWidth));
+
+    for (uint32_t y = rect.y; y < rect.y + rect.height; ++y)
+    {
+        int64_t rowHeight = coveredHeight(y);
+        if (rowHeight == 0)
+        {
+            continue;
+        }
+        const uint8_t* row = data + size_t(y) * m_width;
+
+        uint32_t histogram[RATE_STATS_MAX_ENTRIES] = {};
+        uint32_t invalid = 0;
+        if (fullEndX > rect.x)
+        {
+            invalid = countRates(row + rect.x, fullEndX - rect.x, histogram);
+        }
+
+        int64_t fullWeight = sign * rowHeight * int64_t(m_texelWidth);
+        for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+        {
+            m_pixels[e] += fullWeight * histogram[e];
+        }
+        m_invalidPixels += fullWeight * invalid;
+
+        for (uint32_t x = fullEndX; x < endX; ++x)
+        {
+            int64_t weight = sign * rowHeight * coveredWidth(x);
+            if (row[x] < RATE_STATS_MAX_ENTRIES)
+            {
+                m_pixels[row[x]] += weight;
+            }
+            else
+            {
+                m_invalidPixels += weight;
+            }
+        }
+    }
+}
+
+float ShadingRateStats::getFraction(uint32_t entry) const
+{
+    uint64_t total = getTotalPixels();
+    return total ? float(double(m_pixels[entry]) / double(total)) : 0.0f;
+}
+
+float ShadingRateStats::getPredictedInvocationsPerPixel(const RateCostModel& cost) const
+{
+    uint64_t total = getTotalPixels();
+    if (!total)
+    {
+        return 0.0f;
+    }
+
+    double invocations = 0.0;
+    for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+    {
+        invocations += double(m_pixels[e]) * cost.invocationsPerPixel[e];
+    }
+    return float(invocations / double(total));
+}
+
+float ShadingRateStats::getNoInvocationFraction(const RateCostModel& cost) const
+{
+    uint64_t total = getTotalPixels();
+    if (!total)
+    {
+        return 0.0f;
+    }
+
+    int64_t pixels = 0;
+    for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+    {
+        if (cost.invocationsPerPixel[e] == 0.0f)
+        {
+            pixels += m_pixels[e];
+        }
+    }
+    return float(double(pixels) / double(total));
+}
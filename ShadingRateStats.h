@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ShadingRateImage.h"
+
+#include <cstdint>
+
+//
+// Statistics over the content of a shading rate image: how many pixels use
+// each palette entry and, with the cost of each entry, how many fragment
+// shader invocations per pixel the image predicts. Per-primitive rates (the
+// green objects) and overdraw are not part of the prediction. Nothing in
+// here touches OpenGL.
+//
+// Counts are in framebuffer pixels, so the texels in the last column and row,
+// which only partially cover the framebuffer, are weighted correctly.
+//
+
+static const uint32_t RATE_STATS_MAX_ENTRIES = 16;
+
+// fragment shader invocations per pixel of each palette entry
+struct RateCostModel
+{
+    float invocationsPerPixel[RATE_STATS_MAX_ENTRIES] = {};
+};
+
+class ShadingRateStats
+{
+public:
+    // image of width x height texels, each covering texelWidth x texelHeight
+    // pixels of a framebufferWidth x framebufferHeight framebuffer
+    void setLayout(uint32_t width, uint32_t height, uint32_t texelWidth, uint32_t texelHeight,
+                   uint32_t framebufferWidth, uint32_t framebufferHeight);
+
+    // full rebuild from the image content
+    void build(const uint8_t* data);
+
+    // incremental update after the texels in dirty changed from oldData to newData,
+    // both images have the layout set above
+    void update(const uint8_t* oldData, const uint8_t* newData, const RateRect& dirty);
+
+    uint64_t getPixels(uint32_t entry) const { return m_pixels[entry]; }
+    // pixels with values outside the palette
+    uint64_t getInvalidPixels() const { return m_invalidPixels; }
+    uint64_t getTotalPixels() const { return uint64_t(m_framebufferWidth) * m_framebufferHeight; }
+
+    float getFraction(uint32_t entry) const;
+    float getPredictedInvocationsPerPixel(const RateCostModel& cost) const;
+    // fraction of the framebuffer whose entry costs no invocations
+    float getNoInvocationFraction(const RateCostModel& cost) const;
+
+private:
+    // adds sign * histogram of the rect to m_pixels
+    void accumulate(const uint8_t* data, const RateRect& rect, int64_t sign);
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_texelWidth = 1;
+    uint32_t m_texelHeight = 1;
+    uint32_t m_framebufferWidth = 0;
+    uint32_t m_framebufferHeight = 0;
+
+    int64_t m_pixels[RATE_STATS_MAX_ENTRIES] = {};
+    int64_t m_invalidPixels = 0;
+};
+
+// counts the values 0..RATE_STATS_MAX_ENTRIES-1 in data, returns the count of all other values
+uint32_t countRates(const uint8_t* data, uint32_t count, uint32_t histogram[RATE_STATS_MAX_ENTRIES]);
@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TessellatedTorus.h"
+
+#include "common.h"
+
+#include <algorithm>
+#include <vector>
+
+TessellatedTorus::TessellatedTorus()
+{
+}
+
+TessellatedTorus::~TessellatedTorus()
+{
+    nvgl::deleteBuffer(m_vbo);
+    if (m_nearestSampler)
+    {
+        glDeleteSamplers(1, &m_nearestSampler);
+    }
+}
+
+void TessellatedTorus::setSettings(const TessellationSettings& settings, float innerRadius, float outerRadius)
+{
+    TessellationSettings clamped = settings;
+    clamped.ringPatches = std::max(clamped.ringPatches, 1);
+    clamped.tubePatches = std::max(clamped.tubePatches, 1);
+
+    if (clamped.ringPatches != m_settings.ringPatches || clamped.tubePatches != m_settings.tubePatches)
+    {
+        m_patchesDirty = true;
+    }
+    m_settings = clamped;
+    m_radii = glm::vec2(std::max(innerRadius, 0.0f), outerRadius);
+}
+
+void TessellatedTorus::setTarget(uint32_t width, uint32_t height, GLuint rateImage, GLint texelWidth, GLint texelHeight)
+{
+    m_viewport = glm::vec2(float(width), float(height));
+    m_rateImage = rateImage;
+    m_texelWidth = texelWidth;
+    m_texelHeight = texelHeight;
+}
+
+void TessellatedTorus::setBufferState()
+{
+    updatePatches();
+
+    // GL objects are created on first use, the torus is constructed before the context exists
+    if (!m_nearestSampler)
+    {
+        glCreateSamplers(1, &m_nearestSampler);
+        glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glVertexAttribPointer(m_vertexAttributeTexcoord, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+    glEnableVertexAttribArray(m_vertexAttributeTexcoord);
+
+    glPatchParameteri(GL_PATCH_VERTICES, 4);
+
+    // uniforms of the bound scene program, see scene.tesc.glsl
+    bool rateDriven = m_settings.rateDriven && m_rateImage != 0;
+    glUniform4f(TESS_SETTINGS_LOC, m_settings.targetEdgePixels, m_settings.maxFactor, m_viewport.x, m_viewport.y);
+    glUniform3i(TESS_RATE_LOC, m_texelWidth, m_texelHeight, rateDriven ? 1 : 0);
+    glUniform2f(TESS_RADII_LOC, m_radii.x, m_radii.y);
+
+    glBindTextureUnit(TEX_TESS_RATE, rateDriven ? m_rateImage : 0);
+    glBindSampler(TEX_TESS_RATE, m_nearestSampler);
+}
+
+void TessellatedTorus::unsetBufferState()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray(m_vertexAttributeTexcoord);
+    glBindTextureUnit(TEX_TESS_RATE, 0);
+    glBindSampler(TEX_TESS_RATE, 0);
+}
+
+void TessellatedTorus::draw()
+{
+    glDrawArrays(GL_PATCHES, 0, m_numPatches * 4);
+}
+
+void TessellatedTorus::updatePatches()
+{
+    if (!m_patchesDirty)
+    {
+        return;
+    }
+    m_patchesDirty = false;
+
+    // a few hundred patches at most, small enough to rebuild inside the frame
+    std::vector<glm::vec2> corners;
+    generatePatchCorners(m_settings.ringPatches, m_settings.tubePatches, corners);
+
+    nvgl::deleteBuffer(m_vbo);
+    glCreateBuffers(1, &m_vbo);
+    glNamedBufferStorage(m_vbo, corners.size() * sizeof(corners[0]), corners.data(), 0);
+    m_numPatches = GLsizei(corners.size() / 4);
+}
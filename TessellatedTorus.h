@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include "nvgl/base_gl.hpp"
+
+#include "TessellationReference.h"
+
+#include <cstdint>
+
+//
+// The torus surface generated by the tessellation stages of the scene
+// program (permutation tessellated) from a coarse mesh of patches. Only the
+// uv corners of the patches are stored, scene.tesc.glsl picks the factors
+// per edge from its projected length and the shading rate image, and
+// scene.tese.glsl evaluates the surface. The scene program has to be bound
+// before setBufferState(), which sets its tessellation uniforms.
+//
+class TessellatedTorus
+{
+public:
+    TessellatedTorus();
+    ~TessellatedTorus();
+
+    TessellatedTorus(const TessellatedTorus&) = delete;
+    TessellatedTorus& operator=(const TessellatedTorus&) = delete;
+
+    // patch counts below 1 are set to 1, the patch mesh is rebuilt on the next setBufferState()
+    void setSettings(const TessellationSettings& settings, float innerRadius = 0.8f, float outerRadius = 0.2f);
+    const TessellationSettings& getSettings() const { return m_settings; }
+
+    // the framebuffer the tori are rendered to and its shading rate image, 0 for full rate everywhere
+    void setTarget(uint32_t width, uint32_t height, GLuint rateImage, GLint texelWidth, GLint texelHeight);
+
+    void setBufferState();
+
+    // just unset, won't restore the state from before setBufferState()!
+    void unsetBufferState();
+
+    void draw();
+
+    void setVertexAttributeLocation(GLuint texcoord) { m_vertexAttributeTexcoord = texcoord; }
+
+    GLsizei getPatchCount() const { return m_numPatches; }
+
+private:
+    void updatePatches();
+
+    TessellationSettings m_settings;
+    glm::vec2 m_radii = glm::vec2(0.8f, 0.2f);
+    bool m_patchesDirty = true;
+
+    GLuint m_vbo = 0;
+    GLsizei m_numPatches = 0;
+
+    glm::vec2 m_viewport = glm::vec2(1.0f);
+    GLuint m_rateImage = 0;
+    // the rate images are integer textures, which are incomplete with the default linear filters
+    GLuint m_nearestSampler = 0;
+    GLint m_texelWidth = 16;
+    GLint m_texelHeight = 16;
+
+    GLuint m_vertexAttributeTexcoord = 3;
+};
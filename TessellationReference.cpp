@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TessellationReference.h"
+
+#include "tessellation.h"
+
+#include <algorithm>
+
+using tessellation::tessClipOutcode;
+using tessellation::tessEdgeFactor;
+using tessellation::tessEdgePixels;
+using tessellation::tessFragmentSize;
+using tessellation::tessRateTile;
+using tessellation::tessScreenPosition;
+using tessellation::tessTorusPosition;
+using tessellation::TESS_CULL_MARGIN;
+using tessellation::TESS_MIN_W;
+
+// patches spanning more tiles than this per axis are never culled by their rates
+static const int MAX_CULL_TILES = 8;
+
+static bool isRateDriven(const TessellationView& view, const TessellationSettings& settings)
+{
+    return settings.rateDriven && view.rates != nullptr;
+}
+
+static glm::vec4 clipPosition(const TessellationView& view, glm::vec2 uv)
+{
+    return view.modelViewProj * glm::vec4(tessTorusPosition(uv, view.radii), 1.0f);
+}
+
+static int fetchRate(const TessellationView& view, glm::ivec2 tile)
+{
+    return view.rates[size_t(tile.y) * view.rateWidth + tile.x];
+}
+
+static glm::ivec2 rateTile(const TessellationView& view, glm::vec2 pixel)
+{
+    return tessRateTile(pixel, glm::ivec2(view.texelWidth, view.texelHeight), glm::ivec2(view.rateWidth, view.rateHeight));
+}
+
+static float edgeFactor(const TessellationView& view, const TessellationSettings& settings, glm::vec2 uvA, glm::vec2 uvB,
+                        glm::vec4 a, glm::vec4 b)
+{
+    glm::vec4 m = clipPosition(view, (uvA + uvB) * 0.5f);
+    float pixels = tessEdgePixels(a, m, b, view.viewport);
+
+    float fragmentSize = 1.0f;
+    if (isRateDriven(view, settings) && m.w > TESS_MIN_W)
+    {
+        fragmentSize = tessFragmentSize(fetchRate(view, rateTile(view, tessScreenPosition(m, view.viewport))));
+    }
+    return tessEdgeFactor(pixels, fragmentSize, settings.targetEdgePixels, settings.maxFactor);
+}
+
+static bool isPatchCulled(const TessellationView& view, const TessellationSettings& settings, const glm::vec2* corners)
+{
+    int outcode = 0x3f;
+    bool inFront = true;
+    glm::vec2 minPixel(1e30f);
+    glm::vec2 maxPixel(-1e30f);
+    for (int y = 0; y <= 2; ++y)
+    {
+        for (int x = 0; x <= 2; ++x)
+        {
+            glm::vec2 t = glm::vec2(x, y) * 0.5f;
+            glm::vec2 uv = glm::mix(glm::mix(corners[0], corners[1], t.x), glm::mix(corners[3], corners[2], t.x), t.y);
+            glm::vec4 clip = clipPosition(view, uv);
+            outcode &= tessClipOutcode(clip, TESS_CULL_MARGIN);
+            inFront = inFront && clip.w > TESS_MIN_W;
+            if (clip.w > TESS_MIN_W)
+            {
+                glm::vec2 pixel = tessScreenPosition(clip, view.viewport);
+                minPixel = glm::min(minPixel, pixel);
+                maxPixel = glm::max(maxPixel, pixel);
+            }
+        }
+    }
+    if (outcode != 0)
+    {
+        return true;
+    }
+    if (!isRateDriven(view, settings) || !inFront)
+    {
+        return false;
+    }
+
+    glm::ivec2 minTile = glm::max(rateTile(view, minPixel) - 1, glm::ivec2(0));
+    glm::ivec2 maxTile = glm::min(rateTile(view, maxPixel) + 1, glm::ivec2(view.rateWidth, view.rateHeight) - 1);
+    if (maxTile.x - minTile.x > MAX_CULL_TILES - 1 || maxTile.y - minTile.y > MAX_CULL_TILES - 1)
+    {
+        return false;
+    }
+    for (int y = minTile.y; y <= maxTile.y; ++y)
+    {
+        for (int x = minTile.x; x <= maxTile.x; ++x)
+        {
+            if (fetchRate(view, glm::ivec2(x, y)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void generatePatchCorners(int ringPatches, int tubePatches, std::vector<glm::vec2>& corners)
+{
+    corners.clear();
+    corners.reserve(size_t(ringPatches) * tubePatches * 4);
+    for (int tube = 0; tube < tubePatches; ++tube)
+    {
+        float v0 = float(tube) / float(tubePatches);
+        float v1 = float(tube + 1) / float(tubePatches);
+        for (int ring = 0; ring < ringPatches; ++ring)
+        {
+            float u0 = float(ring) / float(ringPatches);
+            float u1 = float(ring + 1) / float(ringPatches);
+            corners.push_back(glm::vec2(u0, v0));
+            corners.push_back(glm::vec2(u1, v0));
+            corners.push_back(glm::vec2(u1, v1));
+            corners.push_back(glm::vec2(u0, v1));
+        }
+    }
+}
+
+PatchFactors computePatchFactors(const TessellationView& view, const TessellationSettings& settings, const glm::vec2* corners)
+{
+    PatchFactors factors;
+    if (isPatchCulled(view, settings, corners))
+    {
+        factors.culled = true;
+        return factors;
+    }
+
+    glm::vec4 c[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        c[i] = clipPosition(view, corners[i]);
+    }
+
+    factors.outer[0] = edgeFactor(view, settings, corners[0], corners[3], c[0], c[3]);
+    factors.outer[1] = edgeFactor(view, settings, corners[0], corners[1], c[0], c[1]);
+    factors.outer[2] = edgeFactor(view, settings, corners[1], corners[2], c[1], c[2]);
+    factors.outer[3] = edgeFactor(view, settings, corners[3], corners[2], c[3], c[2]);
+    factors.inner[0] = std::max(factors.outer[1], factors.outer[3]);
+    factors.inner[1] = std::max(factors.outer[0], factors.outer[2]);
+    return factors;
+}
+
+void computeTorusFactors(const TessellationView& view, const TessellationSettings& settings, std::vector<PatchFactors>& factors)
+{
+    std::vector<glm::vec2> corners;
+    generatePatchCorners(settings.ringPatches, settings.tubePatches, corners);
+
+    factors.resize(corners.size() / 4);
+    for (size_t i = 0; i < factors.size(); ++i)
+    {
+        factors[i] = computePatchFactors(view, settings, &corners[i * 4]);
+    }
+}
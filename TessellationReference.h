@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+//
+// CPU reference of the tessellation control shader of TessellatedTorus
+// (scene.tesc.glsl). The projection and factor functions are shared with
+// the shader through tessellation.h, the code here mirrors the rest of it:
+// the patch culling and which edge feeds which factor.
+//
+
+struct TessellationSettings
+{
+    int ringPatches = 16;           // coarse patches around the ring (u)
+    int tubePatches = 8;            // and around the tube (v)
+    float targetEdgePixels = 8.0f;  // projected length of a generated edge at full rate
+    float maxFactor = 32.0f;        // at most GL_MAX_TESS_GEN_LEVEL
+    bool rateDriven = true;         // the factors and the culling follow the shading rate image
+};
+
+// what the control shader sees of a frame and a torus
+struct TessellationView
+{
+    glm::mat4 modelViewProj = glm::mat4(1.0f);
+    glm::vec2 viewport = glm::vec2(1.0f);           // framebuffer pixels
+    glm::vec2 radii = glm::vec2(0.8f, 0.2f);        // inner, outer
+    // palette 0 entries, rateWidth * rateHeight with the bottom row first,
+    // nullptr for full rate everywhere
+    const uint8_t* rates = nullptr;
+    int rateWidth = 0;
+    int rateHeight = 0;
+    int texelWidth = 16;
+    int texelHeight = 16;
+};
+
+struct PatchFactors
+{
+    float outer[4] = {};    // edges u=0, v=0, u=1, v=1 as in gl_TessLevelOuter
+    float inner[2] = {};
+    bool culled = false;    // all outer factors are 0
+};
+
+// corners of all patches in the order the control shader gets them:
+// (u0,v0), (u1,v0), (u1,v1), (u0,v1), patches around the ring first
+void generatePatchCorners(int ringPatches, int tubePatches, std::vector<glm::vec2>& corners);
+
+// the factors of the patch with the given four corners
+PatchFactors computePatchFactors(const TessellationView& view, const TessellationSettings& settings, const glm::vec2* corners);
+
+// one entry per patch of generatePatchCorners()
+void computeTorusFactors(const TessellationView& view, const TessellationSettings& settings, std::vector<PatchFactors>& factors);
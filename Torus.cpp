@@ -17,8 +17,21 @@
 
 #include "Torus.h"
 
+#include "common.h"
+#include "UnifiedDraws.h"
+
+#include "nvgl/extensions_gl.hpp"
+
 #include <glm/glm.hpp>
-#include <vector>
+
+#include <cstring>
+
+static const GLbitfield STAGING_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+
+// offsets of storage buffer bindings need to be aligned, 256 covers all implementations
+static const GLsizeiptr MESHLET_SECTION_ALIGNMENT = 256;
+
+static const GLuint MESHLET_SECTION_BINDINGS[4] = { SSBO_MESHLETS, SSBO_MESHLET_BOUNDS, SSBO_MESHLET_VERTEX_INDICES, SSBO_MESHLET_PRIMITIVES };
 
 Torus::Torus()
 {
@@ -26,25 +39,43 @@ Torus::Torus()
 
 Torus::~Torus()
 {
-    nvgl::deleteBuffer(m_vbo);
-    nvgl::deleteBuffer(m_ibo);
+    if (m_uploadFence)
+    {
+        glDeleteSync(m_uploadFence);
+    }
+    for (BufferPair& buffers : m_buffers)
+    {
+        nvgl::deleteBuffer(buffers.vbo);
+        nvgl::deleteBuffer(buffers.ibo);
+        nvgl::deleteBuffer(buffers.meshletBuffer);
+    }
+    if (m_nearestSampler)
+    {
+        glDeleteSamplers(1, &m_nearestSampler);
+    }
+    if (m_stagingBuffer)
+    {
+        glUnmapNamedBuffer(m_stagingBuffer);
+        nvgl::deleteBuffer(m_stagingBuffer);
+    }
 }
 
 void Torus::setBufferState()
 {
-    if (!m_dataIsUploadedToGPU)
-    {
-        regenerateGeometry();
-    }
+    updateGeometry();
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    const BufferPair& buffers = m_buffers[m_current];
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.vbo);
     glVertexAttribPointer(m_vertexAttributePosition, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-    glVertexAttribPointer(m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (GLvoid*)(m_numVertices * 3 * sizeof(float)));
+    glVertexAttribPointer(m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (GLvoid*)(buffers.numVertices * 3 * sizeof(float)));
+    glVertexAttribPointer(m_vertexAttributeTexcoord, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (GLvoid*)(buffers.numVertices * 6 * sizeof(float)));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.ibo);
 
     glEnableVertexAttribArray(m_vertexAttributePosition);
     glEnableVertexAttribArray(m_vertexAttributeNormal);
+    glEnableVertexAttribArray(m_vertexAttributeTexcoord);
 }
 
 void Torus::unsetBufferState()
@@ -54,154 +85,275 @@ void Torus::unsetBufferState()
 
     glDisableVertexAttribArray(m_vertexAttributePosition);
     glDisableVertexAttribArray(m_vertexAttributeNormal);
+    glDisableVertexAttribArray(m_vertexAttributeTexcoord);
 }
 
 void Torus::draw()
 {
-    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, NV_BUFFER_OFFSET(0));
+    glDrawElements(GL_TRIANGLES, m_buffers[m_current].numIndices, GL_UNSIGNED_INT, NV_BUFFER_OFFSET(0));
 }
 
-void Torus::setTessellation(uint32_t n, uint32_t m, float innerRadius, float outerRadius)
+void Torus::setUnifiedBufferState()
 {
-    const uint32_t MIN_TES = 3;
-    if (n < MIN_TES) n = MIN_TES;
-    if (m < MIN_TES) m = MIN_TES;
-    if (innerRadius < 0.0f) innerRadius = 0.0f;
+    updateGeometry();
 
-    if (   n == m_tessellationN 
-        && m == m_tessellationM
-        && innerRadius == m_innerRadius
-        && outerRadius == m_outerRadius)
+    BufferPair& buffers = m_buffers[m_current];
+    if (!buffers.vboAddress)
     {
-        return;
+        buffers.vboAddress = UnifiedDraws::getResidentAddress(buffers.vbo);
+        buffers.iboAddress = UnifiedDraws::getResidentAddress(buffers.ibo);
     }
-    m_tessellationN = n;
-    m_tessellationM = m;
-    m_innerRadius = innerRadius;
-    m_outerRadius = outerRadius;
 
-    m_dataIsUploadedToGPU = false;
-}
+    // one vertex binding per attribute, the strides are set with null buffers
+    const GLuint attributes[3] = { m_vertexAttributePosition, m_vertexAttributeNormal, m_vertexAttributeTexcoord };
+    const GLint components[3] = { 3, 3, 2 };
+    const GLuint64 offsets[3] = { 0, GLuint64(buffers.numVertices) * 3 * sizeof(float), GLuint64(buffers.numVertices) * 6 * sizeof(float) };
+    for (int i = 0; i < 3; ++i)
+    {
+        glVertexAttribFormat(attributes[i], components[i], GL_FLOAT, GL_FALSE, 0);
+        glVertexAttribBinding(attributes[i], attributes[i]);
+        glBindVertexBuffer(attributes[i], 0, 0, components[i] * sizeof(float));
+        glEnableVertexAttribArray(attributes[i]);
+    }
 
-void Torus::setVertexAttributeLocations(GLuint position, GLuint normal)
-{
-    if (position == m_vertexAttributePosition && normal == m_vertexAttributeNormal)
+    glEnableClientState(GL_VERTEX_ATTRIB_ARRAY_UNIFIED_NV);
+    glEnableClientState(GL_ELEMENT_ARRAY_UNIFIED_NV);
+    for (int i = 0; i < 3; ++i)
     {
-        return;
+        glBufferAddressRangeNV(GL_VERTEX_ATTRIB_ARRAY_ADDRESS_NV, attributes[i], buffers.vboAddress + offsets[i],
+            GLsizeiptr(buffers.numVertices) * components[i] * sizeof(float));
     }
+    glBufferAddressRangeNV(GL_ELEMENT_ARRAY_ADDRESS_NV, 0, buffers.iboAddress, GLsizeiptr(buffers.numIndices) * sizeof(uint32_t));
+}
 
-    m_vertexAttributePosition = position;
-    m_vertexAttributeNormal = normal;
+void Torus::unsetUnifiedBufferState()
+{
+    glDisableClientState(GL_VERTEX_ATTRIB_ARRAY_UNIFIED_NV);
+    glDisableClientState(GL_ELEMENT_ARRAY_UNIFIED_NV);
 
-    m_dataIsUploadedToGPU = false;
+    glDisableVertexAttribArray(m_vertexAttributePosition);
+    glDisableVertexAttribArray(m_vertexAttributeNormal);
+    glDisableVertexAttribArray(m_vertexAttributeTexcoord);
 }
 
-void Torus::regenerateGeometry()
+void Torus::setMeshletBufferState()
 {
-    uint32_t n = m_tessellationN;
-    uint32_t m = m_tessellationM;
+    updateGeometry();
 
-    std::vector< glm::vec3 > vertices;
-    std::vector< glm::vec3 > tangents;
-    std::vector< glm::vec3 > binormals;
-    std::vector< glm::vec3 > normals;
-    std::vector< glm::vec2 > texcoords;
-    std::vector<unsigned int> indices;
+    // GL objects are created on first use, the torus is constructed before the context exists
+    if (!m_nearestSampler)
+    {
+        glCreateSamplers(1, &m_nearestSampler);
+        glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glSamplerParameteri(m_nearestSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
 
-    unsigned int size_v = (m + 1) * (n + 1);
+    const BufferPair& buffers = m_buffers[m_current];
 
-    vertices.reserve(size_v);
-    tangents.reserve(size_v);
-    binormals.reserve(size_v);
-    normals.reserve(size_v);
-    texcoords.reserve(size_v);
-    indices.reserve(6 * m * n);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_MESHLET_VERTEX_DATA, buffers.vbo, 0, buffers.numVertices * 8 * sizeof(float));
+    for (int i = 0; i < 4; ++i)
+    {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, MESHLET_SECTION_BINDINGS[i], buffers.meshletBuffer, buffers.meshletSections[i],
+            buffers.meshletSections[i + 1] - buffers.meshletSections[i]);
+    }
 
-    float mf = (float)m;
-    float nf = (float)n;
+    // uniforms of the bound scene program, see scene.task.glsl
+    glUniform2ui(MESHLET_INFO_LOC, GLuint(buffers.numMeshlets), GLuint(buffers.numVertices));
+    glUniform4f(MESHLET_CULL_LOC, m_viewport.x, m_viewport.y, float(m_texelWidth), float(m_texelHeight));
+    glUniform2i(MESHLET_FLAGS_LOC, m_rateImage ? 1 : 0, m_coneCulling ? 1 : 0);
 
-    float phi_step = 2.0f * glm::pi<float>() / mf;
-    float theta_step = 2.0f * glm::pi<float>() / nf;
+    glBindTextureUnit(TEX_MESHLET_RATE, m_rateImage);
+    glBindSampler(TEX_MESHLET_RATE, m_nearestSampler);
+}
 
-    // Setup vertices and normals
-    // Generate the Torus exactly like the sphere with rings around the origin along the latitudes.
-    for (unsigned int latitude = 0; latitude <= n; latitude++) // theta angle
+void Torus::unsetMeshletBufferState()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_MESHLET_VERTEX_DATA, 0);
+    for (GLuint binding : MESHLET_SECTION_BINDINGS)
     {
-        float theta = (float)latitude * theta_step;
-        float sinTheta = sinf(theta);
-        float cosTheta = cosf(theta);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    glBindTextureUnit(TEX_MESHLET_RATE, 0);
+    glBindSampler(TEX_MESHLET_RATE, 0);
+}
 
-        float radius = m_innerRadius + m_outerRadius * cosTheta;
+void Torus::drawMeshlets()
+{
+    // one task workgroup culls MESHLET_GROUP_SIZE meshlets
+    GLuint numTasks = GLuint((m_buffers[m_current].numMeshlets + MESHLET_GROUP_SIZE - 1) / MESHLET_GROUP_SIZE);
+    glDrawMeshTasksNV(0, numTasks);
+}
 
-        for (unsigned int longitude = 0; longitude <= m; longitude++) // phi angle
-        {
-            float phi = (float)longitude * phi_step;
-            float sinPhi = sinf(phi);
-            float cosPhi = cosf(phi);
+void Torus::setMeshletCulling(uint32_t width, uint32_t height, GLuint rateImage, GLint texelWidth, GLint texelHeight, bool coneCulling)
+{
+    m_viewport = glm::vec2(float(width), float(height));
+    m_rateImage = rateImage;
+    m_texelWidth = texelWidth;
+    m_texelHeight = texelHeight;
+    m_coneCulling = coneCulling;
+}
 
-            vertices.push_back(glm::vec3(radius * cosPhi,
-                m_outerRadius * sinTheta,
-                radius * -sinPhi));
+void Torus::setTessellation(uint32_t n, uint32_t m, float innerRadius, float outerRadius)
+{
+    const uint32_t MIN_TES = 3;
+    if (n < MIN_TES) n = MIN_TES;
+    if (m < MIN_TES) m = MIN_TES;
+    if (innerRadius < 0.0f) innerRadius = 0.0f;
+
+    TorusParams params;
+    params.n = n;
+    params.m = m;
+    params.innerRadius = innerRadius;
+    params.outerRadius = outerRadius;
 
-            tangents.push_back(glm::vec3(-sinPhi, 0.0f, -cosPhi));
+    if (params == m_params)
+    {
+        return;
+    }
+    m_params = params;
 
-            binormals.push_back(glm::vec3(cosPhi * -sinTheta,
-                cosTheta,
-                sinPhi * sinTheta));
+    // a cache hit skips the worker and gets uploaded in the next setBufferState()
+    std::shared_ptr<const TorusMesh> cached = m_generator.request(params);
+    if (cached)
+    {
+        m_nextMesh = cached;
+    }
+}
 
-            normals.push_back(glm::vec3(cosPhi * cosTheta,
-                sinTheta,
-                -sinPhi * cosTheta));
+void Torus::setVertexAttributeLocations(GLuint position, GLuint normal, GLuint texcoord)
+{
+    // the attribute pointers are set in every setBufferState()
+    m_vertexAttributePosition = position;
+    m_vertexAttributeNormal = normal;
+    m_vertexAttributeTexcoord = texcoord;
+}
 
-            texcoords.push_back(glm::vec2((float)longitude / mf, (float)latitude / nf));
+void Torus::updateGeometry()
+{
+    if (!m_hasMesh)
+    {
+        // Nothing to draw in the meantime, the very first mesh is made and
+        // copied synchronously. The next upload reuses the staging buffer,
+        // so the copy has to be done before the fence goes away.
+        std::shared_ptr<const TorusMesh> mesh = generateTorusMesh(m_params);
+        m_generator.getCache().insert(mesh);
+        upload(*mesh);
+        while (glClientWaitSync(m_uploadFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+        {
         }
+        glDeleteSync(m_uploadFence);
+        m_uploadFence = nullptr;
+        m_current ^= 1;
+        m_hasMesh = true;
+        return;
     }
 
-    const unsigned int columns = m + 1;
-
-    // Setup indices
-    for (unsigned int latitude = 0; latitude < n; latitude++)
+    // swap in the back buffers once the GPU has finished copying into them
+    if (m_uploadFence)
     {
-        for (unsigned int longitude = 0; longitude < m; longitude++)
+        if (glClientWaitSync(m_uploadFence, 0, 0) == GL_TIMEOUT_EXPIRED)
         {
-            // two triangles
-            indices.push_back(latitude * columns + longitude);  // lower left
-            indices.push_back(latitude * columns + longitude + 1);  // lower right
-            indices.push_back((latitude + 1) * columns + longitude);  // upper left
-
-            indices.push_back((latitude + 1) * columns + longitude);  // upper left
-            indices.push_back(latitude * columns + longitude + 1);  // lower right
-            indices.push_back((latitude + 1) * columns + longitude + 1);  // upper right
+            return;
         }
+        glDeleteSync(m_uploadFence);
+        m_uploadFence = nullptr;
+        m_current ^= 1;
+    }
+
+    std::shared_ptr<const TorusMesh> finished = m_generator.poll();
+    if (finished && finished->params == m_params)
+    {
+        m_nextMesh = finished;
     }
 
-    m_numVertices = static_cast<GLsizei>(vertices.size());
-    GLsizeiptr const sizePositionAttributeData = vertices.size() * sizeof(vertices[0]);
-    GLsizeiptr const sizeNormalAttributeData = normals.size() * sizeof(normals[0]);
+    // the staging buffer and the back buffers are free again
+    if (m_nextMesh)
+    {
+        upload(*m_nextMesh);
+        m_nextMesh = nullptr;
+    }
+}
 
-    m_numIndices = static_cast<GLsizei>(indices.size());
-    GLsizeiptr sizeIndexData = indices.size() * sizeof(indices[0]);
+void Torus::reserve(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr size, GLbitfield flags)
+{
+    if (buffer && size <= capacity)
+    {
+        return;
+    }
 
-    nvgl::newBuffer(m_vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizePositionAttributeData + sizeNormalAttributeData, nullptr, GL_STATIC_DRAW);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizePositionAttributeData, &vertices[0]);
-    glBufferSubData(GL_ARRAY_BUFFER, sizePositionAttributeData, sizeNormalAttributeData, &normals[0]);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // grow in powers of two, so sliding through the tessellations only reallocates a few times
+    GLsizeiptr newCapacity = 4096;
+    while (newCapacity < size)
+    {
+        newCapacity *= 2;
+    }
 
-    nvgl::newBuffer(m_ibo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeIndexData, &indices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    nvgl::deleteBuffer(buffer);
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, newCapacity, nullptr, flags);
+    capacity = newCapacity;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glVertexAttribPointer(m_vertexAttributePosition, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-    glVertexAttribPointer(m_vertexAttributeNormal, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (GLvoid*)(sizePositionAttributeData));
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+void Torus::upload(const TorusMesh& mesh)
+{
+    GLsizeiptr const sizePositionAttributeData = mesh.positions.size() * sizeof(mesh.positions[0]);
+    GLsizeiptr const sizeNormalAttributeData = mesh.normals.size() * sizeof(mesh.normals[0]);
+    GLsizeiptr const sizeTexcoordAttributeData = mesh.texcoords.size() * sizeof(mesh.texcoords[0]);
+    GLsizeiptr const sizeVertexData = sizePositionAttributeData + sizeNormalAttributeData + sizeTexcoordAttributeData;
+    GLsizeiptr const sizeIndexData = mesh.indices.size() * sizeof(mesh.indices[0]);
+
+    // the meshlet sections are laid out in the staging buffer just like in the meshlet buffer
+    const MeshletMesh& meshlets = mesh.meshlets;
+    GLsizeiptr const sizeMeshletSections[4] = {
+        GLsizeiptr(meshlets.meshlets.size() * sizeof(meshlets.meshlets[0])),
+        GLsizeiptr(meshlets.bounds.size() * sizeof(meshlets.bounds[0])),
+        GLsizeiptr(meshlets.vertexIndices.size() * sizeof(meshlets.vertexIndices[0])),
+        GLsizeiptr(meshlets.primitiveIndices.size()) };
+    const void* meshletSectionData[4] = { meshlets.meshlets.data(), meshlets.bounds.data(), meshlets.vertexIndices.data(),
+                                          meshlets.primitiveIndices.data() };
+    GLintptr meshletSections[5] = {};
+    for (int i = 0; i < 4; ++i)
+    {
+        meshletSections[i + 1] = meshletSections[i] + ((sizeMeshletSections[i] + MESHLET_SECTION_ALIGNMENT - 1) & ~(MESHLET_SECTION_ALIGNMENT - 1));
+    }
+    GLsizeiptr const sizeMeshletData = meshletSections[4];
+    GLsizeiptr const sizeStagingData = sizeVertexData + sizeIndexData + sizeMeshletData;
 
-    glEnableVertexAttribArray(m_vertexAttributePosition);
-    glEnableVertexAttribArray(m_vertexAttributeNormal);
+    if (!m_stagingBuffer || sizeStagingData > m_stagingCapacity)
+    {
+        if (m_stagingBuffer)
+        {
+            glUnmapNamedBuffer(m_stagingBuffer);
+        }
+        reserve(m_stagingBuffer, m_stagingCapacity, sizeStagingData, STAGING_FLAGS);
+        m_stagingPointer = static_cast<uint8_t*>(glMapNamedBufferRange(m_stagingBuffer, 0, m_stagingCapacity, STAGING_FLAGS | GL_MAP_FLUSH_EXPLICIT_BIT));
+    }
 
-    m_dataIsUploadedToGPU = true;
+    memcpy(m_stagingPointer, mesh.positions.data(), sizePositionAttributeData);
+    memcpy(m_stagingPointer + sizePositionAttributeData, mesh.normals.data(), sizeNormalAttributeData);
+    memcpy(m_stagingPointer + sizePositionAttributeData + sizeNormalAttributeData, mesh.texcoords.data(), sizeTexcoordAttributeData);
+    memcpy(m_stagingPointer + sizeVertexData, mesh.indices.data(), sizeIndexData);
+    for (int i = 0; i < 4; ++i)
+    {
+        memcpy(m_stagingPointer + sizeVertexData + sizeIndexData + meshletSections[i], meshletSectionData[i], sizeMeshletSections[i]);
+    }
+    glFlushMappedNamedBufferRange(m_stagingBuffer, 0, sizeStagingData);
+
+    BufferPair& back = m_buffers[m_current ^ 1];
+    reserve(back.vbo, back.vboCapacity, sizeVertexData, 0);
+    reserve(back.ibo, back.iboCapacity, sizeIndexData, 0);
+    reserve(back.meshletBuffer, back.meshletCapacity, sizeMeshletData, 0);
+    back.numVertices = static_cast<GLsizei>(mesh.positions.size());
+    back.numIndices = static_cast<GLsizei>(mesh.indices.size());
+    back.numMeshlets = static_cast<GLsizei>(meshlets.meshlets.size());
+    // the buffers may have been recreated
+    back.vboAddress = 0;
+    back.iboAddress = 0;
+    memcpy(back.meshletSections, meshletSections, sizeof(meshletSections));
+
+    glCopyNamedBufferSubData(m_stagingBuffer, back.vbo, 0, 0, sizeVertexData);
+    glCopyNamedBufferSubData(m_stagingBuffer, back.ibo, sizeVertexData, 0, sizeIndexData);
+    glCopyNamedBufferSubData(m_stagingBuffer, back.meshletBuffer, sizeVertexData + sizeIndexData, 0, sizeMeshletData);
+
+    m_uploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 }
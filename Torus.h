@@ -17,12 +17,25 @@
 
 #pragma once
 
-#include "nvh/geometry.hpp"
 #include <glm/glm.hpp>
 #include "nvgl/base_gl.hpp"
 
-#include <cstdint>
+#include "TorusGeometry.h"
 
+#include <cstdint>
+#include <memory>
+
+//
+// Changing the tessellation does not stall the frame: the new mesh is
+// generated on a worker thread (or taken from a cache of recent meshes),
+// copied through a persistently mapped staging buffer into the back one of
+// two buffer pairs, and swapped in once a fence says the copy is done. Until
+// then the previous mesh keeps being drawn.
+//
+// The meshlets of the mesh (see MeshletBuilder) are uploaded along with it
+// for the task and mesh shader path of the scene program, which culls them
+// per meshlet instead of drawing the index buffer.
+//
 class Torus
 {
 public:
@@ -39,43 +52,86 @@ public:
     // just the draw calls, use this 
     void draw();
 
+    // the same with GL_NV_vertex_buffer_unified_memory, the attributes and
+    // indices are read by GPU address (see UnifiedDraws); draw() stays the same
+    void setUnifiedBufferState();
+    void unsetUnifiedBufferState();
+
+    // the same for the meshlet path, the scene program has to be a meshShader
+    // permutation, its culling uniforms are set here
+    void setMeshletBufferState();
+    void unsetMeshletBufferState();
+    void drawMeshlets();
+
+    // the framebuffer the tori are rendered to and its shading rate image, 0 for
+    // no culling by rate; cone culling has to be off when back faces are visible
+    void setMeshletCulling(uint32_t width, uint32_t height, GLuint rateImage, GLint texelWidth, GLint texelHeight, bool coneCulling);
+
     // values for n,m below 3 will be set to 3.
     void setTessellation(uint32_t n, uint32_t m, float innerRadius = 0.8f, float outerRadius = 0.2f);
 
-    uint32_t getTessellationN() { return m_tessellationN; }
-    uint32_t getTessellationM() { return m_tessellationM; }
+    // the requested tessellation, the drawn mesh may still lag behind
+    uint32_t getTessellationN() { return m_params.n; }
+    uint32_t getTessellationM() { return m_params.m; }
 
-    void setVertexAttributeLocations(GLuint position, GLuint normal);
+    void setVertexAttributeLocations(GLuint position, GLuint normal, GLuint texcoord);
 
-    GLsizei getTriangleCount() { return m_numIndices / 3; }
+    GLsizei getTriangleCount() { return m_buffers[m_current].numIndices / 3; }
+    // of any tessellation of the requested radii, the ring lies in the xz plane
+    void getBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const
+    {
+        float ring = m_params.innerRadius + m_params.outerRadius;
+        boundsMin = glm::vec3(-ring, -m_params.outerRadius, -ring);
+        boundsMax = glm::vec3(ring, m_params.outerRadius, ring);
+    }
+    GLsizei getMeshletCount() { return m_buffers[m_current].numMeshlets; }
 
 private:
-    void regenerateGeometry();
-
-    uint32_t m_tessellationN = 8;
-    uint32_t m_tessellationM = 8;
-    float m_innerRadius = 0.8f;
-    float m_outerRadius = 0.2f;
-
-    struct Vertex {
-        Vertex(const nvh::geometry::Vertex& vertex) {
-            position = vertex.position;
-            normal = vertex.normal;
-            color = glm::vec4(1.0f);
-        }
-
-        glm::vec4 position;
-        glm::vec4 normal;
-        glm::vec4 color;
+    struct BufferPair
+    {
+        GLuint vbo = 0;
+        GLuint ibo = 0;
+        GLsizeiptr vboCapacity = 0;
+        GLsizeiptr iboCapacity = 0;
+        GLsizei numVertices = 0;
+        GLsizei numIndices = 0;
+        GLuint64 vboAddress = 0;            // once resident, reset by upload()
+        GLuint64 iboAddress = 0;
+
+        // meshlets, bounds, vertex indices and primitive indices, each section starts aligned
+        GLuint meshletBuffer = 0;
+        GLsizeiptr meshletCapacity = 0;
+        GLintptr meshletSections[5] = {};   // the last one is the end
+        GLsizei numMeshlets = 0;
     };
 
-    GLsizei m_numVertices = 0;
-    GLsizei m_numIndices = 0;
+    void updateGeometry();
+    void upload(const TorusMesh& mesh);
+    static void reserve(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr size, GLbitfield flags);
+
+    TorusParams m_params;
+
+    TorusMeshGenerator m_generator;
+    std::shared_ptr<const TorusMesh> m_nextMesh;    // waits for the staging buffer
+
+    BufferPair m_buffers[2];
+    uint32_t m_current = 0;
+    bool m_hasMesh = false;
+    GLsync m_uploadFence = nullptr;                 // copy into the back buffers is done
+
+    GLuint m_stagingBuffer = 0;
+    GLsizeiptr m_stagingCapacity = 0;
+    uint8_t* m_stagingPointer = nullptr;
 
-    bool    m_dataIsUploadedToGPU = false;
-    GLuint  m_vbo = 0;
-    GLuint  m_ibo = 0;
+    glm::vec2 m_viewport = glm::vec2(1.0f);
+    GLuint m_rateImage = 0;
+    // the rate images are integer textures, which are incomplete with the default linear filters
+    GLuint m_nearestSampler = 0;
+    GLint m_texelWidth = 16;
+    GLint m_texelHeight = 16;
+    bool m_coneCulling = true;
 
     GLuint  m_vertexAttributePosition = 0;
     GLuint  m_vertexAttributeNormal = 1;
+    GLuint  m_vertexAttributeTexcoord = 3;
 };
@@ -0,0 +1,219 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TorusGeometry.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+std::shared_ptr<const TorusMesh> generateTorusMesh(const TorusParams& params)
+{
+    auto mesh = std::make_shared<TorusMesh>();
+    mesh->params = params;
+
+    uint32_t n = params.n;
+    uint32_t m = params.m;
+
+    unsigned int size_v = (m + 1) * (n + 1);
+
+    mesh->positions.reserve(size_v);
+    mesh->normals.reserve(size_v);
+    mesh->texcoords.reserve(size_v);
+    mesh->indices.reserve(6 * m * n);
+
+    float mf = (float)m;
+    float nf = (float)n;
+
+    float phi_step = 2.0f * glm::pi<float>() / mf;
+    float theta_step = 2.0f * glm::pi<float>() / nf;
+
+    // Setup vertices and normals
+    // Generate the Torus exactly like the sphere with rings around the origin along the latitudes.
+    for (unsigned int latitude = 0; latitude <= n; latitude++) // theta angle
+    {
+        float theta = (float)latitude * theta_step;
+        float sinTheta = sinf(theta);
+        float cosTheta = cosf(theta);
+
+        float radius = params.innerRadius + params.outerRadius * cosTheta;
+
+        for (unsigned int longitude = 0; longitude <= m; longitude++) // phi angle
+        {
+            float phi = (float)longitude * phi_step;
+            float sinPhi = sinf(phi);
+            float cosPhi = cosf(phi);
+
+            mesh->positions.push_back(glm::vec3(radius * cosPhi,
+                params.outerRadius * sinTheta,
+                radius * -sinPhi));
+
+            mesh->normals.push_back(glm::vec3(cosPhi * cosTheta,
+                sinTheta,
+                -sinPhi * cosTheta));
+
+            // the seam vertices at longitude m and latitude n get 1.0, so the texture wraps around once
+            mesh->texcoords.push_back(glm::vec2((float)longitude / mf, (float)latitude / nf));
+        }
+    }
+
+    const unsigned int columns = m + 1;
+
+    // Setup indices
+    for (unsigned int latitude = 0; latitude < n; latitude++)
+    {
+        for (unsigned int longitude = 0; longitude < m; longitude++)
+        {
+            // two triangles
+            mesh->indices.push_back(latitude * columns + longitude);  // lower left
+            mesh->indices.push_back(latitude * columns + longitude + 1);  // lower right
+            mesh->indices.push_back((latitude + 1) * columns + longitude);  // upper left
+
+            mesh->indices.push_back((latitude + 1) * columns + longitude);  // upper left
+            mesh->indices.push_back(latitude * columns + longitude + 1);  // lower right
+            mesh->indices.push_back((latitude + 1) * columns + longitude + 1);  // upper right
+        }
+    }
+
+    // on the worker thread as well, the mesh shader path draws these
+    buildMeshlets(&mesh->positions[0].x, sizeof(glm::vec3), mesh->positions.size(), mesh->indices.data(),
+                  mesh->indices.size(), MeshletLimits(), mesh->meshlets);
+
+    return mesh;
+}
+
+//////////// TorusMeshCache ////////////
+
+std::shared_ptr<const TorusMesh> TorusMeshCache::find(const TorusParams& params)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if ((*it)->params == params)
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return m_entries.front();
+        }
+    }
+    return nullptr;
+}
+
+void TorusMeshCache::insert(const std::shared_ptr<const TorusMesh>& mesh)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+    if (find(mesh->params))
+    {
+        m_entries.front() = mesh;
+        return;
+    }
+    if (m_entries.size() == m_capacity)
+    {
+        m_entries.pop_back();
+    }
+    m_entries.push_front(mesh);
+}
+
+//////////// TorusMeshGenerator ////////////
+
+TorusMeshGenerator::TorusMeshGenerator(size_t cacheCapacity)
+    : m_cache(cacheCapacity)
+{
+    m_thread = std::thread(&TorusMeshGenerator::threadMain, this);
+}
+
+TorusMeshGenerator::~TorusMeshGenerator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+}
+
+std::shared_ptr<const TorusMesh> TorusMeshGenerator::request(const TorusParams& params)
+{
+    std::shared_ptr<const TorusMesh> cached = m_cache.find(params);
+    if (cached)
+    {
+        return cached;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = params;
+        m_hasPending = true;
+    }
+    m_condition.notify_one();
+    return nullptr;
+}
+
+std::shared_ptr<const TorusMesh> TorusMeshGenerator::poll()
+{
+    std::vector<std::shared_ptr<const TorusMesh>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished.empty())
+        {
+            return nullptr;
+        }
+        std::swap(finished, m_finished);
+    }
+
+    // older results are still worth caching, only the latest is returned
+    for (const auto& mesh : finished)
+    {
+        m_cache.insert(mesh);
+    }
+    return finished.back();
+}
+
+void TorusMeshGenerator::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this] { return !m_hasPending && !m_busy; });
+}
+
+void TorusMeshGenerator::threadMain()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_condition.wait(lock, [this] { return m_stop || m_hasPending; });
+        if (m_stop)
+        {
+            return;
+        }
+
+        TorusParams params = m_pending;
+        m_hasPending = false;
+        m_busy = true;
+
+        lock.unlock();
+        std::shared_ptr<const TorusMesh> mesh = generateTorusMesh(params);
+        lock.lock();
+
+        m_finished.push_back(mesh);
+        m_busy = false;
+        if (!m_hasPending)
+        {
+            m_idleCondition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "MeshletBuilder.h"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// CPU side of Torus: mesh generation, a small cache of recently used meshes
+// and a worker thread, so that changing the tessellation never generates
+// geometry inside a frame. Nothing in here touches OpenGL.
+//
+
+struct TorusParams
+{
+    uint32_t n = 8;
+    uint32_t m = 8;
+    float innerRadius = 0.8f;
+    float outerRadius = 0.2f;
+
+    bool operator==(const TorusParams& other) const
+    {
+        return n == other.n && m == other.m && innerRadius == other.innerRadius && outerRadius == other.outerRadius;
+    }
+    bool operator!=(const TorusParams& other) const { return !(*this == other); }
+};
+
+struct TorusMesh
+{
+    TorusParams params;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;   // same count as positions
+    std::vector<glm::vec2> texcoords; // same count as positions, u along phi and v along theta, both 0..1
+    std::vector<uint32_t> indices;
+    MeshletMesh meshlets;               // of the same vertices and indices
+};
+
+std::shared_ptr<const TorusMesh> generateTorusMesh(const TorusParams& params);
+
+// least recently used meshes, by params
+class TorusMeshCache
+{
+public:
+    explicit TorusMeshCache(size_t capacity = 8) : m_capacity(capacity) {}
+
+    // returns nullptr if params is not cached, a hit becomes the most recently used entry
+    std::shared_ptr<const TorusMesh> find(const TorusParams& params);
+    // evicts the least recently used entry when full
+    void insert(const std::shared_ptr<const TorusMesh>& mesh);
+
+    size_t size() const { return m_entries.size(); }
+    size_t capacity() const { return m_capacity; }
+
+private:
+    size_t m_capacity;
+    std::list<std::shared_ptr<const TorusMesh>> m_entries;  // most recently used first
+};
+
+//
+// Generates meshes on a worker thread. Only the latest request matters: a
+// request replaces one that has not been started yet, so dragging a slider
+// does not queue up work.
+//
+class TorusMeshGenerator
+{
+public:
+    explicit TorusMeshGenerator(size_t cacheCapacity = 8);
+    ~TorusMeshGenerator();
+
+    TorusMeshGenerator(const TorusMeshGenerator&) = delete;
+    TorusMeshGenerator& operator=(const TorusMeshGenerator&) = delete;
+
+    // returns the cached mesh right away, otherwise starts generating it and returns nullptr
+    std::shared_ptr<const TorusMesh> request(const TorusParams& params);
+
+    // returns a finished mesh (which is also added to the cache), or nullptr if none is ready
+    std::shared_ptr<const TorusMesh> poll();
+
+    // blocks until the worker is idle
+    void waitIdle();
+
+    TorusMeshCache& getCache() { return m_cache; }
+
+private:
+    void threadMain();
+
+    TorusMeshCache m_cache;  // only used by the calling thread
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_idleCondition;
+    TorusParams m_pending;
+    bool m_hasPending = false;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::vector<std::shared_ptr<const TorusMesh>> m_finished;
+};
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UnifiedDraws.h"
+
+#include "nvgl/extensions_gl.hpp"
+
+#include <cstring>
+
+GLuint64 UnifiedDraws::getResidentAddress(GLuint buffer)
+{
+    if (!glIsNamedBufferResidentNV(buffer))
+    {
+        glMakeNamedBufferResidentNV(buffer, GL_READ_ONLY);
+    }
+    GLuint64 address = 0;
+    glGetNamedBufferParameterui64vNV(buffer, GL_BUFFER_GPU_ADDRESS_NV, &address);
+    return address;
+}
+
+UnifiedDraws::~UnifiedDraws()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+        }
+    }
+    if (m_buffer)
+    {
+        glUnmapNamedBuffer(m_buffer);
+        nvgl::deleteBuffer(m_buffer);
+    }
+}
+
+bool UnifiedDraws::isSupported()
+{
+    return has_GL_NV_vertex_buffer_unified_memory && has_GL_NV_uniform_buffer_unified_memory && has_GL_NV_shader_buffer_load;
+}
+
+void UnifiedDraws::begin(GLuint sceneBuffer, GLuint sceneBinding, GLsizeiptr sceneSize, GLuint objectBinding,
+                         GLsizeiptr objectSize, uint32_t drawCount)
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    m_objectBinding = objectBinding;
+    m_objectSize = objectSize;
+    m_objectStride = (objectSize + alignment - 1) / alignment * alignment;
+    m_drawCount = drawCount;
+    reserve(m_objectStride * GLsizeiptr(drawCount));
+
+    int slot = m_frame % RING_SIZE;
+    waitForSlot(slot);
+    m_slotPointer = m_pointer + slot * m_slotSize;
+    m_slotAddress = m_address + GLuint64(slot * m_slotSize);
+
+    // the pipeline keeps its scene buffer, a recreated one has a new name
+    if (sceneBuffer != m_residentSceneBuffer || !glIsNamedBufferResidentNV(sceneBuffer))
+    {
+        m_sceneAddress = getResidentAddress(sceneBuffer);
+        m_residentSceneBuffer = sceneBuffer;
+    }
+
+    glEnableClientState(GL_UNIFORM_BUFFER_UNIFIED_NV);
+    glBufferAddressRangeNV(GL_UNIFORM_BUFFER_ADDRESS_NV, sceneBinding, m_sceneAddress, sceneSize);
+}
+
+void UnifiedDraws::setObject(uint32_t drawIndex, const void* data)
+{
+    if (drawIndex >= m_drawCount)
+    {
+        return;
+    }
+    GLsizeiptr offset = GLsizeiptr(drawIndex) * m_objectStride;
+    memcpy(m_slotPointer + offset, data, m_objectSize);
+    glBufferAddressRangeNV(GL_UNIFORM_BUFFER_ADDRESS_NV, m_objectBinding, m_slotAddress + GLuint64(offset), m_objectSize);
+}
+
+void UnifiedDraws::end()
+{
+    glDisableClientState(GL_UNIFORM_BUFFER_UNIFIED_NV);
+
+    int slot = m_frame % RING_SIZE;
+    m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++m_frame;
+}
+
+void UnifiedDraws::reserve(GLsizeiptr slotSize)
+{
+    if (m_buffer && slotSize <= m_slotSize)
+    {
+        return;
+    }
+
+    // the GPU may still read any slot of the old buffer
+    for (int slot = 0; slot < RING_SIZE; ++slot)
+    {
+        waitForSlot(slot);
+    }
+    if (m_buffer)
+    {
+        glUnmapNamedBuffer(m_buffer);
+        nvgl::deleteBuffer(m_buffer);
+    }
+
+    // grow in powers of two like Torus, so raising the draw count only reallocates a few times
+    GLsizeiptr newSlotSize = 64 * 1024;
+    while (newSlotSize < slotSize)
+    {
+        newSlotSize *= 2;
+    }
+
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, RING_SIZE * newSlotSize, nullptr, MAP_FLAGS);
+    m_pointer = static_cast<uint8_t*>(glMapNamedBufferRange(m_buffer, 0, RING_SIZE * newSlotSize, MAP_FLAGS));
+    m_address = getResidentAddress(m_buffer);
+    m_slotSize = newSlotSize;
+}
+
+void UnifiedDraws::waitForSlot(int slot)
+{
+    if (!m_fences[slot])
+    {
+        return;
+    }
+    while (glClientWaitSync(m_fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+    glDeleteSync(m_fences[slot]);
+    m_fences[slot] = nullptr;
+}
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/base_gl.hpp"
+
+#include <cstdint>
+
+//
+// Per-draw uniform buffers by GPU address (GL_NV_uniform_buffer_unified_memory)
+// instead of a glNamedBufferSubData() and glBindBufferBase() per draw. The
+// object data of all draws of a frame is written into one slot of a small
+// ring of persistently mapped buffers guarded by fences, and each draw only
+// points the object binding at its entry. While active, every uniform
+// buffer binding is read by address, so the scene buffer is set that way
+// too. Torus::setUnifiedBufferState() does the same for the vertex and
+// index buffers.
+//
+class UnifiedDraws
+{
+public:
+    UnifiedDraws() = default;
+    ~UnifiedDraws();
+
+    UnifiedDraws(const UnifiedDraws&) = delete;
+    UnifiedDraws& operator=(const UnifiedDraws&) = delete;
+
+    // both unified memory extensions, and GL_NV_shader_buffer_load for the buffer addresses
+    static bool isSupported();
+
+    // makes buffer resident if it is not yet, and returns its address
+    static GLuint64 getResidentAddress(GLuint buffer);
+
+    // enables the unified uniform buffers, sets the scene buffer and makes room for drawCount objects
+    void begin(GLuint sceneBuffer, GLuint sceneBinding, GLsizeiptr sceneSize, GLuint objectBinding, GLsizeiptr objectSize,
+               uint32_t drawCount);
+
+    // copies the object data of a draw and points the object binding at it
+    void setObject(uint32_t drawIndex, const void* data);
+
+    // back to bound uniform buffers
+    void end();
+
+private:
+    static const int RING_SIZE = 3;
+    static const GLbitfield MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    void reserve(GLsizeiptr slotSize);
+    void waitForSlot(int slot);
+
+    GLuint m_buffer = 0;
+    GLuint64 m_address = 0;
+    uint8_t* m_pointer = nullptr;
+    GLsizeiptr m_slotSize = 0;
+    GLsync m_fences[RING_SIZE] = {};
+    int m_frame = 0;
+
+    GLuint m_residentSceneBuffer = 0;
+    GLuint64 m_sceneAddress = 0;
+
+    // of the current begin() ... end()
+    GLuint m_objectBinding = 0;
+    GLsizeiptr m_objectSize = 0;
+    GLsizeiptr m_objectStride = 0;
+    uint32_t m_drawCount = 0;
+    uint8_t* m_slotPointer = nullptr;
+    GLuint64 m_slotAddress = 0;
+};
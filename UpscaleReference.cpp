@@ -0,0 +1,270 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UpscaleReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UPSCALE_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define UPSCALE_USE_SSE2 0
+#endif
+
+const char* UPSCALE_FILTER_NAMES[UPSCALE_FILTER_COUNT] = { "Nearest (blit)", "Bilinear", "Lanczos-2", "Edge-adaptive" };
+
+//
+// One RGBA pixel in the 0..255 range, four lanes wide.
+//
+#if UPSCALE_USE_SSE2
+struct Pixel
+{
+    __m128 v;
+};
+
+static inline Pixel loadPixel(const uint8_t* rgba)
+{
+    int packed;
+    memcpy(&packed, rgba, sizeof(packed));
+    __m128i zero = _mm_setzero_si128();
+    __m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+    return { _mm_cvtepi32_ps(p) };
+}
+
+static inline void storePixel(uint8_t* rgba, Pixel p)
+{
+    __m128 clamped = _mm_min_ps(_mm_max_ps(p.v, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+    __m128i i = _mm_cvtps_epi32(clamped);
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    int packed = _mm_cvtsi128_si32(i);
+    memcpy(rgba, &packed, sizeof(packed));
+}
+
+static inline Pixel zeroPixel() { return { _mm_setzero_ps() }; }
+static inline Pixel splatPixel(float s) { return { _mm_set1_ps(s) }; }
+static inline Pixel operator+(Pixel a, Pixel b) { return { _mm_add_ps(a.v, b.v) }; }
+static inline Pixel operator-(Pixel a, Pixel b) { return { _mm_sub_ps(a.v, b.v) }; }
+static inline Pixel operator*(Pixel a, float s) { return { _mm_mul_ps(a.v, _mm_set1_ps(s)) }; }
+static inline Pixel minPixel(Pixel a, Pixel b) { return { _mm_min_ps(a.v, b.v) }; }
+static inline Pixel maxPixel(Pixel a, Pixel b) { return { _mm_max_ps(a.v, b.v) }; }
+static inline float lumaPixel(Pixel a)
+{
+    alignas(16) float c[4];
+    _mm_store_ps(c, a.v);
+    return (c[0] * 0.299f + c[1] * 0.587f + c[2] * 0.114f) * (1.0f / 255.0f);
+}
+#else
+struct Pixel
+{
+    float v[4];
+};
+
+static inline Pixel loadPixel(const uint8_t* rgba)
+{
+    return { { float(rgba[0]), float(rgba[1]), float(rgba[2]), float(rgba[3]) } };
+}
+
+static inline void storePixel(uint8_t* rgba, Pixel p)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        rgba[c] = uint8_t(std::nearbyint(std::min(std::max(p.v[c], 0.0f), 255.0f)));
+    }
+}
+
+static inline Pixel zeroPixel() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+static inline Pixel splatPixel(float s) { return { { s, s, s, s } }; }
+static inline Pixel operator+(Pixel a, Pixel b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+static inline Pixel operator-(Pixel a, Pixel b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+static inline Pixel operator*(Pixel a, float s) { return { { a.v[0] * s, a.v[1] * s, a.v[2] * s, a.v[3] * s } }; }
+static inline Pixel minPixel(Pixel a, Pixel b) { return { { std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) } }; }
+static inline Pixel maxPixel(Pixel a, Pixel b) { return { { std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]) } }; }
+static inline float lumaPixel(Pixel a)
+{
+    return (a.v[0] * 0.299f + a.v[1] * 0.587f + a.v[2] * 0.114f) * (1.0f / 255.0f);
+}
+#endif
+
+static inline Pixel mixPixel(Pixel a, Pixel b, float t)
+{
+    return a + (b - a) * t;
+}
+
+static inline Pixel clampPixel(Pixel p, Pixel lo, Pixel hi)
+{
+    return minPixel(maxPixel(p, lo), hi);
+}
+
+static float lanczos2(float x)
+{
+    x = std::abs(x);
+    if (x < 1e-5f)
+    {
+        return 1.0f;
+    }
+    if (x >= 2.0f)
+    {
+        return 0.0f;
+    }
+    float px = 3.14159265358979f * x;
+    return 2.0f * std::sin(px) * std::sin(px * 0.5f) / (px * px);
+}
+
+//
+// Source taps of one output row or column. Weights only depend on the
+// output coordinate along one axis, so they are computed once per row
+// and once per column instead of once per pixel.
+//
+struct Taps
+{
+    int index[4];   // clamped source coordinates base-1 .. base+2
+    float fraction; // bilinear weight between index[1] and index[2]
+    float lanczos[4];
+};
+
+static std::vector<Taps> computeTaps(int srcSize, int dstSize)
+{
+    std::vector<Taps> taps(dstSize);
+    float scale = float(srcSize) / float(dstSize);
+
+    for (int i = 0; i < dstSize; ++i)
+    {
+        float src = (float(i) + 0.5f) * scale - 0.5f;
+        float fl = std::floor(src);
+        int base = int(fl);
+        float f = src - fl;
+
+        Taps& t = taps[i];
+        t.fraction = f;
+        float sum = 0.0f;
+        for (int k = 0; k < 4; ++k)
+        {
+            t.index[k] = std::min(std::max(base + k - 1, 0), srcSize - 1);
+            t.lanczos[k] = lanczos2(f + 1.0f - float(k));
+            sum += t.lanczos[k];
+        }
+        for (int k = 0; k < 4; ++k)
+        {
+            t.lanczos[k] /= sum;
+        }
+    }
+    return taps;
+}
+
+static inline Pixel fetch(const uint8_t* src, int srcWidth, int x, int y)
+{
+    return loadPixel(src + (size_t(x) + size_t(y) * srcWidth) * 4);
+}
+
+static inline Pixel filterLanczos(const uint8_t* src, int srcWidth, const Taps& tx, const Taps& ty)
+{
+    Pixel result = zeroPixel();
+    for (int y = 0; y < 4; ++y)
+    {
+        Pixel row = zeroPixel();
+        for (int x = 0; x < 4; ++x)
+        {
+            row = row + fetch(src, srcWidth, tx.index[x], ty.index[y]) * tx.lanczos[x];
+        }
+        result = result + row * ty.lanczos[y];
+    }
+    return clampPixel(result, zeroPixel(), splatPixel(255.0f));
+}
+
+void upscaleImage(UpscaleFilter filter, const uint8_t* src, int srcWidth, int srcHeight,
+                  uint8_t* dst, int dstWidth, int dstHeight, float sharpness)
+{
+    std::vector<Taps> columns = computeTaps(srcWidth, dstWidth);
+    std::vector<Taps> rows = computeTaps(srcHeight, dstHeight);
+
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const Taps& ty = rows[y];
+        uint8_t* out = dst + size_t(y) * dstWidth * 4;
+
+        for (int x = 0; x < dstWidth; ++x, out += 4)
+        {
+            const Taps& tx = columns[x];
+
+            if (filter == UPSCALE_NEAREST)
+            {
+                // glBlitFramebuffer picks the texel the output pixel center falls into
+                int sx = std::min(int((float(x) + 0.5f) * srcWidth / dstWidth), srcWidth - 1);
+                int sy = std::min(int((float(y) + 0.5f) * srcHeight / dstHeight), srcHeight - 1);
+                storePixel(out, fetch(src, srcWidth, sx, sy));
+                continue;
+            }
+
+            if (filter == UPSCALE_LANCZOS)
+            {
+                storePixel(out, filterLanczos(src, srcWidth, tx, ty));
+                continue;
+            }
+
+            Pixel p00 = fetch(src, srcWidth, tx.index[1], ty.index[1]);
+            Pixel p10 = fetch(src, srcWidth, tx.index[2], ty.index[1]);
+            Pixel p01 = fetch(src, srcWidth, tx.index[1], ty.index[2]);
+            Pixel p11 = fetch(src, srcWidth, tx.index[2], ty.index[2]);
+            Pixel smoothed = mixPixel(mixPixel(p00, p10, tx.fraction), mixPixel(p01, p11, tx.fraction), ty.fraction);
+
+            if (filter == UPSCALE_BILINEAR)
+            {
+                storePixel(out, smoothed);
+                continue;
+            }
+
+            // UPSCALE_EDGE_ADAPTIVE
+            float l00 = lumaPixel(p00);
+            float l10 = lumaPixel(p10);
+            float l01 = lumaPixel(p01);
+            float l11 = lumaPixel(p11);
+            float gx = 0.5f * (l10 + l11 - l00 - l01);
+            float gy = 0.5f * (l01 + l11 - l00 - l10);
+            float edge = std::min(std::max(std::sqrt(gx * gx + gy * gy) * 4.0f * sharpness, 0.0f), 1.0f);
+
+            Pixel lo = minPixel(minPixel(p00, p10), minPixel(p01, p11));
+            Pixel hi = maxPixel(maxPixel(p00, p10), maxPixel(p01, p11));
+            Pixel sharp = clampPixel(filterLanczos(src, srcWidth, tx, ty), lo, hi);
+
+            storePixel(out, mixPixel(smoothed, sharp, edge));
+        }
+    }
+}
+
+double computePSNR(const uint8_t* a, const uint8_t* b, size_t pixelCount)
+{
+    double sumSquared = 0.0;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            double diff = double(a[i * 4 + c]) - double(b[i * 4 + c]);
+            sumSquared += diff * diff;
+        }
+    }
+    if (sumSquared == 0.0)
+    {
+        return INFINITY;
+    }
+    double mse = sumSquared / double(pixelCount * 3);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
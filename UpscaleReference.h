@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Framebuffer upscaling filters. The GPU versions live in upscale.comp.glsl,
+// the functions here are SIMD CPU implementations of the same math and serve
+// as reference and for quality / cost comparisons.
+//
+enum UpscaleFilter
+{
+    UPSCALE_NEAREST = 0,       // glBlitFramebuffer with GL_NEAREST, no compute pass
+    UPSCALE_BILINEAR = 1,
+    UPSCALE_LANCZOS = 2,       // Lanczos-2, 4x4 taps
+    UPSCALE_EDGE_ADAPTIVE = 3, // bilinear in flat areas, de-ringed Lanczos-2 on edges
+    UPSCALE_FILTER_COUNT
+};
+
+extern const char* UPSCALE_FILTER_NAMES[UPSCALE_FILTER_COUNT];
+
+// src and dst are tightly packed RGBA8 images
+void upscaleImage(UpscaleFilter filter, const uint8_t* src, int srcWidth, int srcHeight,
+                  uint8_t* dst, int dstWidth, int dstHeight, float sharpness = 1.0f);
+
+// PSNR in dB over the RGB channels of two RGBA8 images
+double computePSNR(const uint8_t* a, const uint8_t* b, size_t pixelCount);
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Upscaler.h"
+
+#include "nvh/nvprint.hpp"
+
+#include <string>
+#include <vector>
+
+extern std::vector<std::string> defaultSearchPaths;
+
+// must match upscale.comp.glsl
+static const GLuint UPSCALE_GROUP_SIZE = 8;
+static const GLint LOCATION_INPUT_SIZE = 0;
+static const GLint LOCATION_OUTPUT_SIZE = 1;
+static const GLint LOCATION_SHARPNESS = 2;
+
+Upscaler::Upscaler()
+{
+    for (const auto& path : defaultSearchPaths)
+    {
+        m_progManager.addDirectory(path);
+    }
+
+    // UPSCALE_NEAREST is a plain blit and needs no program
+    for (int filter = UPSCALE_BILINEAR; filter < UPSCALE_FILTER_COUNT; ++filter)
+    {
+        std::string prepend = "#define UPSCALE_FILTER " + std::to_string(filter) + "\n";
+        m_programs[filter] = m_progManager.createProgram(
+            nvgl::ProgramManager::Definition(GL_COMPUTE_SHADER, prepend, "upscale.comp.glsl"));
+    }
+
+    if (!m_progManager.areProgramsValid())
+    {
+        LOGE("Error loading upscale shaders\n");
+    }
+}
+
+Upscaler::~Upscaler()
+{
+    m_progManager.deletePrograms();
+    nvgl::deleteFramebuffer(m_fbo);
+    nvgl::deleteTexture(m_outputTexture);
+}
+
+void Upscaler::resizeOutput(int width, int height)
+{
+    if (width == m_outputWidth && height == m_outputHeight)
+    {
+        return;
+    }
+    m_outputWidth = width;
+    m_outputHeight = height;
+
+    nvgl::newTexture(m_outputTexture, GL_TEXTURE_2D);
+    glTextureStorage2D(m_outputTexture, 1, GL_RGBA8, width, height);
+
+    nvgl::newFramebuffer(m_fbo);
+    glNamedFramebufferTexture(m_fbo, GL_COLOR_ATTACHMENT0, m_outputTexture, 0);
+}
+
+void Upscaler::upscale(UpscaleFilter filter, GLuint inputTexture, int inputWidth, int inputHeight,
+                       int outputWidth, int outputHeight, float sharpness)
+{
+    assert(filter != UPSCALE_NEAREST);
+
+    resizeOutput(outputWidth, outputHeight);
+
+    m_timer.begin();
+
+    GLuint program = m_progManager.get(m_programs[filter]);
+    glUseProgram(program);
+    glProgramUniform2i(program, LOCATION_INPUT_SIZE, inputWidth, inputHeight);
+    glProgramUniform2i(program, LOCATION_OUTPUT_SIZE, outputWidth, outputHeight);
+    glProgramUniform1f(program, LOCATION_SHARPNESS, sharpness);
+
+    glBindTextureUnit(0, inputTexture);
+    glBindImageTexture(0, m_outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    glDispatchCompute((outputWidth + UPSCALE_GROUP_SIZE - 1) / UPSCALE_GROUP_SIZE,
+                      (outputHeight + UPSCALE_GROUP_SIZE - 1) / UPSCALE_GROUP_SIZE, 1);
+
+    // the result is read by a blit
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    glBindTextureUnit(0, 0);
+    glUseProgram(0);
+
+    m_timer.end();
+}
+
+void Upscaler::reloadShaders()
+{
+    m_progManager.reloadPrograms();
+}
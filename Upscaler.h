@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "nvgl/programmanager_gl.hpp"
+#include "nvgl/base_gl.hpp"
+
+#include "GpuTimer.h"
+#include "UpscaleReference.h"
+
+//
+// Compute based alternative to the GL_NEAREST framebuffer scaling blit.
+// upscale() filters the rendered region of the scene color texture into a
+// window sized texture, which the caller then blits 1:1 to the screen via
+// getOutputFramebuffer().
+//
+class Upscaler
+{
+public:
+    Upscaler();
+    ~Upscaler();
+
+    void upscale(UpscaleFilter filter, GLuint inputTexture, int inputWidth, int inputHeight,
+                 int outputWidth, int outputHeight, float sharpness);
+
+    GLuint getOutputFramebuffer() const { return m_fbo; }
+
+    // GPU time of the last finished compute pass
+    double getMilliseconds() const { return m_timer.getMilliseconds(); }
+
+    void reloadShaders();
+
+private:
+    void resizeOutput(int width, int height);
+
+    nvgl::ProgramManager m_progManager;
+    nvgl::ProgramID m_programs[UPSCALE_FILTER_COUNT];
+
+    GLuint m_outputTexture = 0;
+    GLuint m_fbo = 0;
+    int m_outputWidth = 0;
+    int m_outputHeight = 0;
+
+    GpuTimer m_timer;
+};
@@ -19,131 +19,1413 @@
 
 #include "util_vrs.h"
 
+#include "nvh/fileoperations.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
 bool VRSDemo::begin()
 {
     if (!GLDemo::begin()) return false;
+
+    auto start = std::chrono::high_resolution_clock::now();
     m_pipeline = std::make_unique< VRSPipeline >();
+    // compile (or load) the program of the initial settings now rather than in the first frame
+    updatePermutation();
+    m_pipeline->setShaderProgram();
+    LOGI("scene pipeline ready after %.2f ms\n", std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
 
-    m_torus.setVertexAttributeLocations(VERTEX_POS, VERTEX_NORMAL);
+    m_torus.setVertexAttributeLocations(VERTEX_POS, VERTEX_NORMAL, VERTEX_TEXCOORD);
     m_torusTessellationM = m_torus.getTessellationM();
     m_torusTessellationN = m_torus.getTessellationN();
 
     if (!isVRSExtensionPresent() || !isPerPrimitiveVRSExtensionPresent())
     {
-        return false;
+        return false;
+    }
+
+    glEnable(GL_SHADING_RATE_IMAGE_PER_PRIMITIVE_NV);
+
+    // optional, the meshlet path of the tori is not offered without it
+    m_meshShadersSupported = has_GL_NV_mesh_shader != 0;
+    if (!m_meshShadersSupported)
+    {
+        LOGI("GL_NV_mesh_shader not supported, the tori cannot be drawn as meshlets\n");
+    }
+    m_halfPrecisionSupported = has_GL_NV_gpu_shader5 != 0;
+    if (!m_halfPrecisionSupported)
+    {
+        LOGI("GL_NV_gpu_shader5 not supported, the material stays in fp32\n");
+    }
+
+    glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV, &m_shadingRateImageTexelHeight);
+    LOGOK("\nGL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV = %d\n", m_shadingRateImageTexelHeight);
+    glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV, &m_shadingRateImageTexelWidth);
+    LOGOK("GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV = %d\n", m_shadingRateImageTexelWidth);
+
+    setupShadingRatePalette();
+
+    std::string profileError;
+    std::string profileFilename = nvh::findFile("hmd.vrp", defaultSearchPaths, true);
+    if (profileFilename.empty() || !m_hmdProfile.open(profileFilename, &profileError))
+    {
+        LOGI("no HMD rate profile (%s), the HMD mode uses the varying shading rate image\n",
+            profileFilename.empty() ? "hmd.vrp not found" : profileError.c_str());
+    }
+
+    std::string presetError;
+    std::string presetFilename = nvh::findFile("foveation_presets.txt", defaultSearchPaths, true);
+    if (!presetFilename.empty() && loadFoveationPresets(presetFilename, m_foveationPresets, &presetError))
+    {
+        for (size_t i = 0; i < m_foveationPresets.presets.size(); ++i)
+        {
+            const FoveationPreset& preset = m_foveationPresets.presets[i];
+            char name[64];
+            snprintf(name, sizeof(name), "%.3f inv/px, %.1f dB%s", preset.invocationsPerPixel, preset.psnr,
+                i == m_foveationPresets.defaultIndex ? " (default)" : "");
+            m_foveationPresetNames.push_back(name);
+        }
+        for (const std::string& name : m_foveationPresetNames)
+        {
+            m_foveationPresetNamePointers.push_back(name.c_str());
+        }
+
+        m_foveationPreset = int(m_foveationPresets.defaultIndex);
+        m_foveationParams = m_foveationPresets.presets[m_foveationPreset].params;
+        LOGI("loaded %d foveation presets from %s\n", int(m_foveationPresetNames.size()), presetFilename.c_str());
+    }
+    else if (!presetFilename.empty())
+    {
+        LOGW("%s\n", presetError.c_str());
+    }
+
+    m_rateOverlay = std::make_unique< RateOverlay >();
+    m_edgeRefiner = std::make_unique< EdgeRefiner >();
+    m_depthOfFieldRater = std::make_unique< DepthOfFieldRater >();
+
+    return true;
+}
+
+void VRSDemo::end()
+{
+    nvgl::deleteTexture(m_shadingRateImageVarying);
+    nvgl::deleteTexture(m_shadingRateImageMouseTracking);
+    nvgl::deleteTexture(m_shadingRateImage1X1);
+    nvgl::deleteTexture(m_shadingRateImage2X2);
+    nvgl::deleteTexture(m_shadingRateImage4X4);
+    nvgl::deleteTexture(m_shadingRateImageHmdProfile);
+    nvgl::deleteTexture(m_shadingRateImageComposited);
+    m_hmdProfile.close();
+    m_rateOverlay = nullptr;
+    m_edgeRefiner = nullptr;
+    m_depthOfFieldRater = nullptr;
+    m_meshScene = nullptr;
+    m_materialTextures = nullptr;
+    m_oit = nullptr;
+    m_occlusionCuller = nullptr;
+    GLDemo::end();
+}
+
+void VRSDemo::renderFrame(double time, uint32_t width, uint32_t height, GLuint fbo)
+{
+    updateTextures(width, height);
+    updateMeshScene();
+    applySubmissionSweep();
+
+    bool newSceneTime = m_sceneTimer.getResultCount() != m_sceneTimerResultCount;
+    m_sceneTimerResultCount = m_sceneTimer.getResultCount();
+
+    // timer results lag a few frames behind, only attribute them once the permutation was stable for long enough
+    if (newSceneTime && m_framesWithSamePermutation > 4)
+    {
+        m_pipeline->addSceneTime(m_permutationKey, m_sceneTimer.getMilliseconds());
+    }
+
+    updateMeasuredSceneTime(newSceneTime);
+
+    FoveationParams foveationParams = m_foveationParams;
+    if (m_dynamicFoveation)
+    {
+        // only feed the controller while its output is what gets rendered
+        bool controlling = m_activateShadingRate && m_selectedShadingMode == SHADING_MODE_VARYING;
+        if (controlling && newSceneTime)
+        {
+            m_foveationController.update(m_sceneTimer.getMilliseconds());
+        }
+        foveationParams = m_foveationController.apply(m_foveationParams);
+    }
+
+    //////////// ShadingRateSample ////////////
+    //
+    // Everything up to here does not depend on the camera or the gaze, so
+    // they are sampled as late as possible: the varying image follows the
+    // gaze from now, not from before the throttle and the UI.
+    //
+    latchInput();
+    updateFoveationTexture(foveationParams, m_gazeFoveation ? m_gaze : glm::vec2(0.5f));
+    updateCompositedTexture(width, height);
+
+    // the depth ranges and the tile classes are from the depth buffer of the previous frame,
+    // the edges refine what the depth of field coarsened
+    GLuint rates = getSelectedShadingRateImage();
+    bool depthOfFieldRates = m_activateShadingRate && m_depthOfField.enabled;
+    if (depthOfFieldRates)
+    {
+        rates = m_depthOfFieldRater->compose(rates, m_shadingRateImageWidth, m_shadingRateImageHeight, m_depthOfField, m_rateCost);
+    }
+    bool refineEdges = m_activateShadingRate && m_edgeRefinement.policy != EDGE_POLICY_OFF;
+    if (refineEdges)
+    {
+        rates = m_edgeRefiner->refine(rates, m_shadingRateImageWidth, m_shadingRateImageHeight, m_edgeRefinement);
+    }
+    m_refinedShadingRateImage = rates != getSelectedShadingRateImage() ? rates : 0;
+
+    if (isTexturedMaterialActive() && !m_materialTextures)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        m_materialTextures = std::make_unique< MaterialTextures >();
+        LOGI("material textures (%u x %u, %u mips) ready after %.2f ms\n", m_materialTextures->getSize(), m_materialTextures->getSize(),
+            m_materialTextures->getMipLevels(), std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+
+    bindShadingRateTexture();
+    glViewport(0, 0, width, height);
+    updatePerFrameUniforms(width, height);
+    updatePermutation();
+    m_pipeline->setShaderProgram();
+    m_pipeline->updateSceneUniforms();
+
+    if (isTransparentSceneActive())
+    {
+        if (!m_oit)
+        {
+            m_oit = std::make_unique< OITRenderer >();
+        }
+        if (uint32_t(m_oitCapacityMillions) * 1000000u != m_oit->getCapacity())
+        {
+            std::fill(std::begin(m_oitHighWater), std::end(m_oitHighWater), 0u);
+            std::fill(std::begin(m_oitMaxOverflow), std::end(m_oitMaxOverflow), 0u);
+        }
+        m_oit->resize(width, height);
+        m_oit->setCapacity(uint32_t(m_oitCapacityMillions) * 1000000u);
+
+        vertexload::OITSceneData& oitData = m_oit->sceneData;
+        const vertexload::SceneData& data = m_pipeline->sceneData;
+        oitData.viewMatrix = data.viewMatrix;
+        oitData.lightPos_world = data.lightPos_world;
+        oitData.eyepos_world = data.eyepos_world;
+        oitData.eyePos_view = data.eyePos_view;
+        oitData.loadFactor = data.loadFactor;
+        oitData.fragmentLoadFactor = data.fragmentLoadFactor;
+        oitData.fullShadingRateForGreenObjects = data.fullShadingRateForGreenObjects;
+        oitData.visualizeShadingRate = m_oitVisualizeShadingRate ? 1 : 0;
+        oitData.visualizeSampleCount = m_oitVisualizeSampleCount ? 1 : 0;
+        oitData.maxSamplesForBlending = m_oitMaxSamples;
+        m_oit->beginStore();
+    }
+
+    bool countInvocations = m_overlayMode == RateOverlay::OVERLAY_INVOCATIONS;
+    if (countInvocations)
+    {
+        m_rateOverlay->resize(width, height);
+        m_rateOverlay->beginInvocationCounting();
+    }
+
+    if (isTexturedMaterialActive())
+    {
+        m_materialTextures->bind();
+    }
+    if (isMeasuringTextureTraffic())
+    {
+        m_materialTextures->beginTrafficMeasurement();
+    }
+
+    if (isMeshletPathActive())
+    {
+        m_meshletCounters.begin(SSBO_MESHLET_STATS);
+    }
+
+    m_sceneTimer.begin();
+    m_primitiveCounter.begin();
+    m_samplesPassedCounter.begin();
+    renderScene(width, height);
+    m_samplesPassedCounter.end();
+    m_primitiveCounter.end();
+    m_sceneTimer.end();
+
+    updateOverdrawStatistics(width, height);
+
+    if (isTessellationActive())
+    {
+        updateMeasuredTriangles();
+    }
+    if (isMeshletPathActive())
+    {
+        m_meshletCounters.end(SSBO_MESHLET_STATS);
+        updateMeshletStatistics();
+    }
+
+    if (countInvocations)
+    {
+        m_rateOverlay->endInvocationCounting();
+    }
+
+    if (isMeasuringTextureTraffic())
+    {
+        m_materialTextures->endTrafficMeasurement();
+        updateMeasuredTextureTraffic();
+    }
+    if (isTexturedMaterialActive())
+    {
+        m_materialTextures->unbind();
+    }
+    if (isTransparentSceneActive())
+    {
+        m_oit->endStore();
+    }
+
+    glDisable(GL_SHADING_RATE_IMAGE_NV);
+
+    if (isTransparentSceneActive())
+    {
+        const nvgl::ProfilerGL::Section profile(m_profiler, "OIT resolve");
+        m_oit->resolve(width, height);
+        updateOITStatistics();
+    }
+
+    if (refineEdges)
+    {
+        m_edgeRefiner->classify(getSceneDepthTexture(), width, height, m_shadingRateImageTexelWidth, m_shadingRateImageTexelHeight,
+            m_projectionMatrix, m_edgeRefinement);
+    }
+    else
+    {
+        m_edgeRefiner->invalidate();
+    }
+    if (depthOfFieldRates)
+    {
+        m_depthOfFieldRater->reduce(getSceneDepthTexture(), width, height, m_shadingRateImageTexelWidth,
+            m_shadingRateImageTexelHeight, m_projectionMatrix);
+    }
+    else
+    {
+        m_depthOfFieldRater->invalidate();
+    }
+
+    if (m_logRateStatistics)
+    {
+        const ShadingRateStats& stats = getSelectedRateStats();
+        LOGI("frame %u rates: 1x1 %.4f 2x2 %.4f 4x4 %.4f none %.4f predicted %.4f scene %.3f ms\n", m_frameIndex,
+            stats.getFraction(RATE_1X1), stats.getFraction(RATE_2X2), stats.getFraction(RATE_4X4),
+            stats.getNoInvocationFraction(m_rateCost),
+            m_activateShadingRate ? stats.getPredictedInvocationsPerPixel(m_rateCost) : 1.0f, m_sceneTimer.getMilliseconds());
+        if (isMeasuringTextureTraffic())
+        {
+            LOGI("frame %u texture traffic %.3f MB\n", m_frameIndex, m_materialTextures->getTrafficBytes() / (1024.0 * 1024.0));
+        }
+    }
+    ++m_frameIndex;
+
+    // the overlay itself is shaded at full rate, after the scene timer
+    m_rateOverlay->draw(RateOverlay::Mode(m_overlayMode), m_activateShadingRate ? getActiveShadingRateImage() : 0,
+        m_shadingRateImageTexelWidth, m_shadingRateImageTexelHeight, width, height);
+}
+
+// running average of a measurement that varies from frame to frame, the first one starts it
+static void accumulateAverage(double& average, double measured)
+{
+    average = average == 0.0 ? measured : average * 0.9 + measured * 0.1;
+}
+
+VRSDemo::MeasuredSceneKey VRSDemo::getMeasuredSceneKey() const
+{
+    MeasuredSceneKey key;
+    key.shadingMode = m_activateShadingRate ? m_selectedShadingMode : SHADING_MODE_COUNT;
+    key.texturedMaterial = isTexturedMaterialActive();
+    key.textureTraffic = isMeasuringTextureTraffic();
+    key.transparentScene = isTransparentSceneActive();
+    key.tessellation = isTessellationActive();
+    key.meshletPath = isMeshletPathActive();
+    key.occlusionCulling = isOcclusionCullingActive();
+    key.halfPrecisionMaterial = isHalfPrecisionMaterialActive();
+    key.sortDraws = m_sortDraws;
+    return key;
+}
+
+void VRSDemo::updateMeasuredSceneTime(bool newSceneTime)
+{
+    MeasuredSceneKey key = getMeasuredSceneKey();
+    if (key != m_measuredSceneKey)
+    {
+        m_measuredSceneKey = key;
+        m_framesWithSameSceneKey = 0;
+    }
+    ++m_framesWithSameSceneKey;
+
+    // the atomics of the traffic counter would show up in the scene time
+    if (isSettledResult(newSceneTime) && !isMeasuringTextureTraffic())
+    {
+        double measured = m_sceneTimer.getMilliseconds();
+        accumulateAverage((isTexturedMaterialActive() ? m_texturedSceneMilliseconds : m_measuredSceneMilliseconds)[key.shadingMode], measured);
+
+        // the plain tori on the vertex path, where culling can be switched
+        if (!isMeshSceneActive() && !isTransparentSceneActive() && !isTexturedMaterialActive() && getActiveTorusPath() == TORUS_PATH_VERTEX)
+        {
+            accumulateAverage(m_cullingSceneMilliseconds[isOcclusionCullingActive() ? 1 : 0], measured);
+        }
+        // the procedural material on its own, on any torus path
+        if (!isMeshSceneActive() && !isTransparentSceneActive() && !isTexturedMaterialActive())
+        {
+            accumulateAverage(m_materialSceneMilliseconds[isHalfPrecisionMaterialActive() ? 1 : 0], measured);
+        }
+    }
+}
+
+void VRSDemo::updateMeasuredTextureTraffic()
+{
+    bool newResult = m_materialTextures->getTrafficResultCount() != m_textureTrafficResultCount;
+    m_textureTrafficResultCount = m_materialTextures->getTrafficResultCount();
+
+    if (isSettledResult(newResult))
+    {
+        accumulateAverage(m_textureMegabytes[m_measuredSceneKey.shadingMode],
+            m_materialTextures->getTrafficBytes() / (1024.0 * 1024.0));
+    }
+}
+
+void VRSDemo::updateOITStatistics()
+{
+    bool newResult = m_oit->getResultCount() != m_oitResultCount;
+    m_oitResultCount = m_oit->getResultCount();
+
+    if (isSettledResult(newResult))
+    {
+        int mode = m_measuredSceneKey.shadingMode;
+        m_oitHighWater[mode] = std::max(m_oitHighWater[mode], m_oit->getStoredFragments());
+        m_oitMaxOverflow[mode] = std::max(m_oitMaxOverflow[mode], m_oit->getOverflowFragments());
+    }
+}
+
+void VRSDemo::updateMeasuredTriangles()
+{
+    bool newResult = m_primitiveCounter.getResultCount() != m_primitiveResultCount;
+    m_primitiveResultCount = m_primitiveCounter.getResultCount();
+
+    if (isSettledResult(newResult))
+    {
+        accumulateAverage(m_tessellatedTriangles[m_measuredSceneKey.shadingMode], double(m_primitiveCounter.getValue()));
+    }
+}
+
+void VRSDemo::updateMeshletStatistics()
+{
+    bool newResult = m_meshletCounters.getResultCount() != m_meshletResultCount;
+    m_meshletResultCount = m_meshletCounters.getResultCount();
+
+    if (isSettledResult(newResult))
+    {
+        accumulateAverage(m_drawnMeshlets[m_measuredSceneKey.shadingMode], double(m_meshletCounters.getValue(0)));
+    }
+}
+
+void VRSDemo::updateOverdrawStatistics(uint32_t width, uint32_t height)
+{
+    bool newResult = m_samplesPassedCounter.getResultCount() != m_samplesPassedResultCount;
+    m_samplesPassedResultCount = m_samplesPassedCounter.getResultCount();
+
+    // only the opaque tori of renderTori() go through the render queue
+    if (isMeshSceneActive() || isOcclusionCullingActive() || isTransparentSceneActive())
+    {
+        return;
+    }
+    if (m_numberOfTori != m_overdrawTori || getActiveTorusPath() != m_overdrawTorusPath)
+    {
+        m_overdrawTori = m_numberOfTori;
+        m_overdrawTorusPath = getActiveTorusPath();
+        m_samplesPerPixel[0] = 0.0;
+        m_samplesPerPixel[1] = 0.0;
+    }
+
+    // sorting is part of the scene key
+    if (isSettledResult(newResult))
+    {
+        accumulateAverage(m_samplesPerPixel[m_sortDraws ? 1 : 0], double(m_samplesPassedCounter.getValue()) / double(width * height));
+    }
+}
+
+void VRSDemo::applySubmissionSweep()
+{
+    if (m_submissionSweepStep < 0)
+    {
+        return;
+    }
+    m_numberOfTori = SUBMISSION_DRAW_COUNTS[m_submissionSweepStep / 2];
+    m_useUnifiedDraws = (m_submissionSweepStep % 2) != 0;
+}
+
+void VRSDemo::updateSubmissionSweep(double milliseconds)
+{
+    // skips the frames that grow the buffers, then averages
+    const uint32_t WARMUP_FRAMES = 10;
+    const uint32_t MEASURED_FRAMES = 30;
+
+    if (m_submissionSweepStep < 0)
+    {
+        return;
+    }
+    if (++m_submissionSweepFrames > WARMUP_FRAMES)
+    {
+        m_submissionSweepSum += milliseconds;
+    }
+    bool skipped = m_useUnifiedDraws && !isUnifiedDrawActive();
+    if (m_submissionSweepFrames < WARMUP_FRAMES + MEASURED_FRAMES && !skipped)
+    {
+        return;
+    }
+
+    int count = m_submissionSweepStep / 2;
+    int unified = m_submissionSweepStep % 2;
+    m_submissionSweepMilliseconds[count][unified] = skipped ? 0.0 : m_submissionSweepSum / MEASURED_FRAMES;
+    if (unified)
+    {
+        LOGI("submission of %d tori: %.3f ms bound, %.3f ms unified\n", SUBMISSION_DRAW_COUNTS[count],
+            m_submissionSweepMilliseconds[count][0], m_submissionSweepMilliseconds[count][1]);
+    }
+
+    m_submissionSweepFrames = 0;
+    m_submissionSweepSum = 0.0;
+    if (++m_submissionSweepStep == SUBMISSION_SWEEP_COUNTS * 2)
+    {
+        m_submissionSweepStep = -1;
+        m_numberOfTori = m_submissionSweepSavedTori;
+        m_useUnifiedDraws = m_submissionSweepSavedUnified;
+    }
+}
+
+void VRSDemo::updateMeshScene()
+{
+    if (m_sceneMode != SCENE_MESH_BLOB || m_meshScene || m_meshSceneLoadFailed)
+    {
+        return;
+    }
+
+    std::string filename = nvh::findFile("scene.vmb", defaultSearchPaths, true);
+    m_meshScene = std::make_unique< MeshScene >();
+    if (filename.empty() || !m_meshScene->load(filename))
+    {
+        LOGW("no usable scene.vmb found, bake one with tools/meshbaker\n");
+        m_meshScene = nullptr;
+        m_meshSceneLoadFailed = true;
+    }
+}
+
+void VRSDemo::renderScene(uint32_t width, uint32_t height)
+{
+    if (!isMeshSceneActive())
+    {
+        if (isOcclusionCullingActive())
+        {
+            renderCulledTori(width, height);
+            return;
+        }
+        if (isTessellationActive())
+        {
+            m_tessellatedTorus.setSettings(m_tessellation);
+            m_tessellatedTorus.setTarget(width, height, m_activateShadingRate ? getActiveShadingRateImage() : 0,
+                m_shadingRateImageTexelWidth, m_shadingRateImageTexelHeight);
+        }
+        if (isMeshletPathActive())
+        {
+            // the back faces of the transparent tori are visible
+            m_torus.setMeshletCulling(width, height, m_activateShadingRate ? getActiveShadingRateImage() : 0,
+                m_shadingRateImageTexelWidth, m_shadingRateImageTexelHeight, m_meshletConeCulling && !isTransparentSceneActive());
+        }
+        // CPU time only, the draws are queued and the GPU is measured by the scene timer
+        auto start = std::chrono::high_resolution_clock::now();
+        renderTori(m_numberOfTori, getActiveTorusPath(), isUnifiedDrawActive());
+        m_submissionMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        updateSubmissionSweep(m_submissionMilliseconds);
+        return;
+    }
+
+    // the instance transforms are applied in the vertex shader, the object UBO only holds view and projection
+    m_pipeline->setModelMatrix(glm::mat4(1.0f));
+    m_pipeline->updateObjectUniforms();
+
+    m_meshScene->setInstances(m_meshInstances, float(width) / float(height));
+    m_meshScene->draw(VERTEX_POS, VERTEX_NORMAL);
+}
+
+void VRSDemo::renderCulledTori(uint32_t width, uint32_t height)
+{
+    if (!m_occlusionCuller)
+    {
+        m_occlusionCuller = std::make_unique< OcclusionCuller >();
+    }
+    // a pyramid from before a frame without culling may hold another scene
+    if (m_occlusionCulledFrame + 1 != m_frameIndex)
+    {
+        m_occlusionCuller->invalidate();
+    }
+    m_occlusionCulledFrame = m_frameIndex;
+
+    // the placement only changes with the count and the window
+    if (m_culledToriCount != uint32_t(m_numberOfTori) || m_culledToriWindow[0] != m_windowState.m_winSize[0]
+        || m_culledToriWindow[1] != m_windowState.m_winSize[1])
+    {
+        m_culledToriCount = uint32_t(m_numberOfTori);
+        m_culledToriWindow[0] = m_windowState.m_winSize[0];
+        m_culledToriWindow[1] = m_windowState.m_winSize[1];
+
+        glm::vec3 boundsMin, boundsMax;
+        m_torus.getBounds(boundsMin, boundsMax);
+        placeTori(m_culledToriCount, m_torusInstances);
+        m_occlusionCuller->setObjects(m_torusInstances, boundsMin, boundsMax);
+    }
+
+    // the instance transforms are applied in the vertex shader, the object UBO only holds view and projection
+    m_pipeline->setModelMatrix(glm::mat4(1.0f));
+    m_pipeline->updateObjectUniforms();
+
+    // the buffers may switch to a new tessellation here, the draws need its index count
+    m_torus.setBufferState();
+    m_occlusionCuller->setMesh(m_torus.getTriangleCount() * 3);
+
+    // the culling passes are compute dispatches, the scene program is bound again before each draw
+    m_occlusionCuller->cullFirstPhase(m_projectionMatrix * m_control.m_viewMatrix, width, height);
+    m_pipeline->setShaderProgram();
+    m_occlusionCuller->drawPhase(0);
+
+    m_occlusionCuller->cullSecondPhase(getSceneDepthTexture());
+    m_pipeline->setShaderProgram();
+    m_occlusionCuller->drawPhase(1);
+
+    m_occlusionCuller->endFrame(getSceneDepthTexture());
+    m_pipeline->setShaderProgram();
+    m_torus.unsetBufferState();
+}
+
+GLuint VRSDemo::getSelectedShadingRateImage() const
+{
+    if (m_useCompositedImage)
+    {
+        return m_shadingRateImageComposited;
+    }
+
+    switch (m_selectedShadingMode)
+    {
+    case SHADING_MODE_VARYING:
+        return m_shadingRateImageVarying;
+    case SHADING_MODE_1X1:
+        return m_shadingRateImage1X1;
+    case SHADING_MODE_2X2:
+        return m_shadingRateImage2X2;
+    case SHADING_MODE_HMD_PROFILE:
+        return m_shadingRateImageHmdProfile;
+    case SHADING_MODE_4X4:
+    default:
+        return m_shadingRateImage4X4;
+    }
+}
+
+GLuint VRSDemo::getCaptureRateImage(uint32_t& width, uint32_t& height)
+{
+    width = m_shadingRateImageWidth;
+    height = m_shadingRateImageHeight;
+    return m_activateShadingRate ? getActiveShadingRateImage() : 0;
+}
+
+const ShadingRateStats& VRSDemo::getSelectedRateStats() const
+{
+    return m_useCompositedImage ? m_compositedStats : m_rateStats[m_selectedShadingMode];
+}
+
+void VRSDemo::bindShadingRateTexture()
+{
+    //////////// ShadingRateSample ////////////
+    // 
+    // setting the shading rate image:
+    // 
+    
+    glBindShadingRateImageNV(getActiveShadingRateImage());
+
+    if (m_activateShadingRate)
+    {
+        // independent on the set shading rate image and palette all you need to switch
+        // back to full shading rate is one enable / disable:
+        glEnable(GL_SHADING_RATE_IMAGE_NV);
+    }
+}
+
+static float getInvocationsPerPixel(GLenum rate)
+{
+    switch (rate)
+    {
+    case GL_SHADING_RATE_NO_INVOCATIONS_NV: return 0.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_PIXEL_NV: return 1.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_1X2_PIXELS_NV: return 1.0f / 2.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_2X1_PIXELS_NV: return 1.0f / 2.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_2X2_PIXELS_NV: return 1.0f / 4.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_2X4_PIXELS_NV: return 1.0f / 8.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_4X2_PIXELS_NV: return 1.0f / 8.0f;
+    case GL_SHADING_RATE_1_INVOCATION_PER_4X4_PIXELS_NV: return 1.0f / 16.0f;
+    case GL_SHADING_RATE_2_INVOCATIONS_PER_PIXEL_NV: return 2.0f;
+    case GL_SHADING_RATE_4_INVOCATIONS_PER_PIXEL_NV: return 4.0f;
+    case GL_SHADING_RATE_8_INVOCATIONS_PER_PIXEL_NV: return 8.0f;
+    case GL_SHADING_RATE_16_INVOCATIONS_PER_PIXEL_NV: return 16.0f;
+    default: return 1.0f;
+    }
+}
+
+static void HelpMarker(const char* desc)
+{
+    ImGui::TextDisabled("(?)");
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
+        ImGui::TextUnformatted(desc);
+        ImGui::PopTextWrapPos();
+        ImGui::EndTooltip();
+    }
+}
+
+// "12.345 ms (-40.2 %)" relative to reference, "-" if not measured yet
+static std::string formatMeasurement(double value, double reference, const char* unit)
+{
+    if (value == 0.0)
+    {
+        return "-";
+    }
+    char text[64];
+    if (reference > 0.0)
+    {
+        snprintf(text, sizeof(text), "%.3f %s (%+.1f %%)", value, unit, (value / reference - 1.0) * 100.0);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%.3f %s", value, unit);
+    }
+    return text;
+}
+
+void VRSDemo::processUI(double time)
+{
+    GLDemo::processUI(time);
+
+    setNextPanelOpaque();
+    if (ImGui::Begin("VRS Demo Settings", nullptr))
+    {
+        addOpaquePanel();
+        ImGui::TextUnformatted("Input manually with CTRL+Click");
+
+        ImGui::Combo("Scene", &m_sceneMode, SCENE_MODE_NAMES, SCENE_MODE_COUNT);
+        if (m_sceneMode == SCENE_MESH_BLOB)
+        {
+            if (m_meshSceneLoadFailed)
+            {
+                ImGui::TextDisabled("scene.vmb not found, bake one with tools/meshbaker");
+            }
+            else if (m_meshScene)
+            {
+                ImGui::SliderInt("Instances", &m_meshInstances, 1, 100000, "%d", ImGuiSliderFlags_Logarithmic);
+                ImGui::Text("Triangles: %llu, upload: %.2f MB in %.2f ms", (unsigned long long)m_meshScene->getTriangleCount(),
+                    m_meshScene->getUploadBytes() / (1024.0 * 1024.0), m_meshScene->getUploadMilliseconds());
+            }
+        }
+        else
+        {
+            ImGui::SliderInt("Tori", &m_numberOfTori, 1, 1000, "%d", ImGuiSliderFlags_None);
+            ImGui::SameLine(); HelpMarker("Input manually with CTRL+Click.");
+        }
+        if (m_sceneMode == SCENE_TRANSPARENT_TORI)
+        {
+            ImGui::SliderInt("Fragment buffer (M)", &m_oitCapacityMillions, 1, 64, "%d", ImGuiSliderFlags_None);
+            ImGui::SameLine(); HelpMarker("Millions of fragments, 16 bytes each. A coarse fragment takes one entry "
+                "for all the pixels it covers, fragments that do not fit are dropped.");
+            ImGui::SliderInt("Samples per pixel", &m_oitMaxSamples, 1, OIT_MAX_SAMPLES, "%d", ImGuiSliderFlags_None);
+            ImGui::SameLine(); HelpMarker("The nearest fragments of a pixel that are blended, the farther ones are dropped.");
+            ImGui::Checkbox("Show sample count", &m_oitVisualizeSampleCount);
+            ImGui::SameLine();
+            ImGui::Checkbox("Show fragment size", &m_oitVisualizeShadingRate);
+        }
+
+        ImGui::SliderInt("Fragment load", &m_fragmentLoad, 1, 250, "%d", ImGuiSliderFlags_None);
+
+        if (m_sceneMode != SCENE_MESH_BLOB)
+        {
+            if (ImGui::Combo("Torus geometry", &m_torusPath, TORUS_PATH_NAMES, m_meshShadersSupported ? TORUS_PATH_COUNT : TORUS_PATH_MESHLETS))
+            {
+                // the scene times per shading mode are only comparable with the same geometry
+                std::fill(std::begin(m_measuredSceneMilliseconds), std::end(m_measuredSceneMilliseconds), 0.0);
+                std::fill(std::begin(m_texturedSceneMilliseconds), std::end(m_texturedSceneMilliseconds), 0.0);
+            }
+            ImGui::SameLine(); HelpMarker("Hardware tessellation generates the torus surface in the tessellation stages from a "
+                "coarse mesh of patches. Each patch edge gets one segment per target length on screen, divided by the fragment "
+                "size of the shading rate image at the edge. Patches outside of the view or only over tiles without invocations "
+                "are culled.\nMeshlets draws the torus mesh in chunks of at most 64 vertices and 126 triangles with task and mesh "
+                "shaders (GL_NV_mesh_shader). Chunks outside of the view, facing away from the eye or only over tiles without "
+                "invocations are culled.\nSwitching restarts the scene times per shading mode.");
+        }
+        if (isTessellationActive())
+        {
+            bool changed = ImGui::SliderInt("Patches around the ring", &m_tessellation.ringPatches, 1, 64, "%d", ImGuiSliderFlags_None);
+            changed |= ImGui::SliderInt("Patches around the tube", &m_tessellation.tubePatches, 1, 32, "%d", ImGuiSliderFlags_None);
+            changed |= ImGui::SliderFloat("Target edge pixels", &m_tessellation.targetEdgePixels, 1.0f, 64.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+            changed |= ImGui::SliderFloat("Max tessellation factor", &m_tessellation.maxFactor, 1.0f, 64.0f, "%.0f");
+            changed |= ImGui::Checkbox("Rate-driven factors", &m_tessellation.rateDriven);
+            if (changed)
+            {
+                std::fill(std::begin(m_tessellatedTriangles), std::end(m_tessellatedTriangles), 0.0);
+            }
+        }
+        else
+        {
+            bool changed = ImGui::SliderInt("Torus tessellation N", &m_torusTessellationN, 3, 64, "%d", ImGuiSliderFlags_None);
+            changed |= ImGui::SliderInt("Torus tessellation M", &m_torusTessellationM, 3, 64, "%d", ImGuiSliderFlags_None);
+            ImGui::Text("Triangle count per torus: %d", (int)m_torus.getTriangleCount());
+            if (isMeshletPathActive())
+            {
+                changed |= ImGui::Checkbox("Meshlet cone culling", &m_meshletConeCulling);
+                ImGui::SameLine(); HelpMarker("Culls the meshlets whose triangles all face away from the eye. "
+                    "Always off for the transparent tori, their back faces are visible.");
+            }
+            if (changed)
+            {
+                std::fill(std::begin(m_drawnMeshlets), std::end(m_drawnMeshlets), 0.0);
+            }
+        }
+
+        ImGui::Separator();
+
+        ImGui::ListBox("Shading mode", &m_selectedShadingMode, SHADING_MODE_NAMES, SHADING_MODE_COUNT, SHADING_MODE_COUNT);
+
+        if (m_foveationPreset >= 0)
+        {
+            if (ImGui::Combo("Foveation preset", &m_foveationPreset, m_foveationPresetNamePointers.data(), int(m_foveationPresetNamePointers.size())))
+            {
+                m_foveationParams = m_foveationPresets.presets[m_foveationPreset].params;
+            }
+            ImGui::SameLine(); HelpMarker("Radii and rates of the varying shading rate image from tools/foveation_tuner, "
+                "sorted by predicted invocations per pixel. The PSNR is against the frames the presets were tuned on.");
+        }
+
+        ImGui::Checkbox("Enable VRS", &m_activateShadingRate);
+        ImGui::Combo("Overlay", &m_overlayMode, OVERLAY_MODE_NAMES, RateOverlay::OVERLAY_MODE_COUNT);
+        ImGui::SameLine(); HelpMarker("Invocations per pixel compiles a scene program variant that counts the fragment shader "
+            "invocations per pixel, including overdraw and the full rate of green objects.");
+        if (m_overlayMode != RateOverlay::OVERLAY_OFF)
+        {
+            ImGui::SliderFloat("Overlay opacity", &m_rateOverlay->m_opacity, 0.0f, 1.0f, "%.2f");
+            if (m_overlayMode == RateOverlay::OVERLAY_INVOCATIONS)
+            {
+                ImGui::SliderFloat("Invocations for red", &m_rateOverlay->m_maxInvocations, 0.25f, 8.0f, "%.2f");
+            }
+        }
+        ImGui::Checkbox("full ShadingRate for green objects", &m_fullShadingRateForGreenObjects);
+
+        ImGui::Checkbox("Textured material", &m_texturedMaterial);
+        ImGui::SameLine(); HelpMarker("Albedo and normal maps with full mip chains on the torus UVs. "
+            "The mesh blob has no UVs and stays untextured.");
+        if (m_texturedMaterial)
+        {
+            if (ImGui::SliderFloat("Rate LOD bias", &m_lodBiasScale, 0.0f, 2.0f, "%.2f"))
+            {
+                std::fill(std::begin(m_texturedSceneMilliseconds), std::end(m_texturedSceneMilliseconds), 0.0);
+                std::fill(std::begin(m_textureMegabytes), std::end(m_textureMegabytes), 0.0);
+            }
+            ImGui::SameLine(); HelpMarker("Mip bias per doubling of the fragment size. Coarse fragments already pick "
+                "coarser mips through their derivatives, the bias skips the detail they could only alias on top of that.");
+            ImGui::Checkbox("Measure texture traffic", &m_measureTextureTraffic);
+            ImGui::SameLine(); HelpMarker("Compiles a scene program variant that estimates the texels read from both "
+                "textures. Scene times are not recorded while it is on.");
+        }
+
+        if (m_halfPrecisionSupported)
+        {
+            if (ImGui::Checkbox("Half precision material", &m_halfPrecisionMaterial))
+            {
+                std::fill(std::begin(m_materialSceneMilliseconds), std::end(m_materialSceneMilliseconds), 0.0);
+            }
+            ImGui::SameLine(); HelpMarker("Evaluates the noise surflets and the lighting in float16 (GL_NV_gpu_shader5), "
+                "the noise lattice, the hash and the sum over the fragment load stay fp32. tools/material_precision "
+                "reports the error against fp32: about one pixel in six changes by up to four steps of 1/255.");
+            if (m_materialSceneMilliseconds[0] > 0.0 || m_materialSceneMilliseconds[1] > 0.0)
+            {
+                std::string full = formatMeasurement(m_materialSceneMilliseconds[0], 0.0, "ms");
+                std::string half = formatMeasurement(m_materialSceneMilliseconds[1], m_materialSceneMilliseconds[0], "ms");
+                ImGui::Text("untextured scene fp32 %s, fp16 %s", full.c_str(), half.c_str());
+            }
+        }
+
+        ImGui::Combo("Edge refinement", &m_edgeRefinement.policy, EDGE_POLICY_NAMES, EDGE_POLICY_COUNT);
+        ImGui::SameLine(); HelpMarker("Classifies each tile by the depth buffer of the previous frame. Silhouettes and creases "
+            "get at most the rates below, interiors may go one step coarser. The rate statistics do not include this.");
+        if (m_edgeRefinement.policy != EDGE_POLICY_OFF)
+        {
+            static const char* EDGE_RATE_NAMES[] = { "1x1", "2x2", "4x4" };
+            int silhouetteRate = m_edgeRefinement.silhouetteRate - RATE_1X1;
+            int creaseRate = m_edgeRefinement.creaseRate - RATE_1X1;
+            ImGui::SliderFloat("Depth edge threshold", &m_edgeRefinement.depthThreshold, 0.005f, 0.5f, "%.3f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Crease threshold", &m_edgeRefinement.creaseThreshold, 0.001f, 0.1f, "%.4f", ImGuiSliderFlags_Logarithmic);
+            ImGui::Combo("Silhouette rate", &silhouetteRate, EDGE_RATE_NAMES, 3);
+            ImGui::Combo("Crease rate", &creaseRate, EDGE_RATE_NAMES, 3);
+            m_edgeRefinement.silhouetteRate = uint8_t(RATE_1X1 + silhouetteRate);
+            m_edgeRefinement.creaseRate = uint8_t(RATE_1X1 + creaseRate);
+            ImGui::Text("Edge refinement: %.3f ms", m_edgeRefiner->getMilliseconds());
+        }
+        ImGui::Checkbox("Depth of field rates", &m_depthOfField.enabled);
+        ImGui::SameLine(); HelpMarker("Reduces the depth buffer of the previous frame to the nearest and farthest distance "
+            "per tile. Tiles whose smallest circle of confusion exceeds the thresholds below go to 2x2 or 4x4, where that "
+            "is cheaper than the selected rate. There is no blur pass, the rates assume the content blurs these regions. "
+            "The rate statistics do not include this.");
+        if (m_depthOfField.enabled)
+        {
+            ImGui::SliderFloat("Focus distance", &m_depthOfField.focusDistance, 0.1f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Blur at infinity", &m_depthOfField.infinityBlurPixels, 1.0f, 64.0f, "%.1f px", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("CoC for 2x2", &m_depthOfField.cocThresholds[0], 0.5f, 16.0f, "%.1f px");
+            ImGui::SliderFloat("CoC for 4x4", &m_depthOfField.cocThresholds[1], 0.5f, 16.0f, "%.1f px");
+            m_depthOfField.cocThresholds[1] = std::max(m_depthOfField.cocThresholds[1], m_depthOfField.cocThresholds[0]);
+            ImGui::Text("Depth of field rates: %.3f ms", m_depthOfFieldRater->getMilliseconds());
+        }
+        ImGui::Checkbox("Skip shading behind UI panels", &m_opaquePanels);
+        ImGui::SameLine(); HelpMarker("Makes the UI windows opaque and sets the shading rate image tiles they fully cover "
+            "to no invocations, on top of the selected shading mode.");
+
+        ImGui::Separator();
+
+        if (ImGui::Checkbox("Dynamic foveation", &m_dynamicFoveation))
+        {
+            m_foveationController.reset();
+        }
+        ImGui::SameLine(); HelpMarker("Scales the radii of the shading rings of the varying shading rate image to hit the target GPU time of the scene pass. "
+            "The cut-off to no invocations stays where it is.");
+        if (m_dynamicFoveation)
+        {
+            ImGui::SliderFloat("Target scene time (ms)", &m_foveationController.m_settings.targetMilliseconds, 0.5f, 50.0f, "%.1f");
+            ImGui::Text("Radius scale: %.2f", m_foveationController.getScale());
+        }
+        ImGui::Checkbox("Gaze follows the cursor", &m_gazeFoveation);
+        ImGui::SameLine(); HelpMarker("Centers the varying shading rate image on the cursor, sampled with the camera "
+            "(see \"Late input latch\"), as a stand-in for an eye tracker.");
+        ImGui::Text("Scene pass: %.3f ms", m_sceneTimer.getMilliseconds());
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Shader permutations", &m_useShaderPermutations);
+        ImGui::SameLine(); HelpMarker("Bake the green object rule and fragment load into the scene program. "
+            "Each combination is compiled on first use and cached on disk as a program binary.");
+        for (const auto& it : m_pipeline->getPermutations())
+        {
+            const VRSPipeline::PermutationInfo& info = it.second;
+            double sceneTime = info.gpuSamples ? info.gpuMilliseconds / info.gpuSamples : 0.0;
+            if (info.permutation.dynamic)
+            {
+                ImGui::Text("dynamic%s%s%s%s: %s in %.1f ms, scene %.3f ms", info.permutation.countInvocations ? " count" : "",
+                    info.permutation.instanced ? " instanced" : "", info.permutation.texturedMaterial ? " textured" : "",
+                    info.permutation.measureTextureTraffic ? " traffic" : "", info.fromCache ? "loaded" : "compiled", info.loadMilliseconds, sceneTime);
+                if (info.permutation.transparent)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(transparent)");
+                }
+                if (info.permutation.tessellated)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(tessellated)");
+                }
+                if (info.permutation.meshShader)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(meshlets)");
+                }
+                if (info.permutation.halfPrecision)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(fp16)");
+                }
+            }
+            else
+            {
+                ImGui::Text("load %d%s%s%s%s%s: %s in %.1f ms, scene %.3f ms", info.permutation.fragmentLoad,
+                    info.permutation.countInvocations ? " count" : "", info.permutation.instanced ? " instanced" : "",
+                    info.permutation.fullShadingRateForGreenObjects ? " green" : "", info.permutation.texturedMaterial ? " textured" : "",
+                    info.permutation.measureTextureTraffic ? " traffic" : "",
+                    info.fromCache ? "loaded" : "compiled", info.loadMilliseconds, sceneTime);
+                if (info.permutation.transparent)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(transparent)");
+                }
+                if (info.permutation.tessellated)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(tessellated)");
+                }
+                if (info.permutation.meshShader)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(meshlets)");
+                }
+                if (info.permutation.halfPrecision)
+                {
+                    ImGui::SameLine(); ImGui::TextUnformatted("(fp16)");
+                }
+            }
+        }
+    }
+    ImGui::End();
+
+    processOverlayLegend();
+    processRateStatisticsUI();
+    processTextureTrafficUI();
+    processTransparencyUI();
+    processTessellationUI();
+    processMeshletUI();
+    processSubmissionUI();
+    processCullingUI();
+
+    if (m_torusTessellationM != m_torus.getTessellationM()
+        || m_torusTessellationN != m_torus.getTessellationN())
+    {
+        m_torus.setTessellation(m_torusTessellationN, m_torusTessellationM);
+    }
+}
+
+void VRSDemo::reloadShaders()
+{
+    m_edgeRefiner->reloadShaders();
+    m_depthOfFieldRater->reloadShaders();
+    if (m_oit)
+    {
+        m_oit->reloadShaders();
+    }
+    if (m_occlusionCuller)
+    {
+        m_occlusionCuller->reloadShaders();
+    }
+}
+
+void VRSDemo::storeTraceSettings(TraceSettings& settings)
+{
+    GLDemo::storeTraceSettings(settings);
+
+    settings.sceneMode = m_sceneMode;
+    settings.meshInstances = m_meshInstances;
+    settings.shadingMode = m_selectedShadingMode;
+    settings.overlayMode = m_overlayMode;
+    settings.activateShadingRate = m_activateShadingRate ? 1 : 0;
+    settings.fullShadingRateForGreenObjects = m_fullShadingRateForGreenObjects ? 1 : 0;
+    settings.dynamicFoveation = m_dynamicFoveation ? 1 : 0;
+    settings.useShaderPermutations = m_useShaderPermutations ? 1 : 0;
+    settings.targetMilliseconds = m_foveationController.m_settings.targetMilliseconds;
+    for (int i = 0; i < 3; ++i)
+    {
+        settings.foveationRadii[i] = m_foveationParams.radii[i];
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        settings.foveationRates[i] = m_foveationParams.rates[i];
+    }
+    settings.edgePolicy = m_edgeRefinement.policy;
+    settings.edgeThresholds[0] = m_edgeRefinement.depthThreshold;
+    settings.edgeThresholds[1] = m_edgeRefinement.creaseThreshold;
+    settings.edgeRates[0] = m_edgeRefinement.silhouetteRate;
+    settings.edgeRates[1] = m_edgeRefinement.creaseRate;
+    settings.texturedMaterial = m_texturedMaterial ? 1 : 0;
+    settings.measureTextureTraffic = m_measureTextureTraffic ? 1 : 0;
+    settings.lodBiasScale = m_lodBiasScale;
+    settings.oitCapacityMillions = m_oitCapacityMillions;
+    settings.oitMaxSamples = m_oitMaxSamples;
+    settings.oitVisualizeSampleCount = m_oitVisualizeSampleCount ? 1 : 0;
+    settings.oitVisualizeShadingRate = m_oitVisualizeShadingRate ? 1 : 0;
+    settings.torusPath = uint8_t(m_torusPath);
+    settings.tessellationRateDriven = m_tessellation.rateDriven ? 1 : 0;
+    settings.meshletConeCulling = m_meshletConeCulling ? 1 : 0;
+    settings.unifiedDraws = m_useUnifiedDraws ? 1 : 0;
+    settings.occlusionCulling = m_occlusionCulling ? 1 : 0;
+    settings.halfPrecisionMaterial = m_halfPrecisionMaterial ? 1 : 0;
+    settings.depthOfFieldRates = m_depthOfField.enabled ? 1 : 0;
+    settings.gazeFoveation = m_gazeFoveation ? 1 : 0;
+    settings.depthOfFieldLens[0] = m_depthOfField.focusDistance;
+    settings.depthOfFieldLens[1] = m_depthOfField.infinityBlurPixels;
+    settings.depthOfFieldThresholds[0] = m_depthOfField.cocThresholds[0];
+    settings.depthOfFieldThresholds[1] = m_depthOfField.cocThresholds[1];
+    settings.tessellationPatches[0] = m_tessellation.ringPatches;
+    settings.tessellationPatches[1] = m_tessellation.tubePatches;
+    settings.tessellationTargetPixels = m_tessellation.targetEdgePixels;
+    settings.tessellationMaxFactor = m_tessellation.maxFactor;
+}
+
+void VRSDemo::applyTraceSettings(const TraceSettings& settings)
+{
+    GLDemo::applyTraceSettings(settings);
+
+    // clamped to the ranges of the UI controls, so a corrupt trace cannot index out of the per-mode arrays
+    m_sceneMode = clampTraceSetting(settings.sceneMode, 0, SCENE_MODE_COUNT - 1);
+    m_meshInstances = clampTraceSetting(settings.meshInstances, 1, 100000);
+    m_selectedShadingMode = clampTraceSetting(settings.shadingMode, 0, SHADING_MODE_COUNT - 1);
+    m_overlayMode = clampTraceSetting(settings.overlayMode, 0, int(RateOverlay::OVERLAY_MODE_COUNT) - 1);
+    m_activateShadingRate = settings.activateShadingRate != 0;
+    m_fullShadingRateForGreenObjects = settings.fullShadingRateForGreenObjects != 0;
+    if (m_dynamicFoveation != (settings.dynamicFoveation != 0))
+    {
+        m_dynamicFoveation = settings.dynamicFoveation != 0;
+        m_foveationController.reset();
+    }
+    m_useShaderPermutations = settings.useShaderPermutations != 0;
+    m_foveationController.m_settings.targetMilliseconds = clampTraceSetting(settings.targetMilliseconds, 0.5f, 50.0f);
+    // ascending radii and palette entries, as loadFoveationPresets requires
+    float previousRadius = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        m_foveationParams.radii[i] = clampTraceSetting(settings.foveationRadii[i], previousRadius, 2.0f);
+        previousRadius = m_foveationParams.radii[i];
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        m_foveationParams.rates[i] = clampTraceSetting(settings.foveationRates[i], uint8_t(RATE_NO_INVOCATIONS), uint8_t(RATE_4X4));
+    }
+    m_edgeRefinement.policy = clampTraceSetting(settings.edgePolicy, 0, int(EDGE_POLICY_COUNT) - 1);
+    m_edgeRefinement.depthThreshold = clampTraceSetting(settings.edgeThresholds[0], 0.005f, 0.5f);
+    m_edgeRefinement.creaseThreshold = clampTraceSetting(settings.edgeThresholds[1], 0.001f, 0.1f);
+    m_edgeRefinement.silhouetteRate = clampTraceSetting(settings.edgeRates[0], uint8_t(RATE_1X1), uint8_t(RATE_4X4));
+    m_edgeRefinement.creaseRate = clampTraceSetting(settings.edgeRates[1], uint8_t(RATE_1X1), uint8_t(RATE_4X4));
+    m_texturedMaterial = settings.texturedMaterial != 0;
+    m_measureTextureTraffic = settings.measureTextureTraffic != 0;
+    m_lodBiasScale = clampTraceSetting(settings.lodBiasScale, 0.0f, 2.0f);
+    m_oitCapacityMillions = clampTraceSetting(settings.oitCapacityMillions, 1, 64);
+    m_oitMaxSamples = clampTraceSetting(settings.oitMaxSamples, 1, OIT_MAX_SAMPLES);
+    m_oitVisualizeSampleCount = settings.oitVisualizeSampleCount != 0;
+    m_oitVisualizeShadingRate = settings.oitVisualizeShadingRate != 0;
+    m_torusPath = clampTraceSetting(int(settings.torusPath), 0, (m_meshShadersSupported ? TORUS_PATH_COUNT : TORUS_PATH_MESHLETS) - 1);
+    m_tessellation.rateDriven = settings.tessellationRateDriven != 0;
+    m_meshletConeCulling = settings.meshletConeCulling != 0;
+    m_useUnifiedDraws = settings.unifiedDraws != 0;
+    m_occlusionCulling = settings.occlusionCulling != 0;
+    m_halfPrecisionMaterial = settings.halfPrecisionMaterial != 0;
+    m_depthOfField.enabled = settings.depthOfFieldRates != 0;
+    m_gazeFoveation = settings.gazeFoveation != 0;
+    m_depthOfField.focusDistance = clampTraceSetting(settings.depthOfFieldLens[0], 0.1f, 10.0f);
+    m_depthOfField.infinityBlurPixels = clampTraceSetting(settings.depthOfFieldLens[1], 1.0f, 64.0f);
+    m_depthOfField.cocThresholds[0] = clampTraceSetting(settings.depthOfFieldThresholds[0], 0.5f, 16.0f);
+    m_depthOfField.cocThresholds[1] = clampTraceSetting(settings.depthOfFieldThresholds[1], m_depthOfField.cocThresholds[0], 16.0f);
+    m_tessellation.ringPatches = clampTraceSetting(settings.tessellationPatches[0], 1, 64);
+    m_tessellation.tubePatches = clampTraceSetting(settings.tessellationPatches[1], 1, 32);
+    m_tessellation.targetEdgePixels = clampTraceSetting(settings.tessellationTargetPixels, 1.0f, 64.0f);
+    m_tessellation.maxFactor = clampTraceSetting(settings.tessellationMaxFactor, 1.0f, 64.0f);
+}
+
+void VRSDemo::processRateStatisticsUI()
+{
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(30, 600), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Rate statistics", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        const ShadingRateStats& stats = getSelectedRateStats();
+        ImGui::Text("1x1: %5.1f %%", stats.getFraction(RATE_1X1) * 100.0f);
+        ImGui::Text("2x2: %5.1f %%", stats.getFraction(RATE_2X2) * 100.0f);
+        ImGui::Text("4x4: %5.1f %%", stats.getFraction(RATE_4X4) * 100.0f);
+        ImGui::Text("no invocations: %5.1f %%", stats.getNoInvocationFraction(m_rateCost) * 100.0f);
+
+        float predicted = m_activateShadingRate ? stats.getPredictedInvocationsPerPixel(m_rateCost) : 1.0f;
+        ImGui::Text("Predicted invocations per pixel: %.3f", predicted);
+        ImGui::SameLine(); HelpMarker("From the shading rate image and the palette only, "
+            "the full rate green objects and overdraw are not included.");
+
+        // savings relative to full rate, measured with the 1x1 image or with VRS disabled
+        const double* measured = isTexturedMaterialActive() ? m_texturedSceneMilliseconds : m_measuredSceneMilliseconds;
+        double full = measured[SHADING_MODE_1X1];
+        if (full == 0.0)
+        {
+            full = measured[SHADING_MODE_COUNT];
+        }
+        double current = measured[m_activateShadingRate ? m_selectedShadingMode : SHADING_MODE_COUNT];
+        ImGui::Text("Predicted saving: %5.1f %%", (1.0f - predicted) * 100.0f);
+        if (full > 0.0 && current > 0.0)
+        {
+            ImGui::Text("Measured saving:  %5.1f %% (%.3f ms of %.3f ms)", (1.0 - current / full) * 100.0, current, full);
+        }
+        else
+        {
+            ImGui::TextDisabled("Measured saving: run with the 1x1 rate or VRS disabled first");
+        }
+
+        ImGui::Checkbox("Log per frame", &m_logRateStatistics);
+    }
+    ImGui::End();
+}
+
+void VRSDemo::processTextureTrafficUI()
+{
+    if (!isTexturedMaterialActive() || !m_materialTextures)
+    {
+        return;
     }
 
-    glEnable(GL_SHADING_RATE_IMAGE_PER_PRIMITIVE_NV);
-
-    glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV, &m_shadingRateImageTexelHeight);
-    LOGOK("\nGL_SHADING_RATE_IMAGE_TEXEL_HEIGHT_NV = %d\n", m_shadingRateImageTexelHeight);
-    glGetIntegerv(GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV, &m_shadingRateImageTexelWidth);
-    LOGOK("GL_SHADING_RATE_IMAGE_TEXEL_WIDTH_NV = %d\n", m_shadingRateImageTexelWidth);
-
-    setupShadingRatePalette();
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(30, 800), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Texture traffic", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        ImGui::Text("%u x %u, %u mips, LOD bias %.2f per rate step", m_materialTextures->getSize(), m_materialTextures->getSize(),
+            m_materialTextures->getMipLevels(), m_lodBiasScale);
 
-    return true;
+        // changes relative to full rate, measured with the 1x1 image or with VRS disabled
+        int reference = m_textureMegabytes[SHADING_MODE_1X1] > 0.0 || m_texturedSceneMilliseconds[SHADING_MODE_1X1] > 0.0
+            ? SHADING_MODE_1X1 : SHADING_MODE_COUNT;
+        for (int mode = 0; mode <= SHADING_MODE_COUNT; ++mode)
+        {
+            std::string traffic = formatMeasurement(m_textureMegabytes[mode], mode != reference ? m_textureMegabytes[reference] : 0.0, "MB");
+            std::string time = formatMeasurement(m_texturedSceneMilliseconds[mode], mode != reference ? m_texturedSceneMilliseconds[reference] : 0.0, "ms");
+            ImGui::Text("%-20s %-22s %s", mode < SHADING_MODE_COUNT ? SHADING_MODE_NAMES[mode] : "VRS disabled", traffic.c_str(), time.c_str());
+        }
+        ImGui::SameLine(); HelpMarker("Estimated texture reads per frame and scene time per shading mode. The traffic "
+            "counts the texels under each invocation in the mip level it fetches, without cache effects; "
+            "the time is only recorded while the traffic is not measured.");
+    }
+    ImGui::End();
 }
 
-void VRSDemo::end()
+void VRSDemo::processTessellationUI()
 {
-    nvgl::deleteTexture(m_shadingRateImageVarying);
-    nvgl::deleteTexture(m_shadingRateImageMouseTracking);
-    nvgl::deleteTexture(m_shadingRateImage1X1);
-    nvgl::deleteTexture(m_shadingRateImage2X2);
-    nvgl::deleteTexture(m_shadingRateImage4X4);
-    GLDemo::end();
-}
+    if (!isTessellationActive())
+    {
+        return;
+    }
 
-void VRSDemo::renderFrame(double time, uint32_t width, uint32_t height, GLuint fbo)
-{
-    updateTextures(width, height);
-    bindShadingRateTexture();
-    glViewport(0, 0, width, height);
-    updatePerFrameUniforms(width, height);
-    m_pipeline->setShaderProgram();
-    m_pipeline->updateSceneUniforms();
-    renderTori(m_numberOfTori);
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(400, 800), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Tessellation", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        ImGui::Text("%d patches per torus, %llu triangles this frame", int(m_tessellatedTorus.getPatchCount()),
+            (unsigned long long)m_primitiveCounter.getValue());
 
-    glDisable(GL_SHADING_RATE_IMAGE_NV);
+        // changes relative to full rate, like the texture traffic
+        int reference = m_tessellatedTriangles[SHADING_MODE_1X1] > 0.0 ? SHADING_MODE_1X1 : SHADING_MODE_COUNT;
+        for (int mode = 0; mode <= SHADING_MODE_COUNT; ++mode)
+        {
+            std::string triangles = formatMeasurement(m_tessellatedTriangles[mode] / 1000.0,
+                mode != reference ? m_tessellatedTriangles[reference] / 1000.0 : 0.0, "k");
+            ImGui::Text("%-20s %s", mode < SHADING_MODE_COUNT ? SHADING_MODE_NAMES[mode] : "VRS disabled", triangles.c_str());
+        }
+        ImGui::SameLine(); HelpMarker("Triangles per frame out of the tessellator per shading mode, before clipping. "
+            "Without rate-driven factors only the culled patches differ between the modes.");
+    }
+    ImGui::End();
 }
 
-void VRSDemo::bindShadingRateTexture()
+void VRSDemo::processMeshletUI()
 {
-    //////////// ShadingRateSample ////////////
-    // 
-    // setting the shading rate image:
-    // 
-    
-    switch (m_selectedShadingMode)
+    if (!isMeshletPathActive())
     {
-    case SHADING_MODE_VARYING:
-        glBindShadingRateImageNV(m_shadingRateImageVarying);
-        break;
-    case SHADING_MODE_1X1:
-        glBindShadingRateImageNV(m_shadingRateImage1X1);
-        break;    
-    case SHADING_MODE_2X2:
-        glBindShadingRateImageNV(m_shadingRateImage2X2);
-        break;
-    case SHADING_MODE_4X4:
-    default:
-        glBindShadingRateImageNV(m_shadingRateImage4X4);
+        return;
     }
 
-    if (m_activateShadingRate)
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(400, 800), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Meshlets", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        // independent on the set shading rate image and palette all you need to switch
-        // back to full shading rate is one enable / disable:
-        glEnable(GL_SHADING_RATE_IMAGE_NV);
+        addOpaquePanel();
+        uint32_t drawn = m_meshletCounters.getValue(0);
+        uint32_t frustum = m_meshletCounters.getValue(1);
+        uint32_t cone = m_meshletCounters.getValue(2);
+        uint32_t rate = m_meshletCounters.getValue(3);
+        uint32_t total = drawn + frustum + cone + rate;
+        ImGui::Text("%d meshlets per torus, %u this frame", int(m_torus.getMeshletCount()), total);
+        ImGui::Text("drawn %u, culled by frustum %u, cone %u, rate %u", drawn, frustum, cone, rate);
+
+        // changes relative to full rate, like the tessellated triangles
+        int reference = m_drawnMeshlets[SHADING_MODE_1X1] > 0.0 ? SHADING_MODE_1X1 : SHADING_MODE_COUNT;
+        for (int mode = 0; mode <= SHADING_MODE_COUNT; ++mode)
+        {
+            std::string meshlets = formatMeasurement(m_drawnMeshlets[mode] / 1000.0,
+                mode != reference ? m_drawnMeshlets[reference] / 1000.0 : 0.0, "k");
+            ImGui::Text("%-20s %s", mode < SHADING_MODE_COUNT ? SHADING_MODE_NAMES[mode] : "VRS disabled", meshlets.c_str());
+        }
+        ImGui::SameLine(); HelpMarker("Meshlets per frame that survive the task shader, per shading mode. Only the "
+            "culling by tiles without invocations differs between the modes.");
     }
+    ImGui::End();
 }
 
-static void HelpMarker(const char* desc)
+void VRSDemo::processSubmissionUI()
 {
-    ImGui::TextDisabled("(?)");
-    if (ImGui::IsItemHovered())
+    if (isMeshSceneActive())
     {
-        ImGui::BeginTooltip();
-        ImGui::PushTextWrapPos(ImGui::GetFontSize() * 35.0f);
-        ImGui::TextUnformatted(desc);
-        ImGui::PopTextWrapPos();
-        ImGui::EndTooltip();
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(760, 800), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Draw submission", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        if (UnifiedDraws::isSupported())
+        {
+            ImGui::Checkbox("Unified memory draws", &m_useUnifiedDraws);
+            ImGui::SameLine(); HelpMarker("Sets the object uniforms and the vertex and index buffers of each torus draw by "
+                "GPU address (GL_NV_uniform_buffer_unified_memory, GL_NV_vertex_buffer_unified_memory) instead of "
+                "uploading and binding them. Only for the opaque tori drawn by the vertex shader.");
+        }
+        else
+        {
+            ImGui::TextUnformatted("No unified memory extensions, the draws use bound buffers");
+        }
+        ImGui::Text("%d draws, %.3f ms CPU submission%s", m_numberOfTori, m_submissionMilliseconds,
+            isUnifiedDrawActive() ? " (unified)" : "");
+
+        ImGui::Checkbox("Sort draws", &m_sortDraws);
+        ImGui::SameLine(); HelpMarker("Submits the tori sorted by a 64 bit key per draw (see RenderQueue), front to back "
+            "instead of in grid order. Fewer samples pass the depth test, so fewer get shaded.");
+        ImGui::Text("Key sort: %.3f ms, %u radix passes", m_sortMilliseconds, m_renderQueue.getSortPasses());
+        std::string gridOrder = formatMeasurement(m_samplesPerPixel[0], 0.0, "per pixel");
+        std::string sorted = formatMeasurement(m_samplesPerPixel[1], m_samplesPerPixel[0], "per pixel");
+        ImGui::Text("Samples passing the depth test: grid order %s, sorted %s", gridOrder.c_str(), sorted.c_str());
+
+        if (m_submissionSweepStep >= 0)
+        {
+            ImGui::Text("Sweeping %d draws, %s buffers...", SUBMISSION_DRAW_COUNTS[m_submissionSweepStep / 2],
+                m_submissionSweepStep % 2 ? "unified" : "bound");
+        }
+        else if (ImGui::Button("Sweep 1k / 10k / 100k draws"))
+        {
+            m_submissionSweepSavedTori = m_numberOfTori;
+            m_submissionSweepSavedUnified = m_useUnifiedDraws;
+            m_submissionSweepStep = 0;
+            m_submissionSweepFrames = 0;
+            m_submissionSweepSum = 0.0;
+        }
+
+        for (int count = 0; count < SUBMISSION_SWEEP_COUNTS; ++count)
+        {
+            const double* milliseconds = m_submissionSweepMilliseconds[count];
+            std::string bound = formatMeasurement(milliseconds[0], 0.0, "ms");
+            std::string unified = formatMeasurement(milliseconds[1], milliseconds[0], "ms");
+            ImGui::Text("%6d draws  bound %-12s unified %s", SUBMISSION_DRAW_COUNTS[count], bound.c_str(), unified.c_str());
+        }
+        ImGui::SameLine(); HelpMarker("CPU time of submitting the tori per frame, averaged over 30 frames, with bound "
+            "buffers and with unified memory. The GPU time is in the scene pass. The unified column stays empty "
+            "without the extensions or with another torus geometry.");
     }
+    ImGui::End();
 }
 
-void VRSDemo::processUI(double time)
+void VRSDemo::processCullingUI()
 {
-    GLDemo::processUI(time);
+    if (isMeshSceneActive())
+    {
+        return;
+    }
 
-    if (ImGui::Begin("VRS Demo Settings", nullptr))
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(1120, 800), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Occlusion culling", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        ImGui::TextUnformatted("Input manually with CTRL+Click");
+        addOpaquePanel();
+        ImGui::Checkbox("Hi-Z occlusion culling", &m_occlusionCulling);
+        ImGui::SameLine(); HelpMarker("Tests the bounds of each torus in a compute shader against the frustum and a depth "
+            "pyramid of the previous frame, and draws the survivors with one indirect draw. The tori rejected by the "
+            "old depth are tested again against a pyramid of what the first draw rendered, the newly visible ones are "
+            "drawn in a second indirect draw. Only for the opaque tori drawn by the vertex shader.");
+        if (m_occlusionCulling && !isOcclusionCullingActive())
+        {
+            ImGui::TextUnformatted("Inactive with transparent tori, tessellation and meshlets");
+        }
 
-        ImGui::SliderInt("Tori", &m_numberOfTori, 1, 1000, "%d", ImGuiSliderFlags_None);
-        ImGui::SameLine(); HelpMarker("Input manually with CTRL+Click.");
+        if (ImGui::Button("View along the grid"))
+        {
+            // grazing along the rows, most tori hide behind their neighbours
+            m_control.m_viewMatrix = glm::lookAt(glm::vec3(-0.75f, 0.02f, 0.1f), glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0, 1, 0));
+        }
 
-        ImGui::SliderInt("Fragment load", &m_fragmentLoad, 1, 250, "%d", ImGuiSliderFlags_None);
+        if (isOcclusionCullingActive())
+        {
+            uint32_t visible = m_occlusionCuller->getCount(OCCLUSION_VISIBLE);
+            uint32_t late = m_occlusionCuller->getCount(OCCLUSION_VISIBLE_LATE);
+            uint32_t occluded = m_occlusionCuller->getCount(OCCLUSION_OCCLUDED);
+            uint32_t outside = m_occlusionCuller->getCount(OCCLUSION_OUTSIDE_FRUSTUM);
+            ImGui::Text("drawn %u + %u newly visible", visible, late);
+            ImGui::Text("culled %u occluded, %u outside the frustum", occluded, outside);
+        }
 
-        ImGui::SliderInt("Torus tessellation N", &m_torusTessellationN, 3, 64, "%d", ImGuiSliderFlags_None);
-        ImGui::SliderInt("Torus tessellation M", &m_torusTessellationM, 3, 64, "%d", ImGuiSliderFlags_None);
-        ImGui::Text("Triangle count per torus: %d", (int)m_torus.getTriangleCount());
+        std::string off = formatMeasurement(m_cullingSceneMilliseconds[0], 0.0, "ms");
+        std::string on = formatMeasurement(m_cullingSceneMilliseconds[1], m_cullingSceneMilliseconds[0], "ms");
+        ImGui::Text("scene without culling %s", off.c_str());
+        ImGui::Text("scene with culling    %s", on.c_str());
+        ImGui::SameLine(); HelpMarker("GPU time of the scene pass with the untextured opaque tori on the vertex path, "
+            "including the culling passes. Compare at the same view and torus count.");
+    }
+    ImGui::End();
+}
 
-        ImGui::Separator();
+void VRSDemo::processTransparencyUI()
+{
+    if (!isTransparentSceneActive() || !m_oit)
+    {
+        return;
+    }
 
-        ImGui::ListBox("Shading mode", &m_selectedShadingMode, SHADING_MODE_NAMES, SHADING_MODE_COUNT, SHADING_MODE_COUNT);
+    const double MEGABYTE = 1024.0 * 1024.0;
+    const double bytesPerFragment = double(OITRenderer::BYTES_PER_FRAGMENT);
 
-        ImGui::Checkbox("Enable VRS", &m_activateShadingRate);
-        ImGui::Checkbox("visualize ShadingRate", &m_visualizeShadingRate);
-        ImGui::Checkbox("full ShadingRate for green objects", &m_fullShadingRateForGreenObjects);
+    ImGui::SetNextWindowPos(ImGuiH::dpiScaled(400, 600), ImGuiCond_FirstUseEver);
+    setNextPanelOpaque();
+    if (ImGui::Begin("Transparency", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        ImGui::Text("Allocated: %.1f MB (fragment buffer and list heads)", m_oit->getAllocatedBytes() / MEGABYTE);
+        ImGui::Text("Stored:    %u fragments, %.1f MB", m_oit->getStoredFragments(), m_oit->getStoredFragments() * bytesPerFragment / MEGABYTE);
+        if (m_oit->getOverflowFragments() > 0)
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Overflow:  %u fragments", m_oit->getOverflowFragments());
+        }
+        else
+        {
+            ImGui::Text("Overflow:  none");
+        }
+        ImGui::Text("Beyond %d samples per pixel: %u fragments", m_oitMaxSamples, m_oit->getDroppedFragments());
+        ImGui::Text("Store (scene pass): %.3f ms, resolve: %.3f ms", m_sceneTimer.getMilliseconds(), m_oit->getResolveMilliseconds());
+
+        ImGui::Separator();
+        ImGui::TextUnformatted("High-water per shading mode:");
+        for (int mode = 0; mode <= SHADING_MODE_COUNT; ++mode)
+        {
+            const char* name = mode < SHADING_MODE_COUNT ? SHADING_MODE_NAMES[mode] : "VRS disabled";
+            if (m_oitHighWater[mode] == 0 && m_oitMaxOverflow[mode] == 0)
+            {
+                ImGui::TextDisabled("%-20s -", name);
+                continue;
+            }
+            ImGui::Text("%-20s %7.1f MB (%5.1f %%), overflow %u", name, m_oitHighWater[mode] * bytesPerFragment / MEGABYTE,
+                100.0 * m_oitHighWater[mode] / std::max(m_oit->getCapacity(), 1u), m_oitMaxOverflow[mode]);
+        }
+        if (ImGui::Button("Reset high-water"))
+        {
+            std::fill(std::begin(m_oitHighWater), std::end(m_oitHighWater), 0u);
+            std::fill(std::begin(m_oitMaxOverflow), std::end(m_oitMaxOverflow), 0u);
+        }
     }
     ImGui::End();
+}
 
-    if (m_torusTessellationM != m_torus.getTessellationM()
-        || m_torusTessellationN != m_torus.getTessellationN())
+void VRSDemo::processOverlayLegend()
+{
+    if (m_overlayMode == RateOverlay::OVERLAY_OFF)
     {
-        m_torus.setTessellation(m_torusTessellationN, m_torusTessellationM);
+        return;
+    }
+
+    setNextPanelOpaque();
+    if (ImGui::Begin("Overlay legend", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        addOpaquePanel();
+        for (const RateOverlay::LegendEntry& entry : m_rateOverlay->getLegend(RateOverlay::Mode(m_overlayMode)))
+        {
+            ImGui::ColorButton(entry.label.c_str(), ImVec4(entry.color.x, entry.color.y, entry.color.z, 1.0f), ImGuiColorEditFlags_NoTooltip);
+            ImGui::SameLine();
+            ImGui::TextUnformatted(entry.label.c_str());
+        }
     }
+    ImGui::End();
 }
 
 void VRSDemo::updatePerFrameUniforms(uint32_t width, uint32_t height)
@@ -167,16 +1449,42 @@ void VRSDemo::updatePerFrameUniforms(uint32_t width, uint32_t height)
     m_pipeline->sceneData.eyePos_view = eyePos_view;
     m_pipeline->sceneData.loadFactor = m_numberOfTori;
     m_pipeline->sceneData.fragmentLoadFactor = m_fragmentLoad;
-    m_pipeline->sceneData.visualizeShadingRate = m_visualizeShadingRate ? 1 : 0;
     m_pipeline->sceneData.fullShadingRateForGreenObjects = m_fullShadingRateForGreenObjects ? 1 : 0;
+    m_pipeline->sceneData.lodBiasScale = m_lodBiasScale;
 
     m_pipeline->setProjectionMatrix(proj);
+    m_projectionMatrix = proj;
     m_pipeline->setViewMatrix(m_control.m_viewMatrix);
 
     // upload to GPU:
     m_pipeline->updateSceneUniforms();
 }
 
+void VRSDemo::updatePermutation()
+{
+    ScenePermutation permutation;
+    permutation.dynamic = !m_useShaderPermutations;
+    permutation.countInvocations = m_overlayMode == RateOverlay::OVERLAY_INVOCATIONS;
+    permutation.instanced = isMeshSceneActive() || isOcclusionCullingActive();
+    permutation.texturedMaterial = isTexturedMaterialActive();
+    permutation.measureTextureTraffic = isMeasuringTextureTraffic();
+    permutation.transparent = isTransparentSceneActive();
+    permutation.tessellated = isTessellationActive();
+    permutation.meshShader = isMeshletPathActive();
+    permutation.halfPrecision = isHalfPrecisionMaterialActive();
+    permutation.fullShadingRateForGreenObjects = m_fullShadingRateForGreenObjects;
+    permutation.fragmentLoad = m_fragmentLoad;
+
+    m_pipeline->setPermutation(permutation);
+
+    if (permutation.getKey() != m_permutationKey)
+    {
+        m_permutationKey = permutation.getKey();
+        m_framesWithSamePermutation = 0;
+    }
+    ++m_framesWithSamePermutation;
+}
+
 void VRSDemo::updateTextures(uint32_t width, uint32_t height)
 {
     uint32_t textureWidth = (width + m_shadingRateImageTexelWidth - 1) / m_shadingRateImageTexelWidth;
@@ -184,6 +1492,11 @@ void VRSDemo::updateTextures(uint32_t width, uint32_t height)
 
     if (textureWidth == m_shadingRateImageWidth && textureHeight == m_shadingRateImageHeight)
     {
+        // the partially covered texels at the edge change with the framebuffer size
+        if (width != m_rateStatsFramebufferWidth || height != m_rateStatsFramebufferHeight)
+        {
+            buildRateStatistics(width, height);
+        }
         return;
     }
 
@@ -197,14 +1510,39 @@ void VRSDemo::updateTextures(uint32_t width, uint32_t height)
     nvgl::newTexture(m_shadingRateImage1X1, GL_TEXTURE_2D);
     nvgl::newTexture(m_shadingRateImage2X2, GL_TEXTURE_2D);
     nvgl::newTexture(m_shadingRateImage4X4, GL_TEXTURE_2D);
+    nvgl::newTexture(m_shadingRateImageHmdProfile, GL_TEXTURE_2D);
+    nvgl::newTexture(m_shadingRateImageComposited, GL_TEXTURE_2D);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
     //
-    // The first shading rate image will have the full resolution
-    // in the center and a lower rate towards the edges.
+    // Three images have a constant value. This could also simply be
+    // done by different palettes but we wanted to show how to change to a
+    // completely different shading rate image here.
+    //
+    createConstantFoveationTexture(1);
+    uploadFoveationDataToTexture(m_shadingRateImage1X1);
+
+    createConstantFoveationTexture(2);
+    uploadFoveationDataToTexture(m_shadingRateImage2X2);
+
+    createConstantFoveationTexture(3);
+    uploadFoveationDataToTexture(m_shadingRateImage4X4);
+
+    //
+    // The HMD profile matches the rates to the lens distortion of a headset,
+    // resampled from the profile to the size of the shading rate image.
+    //
+    fillHmdProfileRates(m_shadingRateImageData.data());
+    uploadFoveationDataToTexture(m_shadingRateImageHmdProfile);
+
+    //
+    // The varying shading rate image will have the full resolution
+    // in the center and a lower rate towards the edges. It is created
+    // last, so m_shadingRateImageData keeps its content for the
+    // incremental updates in updateFoveationTexture().
     //
-    createFoveationTexture(0.5f, 0.5f);
+    createFoveationTexture(m_appliedFoveationCenter.x, m_appliedFoveationCenter.y);
     uploadFoveationDataToTexture(m_shadingRateImageVarying);
 
     //
@@ -215,74 +1553,167 @@ void VRSDemo::updateTextures(uint32_t width, uint32_t height)
     uploadFoveationDataToTexture(m_shadingRateImageMouseTracking);
 
     //
-    // The remaining three images have a constant value. This could also simply be
-    // done by different palettes but we wanted to show how to change to a
-    // completely different shading rate image here.
+    // The composited image starts as a copy of the varying one, the panels
+    // are stamped in with incremental updates each frame.
     //
-    createConstantFoveationTexture(1);
-    uploadFoveationDataToTexture(m_shadingRateImage1X1);
-
-    createConstantFoveationTexture(2);
-    uploadFoveationDataToTexture(m_shadingRateImage2X2);
-
-    createConstantFoveationTexture(3);
-    uploadFoveationDataToTexture(m_shadingRateImage4X4);
+    m_compositedRates = m_shadingRateImageData;
+    uploadFoveationDataToTexture(m_shadingRateImageComposited);
 
     GLenum errorCode = glGetError(); assert(errorCode == GL_NO_ERROR); // verify there are no errors during development
 
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    buildRateStatistics(width, height);
+}
+
+void VRSDemo::buildRateStatistics(uint32_t width, uint32_t height)
+{
+    m_rateStatsFramebufferWidth = width;
+    m_rateStatsFramebufferHeight = height;
+
+    for (ShadingRateStats& stats : m_rateStats)
+    {
+        stats.setLayout(m_shadingRateImageWidth, m_shadingRateImageHeight, m_shadingRateImageTexelWidth,
+            m_shadingRateImageTexelHeight, width, height);
+    }
+    m_compositedStats.setLayout(m_shadingRateImageWidth, m_shadingRateImageHeight, m_shadingRateImageTexelWidth,
+        m_shadingRateImageTexelHeight, width, height);
+    m_compositedStats.build(m_compositedRates.data());
+
+    m_rateStats[SHADING_MODE_VARYING].build(m_shadingRateImageData.data());
+
+    const uint8_t constantRates[] = { RATE_1X1, RATE_2X2, RATE_4X4 };
+    const int constantModes[] = { SHADING_MODE_1X1, SHADING_MODE_2X2, SHADING_MODE_4X4 };
+    m_shadingRateImageScratch.resize(m_shadingRateImageData.size());
+    for (int i = 0; i < 3; ++i)
+    {
+        fillConstantRates(m_shadingRateImageScratch.data(), m_shadingRateImageWidth, m_shadingRateImageHeight, constantRates[i]);
+        m_rateStats[constantModes[i]].build(m_shadingRateImageScratch.data());
+    }
+
+    fillHmdProfileRates(m_shadingRateImageScratch.data());
+    m_rateStats[SHADING_MODE_HMD_PROFILE].build(m_shadingRateImageScratch.data());
 }
 
 void VRSDemo::createFoveationTexture(float centerX, float centerY)
 {
-    //////////// ShadingRateSample ////////////
-    // 
-    // Creates the data for a 'foveation' shading rate imaage. It will have a
-    // high resolution at the given center and a lower rate further away from
-    // the center. At the edges we also use the SHADE_NO_PIXELS_NV rate
-    // which will discard the full block. This is useful for areas in HMDs
-    // which won't end up on the screen anyway due to the lens distortions.
+    fillFoveationRates(m_shadingRateImageData.data(), m_shadingRateImageWidth, m_shadingRateImageHeight,
+        centerX, centerY, m_appliedFoveationParams);
+}
+
+void VRSDemo::updateFoveationTexture(const FoveationParams& params, const glm::vec2& center)
+{
+    if (memcmp(&params, &m_appliedFoveationParams, sizeof(FoveationParams)) == 0 && center == m_appliedFoveationCenter)
+    {
+        return;
+    }
+    m_appliedFoveationParams = params;
+    m_appliedFoveationCenter = center;
+
+    //
+    // Regenerate on the CPU and only upload the rectangle that changed.
+    // Moving the radii or the center a little only touches the texels
+    // along the rings.
     //
-    const int width = m_shadingRateImageWidth;
-    const int height = m_shadingRateImageHeight;
+    m_shadingRateImageScratch.resize(m_shadingRateImageData.size());
+    fillFoveationRates(m_shadingRateImageScratch.data(), m_shadingRateImageWidth, m_shadingRateImageHeight,
+        m_appliedFoveationCenter.x, m_appliedFoveationCenter.y, m_appliedFoveationParams);
+
+    RateRect dirty = diffRates(m_shadingRateImageData.data(), m_shadingRateImageScratch.data(),
+        m_shadingRateImageWidth, m_shadingRateImageHeight);
+    std::swap(m_shadingRateImageData, m_shadingRateImageScratch);
+
+    m_rateStats[SHADING_MODE_VARYING].update(m_shadingRateImageScratch.data(), m_shadingRateImageData.data(), dirty);
 
-    for (size_t y = 0; y < height; ++y)
+    uploadRateRect(m_shadingRateImageVarying, m_shadingRateImageData, dirty);
+}
+
+void VRSDemo::updateCompositedTexture(uint32_t width, uint32_t height)
+{
+    m_useCompositedImage = false;
+
+    getOpaquePanelRects(m_panelRects);
+    if (m_panelRects.empty() || !m_activateShadingRate)
     {
-        for (size_t x = 0; x < width; ++x)
-        {
-            float fx = x / (float)width;
-            float fy = y / (float)height;
+        return;
+    }
+
+    //
+    // Stamp the panels into a fresh copy of the selected image, so moving
+    // or closing a panel restores the rates of the generator underneath.
+    //
+    m_compositedScratch.resize(m_compositedRates.size());
+    fillShadingModeRates(m_selectedShadingMode, m_compositedScratch.data());
 
-            float d = std::sqrt((fx - centerX) * (fx - centerX) + (fy - centerY) * (fy - centerY));
+    RateRect stamped = stampRateRects(m_compositedScratch.data(), m_shadingRateImageWidth, m_shadingRateImageHeight,
+        m_shadingRateImageTexelWidth, m_shadingRateImageTexelHeight, width, height,
+        m_panelRects.data(), m_panelRects.size(), RATE_NO_INVOCATIONS);
+    if (stamped.isEmpty())
+    {
+        return;
+    }
+    m_useCompositedImage = true;
 
-            if (d < 0.15f)
-            {
-                m_shadingRateImageData[x + y * width] = 1;
-            }
-            else if (d < 0.3f)
-            {
-                m_shadingRateImageData[x + y * width] = 2;
-            }
-            else if (d < 0.45f)
-            {
-                m_shadingRateImageData[x + y * width] = 3;
-            }
-            else
-            {
-                m_shadingRateImageData[x + y * width] = 0;
-            }
-        }
+    RateRect dirty = diffRates(m_compositedRates.data(), m_compositedScratch.data(),
+        m_shadingRateImageWidth, m_shadingRateImageHeight);
+    std::swap(m_compositedRates, m_compositedScratch);
+
+    m_compositedStats.update(m_compositedScratch.data(), m_compositedRates.data(), dirty);
+    uploadRateRect(m_shadingRateImageComposited, m_compositedRates, dirty);
+}
+
+void VRSDemo::uploadRateRect(GLuint texture, const std::vector<uint8_t>& data, const RateRect& rect)
+{
+    if (rect.isEmpty())
+    {
+        return;
     }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_shadingRateImageWidth);
+    glTextureSubImage2D(texture, 0, rect.x, rect.y, rect.width, rect.height, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+        &data[rect.x + rect.y * m_shadingRateImageWidth]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
 
 void VRSDemo::createConstantFoveationTexture(uint8_t value)
 {
-    for (size_t y = 0; y < m_shadingRateImageHeight; ++y)
+    fillConstantRates(m_shadingRateImageData.data(), m_shadingRateImageWidth, m_shadingRateImageHeight, value);
+}
+
+void VRSDemo::fillHmdProfileRates(uint8_t* data)
+{
+    if (!m_hmdProfile.isOpen())
     {
-        for (size_t x = 0; x < m_shadingRateImageWidth; ++x)
-        {
-            m_shadingRateImageData[x + y * m_shadingRateImageWidth] = value;
-        }
+        fillFoveationRates(data, m_shadingRateImageWidth, m_shadingRateImageHeight, 0.5f, 0.5f, FoveationParams());
+        return;
+    }
+
+    // resampled once per resolution, resizing back and forth is a copy
+    const std::vector<uint8_t>& rates = m_hmdProfile.getRates(m_shadingRateImageWidth, m_shadingRateImageHeight);
+    memcpy(data, rates.data(), rates.size());
+}
+
+void VRSDemo::fillShadingModeRates(int shadingMode, uint8_t* data)
+{
+    switch (shadingMode)
+    {
+    case SHADING_MODE_VARYING:
+        memcpy(data, m_shadingRateImageData.data(), m_shadingRateImageData.size());
+        break;
+    case SHADING_MODE_1X1:
+        fillConstantRates(data, m_shadingRateImageWidth, m_shadingRateImageHeight, RATE_1X1);
+        break;
+    case SHADING_MODE_2X2:
+        fillConstantRates(data, m_shadingRateImageWidth, m_shadingRateImageHeight, RATE_2X2);
+        break;
+    case SHADING_MODE_HMD_PROFILE:
+        fillHmdProfileRates(data);
+        break;
+    case SHADING_MODE_4X4:
+    default:
+        fillConstantRates(data, m_shadingRateImageWidth, m_shadingRateImageHeight, RATE_4X4);
+        break;
     }
 }
 
@@ -324,6 +1755,12 @@ void VRSDemo::setupShadingRatePalette()
     }
 
     glShadingRateImagePaletteNV(0, 0, palSize, palette);
+
+    // cost model of the rate statistics
+    for (GLint i = 0; i < palSize && i < GLint(RATE_STATS_MAX_ENTRIES); ++i)
+    {
+        m_rateCost.invocationsPerPixel[i] = getInvocationsPerPixel(palette[i]);
+    }
     delete[] palette;
 
     //
@@ -21,6 +21,21 @@
 
 #include <glm/glm.hpp>
 #include "common.h"
+#include "DepthOfFieldRater.h"
+#include "EdgeRefiner.h"
+#include "FoveationController.h"
+#include "FoveationPresets.h"
+#include "GpuCounters.h"
+#include "GpuQueryCounter.h"
+#include "GpuTimer.h"
+#include "MaterialTextures.h"
+#include "MeshScene.h"
+#include "OcclusionCuller.h"
+#include "OITRenderer.h"
+#include "RateOverlay.h"
+#include "RateProfile.h"
+#include "ShadingRateImage.h"
+#include "ShadingRateStats.h"
 #include "VRSPipeline.h"
 
 #include <cstdint>
@@ -35,24 +50,186 @@ public:
     void renderFrame(double time, uint32_t width, uint32_t height, GLuint fbo) override;
 
 private:
+    //
+    // Everything the measured averages depend on besides the shading mode
+    // itself. Switching any of it restarts the lag of the timers and the
+    // counters, so no result of the previous settings is averaged in.
+    //
+    struct MeasuredSceneKey
+    {
+        int shadingMode = -1;   // SHADING_MODE_COUNT with VRS disabled
+        bool texturedMaterial = false;
+        bool textureTraffic = false;
+        bool transparentScene = false;
+        bool tessellation = false;
+        bool meshletPath = false;
+        bool occlusionCulling = false;
+        bool halfPrecisionMaterial = false;
+        bool sortDraws = false;
+
+        bool operator==(const MeasuredSceneKey& other) const
+        {
+            return shadingMode == other.shadingMode && texturedMaterial == other.texturedMaterial
+                && textureTraffic == other.textureTraffic && transparentScene == other.transparentScene
+                && tessellation == other.tessellation && meshletPath == other.meshletPath
+                && occlusionCulling == other.occlusionCulling && halfPrecisionMaterial == other.halfPrecisionMaterial
+                && sortDraws == other.sortDraws;
+        }
+        bool operator!=(const MeasuredSceneKey& other) const { return !(*this == other); }
+    };
+
     void processUI(double time) override;
+    void reloadShaders() override;
+    void storeTraceSettings(TraceSettings& settings) override;
+    void applyTraceSettings(const TraceSettings& settings) override;
+    GLuint getCaptureRateImage(uint32_t& width, uint32_t& height) override;
     void updatePerFrameUniforms(uint32_t width, uint32_t height);
+    void updatePermutation();
+    void updateMeshScene();
+    void renderScene(uint32_t width, uint32_t height);
+    bool isMeshSceneActive() const { return m_sceneMode == SCENE_MESH_BLOB && m_meshScene && m_meshScene->isLoaded(); }
+    bool isTransparentSceneActive() const { return m_sceneMode == SCENE_TRANSPARENT_TORI; }
+    // the mesh blob has no texture coordinates and stays untextured, the transparent tori have their own scene UBO
+    bool isTexturedMaterialActive() const { return m_texturedMaterial && !isMeshSceneActive() && !isTransparentSceneActive(); }
+    bool isMeasuringTextureTraffic() const { return isTexturedMaterialActive() && m_measureTextureTraffic; }
+    bool isHalfPrecisionMaterialActive() const { return m_halfPrecisionMaterial && m_halfPrecisionSupported; }
+    // the mesh blob keeps its triangles, all torus scenes can be tessellated or drawn as meshlets
+    bool isTessellationActive() const { return m_torusPath == TORUS_PATH_TESSELLATION && !isMeshSceneActive(); }
+    bool isMeshletPathActive() const { return m_torusPath == TORUS_PATH_MESHLETS && m_meshShadersSupported && !isMeshSceneActive(); }
+    TorusPath getActiveTorusPath() const
+    {
+        return isTessellationActive() ? TORUS_PATH_TESSELLATION : isMeshletPathActive() ? TORUS_PATH_MESHLETS : TORUS_PATH_VERTEX;
+    }
     void updateTextures(uint32_t width, uint32_t height);
+    void buildRateStatistics(uint32_t width, uint32_t height);
+    MeasuredSceneKey getMeasuredSceneKey() const;
+    void updateMeasuredSceneTime(bool newSceneTime);
+    // the timers and counters read back a few frames late, a result only belongs to the current scene key after that
+    bool isSettledResult(bool newResult) const { return newResult && m_framesWithSameSceneKey > MEASUREMENT_LAG_FRAMES; }
+    void updateMeasuredTextureTraffic();
+    void processRateStatisticsUI();
+    void processTextureTrafficUI();
+    void updateOITStatistics();
+    void processTransparencyUI();
+    void updateMeasuredTriangles();
+    void processTessellationUI();
+    void updateMeshletStatistics();
+    void updateOverdrawStatistics(uint32_t width, uint32_t height);
+    void processMeshletUI();
+    // the bound object buffer of the opaque scene is replaced, the transparent tori keep their own scene buffer
+    bool isUnifiedDrawActive() const
+    {
+        return m_useUnifiedDraws && UnifiedDraws::isSupported() && getActiveTorusPath() == TORUS_PATH_VERTEX && !isTransparentSceneActive()
+            && !isOcclusionCullingActive();
+    }
+    void applySubmissionSweep();
+    void updateSubmissionSweep(double milliseconds);
+    void processSubmissionUI();
+    // the transparent tori do not occlude, the other paths draw each torus themselves
+    bool isOcclusionCullingActive() const
+    {
+        return m_occlusionCulling && getActiveTorusPath() == TORUS_PATH_VERTEX && !isMeshSceneActive() && !isTransparentSceneActive();
+    }
+    void renderCulledTori(uint32_t width, uint32_t height);
+    void processCullingUI();
     void createFoveationTexture(float centerX, float centerY);
+    void updateFoveationTexture(const FoveationParams& params, const glm::vec2& center);
     void createConstantFoveationTexture(uint8_t value);
+    void fillHmdProfileRates(uint8_t* data);
+    void fillShadingModeRates(int shadingMode, uint8_t* data);
+    void updateCompositedTexture(uint32_t width, uint32_t height);
+    void uploadRateRect(GLuint texture, const std::vector<uint8_t>& data, const RateRect& rect);
     void uploadFoveationDataToTexture(GLuint texture);
     void setupShadingRatePalette();
     void bindShadingRateTexture();
+    GLuint getSelectedShadingRateImage() const;
+    // the selected image after the edge refinement, what the scene is rendered with
+    GLuint getActiveShadingRateImage() const { return m_refinedShadingRateImage ? m_refinedShadingRateImage : getSelectedShadingRateImage(); }
+    const ShadingRateStats& getSelectedRateStats() const;
+    void processOverlayLegend();
+
+    static const int SCENE_MODE_COUNT = 3;
+    const char* SCENE_MODE_NAMES[SCENE_MODE_COUNT] = { "Tori", "Mesh blob", "Transparent tori" };
+    static const int SCENE_TORI = 0;
+    static const int SCENE_MESH_BLOB = 1;
+    static const int SCENE_TRANSPARENT_TORI = 2;
+
+    // instanced meshes from a blob baked by tools/meshbaker, loaded on first use
+    std::unique_ptr< MeshScene > m_meshScene = nullptr;
+    bool m_meshSceneLoadFailed = false;
+    int m_sceneMode = SCENE_TORI;
+    int m_meshInstances = 1000;
+
+    // albedo and normal maps on the torus UVs, created on first use
+    std::unique_ptr< MaterialTextures > m_materialTextures = nullptr;
+    bool m_texturedMaterial = false;
+    bool m_measureTextureTraffic = false;
+    float m_lodBiasScale = 0.5f;
+    uint32_t m_textureTrafficResultCount = 0;
+
+    // float16 noise surflets and lighting in the scene program, see MaterialReference
+    bool m_halfPrecisionSupported = false;
+    bool m_halfPrecisionMaterial = false;
+    double m_materialSceneMilliseconds[2] = {};  // of the untextured opaque tori, with the fp32 and the fp16 material
+
+    // per-pixel fragment lists of the transparent tori, created on first use
+    std::unique_ptr< OITRenderer > m_oit = nullptr;
+    int m_oitCapacityMillions = 4;
+    int m_oitMaxSamples = 8;
+    bool m_oitVisualizeSampleCount = false;
+    bool m_oitVisualizeShadingRate = false;
+    uint32_t m_oitResultCount = 0;
+
+    // tori generated by the tessellation stages (see TessellatedTorus) or
+    // drawn as culled meshlets instead of the index buffer of m_torus
+    int m_torusPath = TORUS_PATH_VERTEX;
+    const char* TORUS_PATH_NAMES[TORUS_PATH_COUNT] = { "Vertex shader", "Hardware tessellation", "Meshlets" };
+    TessellationSettings m_tessellation;
+    GpuQueryCounter m_primitiveCounter;
+    bool m_meshShadersSupported = false;
+    bool m_meshletConeCulling = true;
+    GpuCounters m_meshletCounters{ 4 };     // drawn, frustum, cone and rate culled, see scene.task.glsl
+
+    // object and vertex buffers of the tori by GPU address, see UnifiedDraws
+    bool m_useUnifiedDraws = false;
+    double m_submissionMilliseconds = 0.0;  // CPU time of renderTori() in the last frame
+
+    // CPU submission time at each draw count, with bound and with unified buffers
+    static const int SUBMISSION_SWEEP_COUNTS = 3;
+    const int SUBMISSION_DRAW_COUNTS[SUBMISSION_SWEEP_COUNTS] = { 1000, 10000, 100000 };
+    double m_submissionSweepMilliseconds[SUBMISSION_SWEEP_COUNTS][2] = {};
+    int m_submissionSweepStep = -1;         // count * 2 + unified, -1 while not sweeping
+    uint32_t m_submissionSweepFrames = 0;
+    double m_submissionSweepSum = 0.0;
+    int m_submissionSweepSavedTori = 0;
+    bool m_submissionSweepSavedUnified = false;
+
+    // samples of the opaque tori passing the depth test per pixel, in grid
+    // order and sorted (see GLDemo::m_renderQueue), restart when the tori change
+    GpuQueryCounter m_samplesPassedCounter{ GL_SAMPLES_PASSED };
+    uint32_t m_samplesPassedResultCount = 0;
+    double m_samplesPerPixel[2] = {};
+    int m_overdrawTori = 0;
+    int m_overdrawTorusPath = TORUS_PATH_VERTEX;
+
+    // two phase Hi-Z occlusion culling of the tori, created on first use
+    std::unique_ptr< OcclusionCuller > m_occlusionCuller = nullptr;
+    bool m_occlusionCulling = false;
+    uint32_t m_culledToriCount = 0;         // what the culler holds, placed for the window size below
+    int m_culledToriWindow[2] = {};
+    uint32_t m_occlusionCulledFrame = ~0u;  // the pyramid is only valid if this was the previous frame
+    double m_cullingSceneMilliseconds[2] = {};   // of the tori on the vertex path, without and with culling
 
     uint32_t m_shadingRateImageWidth = 0;
     uint32_t m_shadingRateImageHeight = 0;
 
-    static const int SHADING_MODE_COUNT = 4;
-    const char* SHADING_MODE_NAMES[SHADING_MODE_COUNT] = { "Varying shading rate", "1x1 rate", "2x2 rate", "4x4 rate" };
+    static const int SHADING_MODE_COUNT = 5;
+    const char* SHADING_MODE_NAMES[SHADING_MODE_COUNT] = { "Varying shading rate", "1x1 rate", "2x2 rate", "4x4 rate", "HMD lens profile" };
     static const int SHADING_MODE_VARYING = 0;
     static const int SHADING_MODE_1X1 = 1;
     static const int SHADING_MODE_2X2 = 2;
     static const int SHADING_MODE_4X4 = 3;
+    static const int SHADING_MODE_HMD_PROFILE = 4;
 
     GLint m_shadingRateImageTexelWidth;
     GLint m_shadingRateImageTexelHeight;
@@ -62,11 +239,93 @@ private:
     GLuint m_shadingRateImage1X1 = 0;
     GLuint m_shadingRateImage2X2 = 0;
     GLuint m_shadingRateImage4X4 = 0;
+    GLuint m_shadingRateImageHmdProfile = 0;
 
-    std::vector<uint8_t> m_shadingRateImageData;
+    // the selected image with the tiles behind opaque UI panels set to no invocations,
+    // used instead of the selected one while any tile is covered
+    GLuint m_shadingRateImageComposited = 0;
+    std::vector<uint8_t> m_compositedRates;
+    std::vector<uint8_t> m_compositedScratch;
+    std::vector<PixelRect> m_panelRects;
+    ShadingRateStats m_compositedStats;
+    bool m_useCompositedImage = false;
+
+    // lens matched rates from tools/rateprofile_gen, the varying image is used if there is none
+    RateProfile m_hmdProfile;
+
+    std::vector<uint8_t> m_shadingRateImageData;    // content of m_shadingRateImageVarying after updateTextures()
+    std::vector<uint8_t> m_shadingRateImageScratch;
+
+    // radii of the varying shading rate image, m_appliedFoveationParams
+    // and the center are what m_shadingRateImageVarying currently holds
+    FoveationParams m_foveationParams;
+    FoveationParams m_appliedFoveationParams;
+    glm::vec2 m_appliedFoveationCenter = glm::vec2(0.5f);
+    // center the rings on the latched gaze instead of the image
+    bool m_gazeFoveation = false;
+
+    // Pareto front from tools/foveation_tuner, its default replaces the built-in radii and rates
+    FoveationPresets m_foveationPresets;
+    std::vector<std::string> m_foveationPresetNames;
+    std::vector<const char*> m_foveationPresetNamePointers;
+    int m_foveationPreset = -1;
+
+    // per shading mode, the varying one is updated incrementally with the texture
+    ShadingRateStats m_rateStats[SHADING_MODE_COUNT];
+    RateCostModel m_rateCost;
+    uint32_t m_rateStatsFramebufferWidth = 0;
+    uint32_t m_rateStatsFramebufferHeight = 0;
+    bool m_logRateStatistics = BENCHMARK_MODE != 0;
+    uint32_t m_frameIndex = 0;
+
+    // average scene time per shading mode, the last entry is with VRS disabled
+    double m_measuredSceneMilliseconds[SHADING_MODE_COUNT + 1] = {};
+    // the same with the textured material, and its texture traffic per frame,
+    // both restart when the LOD bias changes
+    double m_texturedSceneMilliseconds[SHADING_MODE_COUNT + 1] = {};
+    double m_textureMegabytes[SHADING_MODE_COUNT + 1] = {};
+    // most fragments of the transparent tori stored and overflowed in one frame,
+    // restart when the fragment buffer changes
+    uint32_t m_oitHighWater[SHADING_MODE_COUNT + 1] = {};
+    uint32_t m_oitMaxOverflow[SHADING_MODE_COUNT + 1] = {};
+    // triangles per frame out of the tessellator, restart when the tessellation settings change
+    double m_tessellatedTriangles[SHADING_MODE_COUNT + 1] = {};
+    uint32_t m_primitiveResultCount = 0;
+    // meshlets per frame that survive the task shader, restart when the tessellation changes
+    double m_drawnMeshlets[SHADING_MODE_COUNT + 1] = {};
+    uint32_t m_meshletResultCount = 0;
+    MeasuredSceneKey m_measuredSceneKey;
+    uint32_t m_framesWithSameSceneKey = 0;
+    static const uint32_t MEASUREMENT_LAG_FRAMES = 4;
+
+    // closed-loop control of the foveation radii on the GPU time of the scene
+    FoveationController m_foveationController;
+    GpuTimer m_sceneTimer;
+    uint32_t m_sceneTimerResultCount = 0;
+    bool m_dynamicFoveation = false;
 
     int m_selectedShadingMode = 0;
     bool m_activateShadingRate = true;
-    bool m_visualizeShadingRate = false;
     bool m_fullShadingRateForGreenObjects = true;
+
+    // bake the settings above into the scene program instead of reading them from the UBO
+    bool m_useShaderPermutations = true;
+    uint32_t m_permutationKey = 0;
+    uint32_t m_framesWithSamePermutation = 0;
+
+    // coarser rates out of focus, from the previous frame's depth buffer
+    std::unique_ptr< DepthOfFieldRater > m_depthOfFieldRater = nullptr;
+    DepthOfFieldSettings m_depthOfField;
+
+    // finer rates on the silhouettes and creases of the previous frame's depth buffer
+    std::unique_ptr< EdgeRefiner > m_edgeRefiner = nullptr;
+    EdgeRefinementSettings m_edgeRefinement;
+    // the selected image after the depth of field rates and the edge refinement, 0 without either
+    GLuint m_refinedShadingRateImage = 0;
+    glm::mat4 m_projectionMatrix = glm::mat4(1.0f);
+
+    // heatmap of the shading rate or of the measured invocations per pixel
+    std::unique_ptr< RateOverlay > m_rateOverlay = nullptr;
+    int m_overlayMode = RateOverlay::OVERLAY_OFF;
+    const char* OVERLAY_MODE_NAMES[RateOverlay::OVERLAY_MODE_COUNT] = { "Off", "Shading rate", "Invocations per pixel" };
 };
@@ -17,33 +17,188 @@
 
 #include "VRSPipeline.h"
 
+#include "nvh/fileoperations.hpp"
 #include "nvh/nvprint.hpp"
+#include "nvpsystem.hpp"
+
+#include <chrono>
+#include <vector>
+
+// all files that end up in the scene program, part of the cache key
+static const char* SCENE_SOURCE_FILES[] = { "scene.vert.glsl", "scene.frag.glsl", "scene.tesc.glsl", "scene.tese.glsl",
+                                            "scene.task.glsl", "scene.mesh.glsl", "scene_vertex.glsl", "common.h",
+                                            "noise.glsl", "tessellation.h" };
+
+uint32_t ScenePermutation::getKey() const
+{
+    uint32_t sharedKey = (countInvocations ? 0x40000000u : 0u) | (instanced ? 0x20000000u : 0u)
+        | (texturedMaterial ? 0x10000000u : 0u) | (measureTextureTraffic ? 0x08000000u : 0u) | (transparent ? 0x04000000u : 0u)
+        | (tessellated ? 0x02000000u : 0u) | (meshShader ? 0x01000000u : 0u) | (halfPrecision ? 0x00800000u : 0u);
+    if (dynamic)
+    {
+        return 0x80000000u | sharedKey;
+    }
+    return sharedKey
+        | (fullShadingRateForGreenObjects ? 2u : 0u)
+        | (uint32_t(fragmentLoad) << 8);
+}
+
+std::string ScenePermutation::getDefines() const
+{
+    std::string defines = "#define COUNT_INVOCATIONS " + std::to_string(countInvocations ? 1 : 0) + "\n"
+        "#define USE_INSTANCING " + std::to_string(instanced ? 1 : 0) + "\n"
+        "#define TEXTURED_MATERIAL " + std::to_string(texturedMaterial ? 1 : 0) + "\n"
+        "#define MEASURE_TEXTURE_TRAFFIC " + std::to_string(measureTextureTraffic ? 1 : 0) + "\n"
+        "#define OIT_STORE " + std::to_string(transparent ? 1 : 0) + "\n"
+        "#define TESSELLATION " + std::to_string(tessellated ? 1 : 0) + "\n"
+        "#define MESH_SHADER " + std::to_string(meshShader ? 1 : 0) + "\n"
+        "#define HALF_PRECISION " + std::to_string(halfPrecision ? 1 : 0) + "\n";
+    if (transparent)
+    {
+        defines += "#define USE_OIT_SCENE_DATA\n";
+    }
+    if (dynamic)
+    {
+        return defines;
+    }
+    return defines + "#define SCENE_PERMUTATION\n"
+        "#define FULL_RATE_FOR_GREEN_OBJECTS " + std::to_string(fullShadingRateForGreenObjects ? 1 : 0) + "\n"
+        "#define FRAGMENT_LOAD " + std::to_string(fragmentLoad) + "\n";
+}
 
 VRSPipeline::VRSPipeline()
     : Pipeline< vertexload::SceneData, vertexload::ObjectData >(UBO_SCENE, UBO_OBJECT)
 {
     m_progManager.registerInclude("common.h", "common.h");
     m_progManager.registerInclude("noise.glsl", "noise.glsl");
+    m_progManager.registerInclude("scene_vertex.glsl", "scene_vertex.glsl");
+    m_progManager.registerInclude("tessellation.h", "tessellation.h");
 
-    m_program = m_progManager.createProgram(
-        nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "#define USE_VIEWPORT\n", "scene.vert.glsl"),
-        nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, "", "scene.frag.glsl"));
+    m_programCache = std::make_unique<ProgramCache>(NVPSystem::exePath() + "programcache_" PROJECT_NAME);
+    m_sourceHash = hashSources();
 
-    bool valid = m_progManager.areProgramsValid();
-    if (!valid)
-    {
-        LOGE("Error loading shader files\n");
-    }
+    // programs are created lazily in setShaderProgram()
 }
 
 VRSPipeline::~VRSPipeline()
 {
+    destroyPermutations();
 }
 
-void VRSPipeline::updateObjectUniforms()
+void VRSPipeline::prepareObjectData()
 {
     objectData.color = m_objectColor;
 
-    Pipeline< vertexload::SceneData, vertexload::ObjectData >::updateObjectUniforms();
+    Pipeline< vertexload::SceneData, vertexload::ObjectData >::prepareObjectData();
 }
 
+void VRSPipeline::setShaderProgram()
+{
+    const PermutationInfo& info = getPermutationInfo(m_permutation);
+    glUseProgram(info.binaryProgram ? info.binaryProgram : m_progManager.get(info.program));
+}
+
+void VRSPipeline::reloadShaders()
+{
+    destroyPermutations();
+    m_sourceHash = hashSources();
+}
+
+void VRSPipeline::addSceneTime(uint32_t key, double milliseconds)
+{
+    auto it = m_permutations.find(key);
+    if (it != m_permutations.end())
+    {
+        it->second.gpuMilliseconds += milliseconds;
+        it->second.gpuSamples++;
+    }
+}
+
+VRSPipeline::PermutationInfo& VRSPipeline::getPermutationInfo(const ScenePermutation& permutation)
+{
+    uint32_t key = permutation.getKey();
+    auto it = m_permutations.find(key);
+    if (it != m_permutations.end())
+    {
+        return it->second;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    PermutationInfo info;
+    info.permutation = permutation;
+
+    std::string defines = permutation.getDefines();
+    uint64_t cacheKey = ProgramCache::hash(defines, m_sourceHash);
+
+    info.binaryProgram = m_programCache->load(cacheKey);
+    info.fromCache = info.binaryProgram != 0;
+
+    if (!info.fromCache)
+    {
+        std::vector<nvgl::ProgramManager::Definition> definitions;
+        if (permutation.meshShader)
+        {
+            definitions.push_back(nvgl::ProgramManager::Definition(GL_TASK_SHADER_NV, defines, "scene.task.glsl"));
+            definitions.push_back(nvgl::ProgramManager::Definition(GL_MESH_SHADER_NV, defines, "scene.mesh.glsl"));
+        }
+        else
+        {
+            definitions.push_back(nvgl::ProgramManager::Definition(GL_VERTEX_SHADER, "#define USE_VIEWPORT\n" + defines, "scene.vert.glsl"));
+        }
+        if (permutation.tessellated)
+        {
+            definitions.push_back(nvgl::ProgramManager::Definition(GL_TESS_CONTROL_SHADER, defines, "scene.tesc.glsl"));
+            definitions.push_back(nvgl::ProgramManager::Definition(GL_TESS_EVALUATION_SHADER, "#define USE_VIEWPORT\n" + defines, "scene.tese.glsl"));
+        }
+        definitions.push_back(nvgl::ProgramManager::Definition(GL_FRAGMENT_SHADER, defines, "scene.frag.glsl"));
+        info.program = m_progManager.createProgram(definitions);
+
+        GLuint program = m_progManager.get(info.program);
+        GLint linked = GL_FALSE;
+        if (program)
+        {
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        }
+        if (linked)
+        {
+            m_programCache->store(cacheKey, program);
+        }
+        else
+        {
+            LOGE("Error loading shader files\n");
+        }
+    }
+
+    info.loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    LOGI("scene program %08x: %.2f ms (%s)\n", key, info.loadMilliseconds, info.fromCache ? "binary cache" : "compiled");
+
+    return m_permutations[key] = info;
+}
+
+void VRSPipeline::destroyPermutations()
+{
+    for (auto& it : m_permutations)
+    {
+        if (it.second.binaryProgram)
+        {
+            glDeleteProgram(it.second.binaryProgram);
+        }
+        else
+        {
+            m_progManager.destroyProgram(it.second.program);
+        }
+    }
+    m_permutations.clear();
+}
+
+uint64_t VRSPipeline::hashSources() const
+{
+    uint64_t h = ProgramCache::hash(std::string());
+    for (const char* name : SCENE_SOURCE_FILES)
+    {
+        std::string filename = nvh::findFile(name, defaultSearchPaths, true);
+        h = ProgramCache::hash(nvh::loadFile(filename, true), h);
+    }
+    return h;
+}
@@ -21,9 +21,44 @@
 
 #include <glm/glm.hpp>
 #include "common.h"
+#include "ProgramCache.h"
 
 #include "nvgl/base_gl.hpp"
 
+#include <map>
+#include <memory>
+#include <string>
+
+//
+// Settings that can be baked into the scene program as defines instead of
+// being read from the scene UBO. The dynamic permutation reads everything
+// from the UBO and serves all settings with one program. countInvocations
+// and instanced are never read from the UBO, they add the per-pixel
+// invocation counting for the RateOverlay heatmap and the per-instance
+// transforms of MeshScene to either kind of permutation, tessellated adds
+// the tessellation stages of TessellatedTorus, meshShader replaces the
+// vertex stage with the task and mesh shaders of Torus::drawMeshlets,
+// halfPrecision evaluates the procedural material in float16 (see
+// MaterialReference for the error against fp32).
+//
+struct ScenePermutation
+{
+    bool dynamic = true;
+    bool countInvocations = false;
+    bool instanced = false;
+    bool texturedMaterial = false;
+    bool measureTextureTraffic = false;     // only with texturedMaterial
+    bool transparent = false;               // stores the fragments for OITRenderer, reads OITSceneData
+    bool tessellated = false;               // patches of TessellatedTorus, not with instanced
+    bool meshShader = false;                // meshlets of Torus, not with instanced or tessellated
+    bool halfPrecision = false;             // needs GL_NV_gpu_shader5
+    bool fullShadingRateForGreenObjects = true;
+    int fragmentLoad = 16;
+
+    uint32_t getKey() const;
+    std::string getDefines() const;
+};
+
 class VRSPipeline : public Pipeline< vertexload::SceneData, vertexload::ObjectData >
 {
 public:
@@ -35,8 +70,42 @@ public:
         m_objectColor = color;
     }
 
-    void updateObjectUniforms() override;
+    void prepareObjectData() override;
+
+    // binds the program of the current permutation, compiling it (or
+    // loading it from the program binary cache) on first use
+    void setShaderProgram() override;
+    void setPermutation(const ScenePermutation& permutation) { m_permutation = permutation; }
+    const ScenePermutation& getPermutation() const { return m_permutation; }
+
+    // forgets all permutations, they get rebuilt on their next use
+    void reloadShaders() override;
+
+    struct PermutationInfo
+    {
+        ScenePermutation permutation;
+        GLuint binaryProgram = 0;       // loaded from the cache, owned by us
+        nvgl::ProgramID program;        // compiled from source, owned by m_progManager
+        bool fromCache = false;
+        double loadMilliseconds = 0.0;  // compile + link, or binary load
+        double gpuMilliseconds = 0.0;   // sum of scene pass times, see addSceneTime()
+        uint32_t gpuSamples = 0;
+    };
+    const std::map<uint32_t, PermutationInfo>& getPermutations() const { return m_permutations; }
+
+    // attributes a measured scene pass time to a permutation
+    void addSceneTime(uint32_t key, double milliseconds);
 
 private:
+    PermutationInfo& getPermutationInfo(const ScenePermutation& permutation);
+    void destroyPermutations();
+    uint64_t hashSources() const;
+
     glm::vec3 m_objectColor;
+
+    ScenePermutation m_permutation;
+    std::map<uint32_t, PermutationInfo> m_permutations;
+
+    std::unique_ptr<ProgramCache> m_programCache;
+    uint64_t m_sourceHash = 0;
 };
@@ -20,6 +20,7 @@
 #ifdef __cplusplus
 typedef glm::mat4 mat4;
 typedef glm::vec3 vec3;
+typedef glm::vec4 vec4;
 #endif
 
 // general behavior defines
@@ -34,10 +35,60 @@ typedef glm::vec3 vec3;
 #define VERTEX_POS        0
 #define VERTEX_NORMAL     1
 #define OFFSET_LOC        2
+#define VERTEX_TEXCOORD   3
 
 #define UBO_SCENE         1
 #define UBO_OBJECT        2
 
+#define SSBO_INSTANCES    3
+#define SSBO_TEXTURE_TRAFFIC 4
+
+// fixed point scale of the texel counts in SSBO_TEXTURE_TRAFFIC
+#define TEXTURE_TRAFFIC_UNITS 16
+
+// order independent transparency, see OITRenderer
+#define SSBO_OIT_NODES    5
+#define SSBO_OIT_COUNTERS 6
+#define IMAGE_OIT_HEADS   1     // image unit 0 holds the invocation counts
+#define OIT_LIST_END      0xffffffffu
+#define OIT_MAX_SAMPLES   32    // upper bound of maxSamplesForBlending
+
+// texture units of the textured material
+#define TEX_ALBEDO        1
+#define TEX_NORMAL        2
+
+// hardware tessellated tori, see TessellatedTorus
+#define TEX_TESS_RATE     3     // shading rate image read by scene.tesc.glsl
+#define TESS_SETTINGS_LOC 4
+#define TESS_RATE_LOC     5
+#define TESS_RADII_LOC    6
+
+// meshlet tori drawn by the task and mesh shaders, see Torus::drawMeshlets
+#define SSBO_MESHLET_VERTEX_DATA     7   // positions, normals and texcoords of the torus vertex buffer as floats
+#define SSBO_MESHLETS                8
+#define SSBO_MESHLET_BOUNDS          9
+#define SSBO_MESHLET_VERTEX_INDICES  10
+#define SSBO_MESHLET_PRIMITIVES      11  // three byte indices per triangle, read as uints
+#define SSBO_MESHLET_STATS           12  // drawn, frustum, cone and rate culled meshlets
+#define TEX_MESHLET_RATE             4   // shading rate image read by scene.task.glsl
+#define MESHLET_INFO_LOC             7
+#define MESHLET_CULL_LOC             8
+#define MESHLET_FLAGS_LOC            9
+#define MESHLET_GROUP_SIZE           32  // meshlets per task workgroup, threads per mesh workgroup
+#define MESHLET_MAX_VERTICES         64  // must match MeshletLimits
+#define MESHLET_MAX_PRIMITIVES       126
+
+// occlusion culled tori, see OcclusionCuller; the survivors are drawn
+// with the instanced scene program from SSBO_INSTANCES
+#define SSBO_CULL_OBJECTS            13  // InstanceData of all objects
+#define SSBO_CULL_STATUS             14  // OcclusionResult per object, from the first phase to the second
+#define SSBO_CULL_DRAWS              15  // the indirect draws of both phases
+#define SSBO_CULL_STATS              16  // objects per OcclusionResult
+#define TEX_CULL_DEPTH               5   // the depth buffer while reducing, the pyramid while culling
+#define IMAGE_CULL_SOURCE            2   // pyramid levels, image unit 0 may hold the invocation counts
+#define IMAGE_CULL_TARGET            3
+#define CULL_GROUP_SIZE              64
+
 #ifdef __cplusplus
 namespace vertexload
 {
@@ -61,8 +112,9 @@ namespace vertexload
     int loadFactor;
     int fragmentLoadFactor;
 
-    int visualizeShadingRate;
     int fullShadingRateForGreenObjects;
+
+    float lodBiasScale;   // textured material: mip bias per log2 of the fragment size
   };
 
   struct OITSceneData
@@ -97,6 +149,14 @@ namespace vertexload
     vec3 color;         // model color
   };
 
+  // per instance of the instanced (mesh blob) path, the model matrix is
+  // applied before object.model, only rotation and uniform scale allowed
+  struct InstanceData
+  {
+    mat4 model;         // instance -> model
+    vec4 color;         // replaces object.color
+  };
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+//
+// Shading rates from a depth of field model, see DepthOfFieldReference.h
+// for the CPU reference of both passes. DOF_PASS selects the pass:
+//   1 reduce: one workgroup per shading rate image texel, writes the
+//     nearest and farthest distance of the tile from the depth buffer
+//   2 compose: one invocation per texel, turns the range into a rate and
+//     composes it with a rate image through the palette cost model
+//
+
+#ifndef DOF_PASS
+#define DOF_PASS 1
+#endif
+
+#define DOF_PASS_REDUCE  1
+#define DOF_PASS_COMPOSE 2
+
+// RATE_STATS_MAX_ENTRIES
+#define RATE_COST_ENTRIES 16
+
+#if DOF_PASS == DOF_PASS_REDUCE
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform sampler2D depthImage;
+layout(binding = 0, rg32f) uniform writeonly image2D rangeImage;
+
+layout(location = 0) uniform ivec2 framebufferSize;
+layout(location = 1) uniform ivec2 texelSize;
+layout(location = 2) uniform vec2 projection; // projection[2][2], projection[3][2]
+
+// the distances are positive, their bits order like the floats
+const uint INFINITY_BITS = 0x7f800000u;
+shared uint nearestBits;
+shared uint farthestBits;
+
+void main()
+{
+  if(gl_LocalInvocationIndex == 0)
+  {
+    nearestBits  = INFINITY_BITS;
+    farthestBits = 0u;
+  }
+  barrier();
+
+  // texels larger than the workgroup are covered in several steps
+  ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * texelSize;
+  float nearest    = uintBitsToFloat(INFINITY_BITS);
+  float farthest   = 0.0;
+  for(int y = int(gl_LocalInvocationID.y); y < texelSize.y; y += int(gl_WorkGroupSize.y))
+  {
+    for(int x = int(gl_LocalInvocationID.x); x < texelSize.x; x += int(gl_WorkGroupSize.x))
+    {
+      ivec2 p = tileOrigin + ivec2(x, y);
+      if(all(lessThan(p, framebufferSize)))
+      {
+        float depth = texelFetch(depthImage, p, 0).r;
+        if(depth < 1.0)
+        {
+          float z  = projection.y / (depth * 2.0 - 1.0 + projection.x);
+          nearest  = min(nearest, z);
+          farthest = max(farthest, z);
+        }
+      }
+    }
+  }
+  atomicMin(nearestBits, floatBitsToUint(nearest));
+  atomicMax(farthestBits, floatBitsToUint(farthest));
+  barrier();
+
+  if(gl_LocalInvocationIndex == 0)
+  {
+    // both 0 for tiles without geometry
+    float tileFarthest = uintBitsToFloat(farthestBits);
+    float tileNearest  = tileFarthest > 0.0 ? uintBitsToFloat(nearestBits) : 0.0;
+    imageStore(rangeImage, ivec2(gl_WorkGroupID.xy), vec4(tileNearest, tileFarthest, 0.0, 0.0));
+  }
+}
+
+#else
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform usampler2D sourceRates;
+layout(binding = 1) uniform sampler2D tileRanges;
+layout(binding = 0, r8ui) uniform writeonly uimage2D composedRates;
+
+layout(location = 0) uniform ivec2 rateImageSize;
+layout(location = 1) uniform vec2 lens;          // focus distance, blur at infinity in pixels
+layout(location = 2) uniform vec2 cocThresholds; // for 2x2, for 4x4
+layout(location = 3) uniform float rateCost[RATE_COST_ENTRIES];
+
+// palette entries of ShadingRatePaletteEntry
+#define RATE_1X1 1u
+#define RATE_2X2 2u
+#define RATE_4X4 3u
+
+float circleOfConfusion(float z)
+{
+  return lens.y * abs(z - lens.x) / z;
+}
+
+void main()
+{
+  ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+  if(any(greaterThanEqual(p, rateImageSize)))
+    return;
+
+  uint rate  = texelFetch(sourceRates, p, 0).r;
+  vec2 range = texelFetch(tileRanges, p, 0).rg;
+  if(range.y > 0.0 && rate < RATE_COST_ENTRIES)
+  {
+    // the circle of confusion grows away from the focus on both sides, a range across it has a sharp pixel
+    float coc = 0.0;
+    if(lens.x < range.x)
+      coc = circleOfConfusion(range.x);
+    else if(lens.x > range.y)
+      coc = circleOfConfusion(range.y);
+    uint dofRate = coc >= cocThresholds.y ? RATE_4X4 : coc >= cocThresholds.x ? RATE_2X2 : RATE_1X1;
+
+    // the cheaper entry wins, either generator alone would accept it
+    if(rateCost[dofRate] < rateCost[rate])
+      rate = dofRate;
+  }
+  imageStore(composedRates, p, uvec4(rate));
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+//
+// Refines the shading rate image with the depth buffer of the previous
+// frame, see EdgeRefinementReference.h for the CPU reference of both passes.
+// EDGE_PASS selects the pass:
+//   1 classify: one workgroup per shading rate image texel, writes the
+//     EdgeTileClass of the tile from the depth buffer
+//   2 merge: one invocation per texel, applies the classes to a rate image
+//
+
+#ifndef EDGE_PASS
+#define EDGE_PASS 1
+#endif
+
+#define EDGE_PASS_CLASSIFY 1
+#define EDGE_PASS_MERGE    2
+
+// EdgeTileClass
+#define EDGE_TILE_BACKGROUND 0u
+#define EDGE_TILE_INTERIOR   1u
+#define EDGE_TILE_CREASE     2u
+#define EDGE_TILE_SILHOUETTE 3u
+
+// EdgeRefinementPolicy
+#define EDGE_POLICY_REFINE_AND_COARSEN 2
+
+#if EDGE_PASS == EDGE_PASS_CLASSIFY
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform sampler2D depthImage;
+layout(binding = 0, r8ui) uniform writeonly uimage2D classImage;
+
+layout(location = 0) uniform ivec2 framebufferSize;
+layout(location = 1) uniform ivec2 texelSize;
+layout(location = 2) uniform vec2 projection; // projection[2][2], projection[3][2]
+layout(location = 3) uniform vec2 thresholds; // depth, crease
+
+shared uint tileClass;
+
+// distance to the eye, 0 for the background
+float linearDepth(ivec2 p)
+{
+  float depth = texelFetch(depthImage, p, 0).r;
+  return depth >= 1.0 ? 0.0 : projection.y / (depth * 2.0 - 1.0 + projection.x);
+}
+
+bool isDepthEdge(float z, float neighbour)
+{
+  if((z == 0.0) != (neighbour == 0.0))
+    return true;
+  return z != 0.0 && abs(z - neighbour) > thresholds.x * min(z, neighbour);
+}
+
+bool isCrease(float before, float z, float after)
+{
+  return before != 0.0 && after != 0.0 && abs(before - 2.0 * z + after) > thresholds.y * z;
+}
+
+uint classifyPixel(ivec2 p)
+{
+  float center = linearDepth(p);
+
+  bool silhouette = (p.x > 0 && isDepthEdge(center, linearDepth(p - ivec2(1, 0))))
+                    || (p.x + 1 < framebufferSize.x && isDepthEdge(center, linearDepth(p + ivec2(1, 0))))
+                    || (p.y > 0 && isDepthEdge(center, linearDepth(p - ivec2(0, 1))))
+                    || (p.y + 1 < framebufferSize.y && isDepthEdge(center, linearDepth(p + ivec2(0, 1))));
+  if(silhouette)
+    return EDGE_TILE_SILHOUETTE;
+  if(center == 0.0)
+    return EDGE_TILE_BACKGROUND;
+
+  bool crease = (p.x > 0 && p.x + 1 < framebufferSize.x
+                 && isCrease(linearDepth(p - ivec2(1, 0)), center, linearDepth(p + ivec2(1, 0))))
+                || (p.y > 0 && p.y + 1 < framebufferSize.y
+                    && isCrease(linearDepth(p - ivec2(0, 1)), center, linearDepth(p + ivec2(0, 1))));
+  return crease ? EDGE_TILE_CREASE : EDGE_TILE_INTERIOR;
+}
+
+void main()
+{
+  if(gl_LocalInvocationIndex == 0)
+    tileClass = EDGE_TILE_BACKGROUND;
+  barrier();
+
+  // texels larger than the workgroup are covered in several steps
+  ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * texelSize;
+  uint pixelClass = EDGE_TILE_BACKGROUND;
+  for(int y = int(gl_LocalInvocationID.y); y < texelSize.y; y += int(gl_WorkGroupSize.y))
+  {
+    for(int x = int(gl_LocalInvocationID.x); x < texelSize.x; x += int(gl_WorkGroupSize.x))
+    {
+      ivec2 p = tileOrigin + ivec2(x, y);
+      if(all(lessThan(p, framebufferSize)))
+        pixelClass = max(pixelClass, classifyPixel(p));
+    }
+  }
+  atomicMax(tileClass, pixelClass);
+  barrier();
+
+  if(gl_LocalInvocationIndex == 0)
+    imageStore(classImage, ivec2(gl_WorkGroupID.xy), uvec4(tileClass));
+}
+
+#else
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform usampler2D sourceRates;
+layout(binding = 1) uniform usampler2D tileClasses;
+layout(binding = 0, r8ui) uniform writeonly uimage2D refinedRates;
+
+layout(location = 0) uniform ivec2 rateImageSize;
+layout(location = 1) uniform int policy;
+layout(location = 2) uniform uvec2 edgeRates; // silhouette, crease
+
+void main()
+{
+  ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+  if(any(greaterThanEqual(p, rateImageSize)))
+    return;
+
+  // palette entries 1 to 3 are ordered from fine to coarse, culled tiles stay culled
+  uint rate = texelFetch(sourceRates, p, 0).r;
+  uint tileClass = texelFetch(tileClasses, p, 0).r;
+  if(rate != 0u && rate <= 3u)
+  {
+    if(tileClass == EDGE_TILE_SILHOUETTE)
+      rate = min(rate, edgeRates.x);
+    else if(tileClass == EDGE_TILE_CREASE)
+      rate = min(rate, edgeRates.y);
+    else if(tileClass == EDGE_TILE_INTERIOR && policy == EDGE_POLICY_REFINE_AND_COARSEN)
+      rate = min(rate + 1u, 3u);
+  }
+  imageStore(refinedRates, p, uvec4(rate));
+}
+
+#endif
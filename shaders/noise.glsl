@@ -99,6 +99,7 @@ vec4 Simplex3D_GetSurfletWeights(
   return surflet_weights*surflet_weights*surflet_weights;
 }
 
+#if !HALF_PRECISION
 float SimplexPerlin3D(vec3 P)
 {
   // calculate the simplex vector and index math
@@ -133,3 +134,46 @@ float SimplexPerlin3D(vec3 P)
   // sum with the surflet and return
   return dot( Simplex3D_GetSurfletWeights( v1234_x, v1234_y, v1234_z ), grad_results ) * FINAL_NORMALIZATION;
 }
+#else
+// float16 variant of the surflets (GL_NV_gpu_shader5, see MaterialReference
+// for the error against the one above). The lattice and the hash stay fp32:
+// the cell index and the squared offsets of the hash exceed the 11 bits of
+// a half and would repeat the pattern. The centering of the hash is done
+// before the conversion as 0.49999 rounds to 0.5 in half. Built-in
+// functions are evaluated in fp32 and converted back, which leaves the
+// arithmetic operators as the half precision work.
+float SimplexPerlin3D(vec3 P)
+{
+  vec3 Pi;
+  vec3 Pi_1;
+  vec3 Pi_2;
+  vec4 v1234_x;
+  vec4 v1234_y;
+  vec4 v1234_z;
+  Simplex3D_GetCornerVectors( P, Pi, Pi_1, Pi_2, v1234_x, v1234_y, v1234_z );
+
+  vec4 hash_0;
+  vec4 hash_1;
+  vec4 hash_2;
+  FAST32_hash_3D( Pi, Pi_1, Pi_2, hash_0, hash_1, hash_2 );
+  f16vec4 h0 = f16vec4( hash_0 - 0.49999 );
+  f16vec4 h1 = f16vec4( hash_1 - 0.49999 );
+  f16vec4 h2 = f16vec4( hash_2 - 0.49999 );
+  f16vec4 vx = f16vec4( v1234_x );
+  f16vec4 vy = f16vec4( v1234_y );
+  f16vec4 vz = f16vec4( v1234_z );
+
+  // evaluate gradients
+  f16vec4 grad_results = f16vec4( inversesqrt( vec4( h0 * h0 + h1 * h1 + h2 * h2 ) ) ) * ( h0 * vx + h1 * vy + h2 * vz );
+
+  // evaluate surflet. f(x)=(0.5-x*x)^3
+  f16vec4 surflet_weights = vx * vx + vy * vy + vz * vz;
+  surflet_weights = f16vec4( max( vec4( float16_t(0.5) - surflet_weights ), 0.0 ) );
+  surflet_weights = surflet_weights * surflet_weights * surflet_weights;
+
+  // sum with the surflet, the normalization and calcNoise stay fp32
+  f16vec4 weighted = surflet_weights * grad_results;
+  const float FINAL_NORMALIZATION = 37.837227241611314102871574478976;
+  return float( weighted.x + weighted.y + weighted.z + weighted.w ) * FINAL_NORMALIZATION;
+}
+#endif
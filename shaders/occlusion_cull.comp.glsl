@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+//
+// Two phase occlusion culling with a depth pyramid, see
+// OcclusionCullingReference.h for the CPU reference of the pyramid and
+// the tests. CULL_PASS selects the pass:
+//   1 reduce: one invocation per texel of a pyramid level, the farthest
+//     depth of the 2x2 texels below, from the depth buffer for level 0
+//   2 cull: one invocation per object, appends the visible ones to the
+//     indirect draw of the phase
+//
+
+#include "common.h"
+
+#ifndef CULL_PASS
+#define CULL_PASS 1
+#endif
+
+#define CULL_PASS_REDUCE 1
+#define CULL_PASS_CULL   2
+
+// OcclusionResult
+#define OCCLUSION_VISIBLE         0u
+#define OCCLUSION_VISIBLE_LATE    1u
+#define OCCLUSION_OCCLUDED        2u
+#define OCCLUSION_OUTSIDE_FRUSTUM 3u
+
+#if CULL_PASS == CULL_PASS_REDUCE
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = TEX_CULL_DEPTH) uniform sampler2D depthImage;
+layout(binding = IMAGE_CULL_SOURCE, r32f) uniform readonly image2D sourceLevel;
+layout(binding = IMAGE_CULL_TARGET, r32f) uniform writeonly image2D targetLevel;
+
+layout(location = 0) uniform ivec2 sourceSize;
+layout(location = 1) uniform int fromDepth;
+
+float fetchSource(ivec2 p)
+{
+  p = min(p, sourceSize - 1);
+  return fromDepth != 0 ? texelFetch(depthImage, p, 0).r : imageLoad(sourceLevel, p).r;
+}
+
+void main()
+{
+  ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+  if(any(greaterThanEqual(p, imageSize(targetLevel))))
+    return;
+
+  // the odd last row and column only have one source texel in that direction
+  ivec2 s = p * 2;
+  float farthest = max(max(fetchSource(s), fetchSource(s + ivec2(1, 0))), max(fetchSource(s + ivec2(0, 1)), fetchSource(s + ivec2(1, 1))));
+  imageStore(targetLevel, p, vec4(farthest));
+}
+
+#else
+
+layout(local_size_x = CULL_GROUP_SIZE) in;
+
+layout(binding = TEX_CULL_DEPTH) uniform sampler2D depthPyramid;
+
+layout(std430, binding = SSBO_CULL_OBJECTS) readonly buffer objectBuffer {
+  InstanceData objects[];
+};
+layout(std430, binding = SSBO_INSTANCES) writeonly buffer visibleBuffer {
+  InstanceData visibleObjects[];
+};
+layout(std430, binding = SSBO_CULL_STATUS) buffer statusBuffer {
+  uint status[];
+};
+
+// DrawElementsIndirectCommand
+struct DrawCommand
+{
+  uint count;
+  uint instanceCount;
+  uint firstIndex;
+  int  baseVertex;
+  uint baseInstance;
+};
+layout(std430, binding = SSBO_CULL_DRAWS) coherent buffer drawBuffer {
+  DrawCommand draws[2];
+};
+layout(std430, binding = SSBO_CULL_STATS) buffer statsBuffer {
+  uint stats[4];
+};
+
+layout(location = 0) uniform mat4 viewProj;         // current frame, for the frustum
+layout(location = 1) uniform mat4 pyramidViewProj;  // the one the depth of the pyramid was rendered with
+layout(location = 2) uniform vec3 boundsMin;        // of all objects in their model space
+layout(location = 3) uniform vec3 boundsMax;
+layout(location = 4) uniform uint objectCount;
+layout(location = 5) uniform int phase;
+layout(location = 6) uniform ivec2 pyramidSize;     // of the depth buffer, 0 without a pyramid
+layout(location = 7) uniform int pyramidLevels;
+
+vec4 clipCorner(mat4 mvp, int i)
+{
+  vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x, (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+                     (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+  return mvp * vec4(corner, 1.0);
+}
+
+bool isOutsideFrustum(mat4 mvp)
+{
+  // one bit per plane a corner is outside of, the box is outside if all corners share one
+  uint outside = 0x3fu;
+  for(int i = 0; i < 8; ++i)
+  {
+    vec4 c = clipCorner(mvp, i);
+    outside &= (c.x < -c.w ? 0x01u : 0u) | (c.x > c.w ? 0x02u : 0u) | (c.y < -c.w ? 0x04u : 0u)
+               | (c.y > c.w ? 0x08u : 0u) | (c.z < -c.w ? 0x10u : 0u) | (c.z > c.w ? 0x20u : 0u);
+  }
+  return outside != 0u;
+}
+
+bool isOccluded(mat4 mvp)
+{
+  if(pyramidLevels == 0)
+    return false;
+
+  vec2  ndcMin  = vec2(1.0);
+  vec2  ndcMax  = vec2(-1.0);
+  float nearest = 1.0;
+  for(int i = 0; i < 8; ++i)
+  {
+    vec4 c = clipCorner(mvp, i);
+    // crossing the near plane
+    if(c.w <= 0.0 || c.z < -c.w)
+      return false;
+    vec3 ndc = c.xyz / c.w;
+    ndcMin   = min(ndcMin, ndc.xy);
+    ndcMax   = max(ndcMax, ndc.xy);
+    nearest  = min(nearest, ndc.z * 0.5 + 0.5);
+  }
+  // the pyramid knows nothing about the part outside the screen
+  if(any(lessThan(ndcMin, vec2(-1.0))) || any(greaterThan(ndcMax, vec2(1.0))))
+    return false;
+
+  // pixels under the rectangle, then the finest level where they span at most 2x2 texels
+  uvec2 pixelMin = min(uvec2((ndcMin * 0.5 + 0.5) * vec2(pyramidSize)), uvec2(pyramidSize - 1));
+  uvec2 pixelMax = min(uvec2((ndcMax * 0.5 + 0.5) * vec2(pyramidSize)), uvec2(pyramidSize - 1));
+
+  int level = 0;
+  while(level + 1 < pyramidLevels
+        && any(greaterThan((pixelMax >> uint(level + 1)) - (pixelMin >> uint(level + 1)), uvec2(1u))))
+  {
+    ++level;
+  }
+
+  ivec2 texelMin = ivec2(pixelMin >> uint(level + 1));
+  ivec2 texelMax = ivec2(pixelMax >> uint(level + 1));
+  float farthest = 0.0;
+  for(int y = texelMin.y; y <= texelMax.y; ++y)
+  {
+    for(int x = texelMin.x; x <= texelMax.x; ++x)
+    {
+      farthest = max(farthest, texelFetch(depthPyramid, ivec2(x, y), level).r);
+    }
+  }
+  return nearest > farthest;
+}
+
+void main()
+{
+  uint index = gl_GlobalInvocationID.x;
+
+  // the second phase appends behind the survivors of the first, which are all in by now
+  uint first = phase == 0 ? 0u : draws[0].instanceCount;
+  if(phase != 0 && index == 0u)
+    draws[1].baseInstance = first;
+
+  if(index >= objectCount)
+    return;
+
+  mat4 mvp = viewProj * objects[index].model;
+  uint result;
+  if(phase == 0)
+  {
+    result = isOutsideFrustum(mvp) ? OCCLUSION_OUTSIDE_FRUSTUM
+             : isOccluded(pyramidViewProj * objects[index].model) ? OCCLUSION_OCCLUDED : OCCLUSION_VISIBLE;
+    status[index] = result;
+  }
+  else
+  {
+    // only the ones occluded in the old depth get a second chance
+    if(status[index] != OCCLUSION_OCCLUDED)
+      return;
+    result = isOccluded(pyramidViewProj * objects[index].model) ? OCCLUSION_OCCLUDED : OCCLUSION_VISIBLE_LATE;
+    status[index] = result;
+  }
+
+  if(result == OCCLUSION_VISIBLE || result == OCCLUSION_VISIBLE_LATE)
+  {
+    uint slot = first + atomicAdd(draws[phase].instanceCount, 1u);
+    visibleObjects[slot] = objects[index];
+  }
+  // the occluded ones are counted once they are final
+  if(phase != 0 || result != OCCLUSION_OCCLUDED)
+    atomicAdd(stats[result], 1u);
+}
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+//
+// Resolve of the transparent tori (see OITRenderer): walks the fragment
+// lists that can cover this pixel, keeps the maxSamplesForBlending nearest
+// fragments and blends them front to back. The result is premultiplied
+// and blended over the framebuffer with (ONE, ONE_MINUS_SRC_ALPHA).
+//
+
+#define USE_OIT_SCENE_DATA
+#include "common.h"
+
+layout(binding = IMAGE_OIT_HEADS, r32ui) uniform readonly uimage2D oitHeads;
+
+layout(std430, binding = SSBO_OIT_NODES) readonly buffer oitNodeBuffer {
+  uvec4 oitNodes[];   // color, depth, next, info (see scene.frag.glsl)
+};
+layout(std430, binding = SSBO_OIT_COUNTERS) buffer oitCounterBuffer {
+  uint oitAllocated;
+  uint oitDropped;
+};
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+// blue (few) -> green -> red (many), same as rate_overlay.frag.glsl
+vec3 heatColor(float t)
+{
+  t = clamp(t, 0.0, 1.0);
+  if(t < 0.5)
+    return mix(vec3(0, 0, 1), vec3(0, 1, 0), t * 2.0);
+  return mix(vec3(0, 1, 0), vec3(1, 0, 0), t * 2.0 - 1.0);
+}
+
+void main()
+{
+  ivec2 pixel      = ivec2(gl_FragCoord.xy);
+  int   maxSamples = clamp(scene.maxSamplesForBlending, 1, OIT_MAX_SAMPLES);
+
+  // nearest first
+  uint colors[OIT_MAX_SAMPLES];
+  uint depths[OIT_MAX_SAMPLES];
+  int  count   = 0;
+  int  total   = 0;
+  int  maxSize = 0;
+
+  //////////// ShadingRateSample ////////////
+  //
+  // A fragment is stored in the list of the pixel its (possibly coarse)
+  // fragment starts at. The lists that can cover this pixel are the ones
+  // at the pixel snapped to each fragment size, visited once each.
+  //
+  ivec2 visited[9];
+  int   visitedCount = 0;
+  for(int sizeLog2Y = 0; sizeLog2Y < 3; ++sizeLog2Y)
+  {
+    for(int sizeLog2X = 0; sizeLog2X < 3; ++sizeLog2X)
+    {
+      ivec2 anchor = (pixel >> ivec2(sizeLog2X, sizeLog2Y)) << ivec2(sizeLog2X, sizeLog2Y);
+      bool  seen   = false;
+      for(int i = 0; i < visitedCount; ++i)
+      {
+        seen = seen || visited[i] == anchor;
+      }
+      if(seen)
+      {
+        continue;
+      }
+      visited[visitedCount++] = anchor;
+
+      uint node = imageLoad(oitHeads, anchor).r;
+      while(node != OIT_LIST_END)
+      {
+        uvec4 data = oitNodes[node];
+        node       = data.z;
+
+        // the fragment covers this pixel if it is anchored here with its own size and the pixel is in its mask
+        ivec2 sizeLog2 = ivec2(data.w & 3u, (data.w >> 2) & 3u);
+        ivec2 local    = pixel - anchor;
+        if(((pixel >> sizeLog2) << sizeLog2) != anchor
+           || (data.w & (1u << (16 + local.y * (1 << sizeLog2.x) + local.x))) == 0u)
+        {
+          continue;
+        }
+
+        ++total;
+        maxSize = max(maxSize, max(sizeLog2.x, sizeLog2.y));
+
+        // insertion into the sorted nearest samples, the farthest one falls out when full
+        if(count == maxSamples && data.y >= depths[count - 1])
+        {
+          continue;
+        }
+        int i = min(count, maxSamples - 1);
+        while(i > 0 && depths[i - 1] > data.y)
+        {
+          colors[i] = colors[i - 1];
+          depths[i] = depths[i - 1];
+          --i;
+        }
+        colors[i] = data.x;
+        depths[i] = data.y;
+        count     = min(count + 1, maxSamples);
+      }
+    }
+  }
+
+  if(total == 0)
+  {
+    discard;
+  }
+  if(total > count)
+  {
+    atomicAdd(oitDropped, uint(total - count));
+  }
+
+  if(scene.visualizeSampleCount != 0)
+  {
+    outColor = vec4(heatColor(float(total) / float(maxSamples)), 1.0);
+    return;
+  }
+
+  vec3  color         = vec3(0.0);
+  float transmittance = 1.0;
+  for(int i = 0; i < count; ++i)
+  {
+    vec4 fragment = unpackUnorm4x8(colors[i]);
+    color         += transmittance * fragment.a * fragment.rgb;
+    transmittance *= 1.0 - fragment.a;
+  }
+
+  if(scene.visualizeShadingRate != 0)
+  {
+    // the coarsest fragment in the pixel: 1x1, 2x2, 4x4 as in the rate overlay
+    color = mix(color, heatColor(1.0 - float(maxSize) * 0.5) * (1.0 - transmittance), 0.5);
+  }
+
+  outColor = vec4(color, 1.0 - transmittance);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+//
+// Heatmap of the shading cost, drawn as a fullscreen pass on top of the
+// scene (see RateOverlay). Independent of the scene program, so it adds no
+// cost to the scene pass in OVERLAY_SHADING_RATE mode.
+//
+
+#define OVERLAY_SHADING_RATE 1
+#define OVERLAY_INVOCATIONS  2
+
+// 16 units per invocation, see countInvocation() in scene.frag.glsl
+#define INVOCATION_UNITS     16.0
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 0) uniform usampler2D shadingRateImage;
+layout(binding = 1) uniform usampler2D invocationCounts;
+
+layout(location = 0) uniform int   overlayMode;
+layout(location = 1) uniform ivec2 rateTexelSize;
+layout(location = 2) uniform bool  shadingRateActive;
+layout(location = 3) uniform float opacity;
+layout(location = 4) uniform float maxInvocations;
+
+// blue (cheap) -> green -> red (expensive), must match RateOverlay::heatColor()
+vec3 heatColor(float t)
+{
+  t = clamp(t, 0.0, 1.0);
+  if(t < 0.5)
+    return mix(vec3(0, 0, 1), vec3(0, 1, 0), t * 2.0);
+  return mix(vec3(0, 1, 0), vec3(1, 0, 0), t * 2.0 - 1.0);
+}
+
+void main()
+{
+  ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+  if(overlayMode == OVERLAY_SHADING_RATE)
+  {
+    // palette 0 of VRSDemo: 0 = no invocations, 1 = 1x1, 2 = 2x2, 3 = 4x4
+    uint rate = shadingRateActive ? texelFetch(shadingRateImage, pixel / rateTexelSize, 0).r : 1u;
+    if(rate == 0u)
+    {
+      outColor = vec4(0.2, 0.2, 0.2, opacity);
+      return;
+    }
+    // log2 of the invocations per pixel: 0 for 1x1, -2 for 2x2, -4 for 4x4
+    float cost = rate == 1u ? 0.0 : (rate == 2u ? -2.0 : -4.0);
+    outColor   = vec4(heatColor(cost / 4.0 + 1.0), opacity);
+  }
+  else
+  {
+    float invocations = float(texelFetch(invocationCounts, pixel, 0).r) / INVOCATION_UNITS;
+    if(invocations == 0.0)
+    {
+      discard;
+    }
+    outColor = vec4(heatColor(invocations / maxInvocations), opacity);
+  }
+}
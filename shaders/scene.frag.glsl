@@ -8,16 +8,73 @@
 //
 #extension GL_NV_shading_rate_image : enable
 
+#if HALF_PRECISION
+// float16_t and f16vec* for the half precision material
+#extension GL_NV_gpu_shader5 : require
+#endif
 
 #include "common.h"
 #include "noise.glsl"
 
+// settings are either baked in as defines (see ScenePermutation in
+// VRSPipeline.h) or read from the scene UBO
+#ifdef SCENE_PERMUTATION
+#define FRAGMENT_LOAD_FACTOR   FRAGMENT_LOAD
+#else
+#define FRAGMENT_LOAD_FACTOR   scene.fragmentLoadFactor
+#endif
+
+#if COUNT_INVOCATIONS || MEASURE_TEXTURE_TRAFFIC || OIT_STORE
+// only fragments that survive the depth test are counted (or stored)
+layout(early_fragment_tests) in;
+#endif
+
+#if COUNT_INVOCATIONS
+// 16 units per invocation, spread over the pixels it covers (see RateOverlay)
+layout(binding = 0, r32ui) uniform coherent uimage2D invocationCounts;
+#endif
+
+#if TEXTURED_MATERIAL
+layout(binding = TEX_ALBEDO) uniform sampler2D albedoTex;
+layout(binding = TEX_NORMAL) uniform sampler2D normalTex;
+
+// repeats of the material around the ring and around the tube
+const vec2 TEXTURE_REPEAT = vec2(8.0, 2.0);
+#endif
+
+#if MEASURE_TEXTURE_TRAFFIC
+// texels of both textures the scene reads, in TEXTURE_TRAFFIC_UNITS (see MaterialTextures)
+layout(std430, binding = SSBO_TEXTURE_TRAFFIC) buffer textureTrafficBuffer {
+  uint textureTrafficUnits;
+};
+#endif
+
+#if OIT_STORE
+// per-pixel lists of the transparent fragments, resolved by oit_resolve.frag.glsl (see OITRenderer)
+layout(binding = IMAGE_OIT_HEADS, r32ui) uniform coherent uimage2D oitHeads;
+
+layout(std430, binding = SSBO_OIT_NODES) writeonly buffer oitNodeBuffer {
+  uvec4 oitNodes[];
+};
+layout(std430, binding = SSBO_OIT_COUNTERS) buffer oitCounterBuffer {
+  uint oitAllocated;
+  uint oitDropped;
+};
+
+// opacity of the transparent tori
+const float OIT_ALPHA = 0.4;
+#endif
+
 // inputs in view space
 in Interpolants {
   centroid vec3 model_pos;
   centroid vec3 normal;
   centroid vec3 eyeDir;
   centroid vec3 lightDir;
+  flat     vec3 color;
+#if TEXTURED_MATERIAL
+  vec2 texcoord;
+#endif
 } IN;
 
 layout(location=0, index=0) out vec4 out_Color;
@@ -34,6 +91,25 @@ float calcNoise(vec3 modelPos, int iterations)
   return val;
 }
 
+#if TEXTURED_MATERIAL
+// the meshes have no tangents, the frame is built from the screen space derivatives
+mat3 cotangentFrame(vec3 normal, vec3 pos, vec2 uv)
+{
+  vec3 dp1  = dFdx(pos);
+  vec3 dp2  = dFdy(pos);
+  vec2 duv1 = dFdx(uv);
+  vec2 duv2 = dFdy(uv);
+
+  vec3 dp2perp = cross(dp2, normal);
+  vec3 dp1perp = cross(normal, dp1);
+  vec3 tangent   = dp2perp * duv1.x + dp1perp * duv2.x;
+  vec3 bitangent = dp2perp * duv1.y + dp1perp * duv2.y;
+
+  float invmax = inversesqrt(max(max(dot(tangent, tangent), dot(bitangent, bitangent)), 1e-20));
+  return mat3(tangent * invmax, bitangent * invmax, normal);
+}
+#endif
+
 vec4 calculateLight(vec3 normal, vec3 eyeDir, vec3 lightDir, vec3 objColor) 
 {
   // ambient term
@@ -51,6 +127,37 @@ vec4 calculateLight(vec3 normal, vec3 eyeDir, vec3 lightDir, vec3 objColor)
   return ambient_color + diffuse_color + specular_color;
 }
 
+#if HALF_PRECISION
+// float16 variant of the lighting above, mirrored by calculateLight in
+// MaterialReference. The inputs are normalized in fp32, reflect and pow are
+// spelled out, the power of ten as three squarings and one multiply.
+vec4 calculateLightHalf(vec3 normal, vec3 eyeDir, vec3 lightDir, vec3 objColor)
+{
+  f16vec3 n     = f16vec3(normal);
+  f16vec3 e     = f16vec3(eyeDir);
+  f16vec3 l     = f16vec3(lightDir);
+  f16vec3 color = f16vec3(objColor);
+
+  // ambient term
+  f16vec4 ambient_color = f16vec4(color * float16_t(0.25), float16_t(1.0));
+
+  // diffuse term
+  float16_t n_dot_l           = n.x * l.x + n.y * l.y + n.z * l.z;
+  float16_t diffuse_intensity = float16_t(max(float(n_dot_l), 0.0)) / float16_t(1.5);
+  f16vec4   diffuse_color     = diffuse_intensity * f16vec4(color, float16_t(1.0));
+
+  // specular term
+  f16vec3   R                  = n * (float16_t(2.0) * n_dot_l) - l;
+  float16_t specular_intensity = float16_t(max(float(e.x * R.x + e.y * R.y + e.z * R.z), 0.0));
+  float16_t s2                 = specular_intensity * specular_intensity;
+  float16_t s4                 = s2 * s2;
+  float16_t s8                 = s4 * s4;
+  f16vec4   specular_color     = (s8 * s2) * f16vec4(float16_t(0.8), float16_t(0.8), float16_t(0.8), float16_t(1.0));
+
+  return vec4(ambient_color + diffuse_color + specular_color);
+}
+#endif
+
 void main()
 {
   // interpolated inputs in view space
@@ -58,40 +165,97 @@ void main()
   vec3 eyeDir   = normalize(IN.eyeDir);
   vec3 lightDir = normalize(IN.lightDir);
 
-  float noiseVal = calcNoise(IN.model_pos/2, scene.fragmentLoadFactor * 100);
-//  vec3 objColor = object.color * (1 - noiseVal * 0.9f);
-  vec3 objColor = object.color + vec3(noiseVal);
+  float noiseVal = calcNoise(IN.model_pos/2, FRAGMENT_LOAD_FACTOR * 100);
+//  vec3 objColor = IN.color * (1 - noiseVal * 0.9f);
+#if TEXTURED_MATERIAL
+  //////////// ShadingRateSample ////////////
+  //
+  // The derivatives of a coarse fragment already span its neighbors, so
+  // the hardware picks a mip level that much coarser on its own. The bias
+  // goes further along the fragment size and skips detail the coarse
+  // rate could only alias, which saves texture bandwidth.
+  //
+  vec2  uv           = IN.texcoord * TEXTURE_REPEAT;
+  ivec2 fragmentSize = gl_FragmentSizeNV;
+  float rateLog2     = log2(float(max(fragmentSize.x, fragmentSize.y)));
+  float lodBias      = scene.lodBiasScale * rateLog2;
 
+  vec3 albedo        = texture(albedoTex, uv, lodBias).rgb;
+  vec2 normalXY      = texture(normalTex, uv, lodBias).xy * 2.0 - 1.0;
+  vec3 normalTangent = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+  normal = normalize(cotangentFrame(normal, -IN.eyeDir, uv) * normalTangent);
+
+  vec3 objColor = albedo * (0.5 + 0.5 * IN.color) + vec3(noiseVal) * 0.3;
+
+#if MEASURE_TEXTURE_TRAFFIC
+  // Texels of the fetched level under the pixels of this invocation. The
+  // lambda of a single pixel is the one of the coarse derivatives without
+  // the fragment size, trilinear filtering is counted as one level.
+  float lambda      = textureQueryLod(albedoTex, uv).y;
+  float level       = clamp(lambda + lodBias, 0.0, float(textureQueryLevels(albedoTex) - 1));
+  float pixels      = float(max(bitCount(gl_SampleMaskIn[0]), 1));
+  float texels      = pixels * exp2(2.0 * (lambda - rateLog2 - level));
+  atomicAdd(textureTrafficUnits, uint(texels * TEXTURE_TRAFFIC_UNITS + 0.5));
+#endif
+#else
+  vec3 objColor = IN.color + vec3(noiseVal);
+#endif
+
+#if HALF_PRECISION
+  out_Color = calculateLightHalf(normal, eyeDir, lightDir, objColor);
+#else
   out_Color = calculateLight(normal, eyeDir, lightDir, objColor);
+#endif
+
+#if OIT_STORE
+  //////////// ShadingRateSample ////////////
+  //
+  // One node per invocation: a coarse fragment is stored once, in the list
+  // of the pixel it starts at, together with its size and the pixels it
+  // covers. Both the shading and the fragment buffer shrink with the rate.
+  // A full buffer drops the fragment, the counter keeps counting so the
+  // overflow shows up in the statistics.
+  //
+  {
+    ivec2 fragmentSize = gl_FragmentSizeNV;
+    ivec2 anchor       = (ivec2(gl_FragCoord.xy) / fragmentSize) * fragmentSize;
+    uint  node         = atomicAdd(oitAllocated, 1u);
+    if (node < uint(scene.sampleBufferSizeInSamples))
+    {
+      uint info = uint(findLSB(fragmentSize.x)) | (uint(findLSB(fragmentSize.y)) << 2)
+                | (uint(gl_SampleMaskIn[0] & 0xffff) << 16);
+      uint next = imageAtomicExchange(oitHeads, anchor, node);
+      oitNodes[node] = uvec4(packUnorm4x8(vec4(clamp(out_Color.rgb, 0.0, 1.0), OIT_ALPHA)), floatBitsToUint(gl_FragCoord.z), next, info);
+    }
+  }
+#endif
     
   //////////// ShadingRateSample ////////////
-  // 
-  // The Fragemnt Shader exposes new build-in types
+  //
+  // The Fragment Shader exposes new build-in types
   // to query the shading rate for the current fragment.
-  // Here we use them to visualize the shading rate.
+  // Here we use them to record how many invocations shade each pixel,
+  // the heatmap itself is drawn by rate_overlay.frag.glsl.
   //
-  if (scene.visualizeShadingRate == 1)
+#if COUNT_INVOCATIONS
   {
-    out_Color = vec4(1,0,0,1);
-    int maxCoarse = max( gl_FragmentSizeNV.x, gl_FragmentSizeNV.y );
+    ivec2 fragmentSize = gl_FragmentSizeNV;
+    ivec2 origin       = (ivec2(gl_FragCoord.xy) / fragmentSize) * fragmentSize;
+    int   mask         = gl_SampleMaskIn[0];
+    uint  units        = 16u / uint(max(bitCount(mask), 1));
 
-    if (maxCoarse == 1)
-    {
-      out_Color = vec4(1,0,0,1);
-    } 
-    else if (maxCoarse == 2)
-    {
-      out_Color = vec4(1,1,0,1);
-    } 
-    else if (maxCoarse == 4)
-    {
-      out_Color = vec4(0,1,0,1);
-    } 
-    else
+    for (int y = 0; y < fragmentSize.y; ++y)
     {
-      out_Color = vec4(1,1,1,1);
+      for (int x = 0; x < fragmentSize.x; ++x)
+      {
+        if ((mask & (1 << (y * fragmentSize.x + x))) != 0)
+        {
+          imageAtomicAdd(invocationCounts, origin + ivec2(x, y), units);
+        }
+      }
     }
   }
+#endif
 }
 
 /*
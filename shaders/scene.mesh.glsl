@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+#extension GL_NV_mesh_shader : require
+#extension GL_NV_primitive_shading_rate : require
+
+//
+// Emits one meshlet that survived the culling in scene.task.glsl. The
+// vertices are read from the torus vertex buffer (positions, normals and
+// texcoords one after another, see Torus::upload) and go through the same
+// outputVertex() as in the other scene programs.
+//
+
+#include "common.h"
+
+layout(local_size_x = MESHLET_GROUP_SIZE) in;
+layout(triangles, max_vertices = MESHLET_MAX_VERTICES, max_primitives = MESHLET_MAX_PRIMITIVES) out;
+
+layout(std430, binding = SSBO_MESHLET_VERTEX_DATA) readonly buffer vertexDataBuffer {
+  float vertexData[];
+};
+// vertex offset, primitive byte offset, vertex count, primitive count (see Meshlet)
+layout(std430, binding = SSBO_MESHLETS) readonly buffer meshletBuffer {
+  uvec4 meshlets[];
+};
+layout(std430, binding = SSBO_MESHLET_VERTEX_INDICES) readonly buffer meshletVertexBuffer {
+  uint meshletVertices[];
+};
+layout(std430, binding = SSBO_MESHLET_PRIMITIVES) readonly buffer meshletPrimitiveBuffer {
+  uint meshletPrimitives[];
+};
+
+layout(location = MESHLET_INFO_LOC) uniform uvec2 meshletInfo;  // meshlet count, vertex count
+
+taskNV in Task {
+  uint meshletIDs[MESHLET_GROUP_SIZE];
+} IN;
+
+#include "scene_vertex.glsl"
+
+vec3 readVec3(uint offset)
+{
+  return vec3(vertexData[offset], vertexData[offset + 1], vertexData[offset + 2]);
+}
+
+uint readPrimitiveIndex(uint byteOffset)
+{
+  return bitfieldExtract(meshletPrimitives[byteOffset / 4], int(byteOffset % 4) * 8, 8);
+}
+
+void main()
+{
+  uvec4 meshlet     = meshlets[IN.meshletIDs[gl_WorkGroupID.x]];
+  uint  vertexCount = meshletInfo.y;
+
+  for (uint v = gl_LocalInvocationID.x; v < meshlet.z; v += MESHLET_GROUP_SIZE)
+  {
+    uint index    = meshletVertices[meshlet.x + v];
+    vec3 position = readVec3(index * 3);
+    vec3 normal   = readVec3(vertexCount * 3 + index * 3);
+    vec2 texcoord = vec2(vertexData[vertexCount * 6 + index * 2], vertexData[vertexCount * 6 + index * 2 + 1]);
+    outputVertex(v, vec4(position, 1), normal, position, object.color, texcoord);
+  }
+
+  //////////// ShadingRateSample ////////////
+  //
+  // Without a provoking vertex the palette index is written per primitive,
+  // the rule is the same as in the other scene programs.
+  //
+  int shadingRate = shadingRateForColor(object.color);
+  for (uint p = gl_LocalInvocationID.x; p < meshlet.w; p += MESHLET_GROUP_SIZE)
+  {
+    gl_PrimitiveIndicesNV[p * 3 + 0] = readPrimitiveIndex(meshlet.y + p * 3 + 0);
+    gl_PrimitiveIndicesNV[p * 3 + 1] = readPrimitiveIndex(meshlet.y + p * 3 + 1);
+    gl_PrimitiveIndicesNV[p * 3 + 2] = readPrimitiveIndex(meshlet.y + p * 3 + 2);
+    gl_MeshPrimitivesNV[p].gl_Layer         = 0;
+    gl_MeshPrimitivesNV[p].gl_ShadingRateNV = shadingRate;
+  }
+
+  if (gl_LocalInvocationID.x == 0)
+  {
+    gl_PrimitiveCountNV = meshlet.w;
+  }
+}
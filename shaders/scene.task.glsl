@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+#extension GL_NV_mesh_shader : require
+#extension GL_NV_shader_thread_group : require
+
+//
+// Culls the meshlets of a torus (see MeshletBuilder and Torus::drawMeshlets),
+// one invocation per meshlet, and starts a scene.mesh.glsl workgroup for
+// each survivor. A meshlet is culled when its bounding sphere is outside of
+// the frustum, when its normal cone faces away from the eye, or when all
+// rate image tiles under it have no invocations.
+//
+
+#include "common.h"
+#include "tessellation.h"
+
+layout(local_size_x = MESHLET_GROUP_SIZE) in;
+
+// x, y, z of the bounding sphere, radius, cone axis, cone cutoff (see MeshletBounds)
+layout(std430, binding = SSBO_MESHLET_BOUNDS) readonly buffer meshletBoundsBuffer {
+  vec4 meshletBounds[];
+};
+layout(std430, binding = SSBO_MESHLET_STATS) buffer meshletStatsBuffer {
+  uint meshletsDrawn;
+  uint meshletsFrustumCulled;
+  uint meshletsConeCulled;
+  uint meshletsRateCulled;
+};
+
+layout(location = OFFSET_LOC)        uniform float offset;
+layout(location = MESHLET_INFO_LOC)  uniform uvec2 meshletInfo;  // meshlet count, vertex count
+layout(location = MESHLET_CULL_LOC)  uniform vec4  meshletCull;  // viewport width, height, rate image texel width, height
+layout(location = MESHLET_FLAGS_LOC) uniform ivec2 meshletFlags; // cull by rate image, cull by normal cone
+
+layout(binding = TEX_MESHLET_RATE) uniform usampler2D rateImage;
+
+taskNV out Task {
+  uint meshletIDs[MESHLET_GROUP_SIZE];
+} OUT;
+
+// spheres spanning more tiles than this per axis are never culled by their rates
+const int MAX_CULL_TILES = 8;
+
+const int CULL_NONE    = 0;
+const int CULL_FRUSTUM = 1;
+const int CULL_CONE    = 2;
+const int CULL_RATE    = 3;
+
+// the projection of the scene vertices, offset is added to the clip x like in scene_vertex.glsl
+mat4 getModelViewProj()
+{
+  mat4 modelViewProj = object.modelViewProj;
+  modelViewProj[3][0] += offset;
+  return modelViewProj;
+}
+
+bool isOutsideFrustum(mat4 modelViewProj, vec3 center, float radius)
+{
+  // the clip planes in model space, -w <= x,y,z <= w
+  mat4 rows = transpose(modelViewProj);
+  for (int i = 0; i < 3; ++i)
+  {
+    vec4 planes[2] = vec4[2](rows[3] + rows[i], rows[3] - rows[i]);
+    for (int k = 0; k < 2; ++k)
+    {
+      if (dot(planes[k].xyz, center) + planes[k].w < -radius * length(planes[k].xyz))
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool isBackFacing(vec3 center, float radius, vec3 coneAxis, float coneCutoff)
+{
+  // modelViewIT is the inverse transpose, so this is the eye in model space
+  vec3 eye  = (transpose(object.modelViewIT) * vec4(0, 0, 0, 1)).xyz;
+  vec3 view = center - eye;
+  return dot(view, coneAxis) >= coneCutoff * length(view) + radius;
+}
+
+bool isOverNoInvocations(mat4 modelViewProj, vec3 center, float radius)
+{
+  // the screen rectangle of the cube around the sphere, not culled if any corner is behind the eye
+  vec2 viewport = meshletCull.xy;
+  vec2 minPixel = vec2( 1e30);
+  vec2 maxPixel = vec2(-1e30);
+  for (int i = 0; i < 8; ++i)
+  {
+    vec3 corner = center + radius * vec3((i & 1) != 0 ? 1 : -1, (i & 2) != 0 ? 1 : -1, (i & 4) != 0 ? 1 : -1);
+    vec4 clip   = modelViewProj * vec4(corner, 1);
+    if (clip.w <= TESS_MIN_W)
+    {
+      return false;
+    }
+    vec2 pixel = tessScreenPosition(clip, viewport);
+    minPixel = min(minPixel, pixel);
+    maxPixel = max(maxPixel, pixel);
+  }
+
+  ivec2 texelSize = ivec2(meshletCull.zw);
+  ivec2 imageSize = textureSize(rateImage, 0);
+  ivec2 minTile   = tessRateTile(minPixel, texelSize, imageSize);
+  ivec2 maxTile   = tessRateTile(maxPixel, texelSize, imageSize);
+  if (any(greaterThan(maxTile - minTile, ivec2(MAX_CULL_TILES - 1))))
+  {
+    return false;
+  }
+  for (int y = minTile.y; y <= maxTile.y; ++y)
+  {
+    for (int x = minTile.x; x <= maxTile.x; ++x)
+    {
+      if (texelFetch(rateImage, ivec2(x, y), 0).r != 0u)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int cullMeshlet(uint meshletID)
+{
+  vec4  sphere = meshletBounds[meshletID * 2 + 0];
+  vec4  cone   = meshletBounds[meshletID * 2 + 1];
+  mat4  modelViewProj = getModelViewProj();
+
+  if (isOutsideFrustum(modelViewProj, sphere.xyz, sphere.w))
+  {
+    return CULL_FRUSTUM;
+  }
+  if (meshletFlags.y != 0 && cone.w < 1.0 && isBackFacing(sphere.xyz, sphere.w, cone.xyz, cone.w))
+  {
+    return CULL_CONE;
+  }
+  if (meshletFlags.x != 0 && isOverNoInvocations(modelViewProj, sphere.xyz, sphere.w))
+  {
+    return CULL_RATE;
+  }
+  return CULL_NONE;
+}
+
+void main()
+{
+  uint meshletID = gl_GlobalInvocationID.x;
+  bool valid     = meshletID < meshletInfo.x;
+  int  culled    = valid ? cullMeshlet(meshletID) : CULL_NONE;
+  bool visible   = valid && culled == CULL_NONE;
+
+  //////////// ShadingRateSample ////////////
+  //
+  // Meshlets over tiles without invocations would not produce a single
+  // fragment, they are dropped here before their vertices are fetched.
+  // The survivors are compacted with a ballot, one task workgroup is one
+  // warp on the hardware this targets.
+  //
+  uint vote = ballotThreadNV(visible);
+  if (visible)
+  {
+    OUT.meshletIDs[bitCount(vote & gl_ThreadLtMaskNV)] = meshletID;
+  }
+
+  uint drawn   = bitCount(vote);
+  uint frustum = bitCount(ballotThreadNV(culled == CULL_FRUSTUM));
+  uint back    = bitCount(ballotThreadNV(culled == CULL_CONE));
+  uint rate    = bitCount(ballotThreadNV(culled == CULL_RATE));
+  if (gl_LocalInvocationID.x == 0)
+  {
+    gl_TaskCountNV = drawn;
+    atomicAdd(meshletsDrawn, drawn);
+    atomicAdd(meshletsFrustumCulled, frustum);
+    atomicAdd(meshletsConeCulled, back);
+    atomicAdd(meshletsRateCulled, rate);
+  }
+}
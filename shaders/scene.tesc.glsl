@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+
+//
+// Tessellation factors of the parametric torus patches (see
+// TessellatedTorus). The factor math lives in tessellation.h and is
+// mirrored by TessellationReference.cpp. Each outer factor only depends on
+// the corners and the middle of its edge, always walked in the direction
+// of increasing u or v, so the patches on both sides of an edge agree and
+// the surface has no cracks.
+//
+
+#include "common.h"
+#include "tessellation.h"
+
+layout(vertices = 4) out;
+
+// corners (u0,v0), (u1,v0), (u1,v1), (u0,v1)
+in TessVertex {
+  vec2 uv;
+} IN[];
+
+out TessVertex {
+  vec2 uv;
+} OUT[];
+
+layout(location = TESS_SETTINGS_LOC) uniform vec4  tessSettings; // target edge pixels, max factor, viewport width, height
+layout(location = TESS_RATE_LOC)     uniform ivec3 tessRate;     // rate image texel width, height, 1 if the factors follow it
+layout(location = TESS_RADII_LOC)    uniform vec2  torusRadii;   // inner, outer
+
+layout(binding = TEX_TESS_RATE) uniform usampler2D rateImage;
+
+// patches spanning more tiles than this per axis are never culled by their rates
+const int MAX_CULL_TILES = 8;
+
+vec4 clipPosition(vec2 uv)
+{
+  return object.modelViewProj * vec4(tessTorusPosition(uv, torusRadii), 1);
+}
+
+int fetchRate(ivec2 tile)
+{
+  return int(texelFetch(rateImage, tile, 0).r);
+}
+
+float edgeFactor(vec2 uvA, vec2 uvB, vec4 a, vec4 b, vec2 viewport)
+{
+  vec4 m = clipPosition((uvA + uvB) * 0.5);
+  float pixels = tessEdgePixels(a, m, b, viewport);
+
+  float fragmentSize = 1.0;
+  if (tessRate.z != 0 && m.w > TESS_MIN_W)
+  {
+    ivec2 tile = tessRateTile(tessScreenPosition(m, viewport), tessRate.xy, textureSize(rateImage, 0));
+    fragmentSize = tessFragmentSize(fetchRate(tile));
+  }
+  return tessEdgeFactor(pixels, fragmentSize, tessSettings.x, tessSettings.y);
+}
+
+// true if no part of the patch can produce a visible fragment
+bool isPatchCulled(vec2 viewport)
+{
+  // a 3x3 grid of surface points: the frustum test needs all of them outside of the same plane
+  int  outcode  = 0x3f;
+  bool inFront  = true;
+  vec2 minPixel = vec2( 1e30);
+  vec2 maxPixel = vec2(-1e30);
+  for (int y = 0; y <= 2; ++y)
+  {
+    for (int x = 0; x <= 2; ++x)
+    {
+      vec2 t  = vec2(x, y) * 0.5;
+      vec2 uv = mix(mix(IN[0].uv, IN[1].uv, t.x), mix(IN[3].uv, IN[2].uv, t.x), t.y);
+      vec4 clip = clipPosition(uv);
+      outcode &= tessClipOutcode(clip, TESS_CULL_MARGIN);
+      inFront = inFront && clip.w > TESS_MIN_W;
+      if (clip.w > TESS_MIN_W)
+      {
+        vec2 pixel = tessScreenPosition(clip, viewport);
+        minPixel = min(minPixel, pixel);
+        maxPixel = max(maxPixel, pixel);
+      }
+    }
+  }
+  if (outcode != 0)
+  {
+    return true;
+  }
+  if (tessRate.z == 0 || !inFront)
+  {
+    return false;
+  }
+
+  // all tiles under the patch, plus one around for the bulge between the points, without invocations
+  ivec2 imageSize = textureSize(rateImage, 0);
+  ivec2 minTile = tessRateTile(minPixel, tessRate.xy, imageSize) - 1;
+  ivec2 maxTile = tessRateTile(maxPixel, tessRate.xy, imageSize) + 1;
+  minTile = max(minTile, ivec2(0));
+  maxTile = min(maxTile, imageSize - 1);
+  if (any(greaterThan(maxTile - minTile, ivec2(MAX_CULL_TILES - 1))))
+  {
+    return false;
+  }
+  for (int y = minTile.y; y <= maxTile.y; ++y)
+  {
+    for (int x = minTile.x; x <= maxTile.x; ++x)
+    {
+      if (fetchRate(ivec2(x, y)) != 0)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void main()
+{
+  OUT[gl_InvocationID].uv = IN[gl_InvocationID].uv;
+
+  // one invocation computes the factors of the whole patch
+  if (gl_InvocationID != 0)
+  {
+    return;
+  }
+
+  vec2 viewport = tessSettings.zw;
+
+  if (isPatchCulled(viewport))
+  {
+    gl_TessLevelOuter[0] = 0.0;
+    gl_TessLevelOuter[1] = 0.0;
+    gl_TessLevelOuter[2] = 0.0;
+    gl_TessLevelOuter[3] = 0.0;
+    return;
+  }
+
+  vec4 c0 = clipPosition(IN[0].uv);
+  vec4 c1 = clipPosition(IN[1].uv);
+  vec4 c2 = clipPosition(IN[2].uv);
+  vec4 c3 = clipPosition(IN[3].uv);
+
+  // the edges u=0, v=0, u=1 and v=1 of the quad domain
+  gl_TessLevelOuter[0] = edgeFactor(IN[0].uv, IN[3].uv, c0, c3, viewport);
+  gl_TessLevelOuter[1] = edgeFactor(IN[0].uv, IN[1].uv, c0, c1, viewport);
+  gl_TessLevelOuter[2] = edgeFactor(IN[1].uv, IN[2].uv, c1, c2, viewport);
+  gl_TessLevelOuter[3] = edgeFactor(IN[3].uv, IN[2].uv, c3, c2, viewport);
+
+  gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+  gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+}
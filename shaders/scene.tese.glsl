@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+#extension GL_ARB_shading_language_include : enable
+#extension GL_NV_viewport_array2: require
+#extension GL_NV_primitive_shading_rate: require
+
+//
+// Evaluates the torus surface at the generated domain points, the factors
+// come from scene.tesc.glsl. The triangles are counter-clockwise in uv
+// like the ones of generateTorusMesh().
+//
+
+#include "common.h"
+#include "tessellation.h"
+
+layout(quads, fractional_odd_spacing, ccw) in;
+
+in TessVertex {
+  vec2 uv;
+} IN[];
+
+layout(location = TESS_RADII_LOC) uniform vec2 torusRadii; // inner, outer
+
+#include "scene_vertex.glsl"
+
+void main()
+{
+  vec2 t  = gl_TessCoord.xy;
+  vec2 uv = mix(mix(IN[0].uv, IN[1].uv, t.x), mix(IN[3].uv, IN[2].uv, t.x), t.y);
+
+  vec3 pos    = tessTorusPosition(uv, torusRadii);
+  vec3 normal = tessTorusNormal(uv);
+
+  // not wrapped, so the texture coordinates run up to 1 at the seams like the ones of the mesh
+  outputVertex(0, vec4(pos, 1), normal, pos, object.color, uv);
+}
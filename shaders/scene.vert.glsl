@@ -3,66 +3,64 @@
 #extension GL_ARB_shading_language_include : enable
 #extension GL_NV_viewport_array2: require
 #extension GL_NV_primitive_shading_rate: require
+#extension GL_ARB_shader_draw_parameters : enable
 
 
 #include "common.h"
 
-// inputs in model space
-in layout(location=VERTEX_POS)    vec3 vertex_pos_model;
-in layout(location=VERTEX_NORMAL) vec3 normal;
+#if TESSELLATION
 
-layout(location=OFFSET_LOC) uniform float offset;
+// the surface is generated by scene.tese.glsl, only the uv of the patch corners pass through
+in layout(location=VERTEX_TEXCOORD) vec2 patch_uv;
 
-// outputs in view space
-out Interpolants {
-  centroid vec3 model_pos;
-  centroid vec3 normal;
-  centroid vec3 eyeDir;
-  centroid vec3 lightDir;
+out TessVertex {
+  vec2 uv;
 } OUT;
 
 void main()
 {
-  // proj space calculations
-  vec4 proj_pos = object.modelViewProj * vec4( vertex_pos_model, 1 );
-  gl_Position   = proj_pos + vec4(offset, 0, 0, 0);
+  OUT.uv = patch_uv;
+}
 
-  gl_Layer = 0;
+#else
 
-  // view space calculations
-  vec3 pos      = (object.modelView   * vec4(vertex_pos_model,1)).xyz;
-  vec3 lightPos = (scene.viewMatrix   * vec4(scene.lightPos_world,1)).xyz;
-  OUT.normal    = ( (object.modelViewIT * vec4(normal,0)).xyz );
-  OUT.eyeDir    = (scene.eyePos_view - pos);
-  OUT.lightDir  = (lightPos - pos);
-  OUT.model_pos = vertex_pos_model;
+#include "scene_vertex.glsl"
 
-  //////////// ShadingRateSample ////////////
-  //
-  // Each viewport can have a different shading rate palette,
-  // we use this feature here to shade objects at different rates.
-  // As we can set this per triangle (via the provoking vertex)
-  // we have a lot of flexibility.
-  // Here it's demonstrated just by the object color.
-  //
-  if (scene.fullShadingRateForGreenObjects == 1)
-  {
-  //gl_Position.x += 0.1;
-    if (object.color.g > 0.8 && object.color.r < 0.2 && object.color.b < 0.2)
-    {
-      gl_ShadingRateNV = 1;
-    }
-    else
-    {
-      gl_ShadingRateNV = 0;
-    }
-  }
-  else
-  {
-    gl_ShadingRateNV = 0;
-  }
+#if USE_INSTANCING
+layout(std430, binding = SSBO_INSTANCES) readonly buffer instanceBuffer {
+  InstanceData instances[];
+};
+#endif
+
+// inputs in model space
+in layout(location=VERTEX_POS)    vec3 vertex_pos_model;
+in layout(location=VERTEX_NORMAL) vec3 normal;
+#if TEXTURED_MATERIAL
+in layout(location=VERTEX_TEXCOORD) vec2 texcoord;
+#endif
+
+void main()
+{
+#if USE_INSTANCING
+  InstanceData instance = instances[gl_BaseInstanceARB + gl_InstanceID];
+  vec4 instance_pos     = instance.model * vec4( vertex_pos_model, 1 );
+  vec3 instance_normal  = mat3(instance.model) * normal;
+  vec3 color            = instance.color.rgb;
+#else
+  vec4 instance_pos     = vec4( vertex_pos_model, 1 );
+  vec3 instance_normal  = normal;
+  vec3 color            = object.color;
+#endif
+
+#if TEXTURED_MATERIAL
+  outputVertex(0, instance_pos, instance_normal, vertex_pos_model, color, texcoord);
+#else
+  outputVertex(0, instance_pos, instance_normal, vertex_pos_model, color, vec2(0));
+#endif
 }
 
+#endif // TESSELLATION
+
 /*
  * Copyright 1993-2018 NVIDIA Corporation.  All rights reserved.
  *
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+//
+// Last vertex stage of the scene program, shared by scene.vert.glsl,
+// scene.tese.glsl and scene.mesh.glsl: transforms a model space vertex,
+// writes the interpolants and picks the primitive shading rate. The mesh
+// shader writes vertex outputIndex of its meshlet and sets the shading
+// rate per primitive itself.
+//
+
+#ifdef SCENE_PERMUTATION
+#define FULL_RATE_FOR_GREEN    (FULL_RATE_FOR_GREEN_OBJECTS != 0)
+#else
+#define FULL_RATE_FOR_GREEN    (scene.fullShadingRateForGreenObjects == 1)
+#endif
+
+layout(location=OFFSET_LOC) uniform float offset;
+
+// outputs in view space
+out Interpolants {
+  centroid vec3 model_pos;
+  centroid vec3 normal;
+  centroid vec3 eyeDir;
+  centroid vec3 lightDir;
+  flat     vec3 color;
+#if TEXTURED_MATERIAL
+  // not centroid, the mip selection needs the derivatives of the pixel centers
+  vec2 texcoord;
+#endif
+#if MESH_SHADER
+} OUT_MESH[];
+
+#define OUT          OUT_MESH[outputIndex]
+#define OUT_POSITION gl_MeshVerticesNV[outputIndex].gl_Position
+#else
+} OUT;
+
+#define OUT_POSITION gl_Position
+#endif
+
+//////////// ShadingRateSample ////////////
+//
+// Each viewport can have a different shading rate palette,
+// we use this feature here to shade objects at different rates.
+// As we can set this per triangle (via the provoking vertex)
+// we have a lot of flexibility.
+// Here it's demonstrated just by the object color.
+//
+int shadingRateForColor(vec3 color)
+{
+  if (FULL_RATE_FOR_GREEN && color.g > 0.8 && color.r < 0.2 && color.b < 0.2)
+  {
+    return 1;
+  }
+  return 0;
+}
+
+void outputVertex(uint outputIndex, vec4 instance_pos, vec3 instance_normal, vec3 vertex_pos_model, vec3 color, vec2 texcoord)
+{
+  // proj space calculations
+  vec4 proj_pos = object.modelViewProj * instance_pos;
+  OUT_POSITION  = proj_pos + vec4(offset, 0, 0, 0);
+
+  // view space calculations
+  vec3 pos      = (object.modelView   * instance_pos).xyz;
+  vec3 lightPos = (scene.viewMatrix   * vec4(scene.lightPos_world,1)).xyz;
+  OUT.normal    = ( (object.modelViewIT * vec4(instance_normal,0)).xyz );
+  OUT.eyeDir    = (scene.eyePos_view - pos);
+  OUT.lightDir  = (lightPos - pos);
+  OUT.model_pos = vertex_pos_model;
+  OUT.color     = color;
+#if TEXTURED_MATERIAL
+  OUT.texcoord  = texcoord;
+#endif
+
+#if !MESH_SHADER
+  gl_Layer         = 0;
+  gl_ShadingRateNV = shadingRateForColor(color);
+#endif
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019-2021, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2019-2021 NVIDIA CORPORATION
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#version 450
+
+//
+// Upscales the reduced resolution scene color to the window size.
+// UPSCALE_FILTER selects the filter (values match UpscaleFilter in
+// UpscaleReference.h, which also holds the CPU version of each filter):
+//   1 bilinear
+//   2 Lanczos-2, separable 4x4 taps
+//   3 edge-adaptive: bilinear in flat regions, de-ringed Lanczos-2 on edges
+//
+
+#ifndef UPSCALE_FILTER
+#define UPSCALE_FILTER 1
+#endif
+
+#define UPSCALE_BILINEAR      1
+#define UPSCALE_LANCZOS       2
+#define UPSCALE_EDGE_ADAPTIVE 3
+
+#define PI 3.14159265358979
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0) uniform sampler2D inputImage;
+layout(binding = 0, rgba8) uniform writeonly image2D outputImage;
+
+layout(location = 0) uniform ivec2 inputSize; // rendered region of inputImage
+layout(location = 1) uniform ivec2 outputSize;
+layout(location = 2) uniform float sharpness; // edge-adaptive only, 0 = bilinear everywhere
+
+vec4 fetch(ivec2 p)
+{
+  return texelFetch(inputImage, clamp(p, ivec2(0), inputSize - 1), 0);
+}
+
+float lanczos2(float x)
+{
+  x = abs(x);
+  if(x < 1e-5)
+    return 1.0;
+  if(x >= 2.0)
+    return 0.0;
+  float px = PI * x;
+  return 2.0 * sin(px) * sin(px * 0.5) / (px * px);
+}
+
+vec4 lanczosWeights(float f)
+{
+  vec4 w = vec4(lanczos2(f + 1.0), lanczos2(f), lanczos2(1.0 - f), lanczos2(2.0 - f));
+  return w / dot(w, vec4(1.0));
+}
+
+vec4 bilinear(ivec2 base, vec2 f)
+{
+  vec4 p00 = fetch(base);
+  vec4 p10 = fetch(base + ivec2(1, 0));
+  vec4 p01 = fetch(base + ivec2(0, 1));
+  vec4 p11 = fetch(base + ivec2(1, 1));
+  return mix(mix(p00, p10, f.x), mix(p01, p11, f.x), f.y);
+}
+
+vec4 lanczos(ivec2 base, vec2 f)
+{
+  vec4 wx = lanczosWeights(f.x);
+  vec4 wy = lanczosWeights(f.y);
+
+  vec4 result = vec4(0.0);
+  for(int y = 0; y < 4; ++y)
+  {
+    vec4 row = vec4(0.0);
+    for(int x = 0; x < 4; ++x)
+    {
+      row += fetch(base + ivec2(x - 1, y - 1)) * wx[x];
+    }
+    result += row * wy[y];
+  }
+  return clamp(result, 0.0, 1.0);
+}
+
+float luma(vec4 c)
+{
+  return dot(c.rgb, vec3(0.299, 0.587, 0.114));
+}
+
+vec4 edgeAdaptive(ivec2 base, vec2 f)
+{
+  vec4 p00 = fetch(base);
+  vec4 p10 = fetch(base + ivec2(1, 0));
+  vec4 p01 = fetch(base + ivec2(0, 1));
+  vec4 p11 = fetch(base + ivec2(1, 1));
+
+  // gradient of the four nearest texels decides how much sharpening we apply
+  float l00 = luma(p00);
+  float l10 = luma(p10);
+  float l01 = luma(p01);
+  float l11 = luma(p11);
+  float gx   = 0.5 * (l10 + l11 - l00 - l01);
+  float gy   = 0.5 * (l01 + l11 - l00 - l10);
+  float edge = clamp(sqrt(gx * gx + gy * gy) * 4.0 * sharpness, 0.0, 1.0);
+
+  vec4 smoothed = mix(mix(p00, p10, f.x), mix(p01, p11, f.x), f.y);
+
+  // remove Lanczos ringing by clamping to the nearest texels
+  vec4 sharp = clamp(lanczos(base, f), min(min(p00, p10), min(p01, p11)), max(max(p00, p10), max(p01, p11)));
+
+  return mix(smoothed, sharp, edge);
+}
+
+void main()
+{
+  ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+  if(any(greaterThanEqual(pixel, outputSize)))
+    return;
+
+  vec2  src  = (vec2(pixel) + 0.5) * vec2(inputSize) / vec2(outputSize) - 0.5;
+  vec2  fl   = floor(src);
+  ivec2 base = ivec2(fl);
+  vec2  f    = src - fl;
+
+#if UPSCALE_FILTER == UPSCALE_LANCZOS
+  vec4 color = lanczos(base, f);
+#elif UPSCALE_FILTER == UPSCALE_EDGE_ADAPTIVE
+  vec4 color = edgeAdaptive(base, f);
+#else
+  vec4 color = bilinear(base, f);
+#endif
+
+  imageStore(outputImage, pixel, color);
+}
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+//
+// Tessellation factors of the parametric torus, shared by scene.tesc.glsl,
+// scene.tese.glsl and the CPU reference in TessellationReference.cpp. Like
+// common.h this is both GLSL and C++, the C++ side has to include glm first.
+// Only the GLSL subset that glm also provides is used here: no swizzles and
+// float literals with an f suffix.
+//
+
+#ifdef __cplusplus
+namespace tessellation
+{
+using glm::vec2;
+using glm::vec3;
+using glm::vec4;
+using glm::ivec2;
+using glm::clamp;
+using glm::cos;
+using glm::floor;
+using glm::length;
+using glm::sin;
+#define TESS_FUNCTION inline
+#else
+#define TESS_FUNCTION
+#endif
+
+const float TESS_TWO_PI = 6.28318530718f;
+
+// the frustum is widened by this fraction of w for the patch culling,
+// the patch surface bulges out between the points that are tested
+const float TESS_CULL_MARGIN = 0.1f;
+
+// fragment size of tiles without invocations, so edges across them get a factor of 1
+const float TESS_NO_INVOCATIONS_SIZE = 64.0f;
+
+// edges reaching behind the eye cannot be measured on screen
+const float TESS_MIN_W = 1e-4f;
+const float TESS_BEHIND_EYE_PIXELS = 1e9f;
+
+// Same surface as generateTorusMesh(): u goes around the ring (phi), v
+// around the tube (theta), both 0..1. The positions use the wrapped uv,
+// so the patches on both sides of the seams compute bitwise equal edges.
+TESS_FUNCTION vec3 tessTorusPosition(vec2 uv, vec2 radii)
+{
+  vec2 wrapped = uv - floor(uv);
+  float phi    = wrapped.x * TESS_TWO_PI;
+  float theta  = wrapped.y * TESS_TWO_PI;
+  float radius = radii.x + radii.y * cos(theta);
+  return vec3(radius * cos(phi), radii.y * sin(theta), -radius * sin(phi));
+}
+
+TESS_FUNCTION vec3 tessTorusNormal(vec2 uv)
+{
+  vec2 wrapped = uv - floor(uv);
+  float phi    = wrapped.x * TESS_TWO_PI;
+  float theta  = wrapped.y * TESS_TWO_PI;
+  return vec3(cos(phi) * cos(theta), sin(theta), -sin(phi) * cos(theta));
+}
+
+// one bit per frustum plane the clip space position is outside of
+TESS_FUNCTION int tessClipOutcode(vec4 clip, float margin)
+{
+  float w = clip.w * (1.0f + margin);
+  int code = 0;
+  if (clip.x < -w) code |= 1;
+  if (clip.x >  w) code |= 2;
+  if (clip.y < -w) code |= 4;
+  if (clip.y >  w) code |= 8;
+  if (clip.z < -w) code |= 16;
+  if (clip.z >  w) code |= 32;
+  return code;
+}
+
+// framebuffer pixels, bottom-left origin
+TESS_FUNCTION vec2 tessScreenPosition(vec4 clip, vec2 viewport)
+{
+  return (vec2(clip.x, clip.y) / clip.w * 0.5f + 0.5f) * viewport;
+}
+
+// shading rate image texel of a screen position, clamped to the image
+TESS_FUNCTION ivec2 tessRateTile(vec2 screen, ivec2 texelSize, ivec2 imageSize)
+{
+  ivec2 tile = ivec2(floor(screen / vec2(texelSize)));
+  return clamp(tile, ivec2(0), imageSize - ivec2(1));
+}
+
+// Projected length of the edge a-b in pixels, measured along a-m-b through
+// the surface point at the middle of the edge, so the curvature of the
+// tube counts as well. Symmetric in a and b, the patches on both sides of
+// an edge get the same length.
+TESS_FUNCTION float tessEdgePixels(vec4 a, vec4 m, vec4 b, vec2 viewport)
+{
+  if (a.w <= TESS_MIN_W || m.w <= TESS_MIN_W || b.w <= TESS_MIN_W)
+  {
+    return TESS_BEHIND_EYE_PIXELS;
+  }
+  vec2 sa = tessScreenPosition(a, viewport);
+  vec2 sm = tessScreenPosition(m, viewport);
+  vec2 sb = tessScreenPosition(b, viewport);
+  return length(sm - sa) + length(sb - sm);
+}
+
+// pixels per fragment along each axis of a palette 0 entry, see ShadingRatePaletteEntry
+TESS_FUNCTION float tessFragmentSize(int rate)
+{
+  if (rate == 1) return 1.0f;
+  if (rate == 2) return 2.0f;
+  if (rate == 3) return 4.0f;
+  return TESS_NO_INVOCATIONS_SIZE;
+}
+
+// Segments for an edge: one per targetPixels of the edge, and as many
+// fewer as the fragments there are larger than a pixel, a coarse fragment
+// cannot show detail below its size anyway.
+TESS_FUNCTION float tessEdgeFactor(float pixels, float fragmentSize, float targetPixels, float maxFactor)
+{
+  return clamp(pixels / (targetPixels * fragmentSize), 1.0f, maxFactor);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Compares a separable AO blur with the brute force loop of composite.frag,
+// on the CPU versions in AOBlurReference:
+//
+//   ao_blur_compare [width height] [depthThreshold]
+//
+// The input is synthetic: a sloped background with boxes and a disc in
+// front of it, so the depth test of the blur has edges to stop at, and a
+// noisy occlusion term as a few AO samples per pixel would give. For each
+// radius the separable blur is compared at full rate, and with a foveated
+// shading rate image (1x1, 2x2 and 4x4 rings, no invocations in the
+// corners, in 16x16 texels), which skips taps.
+//
+// The brute force loop uses the radius as given, the separable blur clamps
+// it to AO_BLUR_MAX_RADIUS, the line cache a compute version would keep.
+// The error is therefore measured against the brute force loop at the
+// clamped radius. Above the clamp the error against the unclamped loop is
+// listed as well, it is what the composite would change by.
+//
+// Both blurs average the samples of a window, so a constant occlusion term
+// has to come out unchanged. The tool fails if it does not, if any result
+// is outside [0, 1], or if a coarse tile sums its center more than once.
+//
+
+#include "../AOBlurReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct AOInput
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> occlusion;
+    std::vector<float> depth;
+};
+
+// deterministic, so runs can be compared
+static float hashNoise(uint32_t x, uint32_t y)
+{
+    uint32_t h = x * 374761393u + y * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return float(h & 0xffffu) / 65535.0f;
+}
+
+static AOInput createInput(int width, int height)
+{
+    AOInput input;
+    input.width = width;
+    input.height = height;
+    input.occlusion.resize(size_t(width) * height);
+    input.depth.resize(size_t(width) * height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            float u = float(x) / float(width);
+            float v = float(y) / float(height);
+
+            // background sloped away from the viewer, with an occluded crease along the floor
+            float depth = 10.0f + 5.0f * v;
+            float base = v > 0.75f ? 0.55f : 0.85f;
+
+            // boxes in front of the background
+            if ((u > 0.15f && u < 0.35f && v > 0.2f && v < 0.7f) || (u > 0.6f && u < 0.9f && v > 0.55f && v < 0.8f))
+            {
+                depth = 3.0f + 0.5f * u;
+                base = 0.7f;
+            }
+
+            // disc in between
+            float du = (u - 0.5f) * float(width) / float(height);
+            float dv = v - 0.35f;
+            if (du * du + dv * dv < 0.04f)
+            {
+                depth = 6.0f + std::sqrt(du * du + dv * dv);
+                base = 0.9f;
+            }
+
+            size_t index = size_t(x) + size_t(y) * width;
+            input.depth[index] = depth;
+            input.occlusion[index] = std::min(std::max(base + 0.3f * (hashNoise(x, y) - 0.5f), 0.0f), 1.0f);
+        }
+    }
+    return input;
+}
+
+// palette indices as in VRSDemo: 0 = no invocations, 1 = 1x1, 2 = 2x2, 3 = 4x4
+static std::vector<uint8_t> createRateImage(int rateWidth, int rateHeight)
+{
+    std::vector<uint8_t> rates(size_t(rateWidth) * rateHeight);
+    for (int y = 0; y < rateHeight; ++y)
+    {
+        for (int x = 0; x < rateWidth; ++x)
+        {
+            float u = (float(x) + 0.5f) / float(rateWidth) * 2.0f - 1.0f;
+            float v = (float(y) + 0.5f) / float(rateHeight) * 2.0f - 1.0f;
+            float distance = std::sqrt(u * u + v * v);
+            rates[x + y * rateWidth] = distance < 0.4f ? 1 : distance < 0.8f ? 2 : distance < 1.25f ? 3 : 0;
+        }
+    }
+    return rates;
+}
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static bool inUnitRange(const std::vector<float>& values)
+{
+    for (float value : values)
+    {
+        if (!(value >= 0.0f && value <= 1.0f))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    int width = argc > 2 ? std::max(1, atoi(argv[1])) : 640;
+    int height = argc > 2 ? std::max(1, atoi(argv[2])) : 360;
+    float depthThreshold = argc > 3 ? float(atof(argv[3])) : 0.1f;
+
+    const int RATE_TEXEL_SIZE = 16;
+    int rateWidth = (width + RATE_TEXEL_SIZE - 1) / RATE_TEXEL_SIZE;
+    int rateHeight = (height + RATE_TEXEL_SIZE - 1) / RATE_TEXEL_SIZE;
+
+    AOInput input = createInput(width, height);
+    std::vector<uint8_t> rates = createRateImage(rateWidth, rateHeight);
+    size_t pixelCount = size_t(width) * height;
+    bool failed = false;
+
+    printf("%d x %d, depth threshold %.3f, separable radius clamped to %d\n", width, height, depthThreshold, AO_BLUR_MAX_RADIUS);
+    printf("errors against the brute force loop at the clamped radius (max / mean / rmse)\n");
+    printf("%6s %10s %10s %28s %28s %12s\n", "radius", "brute ms", "sep. ms", "separable", "separable with rates", "unclamped");
+
+    const int radii[] = {1, 2, 4, 8, 16, 24};
+    std::vector<float> bruteForce(pixelCount);
+    std::vector<float> unclamped(pixelCount);
+    std::vector<float> separable(pixelCount);
+    std::vector<float> separableRates(pixelCount);
+    for (int radius : radii)
+    {
+        int clampedRadius = std::min(radius, AO_BLUR_MAX_RADIUS);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        blurAOBruteForce(input.occlusion.data(), input.depth.data(), width, height, clampedRadius, depthThreshold, bruteForce.data());
+        double bruteSeconds = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        blurAOSeparable(input.occlusion.data(), input.depth.data(), width, height, radius, depthThreshold, separable.data());
+        double separableSeconds = secondsSince(start);
+
+        blurAOSeparable(input.occlusion.data(), input.depth.data(), width, height, radius, depthThreshold,
+                        separableRates.data(), rates.data(), rateWidth, RATE_TEXEL_SIZE, RATE_TEXEL_SIZE);
+
+        AOBlurError error = compareAO(separable.data(), bruteForce.data(), pixelCount);
+        AOBlurError rateError = compareAO(separableRates.data(), bruteForce.data(), pixelCount);
+
+        char unclampedText[32] = "-";
+        if (radius > clampedRadius)
+        {
+            blurAOBruteForce(input.occlusion.data(), input.depth.data(), width, height, radius, depthThreshold, unclamped.data());
+            snprintf(unclampedText, sizeof(unclampedText), "%.4f", compareAO(separable.data(), unclamped.data(), pixelCount).meanAbs);
+        }
+
+        printf("%6d %10.2f %10.2f %10.4f %8.4f %8.4f %10.4f %8.4f %8.4f %12s\n", radius, bruteSeconds * 1000.0,
+               separableSeconds * 1000.0, error.maxAbs, error.meanAbs, error.rmse, rateError.maxAbs, rateError.meanAbs,
+               rateError.rmse, unclampedText);
+
+        if (!inUnitRange(bruteForce) || !inUnitRange(separable) || !inUnitRange(separableRates))
+        {
+            printf("FAILED: radius %d gives occlusion outside of [0, 1]\n", radius);
+            failed = true;
+        }
+    }
+
+    // a constant occlusion term has to survive both blurs, with and without the rate image
+    std::vector<float> constant(pixelCount, 0.625f);
+    for (int radius : radii)
+    {
+        blurAOBruteForce(constant.data(), input.depth.data(), width, height, radius, depthThreshold, bruteForce.data());
+        blurAOSeparable(constant.data(), input.depth.data(), width, height, radius, depthThreshold, separable.data());
+        blurAOSeparable(constant.data(), input.depth.data(), width, height, radius, depthThreshold, separableRates.data(),
+                        rates.data(), rateWidth, RATE_TEXEL_SIZE, RATE_TEXEL_SIZE);
+
+        float maxError = std::max({compareAO(bruteForce.data(), constant.data(), pixelCount).maxAbs,
+                                   compareAO(separable.data(), constant.data(), pixelCount).maxAbs,
+                                   compareAO(separableRates.data(), constant.data(), pixelCount).maxAbs});
+        if (maxError > 1.0e-5f)
+        {
+            printf("FAILED: radius %d changes a constant occlusion by %g\n", radius, maxError);
+            failed = true;
+        }
+    }
+
+    //
+    // The weight of the center in a coarse tile: an impulse in a flat row,
+    // blurred with step 2 and radius 4, has taps at -4, -2, 0 and 2 of
+    // weight 2 each, so a quarter of it stays in the center. Summing the
+    // center up front as well would leave a third.
+    //
+    const float impulse[9] = { 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    const float flat[9] = {};
+    const uint8_t coarse[1] = { 2 };
+    float impulseBlurred[9];
+    blurAOSeparable(impulse, flat, 9, 1, 4, depthThreshold, impulseBlurred, coarse, 1, RATE_TEXEL_SIZE, RATE_TEXEL_SIZE);
+    if (std::abs(impulseBlurred[4] - 0.25f) > 1.0e-6f)
+    {
+        printf("FAILED: the center of a 2x2 tile has weight %g instead of 0.25\n", impulseBlurred[4]);
+        failed = true;
+    }
+
+    if (failed)
+    {
+        return EXIT_FAILURE;
+    }
+    printf("constant occlusion is preserved by both blurs, coarse tiles count the center once\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,311 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the writer thread of FrameCapture (see CaptureWriter.h) without
+// GL, with frames in memory:
+//
+//   capture_writer_check [directory]
+//
+// - written frames: the PPM and PGM files hold the frames top row first,
+//   every frame is released once, and the counts and bytes add up,
+// - a failed write: with a directory in the way of frame 3, frames 0 to 2
+//   are written and the failed frame and the rest counted as dropped,
+//   together with the drops of the render thread; a directory that does
+//   not exist drops everything,
+// - restarting: begin() is refused while a frame of the previous capture
+//   is pending, its counts stay untouched, and once it is done a new
+//   capture starts with zeroed counts,
+// - concurrency: while 500 frames are written, the counts read on the
+//   main thread never exceed the frames pushed and never go backwards.
+//
+// The files go to capture_writer_check/ in the directory and are removed.
+//
+
+#include "../CaptureWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+struct TestFrame
+{
+    std::vector<uint8_t> color;
+    std::vector<uint8_t> rates;
+    CaptureFrame frame;
+};
+
+static TestFrame makeFrame(uint32_t frameIndex, uint32_t width, uint32_t height, uint32_t rateWidth, uint32_t rateHeight)
+{
+    TestFrame test;
+    test.color.resize(size_t(width) * height * 4);
+    for (size_t i = 0; i < test.color.size(); ++i)
+    {
+        test.color[i] = uint8_t(i * 7 + frameIndex);
+    }
+    test.rates.resize(size_t(rateWidth) * rateHeight);
+    for (size_t i = 0; i < test.rates.size(); ++i)
+    {
+        test.rates[i] = uint8_t(i % 4);
+    }
+    test.frame.frameIndex = frameIndex;
+    test.frame.color = test.color.data();
+    test.frame.width = width;
+    test.frame.height = height;
+    test.frame.rates = rateWidth ? test.rates.data() : nullptr;
+    test.frame.rateWidth = rateWidth;
+    test.frame.rateHeight = rateHeight;
+    return test;
+}
+
+static std::string fileName(const std::string& directory, uint32_t frameIndex, const char* suffix)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/frame%06u_%s", frameIndex, suffix);
+    return directory + name;
+}
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// the file is the header followed by the rows of the frame, top row first
+static bool matchesFile(const TestFrame& test, const std::string& directory)
+{
+    const CaptureFrame& frame = test.frame;
+    std::string header = "P6\n" + std::to_string(frame.width) + " " + std::to_string(frame.height) + "\n255\n";
+    std::vector<uint8_t> expected(header.begin(), header.end());
+    for (uint32_t y = frame.height; y-- > 0;)
+    {
+        for (uint32_t x = 0; x < frame.width; ++x)
+        {
+            const uint8_t* rgba = frame.color + (size_t(y) * frame.width + x) * 4;
+            expected.insert(expected.end(), rgba, rgba + 3);
+        }
+    }
+    if (readFile(fileName(directory, frame.frameIndex, "color.ppm")) != expected)
+    {
+        return false;
+    }
+
+    std::string rateName = fileName(directory, frame.frameIndex, "rate.pgm");
+    if (!frame.rates)
+    {
+        return !std::filesystem::exists(rateName);
+    }
+    header = "P5\n" + std::to_string(frame.rateWidth) + " " + std::to_string(frame.rateHeight) + "\n255\n";
+    expected.assign(header.begin(), header.end());
+    for (uint32_t y = frame.rateHeight; y-- > 0;)
+    {
+        expected.insert(expected.end(), frame.rates + size_t(y) * frame.rateWidth, frame.rates + size_t(y + 1) * frame.rateWidth);
+    }
+    return readFile(rateName) == expected;
+}
+
+static void waitIdle(const CaptureWriter& writer)
+{
+    while (writer.isBusy())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// the release callback, which can hold the writer to keep a frame pending
+struct Releases
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<uint32_t> counts;   // per id
+    size_t holdId = SIZE_MAX;
+
+    void release(size_t id)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return id != holdId; });
+        counts.resize(std::max(counts.size(), id + 1));
+        counts[id]++;
+    }
+    void hold(size_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        holdId = id;
+    }
+    void unhold()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            holdId = SIZE_MAX;
+        }
+        condition.notify_all();
+    }
+    bool allOnce(size_t count)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool once = counts.size() == count;
+        for (uint32_t c : counts)
+        {
+            once = once && c == 1;
+        }
+        counts.clear();
+        return once;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    std::string root = (argc > 1 ? std::string(argv[1]) : std::string(".")) + "/capture_writer_check";
+    std::string written = root + "/written";
+    std::string failing = root + "/failing";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(written);
+    std::filesystem::create_directories(failing);
+
+    bool failed = false;
+    Releases releases;
+    CaptureWriter writer([&](size_t id) { releases.release(id); });
+
+    printf("written frames\n");
+    std::vector<TestFrame> frames;
+    const uint32_t sizes[][4] = { { 1, 1, 1, 1 }, { 7, 5, 0, 0 }, { 33, 17, 3, 2 }, { 64, 36, 4, 3 }, { 3, 100, 1, 7 }, { 2, 2, 0, 0 } };
+    uint64_t expectedBytes = 0;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        frames.push_back(makeFrame(i, sizes[i][0], sizes[i][1], sizes[i][2], sizes[i][3]));
+        expectedBytes += uint64_t(sizes[i][0]) * sizes[i][1] * 3 + uint64_t(sizes[i][2]) * sizes[i][3];
+    }
+    check(writer.begin(written), "a capture starts", failed);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        writer.push(i, frames[i].frame);
+    }
+    waitIdle(writer);
+    uint32_t matching = 0;
+    for (const TestFrame& frame : frames)
+    {
+        matching += matchesFile(frame, written);
+    }
+    printf("  written %u  dropped %u  bytes %llu  matching files %u of %zu\n", writer.getFramesWritten(),
+           writer.getFramesDropped(), (unsigned long long)writer.getBytesWritten(), matching, frames.size());
+    check(matching == frames.size(), "the files hold the frames top row first", failed);
+    check(writer.getFramesWritten() == frames.size() && writer.getFramesDropped() == 0, "all frames are counted as written", failed);
+    check(writer.getBytesWritten() == expectedBytes, "the bytes of the pixels are counted", failed);
+    check(releases.allOnce(frames.size()), "every frame is released once", failed);
+
+    printf("failed write\n");
+    // frame 3 can not be opened for writing
+    std::filesystem::create_directories(fileName(failing, 3, "color.ppm"));
+    check(writer.begin(failing), "a capture starts after the previous one is written", failed);
+    check(writer.getFramesWritten() == 0 && writer.getBytesWritten() == 0, "a new capture starts with zeroed counts", failed);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        writer.push(i, frames[i].frame);
+    }
+    writer.drop(2);
+    waitIdle(writer);
+    printf("  written %u  dropped %u  failed %d at frame %u\n", writer.getFramesWritten(), writer.getFramesDropped(),
+           writer.hasWriteFailed() ? 1 : 0, writer.getFailedFrame());
+    check(writer.hasWriteFailed() && writer.getFailedFrame() == 3, "the write of frame 3 fails", failed);
+    check(writer.getFramesWritten() == 3, "the frames before the failure are written", failed);
+    check(writer.getFramesDropped() == 3 + 2, "the failed frame, the rest and the render thread drops are dropped", failed);
+    check(!std::filesystem::exists(fileName(failing, 4, "color.ppm")), "nothing is written after the failure", failed);
+    check(releases.allOnce(frames.size()), "every frame is released once", failed);
+
+    check(writer.begin(root + "/missing"), "a capture starts after a failed one", failed);
+    check(!writer.hasWriteFailed() && writer.getFramesDropped() == 0, "a new capture starts without the failure", failed);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        writer.push(i, frames[i].frame);
+    }
+    waitIdle(writer);
+    printf("  missing directory: written %u  dropped %u\n", writer.getFramesWritten(), writer.getFramesDropped());
+    check(writer.getFramesWritten() == 0 && writer.getFramesDropped() == frames.size(), "a missing directory drops every frame", failed);
+    check(releases.allOnce(frames.size()), "every frame is released once", failed);
+
+    printf("restart while busy\n");
+    check(writer.begin(written), "a capture starts", failed);
+    releases.hold(1);
+    writer.push(0, frames[0].frame);
+    writer.push(1, frames[1].frame);
+    // frame 0 is counted before frame 1 is held in its release
+    while (writer.getFramesWritten() < 2)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool refused = !writer.begin(failing);
+    bool kept = writer.getFramesWritten() == 2;
+    releases.unhold();
+    waitIdle(writer);
+    printf("  refused %d  counts kept %d\n", refused ? 1 : 0, kept ? 1 : 0);
+    check(refused, "begin() is refused while a frame is pending", failed);
+    check(kept, "the counts of the pending capture stay untouched", failed);
+    check(writer.getFramesWritten() == 2 && writer.getFramesDropped() == 0, "the pending capture finishes with its own counts", failed);
+    check(releases.allOnce(2), "every frame is released once", failed);
+    check(writer.begin(written) && writer.getFramesWritten() == 0, "the next capture starts once it is done", failed);
+
+    printf("concurrency\n");
+    const uint32_t concurrentFrames = 500;
+    TestFrame small = makeFrame(0, 8, 8, 1, 1);
+    uint32_t beyondPushed = 0;
+    uint32_t backwards = 0;
+    uint32_t lastCount = 0;
+    for (uint32_t i = 0; i < concurrentFrames; ++i)
+    {
+        small.frame.frameIndex = i;
+        writer.push(i, small.frame);
+        uint32_t count = writer.getFramesWritten() + writer.getFramesDropped();
+        beyondPushed += count > i + 1;
+        backwards += count < lastCount;
+        lastCount = count;
+    }
+    waitIdle(writer);
+    printf("  written %u of %u  counts beyond the pushed frames %u  going backwards %u\n", writer.getFramesWritten(),
+           concurrentFrames, beyondPushed, backwards);
+    check(writer.getFramesWritten() == concurrentFrames, "every frame is written", failed);
+    check(beyondPushed == 0 && backwards == 0, "the counts follow the pushed frames", failed);
+    check(releases.allOnce(concurrentFrames), "every frame is released once", failed);
+
+    writer.close();
+    std::filesystem::remove_all(root);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
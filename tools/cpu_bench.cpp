@@ -0,0 +1,598 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Microbenchmarks of the CPU hot paths of the sample, without a GL context:
+//
+//   cpu_bench [samples] [filter]
+//
+// Covers the rate image generation of VRSDemo (createFoveationTexture,
+// createConstantFoveationTexture, the incremental updateFoveationTexture
+// and the rate statistics), the torus mesh generation of Torus without the
+// upload, the per-object transforms of renderTori / updateObjectUniforms,
+// the draw order of RenderQueue against std::sort, the depth of field rates
+// (the SSE2 tile depth reduction next to a scalar loop, and the composition
+// with the foveation rates) and the extension scan of isExtensionPresent,
+// together with the per-name string copy it used to make as a baseline.
+//
+// Before timing, the depth of field reference is compared against brute
+// force: the tile ranges bitwise against the scalar loop on a framebuffer
+// whose last tile column is not a multiple of four pixels wide, and the
+// composed rates against the per pixel circle of confusion. A mismatch
+// fails the run.
+//
+// Each case is calibrated once to a batch of iterations that takes at least
+// 2 ms, which doubles as warm-up, then timed for the given number of
+// samples. The median time per iteration is the result, the fastest sample
+// and the spread (median absolute deviation over the median) show how
+// stable it is. Heap allocations and bytes per iteration are counted by the
+// replaced global operator new and delete of cpu_bench_alloc.cpp. The inputs
+// are fixed, so results compare across runs and builds. Cases are selected
+// by a substring of their name.
+//
+
+#include "../DepthOfFieldReference.h"
+#include "../RenderQueue.h"
+#include "../SceneTransforms.h"
+#include "../ShadingRateImage.h"
+#include "../ShadingRateStats.h"
+#include "../TorusGeometry.h"
+#include "../util_vrs.h"
+#include "cpu_bench_alloc.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// results go here so the work is not optimized away
+static volatile uint32_t g_sink = 0;
+
+struct BenchCase
+{
+    std::string name;
+    const char* unit = "items";     // of the throughput
+    double itemsPerIteration = 1.0;
+    std::function<void()> run;
+};
+
+struct BenchResult
+{
+    double medianSeconds = 0.0;     // per iteration
+    double minSeconds = 0.0;
+    double spread = 0.0;            // median absolute deviation / median
+    double allocations = 0.0;       // per iteration
+    double allocatedBytes = 0.0;
+};
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+static BenchResult runCase(const BenchCase& bench, int samples)
+{
+    // calibration and warm-up
+    uint64_t iterations = 1;
+    for (;;)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            bench.run();
+        }
+        if (secondsSince(start) >= 0.002 || iterations >= (1ull << 24))
+        {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> times(samples);
+    uint64_t allocations = getAllocationCount();
+    uint64_t allocatedBytes = getAllocatedBytes();
+    for (int s = 0; s < samples; ++s)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            bench.run();
+        }
+        times[s] = secondsSince(start) / double(iterations);
+    }
+    double totalIterations = double(iterations) * samples;
+
+    BenchResult result;
+    result.allocations = double(getAllocationCount() - allocations) / totalIterations;
+    result.allocatedBytes = double(getAllocatedBytes() - allocatedBytes) / totalIterations;
+    result.medianSeconds = median(times);
+    result.minSeconds = *std::min_element(times.begin(), times.end());
+    std::vector<double> deviations(samples);
+    for (int s = 0; s < samples; ++s)
+    {
+        deviations[s] = std::fabs(times[s] - result.medianSeconds);
+    }
+    result.spread = result.medianSeconds > 0.0 ? median(deviations) / result.medianSeconds : 0.0;
+    return result;
+}
+
+static std::string formatSeconds(double seconds)
+{
+    char text[32];
+    if (seconds >= 1.0e-3)
+    {
+        snprintf(text, sizeof(text), "%.3f ms", seconds * 1.0e3);
+    }
+    else if (seconds >= 1.0e-6)
+    {
+        snprintf(text, sizeof(text), "%.3f us", seconds * 1.0e6);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%.1f ns", seconds * 1.0e9);
+    }
+    return text;
+}
+
+// shading rate images of 16x16 pixel texels at 1080p and 4K
+static const uint32_t RATE_IMAGE_SIZES[2][2] = { { 120, 68 }, { 240, 135 } };
+static const char* RATE_IMAGE_NAMES[2] = { "1080p", "4k" };
+
+static void addRateImageCases(std::vector<BenchCase>& cases)
+{
+    for (int s = 0; s < 2; ++s)
+    {
+        const uint32_t width = RATE_IMAGE_SIZES[s][0];
+        const uint32_t height = RATE_IMAGE_SIZES[s][1];
+        const double texels = double(width) * height;
+        auto rates = std::make_shared<std::vector<uint8_t>>(size_t(width) * height);
+
+        BenchCase fill;
+        fill.name = std::string("foveation rates ") + RATE_IMAGE_NAMES[s];
+        fill.unit = "texels";
+        fill.itemsPerIteration = texels;
+        fill.run = [=]() {
+            fillFoveationRates(rates->data(), width, height, 0.5f, 0.5f, FoveationParams());
+            g_sink = g_sink + (*rates)[rates->size() / 2];
+        };
+        cases.push_back(fill);
+
+        BenchCase constant;
+        constant.name = std::string("constant rates ") + RATE_IMAGE_NAMES[s];
+        constant.unit = "texels";
+        constant.itemsPerIteration = texels;
+        constant.run = [=]() {
+            fillConstantRates(rates->data(), width, height, RATE_2X2);
+            g_sink = g_sink + (*rates)[rates->size() / 2];
+        };
+        cases.push_back(constant);
+
+        // updateFoveationTexture between two slightly different sets of radii
+        auto scratch = std::make_shared<std::vector<uint8_t>>(rates->size());
+        auto stats = std::make_shared<ShadingRateStats>();
+        auto toggle = std::make_shared<bool>(false);
+        BenchCase update;
+        update.name = std::string("foveation update ") + RATE_IMAGE_NAMES[s];
+        update.unit = "texels";
+        update.itemsPerIteration = texels;
+        update.run = [=]() {
+            if (stats->getTotalPixels() == 0)
+            {
+                stats->setLayout(width, height, 16, 16, width * 16, height * 16);
+                fillFoveationRates(rates->data(), width, height, 0.5f, 0.5f, FoveationParams());
+                stats->build(rates->data());
+            }
+            FoveationParams params;
+            *toggle = !*toggle;
+            params.radii[1] += *toggle ? 0.02f : 0.0f;
+            fillFoveationRates(scratch->data(), width, height, 0.5f, 0.5f, params);
+            RateRect dirty = diffRates(rates->data(), scratch->data(), width, height);
+            std::swap(*rates, *scratch);
+            stats->update(scratch->data(), rates->data(), dirty);
+            g_sink = g_sink + uint32_t(stats->getPixels(RATE_2X2));
+        };
+        cases.push_back(update);
+
+        BenchCase build;
+        build.name = std::string("rate statistics ") + RATE_IMAGE_NAMES[s];
+        build.unit = "texels";
+        build.itemsPerIteration = texels;
+        build.run = [=]() {
+            stats->setLayout(width, height, 16, 16, width * 16, height * 16);
+            stats->build(rates->data());
+            g_sink = g_sink + uint32_t(stats->getPixels(RATE_1X1));
+        };
+        cases.push_back(build);
+    }
+}
+
+static void addTorusCases(std::vector<BenchCase>& cases)
+{
+    // the default tessellation and the largest of the UI, with the meshlets
+    const uint32_t tessellations[] = { 8, 64 };
+    for (uint32_t n : tessellations)
+    {
+        TorusParams params;
+        params.n = n;
+        params.m = n;
+
+        BenchCase torus;
+        torus.name = "torus mesh " + std::to_string(n) + "x" + std::to_string(n);
+        torus.unit = "tris";
+        torus.itemsPerIteration = double(generateTorusMesh(params)->indices.size() / 3);
+        torus.run = [=]() {
+            std::shared_ptr<const TorusMesh> mesh = generateTorusMesh(params);
+            g_sink = g_sink + uint32_t(mesh->indices.size());
+        };
+        cases.push_back(torus);
+    }
+}
+
+static void addTransformCases(std::vector<BenchCase>& cases)
+{
+    const uint32_t counts[] = { 1000, 100000 };
+    for (uint32_t count : counts)
+    {
+        auto instances = std::make_shared<std::vector<vertexload::InstanceData>>();
+
+        BenchCase place;
+        place.name = "tori placement " + std::to_string(count);
+        place.unit = "tori";
+        place.itemsPerIteration = count;
+        place.run = [=]() {
+            placeTorusGrid(count, 16.0f / 9.0f, *instances);
+            g_sink = g_sink + uint32_t(instances->back().model[3][0]);
+        };
+        cases.push_back(place);
+
+        // what renderTori computes per torus before the upload
+        BenchCase matrices;
+        matrices.name = "object matrices " + std::to_string(count);
+        matrices.unit = "objects";
+        matrices.itemsPerIteration = count;
+        matrices.run = [=]() {
+            if (instances->size() != count)
+            {
+                placeTorusGrid(count, 16.0f / 9.0f, *instances);
+            }
+            const glm::mat4 view = glm::lookAt(glm::vec3(-1.5f, 0.0f, 1.5f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            const glm::mat4 projection = glm::perspective(45.0f, 16.0f / 9.0f, 0.01f, 10.0f);
+            vertexload::ObjectData data;
+            float sum = 0.0f;
+            for (const vertexload::InstanceData& instance : *instances)
+            {
+                data.color = glm::vec3(instance.color);
+                buildObjectMatrices(instance.model, view, projection, data);
+                sum += data.modelViewProj[3][3];
+            }
+            g_sink = g_sink + uint32_t(sum);
+        };
+        cases.push_back(matrices);
+    }
+}
+
+static void addRenderQueueCases(std::vector<BenchCase>& cases)
+{
+    // the keys renderTori builds: one pass, program and mesh, two palettes, depths across the view
+    const uint32_t counts[] = { 10000, 100000, 1000000 };
+    for (uint32_t count : counts)
+    {
+        auto keys = std::make_shared<std::vector<uint64_t>>(count);
+        uint32_t random = 1;
+        for (uint64_t& key : *keys)
+        {
+            random = random * 1664525u + 1013904223u;
+            float depth = 0.5f + 4.5f * float(random >> 8) / float(1u << 24);
+            key = makeDrawKey(DRAW_PASS_OPAQUE, 1, 0, (random >> 4) & 1, depth);
+        }
+        std::string suffix = count >= 1000000 ? std::to_string(count / 1000000) + "M" : std::to_string(count / 1000) + "k";
+
+        auto queue = std::make_shared<RenderQueue>();
+        BenchCase radix;
+        radix.name = "render queue " + suffix;
+        radix.unit = "draws";
+        radix.itemsPerIteration = count;
+        radix.run = [=]() {
+            queue->clear();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                queue->push((*keys)[i], i);
+            }
+            queue->sort();
+            g_sink = g_sink + queue->getItems()[0].index;
+        };
+        cases.push_back(radix);
+
+        auto items = std::make_shared<std::vector<RenderQueue::Item>>();
+        BenchCase comparison;
+        comparison.name = "render queue std::sort " + suffix;
+        comparison.unit = "draws";
+        comparison.itemsPerIteration = count;
+        comparison.run = [=]() {
+            items->clear();
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                items->push_back({ (*keys)[i], i });
+            }
+            std::sort(items->begin(), items->end(), [](const RenderQueue::Item& a, const RenderQueue::Item& b) {
+                return a.key < b.key || (a.key == b.key && a.index < b.index);
+            });
+            g_sink = g_sink + (*items)[0].index;
+        };
+        cases.push_back(comparison);
+    }
+}
+
+// a frame of the tori scene: geometry at 1 to 40 units with background between it
+static std::vector<float> makeDepthOfFieldFrame(uint32_t width, uint32_t height, float projA, float projB)
+{
+    std::vector<float> depth(size_t(width) * height);
+    uint32_t random = 7;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            random = random * 1664525u + 1013904223u;
+            float distance = 1.0f + 39.0f * float((x / 37 + y / 29) % 11) / 10.0f + float(random >> 24) / 256.0f;
+            bool background = ((x / 53) + (y / 41)) % 5 == 0 || (random >> 8) % 97 == 0;
+            depth[size_t(y) * width + x] = background ? 1.0f : ((projB / distance - projA) + 1.0f) * 0.5f;
+        }
+    }
+    return depth;
+}
+
+// reduceTileDepthRanges one pixel at a time
+static void reduceTileDepthRangesScalar(const float* depth, uint32_t width, uint32_t height, float projA, float projB,
+                                        uint32_t texelWidth, uint32_t texelHeight, TileDepthRange* ranges)
+{
+    const uint32_t tilesX = (width + texelWidth - 1) / texelWidth;
+    const uint32_t tilesY = (height + texelHeight - 1) / texelHeight;
+    std::fill(ranges, ranges + size_t(tilesX) * tilesY, TileDepthRange());
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float d = depth[size_t(y) * width + x];
+            if (d < 1.0f)
+            {
+                float z = projB / (d * 2.0f - 1.0f + projA);
+                TileDepthRange& range = ranges[size_t(y / texelHeight) * tilesX + x / texelWidth];
+                range.nearest = range.farthest == 0.0f ? z : std::min(range.nearest, z);
+                range.farthest = std::max(range.farthest, z);
+            }
+        }
+    }
+}
+
+static bool validateDepthOfField()
+{
+    const uint32_t width = 1930, height = 1081, texel = 16;
+    const float projA = -(100.0f + 0.1f) / (100.0f - 0.1f);
+    const float projB = -2.0f * 100.0f * 0.1f / (100.0f - 0.1f);
+    const uint32_t tilesX = (width + texel - 1) / texel, tilesY = (height + texel - 1) / texel;
+    std::vector<float> depth = makeDepthOfFieldFrame(width, height, projA, projB);
+
+    std::vector<TileDepthRange> ranges(size_t(tilesX) * tilesY), expected(ranges.size());
+    reduceTileDepthRanges(depth.data(), width, height, projA, projB, texel, texel, ranges.data());
+    reduceTileDepthRangesScalar(depth.data(), width, height, projA, projB, texel, texel, expected.data());
+    uint32_t wrongRanges = 0;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        wrongRanges += ranges[i].nearest != expected[i].nearest || ranges[i].farthest != expected[i].farthest;
+    }
+
+    //
+    // Brute force takes the rate of the sharpest pixel of each tile. The
+    // range of a tile across the focus has a sharper rate than any of its
+    // pixels, so the composed rate may be finer than brute force, never
+    // coarser, and has to be one of the two it was composed from.
+    //
+    DepthOfFieldSettings settings;
+    settings.enabled = true;
+    settings.focusDistance = 6.0f;
+    RateCostModel cost;
+    cost.invocationsPerPixel[RATE_NO_INVOCATIONS] = 0.0f;
+    cost.invocationsPerPixel[RATE_1X1] = 1.0f;
+    cost.invocationsPerPixel[RATE_2X2] = 1.0f / 4.0f;
+    cost.invocationsPerPixel[RATE_4X4] = 1.0f / 16.0f;
+    std::vector<uint8_t> rates(ranges.size()), composed(ranges.size());
+    fillFoveationRates(rates.data(), tilesX, tilesY, 0.4f, 0.5f, FoveationParams());
+    applyDepthOfFieldRates(rates.data(), ranges.data(), ranges.size(), settings, cost, composed.data());
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::vector<float> sharpest(ranges.size(), infinity);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float d = depth[size_t(y) * width + x];
+            float& coc = sharpest[size_t(y / texel) * tilesX + x / texel];
+            if (d < 1.0f)
+            {
+                coc = std::min(coc, getCircleOfConfusion(projB / (d * 2.0f - 1.0f + projA), settings));
+            }
+        }
+    }
+    uint32_t wrongRates = 0;
+    for (size_t i = 0; i < composed.size(); ++i)
+    {
+        // tiles without geometry keep the source rate
+        uint8_t dofRate = sharpest[i] == infinity                 ? uint8_t(RATE_1X1)
+                        : sharpest[i] >= settings.cocThresholds[1] ? uint8_t(RATE_4X4)
+                        : sharpest[i] >= settings.cocThresholds[0] ? uint8_t(RATE_2X2)
+                                                                   : uint8_t(RATE_1X1);
+        uint8_t expected = cost.invocationsPerPixel[dofRate] < cost.invocationsPerPixel[rates[i]] ? dofRate : rates[i];
+        bool fromEither = composed[i] == rates[i] || composed[i] == getDepthOfFieldRate(ranges[i], settings);
+        wrongRates += !fromEither || cost.invocationsPerPixel[composed[i]] < cost.invocationsPerPixel[expected];
+    }
+
+    printf("depth of field: %zu tiles, %u ranges differ from the scalar loop, %u composed rates coarser than brute force\n\n",
+           ranges.size(), wrongRanges, wrongRates);
+    return wrongRanges == 0 && wrongRates == 0;
+}
+
+static void addDepthOfFieldCases(std::vector<BenchCase>& cases)
+{
+    const uint32_t width = 1920, height = 1080, texel = 16;
+    const uint32_t tilesX = width / texel, tilesY = (height + texel - 1) / texel;
+    const float projA = -(100.0f + 0.1f) / (100.0f - 0.1f);
+    const float projB = -2.0f * 100.0f * 0.1f / (100.0f - 0.1f);
+    auto depth = std::make_shared<std::vector<float>>(makeDepthOfFieldFrame(width, height, projA, projB));
+    auto ranges = std::make_shared<std::vector<TileDepthRange>>(size_t(tilesX) * tilesY);
+
+    BenchCase reduce;
+    reduce.name = "dof tile ranges 1080p";
+    reduce.unit = "pixels";
+    reduce.itemsPerIteration = double(width) * height;
+    reduce.run = [=]() {
+        reduceTileDepthRanges(depth->data(), width, height, projA, projB, texel, texel, ranges->data());
+        g_sink = g_sink + uint32_t((*ranges)[ranges->size() / 2].farthest);
+    };
+    cases.push_back(reduce);
+
+    BenchCase scalar;
+    scalar.name = "dof tile ranges scalar 1080p";
+    scalar.unit = "pixels";
+    scalar.itemsPerIteration = double(width) * height;
+    scalar.run = [=]() {
+        reduceTileDepthRangesScalar(depth->data(), width, height, projA, projB, texel, texel, ranges->data());
+        g_sink = g_sink + uint32_t((*ranges)[ranges->size() / 2].farthest);
+    };
+    cases.push_back(scalar);
+
+    auto rates = std::make_shared<std::vector<uint8_t>>(ranges->size());
+    auto composed = std::make_shared<std::vector<uint8_t>>(ranges->size());
+    fillFoveationRates(rates->data(), tilesX, tilesY, 0.5f, 0.5f, FoveationParams());
+    BenchCase compose;
+    compose.name = "dof compose 1080p";
+    compose.unit = "texels";
+    compose.itemsPerIteration = double(ranges->size());
+    compose.run = [=]() {
+        DepthOfFieldSettings settings;
+        settings.enabled = true;
+        RateCostModel cost;
+        cost.invocationsPerPixel[RATE_1X1] = 1.0f;
+        cost.invocationsPerPixel[RATE_2X2] = 1.0f / 4.0f;
+        cost.invocationsPerPixel[RATE_4X4] = 1.0f / 16.0f;
+        applyDepthOfFieldRates(rates->data(), ranges->data(), ranges->size(), settings, cost, composed->data());
+        g_sink = g_sink + (*composed)[composed->size() / 2];
+    };
+    cases.push_back(compose);
+}
+
+static void addExtensionCases(std::vector<BenchCase>& cases)
+{
+    // a driver exposes a few hundred names, the searched one comes last
+    auto names = std::make_shared<std::vector<std::string>>();
+    const char* vendors[] = { "ARB", "EXT", "KHR", "NV", "NVX", "AMD", "INTEL" };
+    for (int i = 0; i < 400; ++i)
+    {
+        names->push_back(std::string("GL_") + vendors[i % 7] + "_extension_name_" + std::to_string(i));
+    }
+    names->push_back("GL_NV_shading_rate_image");
+    const int count = int(names->size());
+
+    BenchCase copy;
+    copy.name = "extension scan, copy";
+    copy.unit = "names";
+    copy.itemsPerIteration = count;
+    copy.run = [=]() {
+        // the former isExtensionPresent: a std::string per name
+        bool found = false;
+        for (int i = 0; i < count && !found; ++i)
+        {
+            std::string name((*names)[i].c_str());
+            found = (name == "GL_NV_shading_rate_image");
+        }
+        g_sink = g_sink + (found ? 1 : 0);
+    };
+    cases.push_back(copy);
+
+    BenchCase scan;
+    scan.name = "extension scan";
+    scan.unit = "names";
+    scan.itemsPerIteration = count;
+    scan.run = [=]() {
+        bool found = findExtension(count, "GL_NV_shading_rate_image", [&](int i) { return (*names)[i].c_str(); });
+        g_sink = g_sink + (found ? 1 : 0);
+    };
+    cases.push_back(scan);
+}
+
+int main(int argc, const char** argv)
+{
+    int samples = 15;
+    std::string filter;
+    for (int i = 1; i < argc; ++i)
+    {
+        int value = atoi(argv[i]);
+        if (value > 0)
+        {
+            samples = value;
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    if (!validateDepthOfField())
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BenchCase> cases;
+    addRateImageCases(cases);
+    addTorusCases(cases);
+    addTransformCases(cases);
+    addRenderQueueCases(cases);
+    addDepthOfFieldCases(cases);
+    addExtensionCases(cases);
+
+    printf("%-28s %11s %11s %7s %18s %8s %10s\n", "case", "median", "min", "spread", "throughput", "allocs", "bytes");
+    for (const BenchCase& bench : cases)
+    {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        BenchResult result = runCase(bench, samples);
+        double throughput = result.medianSeconds > 0.0 ? bench.itemsPerIteration / result.medianSeconds / 1.0e6 : 0.0;
+        char rate[32];
+        snprintf(rate, sizeof(rate), "%.1f M%s/s", throughput, bench.unit);
+        printf("%-28s %11s %11s %6.1f%% %18s %8.1f %10.0f\n", bench.name.c_str(), formatSeconds(result.medianSeconds).c_str(),
+            formatSeconds(result.minSeconds).c_str(), result.spread * 100.0, rate, result.allocations, result.allocatedBytes);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cpu_bench_alloc.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static std::atomic<uint64_t> g_allocations{ 0 };
+static std::atomic<uint64_t> g_allocatedBytes{ 0 };
+
+uint64_t getAllocationCount()
+{
+    return g_allocations.load();
+}
+
+uint64_t getAllocatedBytes()
+{
+    return g_allocatedBytes.load();
+}
+
+static void* allocate(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void* allocateAligned(size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align));
+#endif
+}
+
+static void freeAligned(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (void* p = allocate(size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocateAligned(size, alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    freeAligned(p);
+}
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+//
+// Heap allocation counters of cpu_bench. cpu_bench_alloc.cpp replaces all
+// forms of the global operator new and delete; it is a translation unit of
+// its own, so the compiler cannot inline them into their callers and pair a
+// new expression with the free() of the replaced delete.
+//
+
+// calls of any operator new since the start of the program
+uint64_t getAllocationCount();
+
+// bytes requested from any operator new since the start of the program
+uint64_t getAllocatedBytes();
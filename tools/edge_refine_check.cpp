@@ -0,0 +1,290 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the CPU reference of the edge refinement (see
+// EdgeRefinementReference.h) on synthetic depth buffers:
+//
+//   edge_refine_check [repetitions]
+//
+// The scenes are rendered analytically through the perspective projection
+// of VRSDemo, into a framebuffer that is not a multiple of the tile size:
+//
+// - no geometry: every tile is background,
+// - a fronto-parallel and a tilted plane: every tile is interior, a
+//   plane has no creases,
+// - a box in front of a plane: exactly the tiles holding a pixel next to
+//   the box outline, on either side, are silhouettes,
+// - a wedge whose linear depth folds along one column: exactly the tiles
+//   around the fold are creases,
+// - a sphere on the background: every tile with both background and
+//   sphere pixels is a silhouette.
+//
+// refineRates is checked for all policies, rates and classes. Reported is
+// the time of classifyTileEdges at 1920x1080.
+//
+
+#include "../EdgeRefinementReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 100.0f;
+static const float PROJ_A = -(FAR_PLANE + NEAR_PLANE) / (FAR_PLANE - NEAR_PLANE);
+static const float PROJ_B = -2.0f * FAR_PLANE * NEAR_PLANE / (FAR_PLANE - NEAR_PLANE);
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+// window depth of a distance to the eye, 1 for the background (distance 0)
+static float windowDepth(float z)
+{
+    return z <= 0.0f ? 1.0f : (PROJ_B / z - PROJ_A + 1.0f) * 0.5f;
+}
+
+struct Framebuffer
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t texelWidth;
+    uint32_t texelHeight;
+
+    uint32_t tilesX() const { return (width + texelWidth - 1) / texelWidth; }
+    uint32_t tilesY() const { return (height + texelHeight - 1) / texelHeight; }
+    size_t tile(uint32_t x, uint32_t y) const { return size_t(y / texelHeight) * tilesX() + x / texelWidth; }
+};
+
+static std::vector<float> render(const Framebuffer& fb, const std::function<float(uint32_t, uint32_t)>& distance)
+{
+    std::vector<float> depth(size_t(fb.width) * fb.height);
+    for (uint32_t y = 0; y < fb.height; ++y)
+    {
+        for (uint32_t x = 0; x < fb.width; ++x)
+        {
+            depth[size_t(y) * fb.width + x] = windowDepth(distance(x, y));
+        }
+    }
+    return depth;
+}
+
+static std::vector<uint8_t> classify(const Framebuffer& fb, const std::vector<float>& depth)
+{
+    EdgeRefinementSettings settings;
+    std::vector<uint8_t> classes(size_t(fb.tilesX()) * fb.tilesY());
+    classifyTileEdges(depth.data(), fb.width, fb.height, PROJ_A, PROJ_B, fb.texelWidth, fb.texelHeight, settings,
+                      classes.data());
+    return classes;
+}
+
+static uint32_t countMismatches(const std::vector<uint8_t>& classes, const std::vector<uint8_t>& expected)
+{
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < classes.size(); ++i)
+    {
+        mismatches += classes[i] != expected[i];
+    }
+    return mismatches;
+}
+
+static void checkScenes(const Framebuffer& fb, bool& failed)
+{
+    printf("classifyTileEdges, %ux%u with %ux%u tiles\n", fb.width, fb.height, fb.texelWidth, fb.texelHeight);
+    size_t tileCount = size_t(fb.tilesX()) * fb.tilesY();
+
+    {
+        std::vector<uint8_t> classes = classify(fb, render(fb, [](uint32_t, uint32_t) { return 0.0f; }));
+        uint32_t mismatches = countMismatches(classes, std::vector<uint8_t>(tileCount, EDGE_TILE_BACKGROUND));
+        printf("  no geometry     %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "without geometry every tile is background", failed);
+    }
+
+    {
+        std::vector<uint8_t> classes = classify(fb, render(fb, [](uint32_t, uint32_t) { return 7.5f; }));
+        uint32_t mismatches = countMismatches(classes, std::vector<uint8_t>(tileCount, EDGE_TILE_INTERIOR));
+        printf("  flat plane      %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "a fronto-parallel plane is interior", failed);
+    }
+
+    {
+        // 1 / z of a plane is linear in screen space
+        std::vector<uint8_t> classes = classify(fb, render(fb, [&](uint32_t x, uint32_t y) {
+            return 1.0f / (0.2f + 0.1f * float(x) / float(fb.width) + 0.05f * float(y) / float(fb.height));
+        }));
+        uint32_t mismatches = countMismatches(classes, std::vector<uint8_t>(tileCount, EDGE_TILE_INTERIOR));
+        printf("  tilted plane    %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "a tilted plane is interior", failed);
+    }
+
+    {
+        // two sides on a tile border, where only the pixel across the border marks the outer tile
+        const uint32_t boxX0 = fb.width / 3 + 1, boxX1 = (fb.width * 2 / 3 / fb.texelWidth) * fb.texelWidth;
+        const uint32_t boxY0 = (fb.height / 4 / fb.texelHeight + 1) * fb.texelHeight, boxY1 = fb.height * 3 / 4 - 1;
+        auto inBox = [&](uint32_t x, uint32_t y) { return x >= boxX0 && x < boxX1 && y >= boxY0 && y < boxY1; };
+        std::vector<uint8_t> classes = classify(fb, render(fb, [&](uint32_t x, uint32_t y) { return inBox(x, y) ? 4.0f : 9.0f; }));
+
+        std::vector<uint8_t> expected(tileCount, EDGE_TILE_INTERIOR);
+        for (uint32_t y = 0; y < fb.height; ++y)
+        {
+            for (uint32_t x = 0; x < fb.width; ++x)
+            {
+                bool inside = inBox(x, y);
+                bool edge = (x > 0 && inBox(x - 1, y) != inside) || (x + 1 < fb.width && inBox(x + 1, y) != inside)
+                            || (y > 0 && inBox(x, y - 1) != inside) || (y + 1 < fb.height && inBox(x, y + 1) != inside);
+                if (edge)
+                {
+                    expected[fb.tile(x, y)] = EDGE_TILE_SILHOUETTE;
+                }
+            }
+        }
+        uint32_t mismatches = countMismatches(classes, expected);
+        printf("  box on a plane  %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "the silhouette tiles are the ones along the box outline", failed);
+    }
+
+    {
+        // steps along the wedge of a third of the silhouette threshold, a fold of twice the step
+        const uint32_t fold = fb.width / 2 + 5;
+        std::vector<uint8_t> classes = classify(fb, render(fb, [&](uint32_t x, uint32_t) {
+            return 6.0f + 0.1f * std::fabs(float(x) - float(fold));
+        }));
+
+        std::vector<uint8_t> expected(tileCount, EDGE_TILE_INTERIOR);
+        for (uint32_t y = 0; y < fb.height; ++y)
+        {
+            expected[fb.tile(fold, y)] = EDGE_TILE_CREASE;
+        }
+        uint32_t mismatches = countMismatches(classes, expected);
+        printf("  wedge           %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "the crease tiles are the ones on the fold", failed);
+    }
+
+    {
+        const float cx = fb.width * 0.45f, cy = fb.height * 0.55f, radius = fb.height * 0.3f;
+        auto sphere = [&](uint32_t x, uint32_t y) {
+            float dx = (float(x) + 0.5f - cx) / radius;
+            float dy = (float(y) + 0.5f - cy) / radius;
+            float r2 = dx * dx + dy * dy;
+            return r2 < 1.0f ? 5.0f - std::sqrt(1.0f - r2) : 0.0f;
+        };
+        std::vector<uint8_t> classes = classify(fb, render(fb, sphere));
+
+        std::vector<uint8_t> hasBackground(tileCount, 0), hasGeometry(tileCount, 0);
+        for (uint32_t y = 0; y < fb.height; ++y)
+        {
+            for (uint32_t x = 0; x < fb.width; ++x)
+            {
+                (sphere(x, y) == 0.0f ? hasBackground : hasGeometry)[fb.tile(x, y)] = 1;
+            }
+        }
+        uint32_t mismatches = 0;
+        for (size_t i = 0; i < tileCount; ++i)
+        {
+            if (hasBackground[i] && hasGeometry[i])
+            {
+                mismatches += classes[i] != EDGE_TILE_SILHOUETTE;
+            }
+            else if (!hasGeometry[i])
+            {
+                // the neighbouring tile's pixel may be on the other side of the outline
+                mismatches += classes[i] != EDGE_TILE_BACKGROUND && classes[i] != EDGE_TILE_SILHOUETTE;
+            }
+        }
+        printf("  sphere          %u wrong tiles\n", mismatches);
+        check(mismatches == 0, "the tiles on the sphere outline are silhouettes", failed);
+    }
+}
+
+static void checkRefine(bool& failed)
+{
+    printf("refineRates\n");
+    uint32_t mismatches = 0;
+    for (int policy = 0; policy < EDGE_POLICY_COUNT; ++policy)
+    {
+        EdgeRefinementSettings settings;
+        settings.policy = policy;
+        settings.silhouetteRate = RATE_1X1;
+        settings.creaseRate = RATE_2X2;
+
+        uint8_t rates[16], classes[16], refined[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            rates[i] = uint8_t(i / 4);
+            classes[i] = uint8_t(i % 4);
+        }
+        refineRates(rates, classes, 16, settings, refined);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            uint8_t expected = rates[i];
+            if (policy != EDGE_POLICY_OFF && rates[i] != RATE_NO_INVOCATIONS)
+            {
+                if (classes[i] == EDGE_TILE_SILHOUETTE)
+                    expected = std::min(rates[i], settings.silhouetteRate);
+                else if (classes[i] == EDGE_TILE_CREASE)
+                    expected = std::min(rates[i], settings.creaseRate);
+                else if (classes[i] == EDGE_TILE_INTERIOR && policy == EDGE_POLICY_REFINE_AND_COARSEN)
+                    expected = std::min(uint8_t(rates[i] + 1), uint8_t(RATE_4X4));
+            }
+            mismatches += refined[i] != expected;
+        }
+    }
+    printf("  %u wrong rates\n", mismatches);
+    check(mismatches == 0, "culled tiles stay culled, edges get finer, interiors at most one step coarser", failed);
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? std::max(1, atoi(argv[1])) : 10;
+    bool failed = false;
+
+    checkScenes(Framebuffer{ 203, 117, 16, 16 }, failed);
+    checkScenes(Framebuffer{ 150, 61, 8, 16 }, failed);
+    checkRefine(failed);
+
+    Framebuffer fb{ 1920, 1080, 16, 16 };
+    std::vector<float> depth = render(fb, [&](uint32_t x, uint32_t y) {
+        return (x / 37 + y / 23) % 3 == 0 ? 0.0f : 3.0f + 0.002f * float(x) + 0.01f * std::sin(float(y) * 0.1f);
+    });
+    double best = 1e30;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        classify(fb, depth);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+    printf("classifyTileEdges at %ux%u: %.3f ms, best of %d\n", fb.width, fb.height, best * 1000.0, repetitions);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Runs FoveationController against a simulated scene pass and validates it:
+//
+//   foveation_controller_sim [frames per target]
+//
+// The simulated GPU time is a fixed cost plus a cost per invocation, and
+// the invocations are counted on the rate image fillFoveationRates builds
+// from the radii the controller applies, at 1080p with 16x16 texels. The
+// time the controller sees is the one of the rate image some frames ago,
+// as with the timer queries in VRSDemo, with multiplicative noise on top.
+//
+// Each run steps through a sequence of targets, one of them out of reach.
+// For every target the tool reports the frames until the noise-free time
+// settles within 5% of the target, the overshoot past the target and, over
+// the last third of the frames, the reversals of the scale and the peak to
+// peak of the noise-free time. It fails if a reachable target does not
+// settle, the overshoot or the peak to peak exceed 10%, or the scale does
+// not sit at its limit for the target out of reach. On every frame it also
+// checks that the cut-off to no invocations is the one of the base rings.
+//
+
+#include "../FoveationController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const uint32_t RATE_WIDTH = 1920 / 16;
+static const uint32_t RATE_HEIGHT = 1080 / 16;
+
+struct SimulatedScene
+{
+    double fixedMilliseconds = 1.0;
+    double fullRateMilliseconds = 16.0;  // every pixel shaded at 1x1
+};
+
+struct TargetResult
+{
+    bool settled = true;
+    uint32_t settleFrames = 0;  // frames until the time stays within 5%
+    double overshoot = 0.0;     // relative, past the target in the direction of the step
+    uint32_t reversals = 0;     // changes of direction of the scale in the last third
+    double peakToPeak = 0.0;    // relative, of the noise-free time in the last third
+    float finalScale = 0.0f;
+};
+
+// deterministic, so runs can be compared
+static double nextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return double(state >> 8) / double(1u << 24);
+}
+
+static double invocationsPerPixel(const std::vector<uint8_t>& rates)
+{
+    static const double INVOCATIONS[4] = { 0.0, 1.0, 1.0 / 4.0, 1.0 / 16.0 };
+    double sum = 0.0;
+    for (uint8_t rate : rates)
+    {
+        sum += INVOCATIONS[rate];
+    }
+    return sum / double(rates.size());
+}
+
+static bool hasSameCutoff(const std::vector<uint8_t>& rates, const std::vector<uint8_t>& baseRates)
+{
+    for (size_t i = 0; i < rates.size(); ++i)
+    {
+        if ((rates[i] == RATE_NO_INVOCATIONS) != (baseRates[i] == RATE_NO_INVOCATIONS))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printResult(double target, const TargetResult& result, bool reachable)
+{
+    char settle[32] = "-";
+    if (result.settled)
+    {
+        snprintf(settle, sizeof(settle), "%u", result.settleFrames);
+    }
+    printf("  %8.1f  %9s  %6s  %8.1f%%  %9u  %10.1f%%  %6.2f\n", target, reachable ? "yes" : "no", settle,
+        result.overshoot * 100.0, result.reversals, result.peakToPeak * 100.0, result.finalScale);
+}
+
+int main(int argc, const char** argv)
+{
+    uint32_t framesPerTarget = argc > 1 ? uint32_t(std::max(atoi(argv[1]), 300)) : 600;
+
+    const SimulatedScene scene;
+    const FoveationParams base;
+    const double targets[] = { 6.0, 2.5, 9.0, 30.0, 4.0 };
+    const uint32_t latencies[] = { 1, 2, 4 };
+    const double noises[] = { 0.0, 0.05 };
+
+    std::vector<uint8_t> baseRates(RATE_WIDTH * RATE_HEIGHT);
+    std::vector<uint8_t> rates(RATE_WIDTH * RATE_HEIGHT);
+    fillFoveationRates(baseRates.data(), RATE_WIDTH, RATE_HEIGHT, 0.5f, 0.5f, base);
+
+    // the reachable range, at the scale limits
+    FoveationController limits;
+    limits.reset(limits.m_settings.minScale);
+    fillFoveationRates(rates.data(), RATE_WIDTH, RATE_HEIGHT, 0.5f, 0.5f, limits.apply(base));
+    double minMilliseconds = scene.fixedMilliseconds + scene.fullRateMilliseconds * invocationsPerPixel(rates);
+    limits.reset(limits.m_settings.maxScale);
+    fillFoveationRates(rates.data(), RATE_WIDTH, RATE_HEIGHT, 0.5f, 0.5f, limits.apply(base));
+    double maxMilliseconds = scene.fixedMilliseconds + scene.fullRateMilliseconds * invocationsPerPixel(rates);
+    printf("scene pass %.2f to %.2f ms over the scale range, %u frames per target\n", minMilliseconds, maxMilliseconds,
+        framesPerTarget);
+
+    bool failed = false;
+    for (uint32_t latency : latencies)
+    {
+        for (double noise : noises)
+        {
+            printf("latency %u frames, noise %.0f%%\n", latency, noise * 100.0);
+            printf("    target  reachable  settle  overshoot  reversals  peak-to-peak  scale\n");
+
+            FoveationController controller;
+            std::vector<double> history(latency + 1, 0.0);
+            uint32_t random = 1;
+            uint32_t frame = 0;
+
+            for (double target : targets)
+            {
+                controller.m_settings.targetMilliseconds = float(target);
+                bool reachable = target > minMilliseconds * 1.05 && target < maxMilliseconds * 0.95;
+                double startMilliseconds = history[frame % history.size()];
+                double direction = target > startMilliseconds ? 1.0 : -1.0;
+
+                TargetResult result;
+                std::vector<double> times(framesPerTarget);
+                std::vector<float> scales(framesPerTarget);
+                for (uint32_t i = 0; i < framesPerTarget; ++i, ++frame)
+                {
+                    FoveationParams params = controller.apply(base);
+                    fillFoveationRates(rates.data(), RATE_WIDTH, RATE_HEIGHT, 0.5f, 0.5f, params);
+                    if (!hasSameCutoff(rates, baseRates) || params.radii[2] != base.radii[2])
+                    {
+                        fprintf(stderr, "  scale %.2f moves the cut-off to no invocations\n", controller.getScale());
+                        failed = true;
+                    }
+
+                    double milliseconds = scene.fixedMilliseconds + scene.fullRateMilliseconds * invocationsPerPixel(rates);
+                    history[frame % history.size()] = milliseconds;
+                    times[i] = milliseconds;
+                    scales[i] = controller.getScale();
+
+                    // the timer of this frame is read back latency frames later
+                    if (frame >= latency)
+                    {
+                        double measured = history[(frame - latency) % history.size()];
+                        controller.update(measured * (1.0 + noise * (2.0 * nextRandom(random) - 1.0)));
+                    }
+                }
+
+                for (uint32_t i = framesPerTarget; i-- > 0;)
+                {
+                    if (std::fabs(times[i] / target - 1.0) > 0.05)
+                    {
+                        result.settled = i + 1 < framesPerTarget;
+                        result.settleFrames = i + 1;
+                        break;
+                    }
+                }
+                double tailMin = times.back();
+                double tailMax = times.back();
+                int lastDirection = 0;
+                for (uint32_t i = 0; i < framesPerTarget; ++i)
+                {
+                    result.overshoot = std::max(result.overshoot, (times[i] - target) / target * direction);
+                    if (i >= framesPerTarget * 2 / 3)
+                    {
+                        tailMin = std::min(tailMin, times[i]);
+                        tailMax = std::max(tailMax, times[i]);
+                        int moved = scales[i] > scales[i - 1] ? 1 : scales[i] < scales[i - 1] ? -1 : 0;
+                        if (moved && lastDirection && moved != lastDirection)
+                        {
+                            ++result.reversals;
+                        }
+                        lastDirection = moved ? moved : lastDirection;
+                    }
+                }
+                result.peakToPeak = (tailMax - tailMin) / target;
+                result.finalScale = controller.getScale();
+                printResult(target, result, reachable);
+
+                if (reachable && (!result.settled || result.overshoot > 0.1 || result.peakToPeak > 0.1))
+                {
+                    fprintf(stderr, "  target %.1f ms: no settling, or too much overshoot or oscillation\n", target);
+                    failed = true;
+                }
+                if (!reachable && result.finalScale != controller.m_settings.minScale
+                    && result.finalScale != controller.m_settings.maxScale)
+                {
+                    fprintf(stderr, "  target %.1f ms is out of reach, but the scale is not at its limit\n", target);
+                    failed = true;
+                }
+            }
+        }
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,480 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Searches the foveation parameters of the varying shading rate image
+// (ring radii and the palette entry per ring) for the best image quality
+// at a given predicted cost, and writes the Pareto front as presets that
+// VRSDemo loads (see FoveationPresets.h):
+//
+//   foveation_tuner output.txt frame.ppm [frame.ppm ...] [--texel N] [--step S]
+//                   [--threads N] [--clear R G B] [--min-gain DB] [--min-psnr DB]
+//                   [--full-rate-ms MS]
+//
+// The frames are full rate renderings (binary PPM) of the scenes to tune
+// for, all of the same size. Coarse rates are approximated by averaging
+// the color over each 2x2 or 4x4 pixel block, which is what shading the
+// block once at its center converges to for smooth content; tiles with no
+// invocations keep the clear color. Quality is the PSNR over all frames,
+// cost the predicted fragment shader invocations per pixel.
+//
+// The innermost ring is always shaded, and candidates below --min-psnr
+// are dropped before the Pareto front is built, so the cheap end of the
+// front is not a blank screen or a 4x4 fovea nobody would pick.
+//
+// The error of every tile at every rate is computed once. Sorting the
+// tiles by their distance to the center then turns each ring into a
+// range, so a candidate is scored from prefix sums in constant time.
+//
+
+#include "../FoveationPresets.h"
+#include "../ShadingRateStats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Image
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgb;   // top row first
+};
+
+static bool readPPMToken(FILE* file, std::string& token)
+{
+    token.clear();
+    int c = fgetc(file);
+    while (c != EOF)
+    {
+        if (c == '#')
+        {
+            while (c != EOF && c != '\n')
+            {
+                c = fgetc(file);
+            }
+        }
+        else if (!isspace(c))
+        {
+            break;
+        }
+        c = fgetc(file);
+    }
+    while (c != EOF && !isspace(c))
+    {
+        token += char(c);
+        c = fgetc(file);
+    }
+    // the single whitespace after the last header token was consumed
+    return !token.empty();
+}
+
+static bool loadPPM(const char* filename, Image& image)
+{
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "could not open %s\n", filename);
+        return false;
+    }
+
+    std::string magic, width, height, maxValue;
+    bool ok = readPPMToken(file, magic) && readPPMToken(file, width) && readPPMToken(file, height) && readPPMToken(file, maxValue);
+    ok = ok && magic == "P6" && maxValue == "255";
+    if (ok)
+    {
+        image.width = uint32_t(atoi(width.c_str()));
+        image.height = uint32_t(atoi(height.c_str()));
+        image.rgb.resize(size_t(image.width) * image.height * 3);
+        ok = image.width > 0 && image.height > 0 && fread(image.rgb.data(), 1, image.rgb.size(), file) == image.rgb.size();
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        fprintf(stderr, "%s is not an 8 bit binary PPM\n", filename);
+    }
+    return ok;
+}
+
+static void parallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t)>& function)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                function(i);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// palette entries from the finest to the coarsest rate
+static const uint8_t RATES_BY_COARSENESS[4] = { RATE_1X1, RATE_2X2, RATE_4X4, RATE_NO_INVOCATIONS };
+
+static const double MAX_PSNR = 60.0;
+
+struct Tile
+{
+    float distance = 0.0f;      // as computed by fillFoveationRates()
+    uint32_t pixels = 0;
+    double error[4] = {};       // squared error summed over all frames, per palette entry
+};
+
+struct Candidate
+{
+    FoveationPreset preset;
+    double squaredError = 0.0;
+};
+
+int main(int argc, const char** argv)
+{
+    std::vector<const char*> frameFiles;
+    const char* output = nullptr;
+    uint32_t texel = 16;
+    float step = 0.025f;
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    float clear[3] = { 118.0f, 185.0f, 0.0f };   // background of VRSDemo
+    double fullRateMilliseconds = 0.0;
+    float minGain = 0.25f;      // dB between neighbouring presets, keeps the front short enough for a UI list
+    float minPsnr = 25.0f;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--texel" && hasValue) texel = uint32_t(std::max(1, atoi(argv[++i])));
+        else if (arg == "--step" && hasValue) step = std::max(0.005f, float(atof(argv[++i])));
+        else if (arg == "--threads" && hasValue) threadCount = uint32_t(std::max(1, atoi(argv[++i])));
+        else if (arg == "--min-gain" && hasValue) minGain = std::max(0.0f, float(atof(argv[++i])));
+        else if (arg == "--min-psnr" && hasValue) minPsnr = float(atof(argv[++i]));
+        else if (arg == "--full-rate-ms" && hasValue) fullRateMilliseconds = atof(argv[++i]);
+        else if (arg == "--clear" && i + 3 < argc)
+        {
+            for (float& c : clear)
+            {
+                c = float(atof(argv[++i]));
+            }
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            fprintf(stderr, "unknown or incomplete argument %s\n", arg.c_str());
+            return EXIT_FAILURE;
+        }
+        else if (!output)
+        {
+            output = argv[i];
+        }
+        else
+        {
+            frameFiles.push_back(argv[i]);
+        }
+    }
+    if (!output || frameFiles.empty())
+    {
+        fprintf(stderr,
+            "usage: %s output.txt frame.ppm [frame.ppm ...] [--texel N] [--step S] [--threads N]\n"
+            "       [--clear R G B] [--min-gain DB] [--min-psnr DB] [--full-rate-ms MS]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Image> frames(frameFiles.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        if (!loadPPM(frameFiles[i], frames[i]))
+        {
+            return EXIT_FAILURE;
+        }
+        if (frames[i].width != frames[0].width || frames[i].height != frames[0].height)
+        {
+            fprintf(stderr, "%s has a different size than %s\n", frameFiles[i], frameFiles[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const uint32_t width = frames[0].width;
+    const uint32_t height = frames[0].height;
+    const uint32_t tilesX = (width + texel - 1) / texel;
+    const uint32_t tilesY = (height + texel - 1) / texel;
+
+    //
+    // Per tile error of each rate, summed over the frames. Tile rows are
+    // counted from the bottom like the shading rate image, the image rows
+    // from the top. Coarse blocks are aligned to the framebuffer origin and
+    // clipped at its edges.
+    //
+    std::vector<Tile> tiles(size_t(tilesX) * tilesY);
+    parallelFor(tilesY, threadCount, [&](size_t ty) {
+        for (uint32_t tx = 0; tx < tilesX; ++tx)
+        {
+            Tile& tile = tiles[ty * tilesX + tx];
+            float fx = tx / (float)tilesX;
+            float fy = ty / (float)tilesY;
+            tile.distance = std::sqrt((fx - 0.5f) * (fx - 0.5f) + (fy - 0.5f) * (fy - 0.5f));
+
+            uint32_t x0 = tx * texel;
+            uint32_t y0 = uint32_t(ty) * texel;
+            uint32_t x1 = std::min(x0 + texel, width);
+            uint32_t y1 = std::min(y0 + texel, height);
+            tile.pixels = (x1 - x0) * (y1 - y0);
+
+            for (const Image& frame : frames)
+            {
+                auto pixel = [&](uint32_t x, uint32_t y) { return &frame.rgb[(size_t(height - 1 - y) * width + x) * 3]; };
+
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    for (uint32_t x = x0; x < x1; ++x)
+                    {
+                        const uint8_t* p = pixel(x, y);
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            double e = (p[c] - clear[c]) / 255.0;
+                            tile.error[RATE_NO_INVOCATIONS] += e * e;
+                        }
+                    }
+                }
+
+                const uint32_t blockSizes[2] = { 2, 4 };
+                const uint8_t blockRates[2] = { RATE_2X2, RATE_4X4 };
+                for (int b = 0; b < 2; ++b)
+                {
+                    uint32_t size = blockSizes[b];
+                    for (uint32_t by = y0; by < y1; by += size)
+                    {
+                        for (uint32_t bx = x0; bx < x1; bx += size)
+                        {
+                            uint32_t ex = std::min(bx + size, x1);
+                            uint32_t ey = std::min(by + size, y1);
+                            double sum[3] = {};
+                            for (uint32_t y = by; y < ey; ++y)
+                            {
+                                for (uint32_t x = bx; x < ex; ++x)
+                                {
+                                    const uint8_t* p = pixel(x, y);
+                                    for (int c = 0; c < 3; ++c)
+                                    {
+                                        sum[c] += p[c];
+                                    }
+                                }
+                            }
+                            double count = double((ex - bx) * (ey - by));
+                            for (uint32_t y = by; y < ey; ++y)
+                            {
+                                for (uint32_t x = bx; x < ex; ++x)
+                                {
+                                    const uint8_t* p = pixel(x, y);
+                                    for (int c = 0; c < 3; ++c)
+                                    {
+                                        double e = (p[c] - sum[c] / count) / 255.0;
+                                        tile.error[blockRates[b]] += e * e;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    std::sort(tiles.begin(), tiles.end(), [](const Tile& a, const Tile& b) { return a.distance < b.distance; });
+
+    // prefix sums over the tiles sorted by distance, entry i covers tiles [0, i)
+    std::vector<float> distances(tiles.size());
+    std::vector<double> pixelPrefix(tiles.size() + 1, 0.0);
+    std::vector<double> errorPrefix[4];
+    for (std::vector<double>& prefix : errorPrefix)
+    {
+        prefix.assign(tiles.size() + 1, 0.0);
+    }
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        distances[i] = tiles[i].distance;
+        pixelPrefix[i + 1] = pixelPrefix[i] + tiles[i].pixels;
+        for (int r = 0; r < 4; ++r)
+        {
+            errorPrefix[r][i + 1] = errorPrefix[r][i] + tiles[i].error[r];
+        }
+    }
+
+    // same palette as VRSDemo::setupShadingRatePalette()
+    RateCostModel cost;
+    cost.invocationsPerPixel[RATE_NO_INVOCATIONS] = 0.0f;
+    cost.invocationsPerPixel[RATE_1X1] = 1.0f;
+    cost.invocationsPerPixel[RATE_2X2] = 1.0f / 4.0f;
+    cost.invocationsPerPixel[RATE_4X4] = 1.0f / 16.0f;
+
+    //
+    // Candidates: ascending radii on a grid up to the corner distance, and
+    // per ring a palette entry that is never finer than the one inside it.
+    // The innermost ring, where the user looks, always gets invocations.
+    //
+    // in units of the 4 decimals of the preset file, so the radii VRSDemo loads are the ones scored here
+    std::vector<float> radii;
+    uint32_t stepUnits = uint32_t(std::lround(step * 10000.0f));
+    for (uint32_t units = stepUnits; units < 7072 + stepUnits; units += stepUnits)
+    {
+        radii.push_back(float(units) / 10000.0f);
+    }
+    std::vector<std::array<uint8_t, 4>> rateSequences;
+    for (int a = 0; a < 3; ++a)
+        for (int b = a; b < 4; ++b)
+            for (int c = b; c < 4; ++c)
+                for (int d = c; d < 4; ++d)
+                    rateSequences.push_back({ RATES_BY_COARSENESS[a], RATES_BY_COARSENESS[b], RATES_BY_COARSENESS[c], RATES_BY_COARSENESS[d] });
+
+    std::vector<std::array<uint32_t, 3>> radiusTriples;
+    for (uint32_t i = 0; i < radii.size(); ++i)
+        for (uint32_t j = i + 1; j < radii.size(); ++j)
+            for (uint32_t k = j + 1; k < radii.size(); ++k)
+                radiusTriples.push_back({ i, j, k });
+
+    const double totalSamples = pixelPrefix.back() * 3.0 * frames.size();
+    std::vector<Candidate> candidates(radiusTriples.size() * rateSequences.size());
+
+    parallelFor(radiusTriples.size(), threadCount, [&](size_t t) {
+        size_t bounds[5] = { 0, 0, 0, 0, tiles.size() };
+        for (int k = 0; k < 3; ++k)
+        {
+            // tiles with distance < radius, the same comparison as fillFoveationRates()
+            bounds[k + 1] = size_t(std::lower_bound(distances.begin(), distances.end(), radii[radiusTriples[t][k]]) - distances.begin());
+        }
+
+        for (size_t s = 0; s < rateSequences.size(); ++s)
+        {
+            Candidate& candidate = candidates[t * rateSequences.size() + s];
+            double invocations = 0.0;
+            for (int ring = 0; ring < 4; ++ring)
+            {
+                uint8_t rate = rateSequences[s][ring];
+                candidate.squaredError += errorPrefix[rate][bounds[ring + 1]] - errorPrefix[rate][bounds[ring]];
+                invocations += (pixelPrefix[bounds[ring + 1]] - pixelPrefix[bounds[ring]]) * cost.invocationsPerPixel[rate];
+                candidate.preset.params.rates[ring] = rate;
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                candidate.preset.params.radii[k] = radii[radiusTriples[t][k]];
+            }
+
+            // capped, 60 dB is visually identical and keeps the knee search below meaningful
+            double mse = candidate.squaredError / totalSamples;
+            candidate.preset.psnr = mse > 0.0 ? float(std::min(MAX_PSNR, -10.0 * std::log10(mse))) : float(MAX_PSNR);
+            candidate.preset.invocationsPerPixel = float(invocations / pixelPrefix.back());
+        }
+    });
+
+    size_t candidateCount = candidates.size();
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const Candidate& candidate) { return candidate.preset.psnr < minPsnr; }),
+                     candidates.end());
+    if (candidates.empty())
+    {
+        fprintf(stderr, "no candidate reaches %.2f dB, lower --min-psnr\n", minPsnr);
+        return EXIT_FAILURE;
+    }
+
+    //
+    // Pareto front: by cost, keep each candidate that beats the quality of
+    // all cheaper ones by at least minGain. The best one is always kept.
+    //
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.preset.invocationsPerPixel != b.preset.invocationsPerPixel)
+        {
+            return a.preset.invocationsPerPixel < b.preset.invocationsPerPixel;
+        }
+        return a.squaredError < b.squaredError;
+    });
+
+    FoveationPresets front;
+    const Candidate* best = nullptr;
+    for (const Candidate& candidate : candidates)
+    {
+        if (best && candidate.squaredError >= best->squaredError)
+        {
+            continue;
+        }
+        best = &candidate;
+        if (front.presets.empty() || candidate.preset.psnr >= front.presets.back().psnr + minGain)
+        {
+            front.presets.push_back(candidate.preset);
+        }
+    }
+    if (front.presets.back().psnr != best->preset.psnr)
+    {
+        front.presets.push_back(best->preset);
+    }
+
+    // recommend the knee: the point furthest from the chord between the cheapest and the best preset
+    const FoveationPreset& first = front.presets.front();
+    const FoveationPreset& last = front.presets.back();
+    double costRange = std::max(1e-6, double(last.invocationsPerPixel - first.invocationsPerPixel));
+    double psnrRange = std::max(1e-6, double(last.psnr - first.psnr));
+    double bestDistance = -1.0;
+    for (size_t i = 0; i < front.presets.size(); ++i)
+    {
+        double x = (front.presets[i].invocationsPerPixel - first.invocationsPerPixel) / costRange;
+        double y = (front.presets[i].psnr - first.psnr) / psnrRange;
+        double distance = y - x;
+        if (distance > bestDistance)
+        {
+            bestDistance = distance;
+            front.defaultIndex = i;
+        }
+    }
+
+    std::string error;
+    if (!writeFoveationPresets(output, front, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    printf("%zu frame(s) of %ux%u, %zu candidates on %u threads in %.2f s, %zu of them at %.2f dB or more, %zu on the Pareto front\n",
+        frames.size(), width, height, candidateCount, threadCount, seconds, candidates.size(), minPsnr, front.presets.size());
+    for (size_t i = 0; i < front.presets.size(); ++i)
+    {
+        const FoveationPreset& preset = front.presets[i];
+        printf("%c %.4f invocations/pixel", i == front.defaultIndex ? '*' : ' ', preset.invocationsPerPixel);
+        if (fullRateMilliseconds > 0.0)
+        {
+            printf(" (%.3f ms)", preset.invocationsPerPixel * fullRateMilliseconds);
+        }
+        printf(", %6.2f dB, radii %.3f %.3f %.3f, rates %u %u %u %u\n", preset.psnr, preset.params.radii[0], preset.params.radii[1],
+            preset.params.radii[2], preset.params.rates[0], preset.params.rates[1], preset.params.rates[2], preset.params.rates[3]);
+    }
+    return EXIT_SUCCESS;
+}
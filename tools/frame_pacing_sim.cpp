@@ -0,0 +1,212 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Runs FramePacer against a simulated GPU clock and validates it:
+//
+//   frame_pacing_sim [frames]
+//
+// Each frame the CPU works for a while before it latches the input and a
+// while after, then submits. The GPU executes the frames in order, each
+// starts when it was submitted and the previous one is done. The pacer
+// only sees completions the way GLDemo does: by polling at the start of a
+// frame, or by blocking on the frame the throttle returns.
+//
+// For a CPU bound, a GPU bound and a jittery balanced load, every number
+// of frames in flight is run with the input latched early (right after the
+// throttle) and late (right before the submission work). Reported are the
+// frame rate and the averages of input to submit, submit to GPU complete
+// and input to GPU complete. The tool fails if the GPU ever has more frames
+// queued than allowed, if the pacer's latencies differ from the simulated
+// ones, or if the frame rate of a load without jitter differs from
+// 1 / (cpu + gpu) with one frame in flight and 1 / max(cpu, gpu) with more.
+//
+
+#include "../FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct SimulatedLoad
+{
+    const char* name;
+    double cpuBeforeLatch;  // seconds, UI and the CPU work that does not need the input
+    double cpuAfterLatch;   // seconds, building and submitting the frame
+    double gpu;             // seconds
+    double jitter;          // relative, of the GPU time
+};
+
+struct SimulationResult
+{
+    double framesPerSecond = 0.0;
+    FramePacer::Latency pacer;      // averages reported by the pacer
+    FramePacer::Latency simulated;  // the same, from the simulation
+    uint32_t maxQueued = 0;         // frames the GPU had not finished at a submission
+};
+
+// deterministic, so runs can be compared
+static double nextRandom(uint32_t& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return double(state >> 8) / double(1u << 24);
+}
+
+static SimulationResult simulate(const SimulatedLoad& load, uint32_t framesInFlight, bool lateLatch, uint32_t frameCount)
+{
+    FramePacer pacer;
+    pacer.setFramesInFlight(framesInFlight);
+
+    std::vector<double> latched(frameCount);
+    std::vector<double> submitted(frameCount);
+    std::vector<double> completed(frameCount);
+    uint32_t random = 1;
+
+    SimulationResult result;
+    double now = 0.0;
+    double gpuIdle = 0.0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        pacer.beginFrame(now);
+
+        uint32_t pending = 0;
+        while (pacer.getOldestPendingFrame(pending) && completed[pending] <= now)
+        {
+            pacer.completeFrame(pending, completed[pending]);
+        }
+        while (pacer.getFrameToWaitFor(pending))
+        {
+            now = std::max(now, completed[pending]);
+            pacer.completeFrame(pending, completed[pending]);
+        }
+        pacer.endThrottle(now);
+
+        if (!lateLatch)
+        {
+            latched[frame] = now;
+            pacer.latchInput(now);
+        }
+        now += load.cpuBeforeLatch;
+        if (lateLatch)
+        {
+            latched[frame] = now;
+            pacer.latchInput(now);
+        }
+        now += load.cpuAfterLatch;
+
+        submitted[frame] = now;
+        pacer.submitFrame(now);
+
+        double gpu = load.gpu * (1.0 + load.jitter * (2.0 * nextRandom(random) - 1.0));
+        gpuIdle = std::max(gpuIdle, now) + gpu;
+        completed[frame] = gpuIdle;
+
+        uint32_t queued = 0;
+        for (uint32_t older = frame + 1; older-- > 0 && completed[older] > now;)
+        {
+            ++queued;
+        }
+        result.maxQueued = std::max(result.maxQueued, queued);
+    }
+
+    // the frame rate after the pipeline filled up, the latency of the frames the pacer has seen complete
+    uint32_t first = frameCount / 10;
+    result.framesPerSecond = double(frameCount - 1 - first) / (completed[frameCount - 1] - completed[first]);
+
+    FramePacer::Latency maximum;
+    pacer.getLatency(result.pacer, maximum);
+    uint64_t end = pacer.getCompletedFrames();
+    uint64_t begin = end - std::min<uint64_t>(end, FramePacer::HISTORY_SIZE);
+    for (uint64_t frame = begin; frame < end; ++frame)
+    {
+        result.simulated.inputToSubmit += submitted[frame] - latched[frame];
+        result.simulated.submitToComplete += completed[frame] - submitted[frame];
+        result.simulated.inputToComplete += completed[frame] - latched[frame];
+    }
+    double count = double(end - begin);
+    result.simulated.inputToSubmit /= count;
+    result.simulated.submitToComplete /= count;
+    result.simulated.inputToComplete /= count;
+    return result;
+}
+
+static bool isClose(double a, double b, double relative)
+{
+    return std::fabs(a - b) <= relative * std::max(std::fabs(a), std::fabs(b)) + 1.0e-9;
+}
+
+int main(int argc, const char** argv)
+{
+    uint32_t frameCount = argc > 1 ? uint32_t(std::max(atoi(argv[1]), 200)) : 2000;
+
+    const SimulatedLoad loads[] = {
+        { "cpu bound", 0.006, 0.004, 0.004, 0.0 },
+        { "gpu bound", 0.002, 0.002, 0.008, 0.0 },
+        { "balanced, jitter", 0.003, 0.003, 0.006, 0.3 },
+    };
+
+    bool failed = false;
+    for (const SimulatedLoad& load : loads)
+    {
+        printf("%s: cpu %.1f + %.1f ms, gpu %.1f ms, jitter %.0f%%\n", load.name, load.cpuBeforeLatch * 1000.0,
+            load.cpuAfterLatch * 1000.0, load.gpu * 1000.0, load.jitter * 100.0);
+        printf("  in flight  latch     fps  input->submit  submit->complete  input->complete  queued\n");
+
+        for (uint32_t framesInFlight = 1; framesInFlight <= FramePacer::MAX_FRAMES_IN_FLIGHT; ++framesInFlight)
+        {
+            for (int late = 0; late < 2; ++late)
+            {
+                SimulationResult result = simulate(load, framesInFlight, late != 0, frameCount);
+                printf("  %9u  %5s  %6.1f  %10.2f ms  %13.2f ms  %12.2f ms  %6u\n", framesInFlight, late ? "late" : "early",
+                    result.framesPerSecond, result.pacer.inputToSubmit * 1000.0, result.pacer.submitToComplete * 1000.0,
+                    result.pacer.inputToComplete * 1000.0, result.maxQueued);
+
+                if (result.maxQueued > framesInFlight)
+                {
+                    fprintf(stderr, "  the GPU had %u frames queued, %u allowed\n", result.maxQueued, framesInFlight);
+                    failed = true;
+                }
+                if (!isClose(result.pacer.inputToSubmit, result.simulated.inputToSubmit, 1.0e-6)
+                    || !isClose(result.pacer.submitToComplete, result.simulated.submitToComplete, 1.0e-6)
+                    || !isClose(result.pacer.inputToComplete, result.simulated.inputToComplete, 1.0e-6))
+                {
+                    fprintf(stderr, "  latency of the pacer differs from the simulation\n");
+                    failed = true;
+                }
+                if (load.jitter == 0.0)
+                {
+                    double cpu = load.cpuBeforeLatch + load.cpuAfterLatch;
+                    double expected = framesInFlight == 1 ? 1.0 / (cpu + load.gpu) : 1.0 / std::max(cpu, load.gpu);
+                    if (!isClose(result.framesPerSecond, expected, 1.0e-3))
+                    {
+                        fprintf(stderr, "  %.1f fps, expected %.1f\n", result.framesPerSecond, expected);
+                        failed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
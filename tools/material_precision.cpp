@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Error analysis of the half precision material against fp32:
+//
+//   material_precision [samples] [seed]
+//
+// Evaluates the CPU port of the material (MaterialReference) at random
+// points of the torus surface, with random eye and light directions in the
+// hemisphere of the normal and the two colors of the tori, once in fp32 and
+// once for each emulated half precision variant. Reports the absolute error
+// of the noise, of calcNoise after the smoothstep for a few fragment loads
+// and of the lit color, and how many pixels change in an RGBA8 target and
+// by how many steps.
+//
+
+#include "../MaterialReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+struct Sample
+{
+    glm::vec3 modelPos;     // model_pos / 2 as passed to calcNoise
+    glm::vec3 normal;
+    glm::vec3 eyeDir;
+    glm::vec3 lightDir;
+    glm::vec3 color;
+};
+
+struct ErrorStats
+{
+    double maxError = 0.0;
+    double sumSquared = 0.0;
+    size_t count = 0;
+    size_t nonFinite = 0;
+
+    void add(float value, float reference)
+    {
+        if (!std::isfinite(value))
+        {
+            ++nonFinite;
+            return;
+        }
+        double error = std::fabs(double(value) - double(reference));
+        maxError = std::max(maxError, error);
+        sumSquared += error * error;
+        ++count;
+    }
+    double rms() const { return count ? std::sqrt(sumSquared / double(count)) : 0.0; }
+};
+
+static float dot3(const glm::vec3& a, const glm::vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static glm::vec3 normalize3(const glm::vec3& v)
+{
+    return v * (1.0f / std::sqrt(dot3(v, v)));
+}
+
+// direction in the hemisphere of the normal
+static glm::vec3 randomDirection(std::mt19937& rng, const glm::vec3& normal)
+{
+    std::normal_distribution<float> gauss;
+    glm::vec3 direction = normalize3(glm::vec3(gauss(rng), gauss(rng), gauss(rng)));
+    return dot3(direction, normal) < 0.0f ? direction * -1.0f : direction;
+}
+
+static std::vector<Sample> generateSamples(size_t count, uint32_t seed)
+{
+    // the tori of GLDemo: TorusParams defaults, colors of placeTori
+    const float innerRadius = 0.8f;
+    const float outerRadius = 0.2f;
+    const glm::vec3 colors[2] = { glm::vec3(0.0f, 0.7f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) };
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> angle(0.0f, 6.28318530718f);
+    std::vector<Sample> samples(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float phi = angle(rng);
+        float theta = angle(rng);
+        glm::vec3 normal(std::cos(theta) * std::cos(phi), std::cos(theta) * std::sin(phi), std::sin(theta));
+        glm::vec3 position(innerRadius * std::cos(phi) + outerRadius * normal.x,
+                           innerRadius * std::sin(phi) + outerRadius * normal.y, outerRadius * normal.z);
+
+        Sample& sample = samples[i];
+        sample.modelPos = position * 0.5f;
+        sample.normal = normal;
+        sample.eyeDir = randomDirection(rng, normal);
+        sample.lightDir = randomDirection(rng, normal);
+        sample.color = colors[i & 1];
+    }
+    return samples;
+}
+
+static int toUnorm8(float value)
+{
+    return int(std::nearbyint(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+}
+
+int main(int argc, const char** argv)
+{
+    size_t sampleCount = argc > 1 ? size_t(std::max(1, atoi(argv[1]))) : 20000;
+    uint32_t seed = argc > 2 ? uint32_t(atoi(argv[2])) : 1;
+    const int fragmentLoads[] = { 1, 16, 250 };
+
+    std::vector<Sample> samples = generateSamples(sampleCount, seed);
+    printf("%zu samples of the torus surface, errors against fp32\n\n", sampleCount);
+
+    printf("%-17s %5s %10s %10s %10s %10s %10s %10s %8s %6s %8s\n", "variant", "load", "noise max", "noise rms",
+        "calc max", "calc rms", "color max", "color rms", "rgba8", "steps", "nan/inf");
+    std::vector<float> referenceNoise(sampleCount);
+    for (size_t i = 0; i < sampleCount; ++i)
+    {
+        referenceNoise[i] = simplexPerlin3D(samples[i].modelPos * 20.0f, MATERIAL_FLOAT);
+    }
+    for (int load : fragmentLoads)
+    {
+        // the fp32 sum of a high load is the expensive part, evaluated once per load
+        std::vector<float> referenceCalc(sampleCount);
+        std::vector<glm::vec4> referenceLit(sampleCount);
+        for (size_t i = 0; i < sampleCount; ++i)
+        {
+            const Sample& sample = samples[i];
+            referenceCalc[i] = calcNoise(sample.modelPos, load * 100, MATERIAL_FLOAT);
+            referenceLit[i] = calculateLight(sample.normal, sample.eyeDir, sample.lightDir,
+                sample.color + glm::vec3(referenceCalc[i]), MATERIAL_FLOAT);
+        }
+
+        for (int precision = MATERIAL_HALF; precision < NUM_MATERIAL_PRECISIONS; ++precision)
+        {
+            MaterialPrecision variant = MaterialPrecision(precision);
+            ErrorStats noise;
+            ErrorStats calc;
+            ErrorStats color;
+            size_t changedPixels = 0;
+            size_t nonFinitePixels = 0;
+            int maxSteps = 0;
+            for (size_t i = 0; i < sampleCount; ++i)
+            {
+                const Sample& sample = samples[i];
+                noise.add(simplexPerlin3D(sample.modelPos * 20.0f, variant), referenceNoise[i]);
+
+                float value = calcNoise(sample.modelPos, load * 100, variant);
+                calc.add(value, referenceCalc[i]);
+
+                glm::vec4 lit = calculateLight(sample.normal, sample.eyeDir, sample.lightDir, sample.color + glm::vec3(value),
+                    variant);
+                const float litValues[3] = { lit.x, lit.y, lit.z };
+                const float referenceValues[3] = { referenceLit[i].x, referenceLit[i].y, referenceLit[i].z };
+                int steps = 0;
+                bool finite = true;
+                for (int c = 0; c < 3; ++c)
+                {
+                    color.add(litValues[c], referenceValues[c]);
+                    finite = finite && std::isfinite(litValues[c]);
+                    steps = finite ? std::max(steps, std::abs(toUnorm8(litValues[c]) - toUnorm8(referenceValues[c]))) : 0;
+                }
+                changedPixels += steps ? 1 : 0;
+                maxSteps = std::max(maxSteps, steps);
+                nonFinitePixels += finite ? 0 : 1;
+            }
+
+            printf("%-17s %5d %10.2e %10.2e %10.2e %10.2e %10.2e %10.2e %7.2f%% %6d %7.2f%%\n",
+                MATERIAL_PRECISION_NAMES[precision], load, noise.maxError, noise.rms(), calc.maxError, calc.rms(),
+                color.maxError, color.rms(), changedPixels * 100.0 / double(sampleCount), maxSteps,
+                nonFinitePixels * 100.0 / double(sampleCount));
+        }
+    }
+
+    printf("\nnoise: SimplexPerlin3D, calc: calcNoise after the smoothstep, color: calculateLight before the\n"
+           "clamp, rgba8: pixels that change in an 8 bit target, steps: largest change in 1/255, nan/inf: pixels\n"
+           "that are not finite, left out of the other columns\n");
+    return EXIT_SUCCESS;
+}
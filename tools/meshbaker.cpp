@@ -0,0 +1,337 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Offline converter from Wavefront OBJ to the mesh blob format read by
+// MeshScene, see MeshBlob.h:
+//
+//   meshbaker input.obj output.vmb
+//
+// Every "o", "g" or "usemtl" starts a new mesh, faces are fan triangulated,
+// vertices are de-duplicated per mesh, missing normals are generated from the
+// faces and the diffuse color ("Kd") of the material becomes the mesh color.
+//
+
+#include "../MeshBlob.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Float3
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+struct ObjMesh
+{
+    std::string material;
+    std::vector<MeshBlobVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::unordered_map<uint64_t, uint32_t> vertexLookup;  // (position, normal) index pair -> vertex
+    bool needsNormals = false;
+};
+
+static std::string directoryOf(const std::string& filename)
+{
+    size_t slash = filename.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+}
+
+static void loadMaterials(const std::string& filename, std::map<std::string, Float3>& colors)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        fprintf(stderr, "warning: could not open material library %s\n", filename.c_str());
+        return;
+    }
+
+    std::string line, current;
+    while (std::getline(file, line))
+    {
+        std::istringstream in(line);
+        std::string keyword;
+        in >> keyword;
+        if (keyword == "newmtl")
+        {
+            in >> current;
+            colors[current] = Float3{ 0.8f, 0.8f, 0.8f };
+        }
+        else if (keyword == "Kd" && !current.empty())
+        {
+            Float3& color = colors[current];
+            in >> color.x >> color.y >> color.z;
+        }
+    }
+}
+
+// OBJ indices are 1-based, negative ones count back from the end
+static bool resolveIndex(long index, size_t count, uint32_t& result)
+{
+    long resolved = index < 0 ? long(count) + index : index - 1;
+    if (resolved < 0 || size_t(resolved) >= count)
+    {
+        return false;
+    }
+    result = uint32_t(resolved);
+    return true;
+}
+
+static void generateNormals(ObjMesh& mesh)
+{
+    for (MeshBlobVertex& vertex : mesh.vertices)
+    {
+        vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+    }
+
+    // area weighted face normals
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const float* a = mesh.vertices[mesh.indices[i + 0]].position;
+        const float* b = mesh.vertices[mesh.indices[i + 1]].position;
+        const float* c = mesh.vertices[mesh.indices[i + 2]].position;
+        float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+        for (int k = 0; k < 3; ++k)
+        {
+            float* normal = mesh.vertices[mesh.indices[i + k]].normal;
+            normal[0] += n[0];
+            normal[1] += n[1];
+            normal[2] += n[2];
+        }
+    }
+
+    for (MeshBlobVertex& vertex : mesh.vertices)
+    {
+        float* n = vertex.normal;
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0f)
+        {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        }
+        else
+        {
+            n[1] = 1.0f;
+        }
+    }
+}
+
+static bool loadObj(const std::string& filename, std::vector<ObjMesh>& meshes, std::map<std::string, Float3>& colors)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        fprintf(stderr, "could not open %s\n", filename.c_str());
+        return false;
+    }
+
+    std::vector<Float3> positions;
+    std::vector<Float3> normals;
+    std::string material;
+    bool startNewMesh = true;
+
+    std::string line;
+    std::vector<uint32_t> polygon;
+    size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        std::istringstream in(line);
+        std::string keyword;
+        in >> keyword;
+
+        if (keyword == "v")
+        {
+            Float3 p;
+            in >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        }
+        else if (keyword == "vn")
+        {
+            Float3 n;
+            in >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        }
+        else if (keyword == "o" || keyword == "g")
+        {
+            startNewMesh = true;
+        }
+        else if (keyword == "usemtl")
+        {
+            in >> material;
+            startNewMesh = true;
+        }
+        else if (keyword == "mtllib")
+        {
+            std::string library;
+            in >> library;
+            loadMaterials(directoryOf(filename) + library, colors);
+        }
+        else if (keyword == "f")
+        {
+            if (startNewMesh || meshes.empty())
+            {
+                meshes.emplace_back();
+                meshes.back().material = material;
+                startNewMesh = false;
+            }
+            ObjMesh& mesh = meshes.back();
+
+            polygon.clear();
+            std::string corner;
+            while (in >> corner)
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                long v = 0, vn = 0;
+                size_t firstSlash = corner.find('/');
+                v = strtol(corner.c_str(), nullptr, 10);
+                if (firstSlash != std::string::npos)
+                {
+                    size_t secondSlash = corner.find('/', firstSlash + 1);
+                    if (secondSlash != std::string::npos)
+                    {
+                        vn = strtol(corner.c_str() + secondSlash + 1, nullptr, 10);
+                    }
+                }
+
+                uint32_t positionIndex, normalIndex = ~0u;
+                if (!resolveIndex(v, positions.size(), positionIndex)
+                    || (vn != 0 && !resolveIndex(vn, normals.size(), normalIndex)))
+                {
+                    fprintf(stderr, "%s(%zu): index out of range\n", filename.c_str(), lineNumber);
+                    return false;
+                }
+
+                uint64_t key = (uint64_t(positionIndex) << 32) | normalIndex;
+                auto it = mesh.vertexLookup.find(key);
+                if (it == mesh.vertexLookup.end())
+                {
+                    MeshBlobVertex vertex = {};
+                    const Float3& p = positions[positionIndex];
+                    vertex.position[0] = p.x;
+                    vertex.position[1] = p.y;
+                    vertex.position[2] = p.z;
+                    if (normalIndex != ~0u)
+                    {
+                        const Float3& n = normals[normalIndex];
+                        vertex.normal[0] = n.x;
+                        vertex.normal[1] = n.y;
+                        vertex.normal[2] = n.z;
+                    }
+                    else
+                    {
+                        mesh.needsNormals = true;
+                    }
+                    it = mesh.vertexLookup.emplace(key, uint32_t(mesh.vertices.size())).first;
+                    mesh.vertices.push_back(vertex);
+                }
+                polygon.push_back(it->second);
+            }
+
+            for (size_t i = 2; i < polygon.size(); ++i)
+            {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[i - 1]);
+                mesh.indices.push_back(polygon[i]);
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s input.obj output.vmb\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<ObjMesh> objMeshes;
+    std::map<std::string, Float3> colors;
+    if (!loadObj(argv[1], objMeshes, colors))
+    {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<MeshBlobMesh> meshes;
+    std::vector<MeshBlobVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    for (ObjMesh& objMesh : objMeshes)
+    {
+        if (objMesh.indices.empty())
+        {
+            continue;
+        }
+        if (objMesh.needsNormals)
+        {
+            generateNormals(objMesh);
+        }
+
+        MeshBlobMesh mesh = {};
+        mesh.firstIndex = uint32_t(indices.size());
+        mesh.indexCount = uint32_t(objMesh.indices.size());
+        mesh.baseVertex = uint32_t(vertices.size());
+        mesh.vertexCount = uint32_t(objMesh.vertices.size());
+
+        auto color = colors.find(objMesh.material);
+        Float3 rgb = color != colors.end() ? color->second : Float3{ 0.0f, 0.7f, 1.0f };
+        mesh.color[0] = rgb.x;
+        mesh.color[1] = rgb.y;
+        mesh.color[2] = rgb.z;
+        mesh.color[3] = 1.0f;
+
+        vertices.insert(vertices.end(), objMesh.vertices.begin(), objMesh.vertices.end());
+        indices.insert(indices.end(), objMesh.indices.begin(), objMesh.indices.end());
+        computeMeshBounds(mesh, vertices);
+        meshes.push_back(mesh);
+    }
+
+    if (meshes.empty())
+    {
+        fprintf(stderr, "%s contains no faces\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    std::string error;
+    if (!writeMeshBlob(argv[2], meshes, vertices, indices, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    printf("%s: %zu meshes, %zu vertices, %zu triangles in %.2f s\n", argv[2], meshes.size(), vertices.size(),
+        indices.size() / 3, seconds);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// CPU side loader benchmark for mesh blobs:
+//
+//   meshblob_bench scene.vmb [staging size in MB]
+//
+// Measures what MeshScene::load() does before the GPU gets involved: mapping
+// and validating the blob, and streaming the vertex and index data through a
+// staging buffer of the same size as the persistent one of MeshScene. The
+// first pass includes the page faults of the mapping, the second pass shows
+// the copy bandwidth from the page cache. Peak RSS shows that the mapped
+// file is not held in private memory.
+//
+
+#include "../MeshBlob.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static double peakResidentMegabytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return double(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return double(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return double(usage.ru_maxrss) / 1024.0;
+#endif
+#endif
+}
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// copies a stream chunk by chunk, like MeshScene does into its staging buffer
+static uint64_t streamThroughStaging(const uint8_t* data, uint64_t size, std::vector<uint8_t>& staging)
+{
+    uint64_t checksum = 0;
+    for (uint64_t offset = 0; offset < size; offset += staging.size())
+    {
+        size_t chunk = size_t(std::min<uint64_t>(staging.size(), size - offset));
+        memcpy(staging.data(), data + offset, chunk);
+        // keeps the copy from being optimized away
+        checksum += staging[0] + staging[chunk - 1];
+    }
+    return checksum;
+}
+
+int main(int argc, const char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s scene.vmb [staging size in MB]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t stagingMegabytes = argc > 2 ? size_t(std::max(1, atoi(argv[2]))) : 16;
+
+    double baseRss = peakResidentMegabytes();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    MeshBlob blob;
+    std::string error;
+    if (!blob.open(argv[1], &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    double openSeconds = secondsSince(start);
+
+    uint64_t triangles = 0;
+    for (uint32_t i = 0; i < blob.getMeshCount(); ++i)
+    {
+        triangles += blob.getMeshes()[i].indexCount / 3;
+    }
+
+    std::vector<uint8_t> staging(stagingMegabytes * 1024 * 1024);
+    uint64_t streamBytes = blob.getVertexDataSize() + blob.getIndexDataSize();
+
+    printf("%s: %.2f MB, %u meshes, %llu triangles\n", argv[1], blob.getFileSize() / (1024.0 * 1024.0),
+        blob.getMeshCount(), (unsigned long long)triangles);
+    printf("open + validate:   %8.3f ms\n", openSeconds * 1000.0);
+
+    uint64_t checksum = 0;
+    const char* passNames[2] = { "first pass", "second pass" };
+    for (const char* passName : passNames)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        checksum += streamThroughStaging(blob.getVertexData(), blob.getVertexDataSize(), staging);
+        checksum += streamThroughStaging(blob.getIndexData(), blob.getIndexDataSize(), staging);
+        double seconds = secondsSince(start);
+        printf("%-12s       %8.3f ms, %8.1f MB/s\n", passName, seconds * 1000.0,
+            seconds > 0.0 ? streamBytes / (1024.0 * 1024.0) / seconds : 0.0);
+    }
+
+    printf("peak RSS:          %8.1f MB (%.1f MB before loading, %zu MB staging)\n", peakResidentMegabytes(), baseRss,
+        stagingMegabytes);
+    printf("checksum %llu\n", (unsigned long long)checksum);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates that MeshBlob::open accepts the blobs of writeMeshBlob and
+// rejects damaged ones before anything reads their streams:
+//
+//   meshblob_check [directory]
+//
+// - a blob of two meshes sharing the vertex and index streams opens, and
+//   its streams read back as written,
+// - an index equal to the vertex count of its mesh, a mesh range past the
+//   streams, an index count that is not a multiple of 3, a truncated file
+//   and a wrong magic are each rejected with an error,
+// - an empty blob without meshes opens.
+//
+// The blobs are written to meshblob_check.vmb in the directory and removed.
+//
+
+#include "../MeshBlob.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+struct TestScene
+{
+    std::vector<MeshBlobMesh> meshes;
+    std::vector<MeshBlobVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// a quad and a triangle, the indices of each are relative to its base vertex
+static TestScene makeScene()
+{
+    TestScene scene;
+    for (uint32_t v = 0; v < 7; ++v)
+    {
+        scene.vertices.push_back({ { float(v), float(v % 2), 0.0f }, { 0.0f, 0.0f, 1.0f } });
+    }
+    scene.indices = { 0, 1, 2, 2, 1, 3, 0, 1, 2 };
+
+    MeshBlobMesh quad = {};
+    quad.firstIndex = 0;
+    quad.indexCount = 6;
+    quad.baseVertex = 0;
+    quad.vertexCount = 4;
+    MeshBlobMesh triangle = {};
+    triangle.firstIndex = 6;
+    triangle.indexCount = 3;
+    triangle.baseVertex = 4;
+    triangle.vertexCount = 3;
+    scene.meshes = { quad, triangle };
+    for (MeshBlobMesh& mesh : scene.meshes)
+    {
+        computeMeshBounds(mesh, scene.vertices);
+    }
+    return scene;
+}
+
+// writes the scene and returns whether it opens, printing the error otherwise
+static bool writeAndOpen(const std::string& filename, const TestScene& scene, const char* name, bool& failed)
+{
+    std::string error;
+    if (!check(writeMeshBlob(filename, scene.meshes, scene.vertices, scene.indices, &error), "the blob is written", failed))
+    {
+        fprintf(stderr, "  %s\n", error.c_str());
+        return false;
+    }
+    MeshBlob blob;
+    bool opened = blob.open(filename, &error);
+    printf("  %-28s %s\n", name, opened ? "opens" : error.c_str());
+    return opened;
+}
+
+// overwrites the bytes of the file at offset
+static bool patchFile(const std::string& filename, uint64_t offset, const void* data, size_t size)
+{
+    FILE* file = fopen(filename.c_str(), "r+b");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = fseek(file, long(offset), SEEK_SET) == 0 && fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path directory = argc > 1 ? std::filesystem::path(argv[1]) : std::filesystem::temp_directory_path();
+    std::string filename = (directory / "meshblob_check.vmb").string();
+    bool failed = false;
+
+    const TestScene scene = makeScene();
+    if (writeAndOpen(filename, scene, "valid", failed))
+    {
+        MeshBlob blob;
+        blob.open(filename);
+        check(blob.getMeshCount() == 2 && memcmp(blob.getMeshes(), scene.meshes.data(), 2 * sizeof(MeshBlobMesh)) == 0,
+              "the mesh table reads back", failed);
+        check(blob.getVertexDataSize() == scene.vertices.size() * sizeof(MeshBlobVertex)
+                  && memcmp(blob.getVertexData(), scene.vertices.data(), size_t(blob.getVertexDataSize())) == 0,
+              "the vertex stream reads back", failed);
+        check(blob.getIndexDataSize() == scene.indices.size() * sizeof(uint32_t)
+                  && memcmp(blob.getIndexData(), scene.indices.data(), size_t(blob.getIndexDataSize())) == 0,
+              "the index stream reads back", failed);
+    }
+    else
+    {
+        check(false, "a valid blob opens", failed);
+    }
+
+    // the triangle's last index reaches its vertex count, it would read past the vertex buffer
+    TestScene badIndex = scene;
+    badIndex.indices.back() = 3;
+    check(!writeAndOpen(filename, badIndex, "index at the vertex count", failed), "an index outside of its mesh is rejected", failed);
+
+    // the quad's indices are fine for the stream but not for the quad
+    TestScene otherMesh = scene;
+    otherMesh.indices[5] = 4;
+    check(!writeAndOpen(filename, otherMesh, "index into the next mesh", failed), "an index into another mesh is rejected", failed);
+
+    TestScene pastStream = scene;
+    pastStream.meshes[1].firstIndex = 7;
+    check(!writeAndOpen(filename, pastStream, "indices past the stream", failed), "a mesh past the index stream is rejected", failed);
+
+    TestScene pastVertices = scene;
+    pastVertices.meshes[1].vertexCount = 4;
+    check(!writeAndOpen(filename, pastVertices, "vertices past the stream", failed), "a mesh past the vertex stream is rejected", failed);
+
+    TestScene partialTriangle = scene;
+    partialTriangle.meshes[0].indexCount = 5;
+    check(!writeAndOpen(filename, partialTriangle, "partial triangle", failed), "an index count that is not a multiple of 3 is rejected", failed);
+
+    std::string error;
+    MeshBlob blob;
+    writeMeshBlob(filename, scene.meshes, scene.vertices, scene.indices);
+    std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - sizeof(uint32_t));
+    check(!blob.open(filename, &error), "a truncated blob is rejected", failed);
+    printf("  %-28s %s\n", "truncated", error.c_str());
+
+    writeMeshBlob(filename, scene.meshes, scene.vertices, scene.indices);
+    const char magic[4] = { 'V', 'M', 'B', 'X' };
+    check(patchFile(filename, 0, magic, sizeof(magic)) && !blob.open(filename, &error), "a wrong magic is rejected", failed);
+    printf("  %-28s %s\n", "wrong magic", error.c_str());
+
+    check(writeAndOpen(filename, TestScene(), "empty", failed), "an empty blob opens", failed);
+
+    std::filesystem::remove(filename);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// CPU side benchmark and validation of the meshlet builder:
+//
+//   meshlet_bench [scene.vmb] [repetitions]
+//
+// Builds the meshlets of tori of increasing tessellation, and of each mesh
+// of a mesh blob if one is given, keeps the best time of the repetitions
+// and validates the result with validateMeshlets(). Fill is the share of
+// the vertex and primitive limits the meshlets use, vertex reuse is the
+// share of meshlet vertices saved over three per triangle. Exits with a
+// failure as soon as a result does not validate.
+//
+
+#include "../MeshletBuilder.h"
+#include "../MeshBlob.h"
+#include "../TorusGeometry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+struct BenchResult
+{
+    double bestSeconds = 0.0;
+    MeshletMesh meshlets;
+};
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static bool benchMesh(const char* name, const float* positions, size_t stride, size_t vertexCount,
+                      const uint32_t* indices, size_t indexCount, int repetitions)
+{
+    const MeshletLimits limits;
+    BenchResult result;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        buildMeshlets(positions, stride, vertexCount, indices, indexCount, limits, result.meshlets);
+        double seconds = secondsSince(start);
+        result.bestSeconds = r == 0 ? seconds : std::min(result.bestSeconds, seconds);
+    }
+
+    std::string error;
+    if (!validateMeshlets(result.meshlets, positions, stride, vertexCount, indices, indexCount, limits, &error))
+    {
+        fprintf(stderr, "%s: %s\n", name, error.c_str());
+        return false;
+    }
+
+    const MeshletMesh& mesh = result.meshlets;
+    size_t meshletCount = mesh.meshlets.size();
+    size_t triangles = indexCount / 3;
+    size_t cones = 0;
+    for (const MeshletBounds& bounds : mesh.bounds)
+    {
+        cones += bounds.coneCutoff < 1.0f ? 1 : 0;
+    }
+    double vertexFill = meshletCount ? double(mesh.vertexIndices.size()) / double(meshletCount * limits.maxVertices) : 0.0;
+    double primitiveFill = meshletCount ? double(triangles) / double(meshletCount * limits.maxPrimitives) : 0.0;
+    double reuse = triangles ? 1.0 - double(mesh.vertexIndices.size()) / double(triangles * 3) : 0.0;
+
+    printf("%-20s %9zu %8zu %9.3f %10.2f %6.1f%% %6.1f%% %6.1f%% %6.1f%%\n", name, triangles, meshletCount,
+        result.bestSeconds * 1000.0, result.bestSeconds > 0.0 ? triangles / result.bestSeconds / 1.0e6 : 0.0,
+        vertexFill * 100.0, primitiveFill * 100.0, reuse * 100.0, meshletCount ? cones * 100.0 / meshletCount : 0.0);
+    return true;
+}
+
+int main(int argc, const char** argv)
+{
+    const char* blobFile = nullptr;
+    int repetitions = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.size() > 4 && arg.compare(arg.size() - 4, 4, ".vmb") == 0)
+        {
+            blobFile = argv[i];
+        }
+        else
+        {
+            repetitions = std::max(1, atoi(argv[i]));
+        }
+    }
+
+    printf("%-20s %9s %8s %9s %10s %7s %7s %7s %7s\n", "mesh", "triangles", "meshlets", "ms", "Mtris/s", "vtxfill",
+        "prmfill", "reuse", "cones");
+
+    const uint32_t tessellations[] = { 8, 32, 128, 512, 1024 };
+    for (uint32_t n : tessellations)
+    {
+        TorusParams params;
+        params.n = n;
+        params.m = n;
+        std::shared_ptr<const TorusMesh> torus = generateTorusMesh(params);
+
+        char name[64];
+        snprintf(name, sizeof(name), "torus %ux%u", n, n);
+        if (!benchMesh(name, &torus->positions[0].x, sizeof(glm::vec3), torus->positions.size(), torus->indices.data(),
+                torus->indices.size(), repetitions))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (blobFile)
+    {
+        MeshBlob blob;
+        std::string error;
+        if (!blob.open(blobFile, &error))
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return EXIT_FAILURE;
+        }
+        const MeshBlobVertex* vertices = reinterpret_cast<const MeshBlobVertex*>(blob.getVertexData());
+        const uint32_t* indices = reinterpret_cast<const uint32_t*>(blob.getIndexData());
+        for (uint32_t i = 0; i < blob.getMeshCount(); ++i)
+        {
+            // the indices of a mesh are relative to its base vertex
+            const MeshBlobMesh& mesh = blob.getMeshes()[i];
+            char name[64];
+            snprintf(name, sizeof(name), "mesh %u", i);
+            if (!benchMesh(name, vertices[mesh.baseVertex].position, sizeof(MeshBlobVertex), mesh.vertexCount,
+                    indices + mesh.firstIndex, mesh.indexCount, repetitions))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,349 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the CPU reference of the occlusion culling (see
+// OcclusionCullingReference.h) against brute force:
+//
+//   occlusion_cull_check [boxes]
+//
+// - buildDepthPyramid: every texel of every level is the farthest depth of
+//   the framebuffer pixels it covers, for even, odd and degenerate sizes.
+// - getDepthPyramidStorageSize: the GL texture of that size, whose mip
+//   levels halve rounding down, allows at least as many levels as the
+//   pyramid has (floor(log2(max(w, h))) + 1), and each of its levels holds
+//   the level of the pyramid, for common window sizes and all sizes up to
+//   1100x1100.
+// - isOccluded: random boxes in front of a depth buffer of walls at
+//   several depths. A box may only be culled if its nearest depth lies
+//   behind the depth of every pixel under its screen rectangle, so there
+//   have to be 0 wrong culls. Reported is the share of the boxes occluded
+//   by that brute force that the pyramid culls as well.
+// - cullFirstPhase and cullSecondPhase: with the camera moved between the
+//   frames, no box visible in the new depth may end up occluded, and
+//   without an old pyramid nothing is occluded in the first phase.
+//
+// Reported are the times of building the pyramid and testing the boxes.
+//
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../OcclusionCullingReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+struct Box
+{
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+static void checkPyramid(bool& failed)
+{
+    printf("buildDepthPyramid\n");
+    const uint32_t sizes[][2] = { { 1, 1 }, { 1, 7 }, { 2, 2 }, { 37, 23 }, { 64, 64 }, { 640, 361 } };
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> depthDist(0.0f, 1.0f);
+    for (const auto& size : sizes)
+    {
+        uint32_t width = size[0], height = size[1];
+        std::vector<float> depth(size_t(width) * height);
+        for (float& d : depth)
+        {
+            d = depthDist(rng);
+        }
+
+        DepthPyramid pyramid;
+        buildDepthPyramid(depth.data(), width, height, pyramid);
+
+        uint32_t mismatches = 0;
+        bool topIsSingle = pyramid.sizes.back() == glm::uvec2(1, 1);
+        for (uint32_t level = 0; level < pyramid.levels.size(); ++level)
+        {
+            glm::uvec2 levelSize = pyramid.sizes[level];
+            mismatches += levelSize != getDepthPyramidLevelSize(width, height, level);
+            for (uint32_t y = 0; y < levelSize.y; ++y)
+            {
+                for (uint32_t x = 0; x < levelSize.x; ++x)
+                {
+                    // texel x of level l covers the pixels [x << (l + 1), (x + 1) << (l + 1))
+                    float farthest = 0.0f;
+                    for (uint32_t py = y << (level + 1); py < std::min((y + 1) << (level + 1), height); ++py)
+                    {
+                        for (uint32_t px = x << (level + 1); px < std::min((x + 1) << (level + 1), width); ++px)
+                        {
+                            farthest = std::max(farthest, depth[size_t(py) * width + px]);
+                        }
+                    }
+                    mismatches += pyramid.levels[level][size_t(y) * levelSize.x + x] != farthest;
+                }
+            }
+        }
+        printf("  %4ux%-4u %2zu levels  %u wrong texels\n", width, height, pyramid.levels.size(), mismatches);
+        check(mismatches == 0, "every texel is the farthest depth of the pixels below it", failed);
+        check(topIsSingle, "the last level is 1x1", failed);
+    }
+}
+
+static void checkStorage(bool& failed)
+{
+    printf("getDepthPyramidStorageSize\n");
+    uint32_t tooManyLevels = 0;
+    uint32_t tooSmallLevels = 0;
+    auto checkSize = [&](uint32_t width, uint32_t height, bool print) {
+        glm::uvec2 storage = getDepthPyramidStorageSize(width, height);
+        uint32_t levelCount = getDepthPyramidLevelCount(width, height);
+        uint32_t glLevelCount = 1;
+        while ((std::max(storage.x, storage.y) >> glLevelCount) > 0)
+        {
+            ++glLevelCount;
+        }
+        tooManyLevels += levelCount > glLevelCount;
+
+        uint32_t smaller = 0;
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            glm::uvec2 glSize(std::max(storage.x >> level, 1u), std::max(storage.y >> level, 1u));
+            glm::uvec2 size = getDepthPyramidLevelSize(width, height, level);
+            smaller += size.x > glSize.x || size.y > glSize.y;
+        }
+        tooSmallLevels += smaller;
+        if (print)
+        {
+            printf("  %4ux%-4u storage %4ux%-4u %2u levels, GL allows %2u  %u levels too small\n", width, height,
+                   storage.x, storage.y, levelCount, glLevelCount, smaller);
+        }
+    };
+
+    const uint32_t sizes[][2] = { { 1280, 720 }, { 1920, 1080 }, { 800, 600 }, { 3840, 2160 }, { 1024, 1024 }, { 2048, 1 } };
+    for (const auto& size : sizes)
+    {
+        checkSize(size[0], size[1], true);
+    }
+    for (uint32_t height = 1; height <= 1100; ++height)
+    {
+        for (uint32_t width = 1; width <= 1100; ++width)
+        {
+            checkSize(width, height, false);
+        }
+    }
+    printf("  all sizes up to 1100x1100: %u with too many levels, %u levels too small\n", tooManyLevels, tooSmallLevels);
+    check(tooManyLevels == 0, "the texture allows all levels of the pyramid", failed);
+    check(tooSmallLevels == 0, "each level of the texture holds the level of the pyramid", failed);
+}
+
+// window depth of a view space distance through the projection
+static float windowDepth(const glm::mat4& projection, float distance)
+{
+    glm::vec4 clip = projection * glm::vec4(0.0f, 0.0f, -distance, 1.0f);
+    return clip.z / clip.w * 0.5f + 0.5f;
+}
+
+// walls at several distances in screen space, the background at 1
+static std::vector<float> renderWalls(const glm::mat4& projection, uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::vector<float> depth(size_t(width) * height, 1.0f);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int wall = 0; wall < 12; ++wall)
+    {
+        // the first one a large wall in the middle, then smaller ones in front
+        float w = wall == 0 ? 0.7f : 0.1f + 0.3f * unit(rng);
+        float h = wall == 0 ? 0.7f : 0.1f + 0.3f * unit(rng);
+        float x0 = wall == 0 ? 0.15f : unit(rng) * (1.0f - w);
+        float y0 = wall == 0 ? 0.15f : unit(rng) * (1.0f - h);
+        float d = windowDepth(projection, wall == 0 ? 12.0f : 2.0f + 8.0f * unit(rng));
+        for (uint32_t y = uint32_t(y0 * height); y < uint32_t((y0 + h) * height); ++y)
+        {
+            for (uint32_t x = uint32_t(x0 * width); x < uint32_t((x0 + w) * width); ++x)
+            {
+                float& pixel = depth[size_t(y) * width + x];
+                pixel = std::min(pixel, d);
+            }
+        }
+    }
+    return depth;
+}
+
+static std::vector<Box> makeBoxes(uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Box> boxes(count);
+    for (Box& box : boxes)
+    {
+        // mostly inside the view, some crossing its border or the near plane
+        float distance = 0.05f + 30.0f * unit(rng) * unit(rng);
+        glm::vec3 center((unit(rng) * 2.4f - 1.2f) * distance * 0.5f, (unit(rng) * 2.4f - 1.2f) * distance * 0.3f, -distance);
+        glm::vec3 extent = glm::vec3(unit(rng), unit(rng), unit(rng)) * (0.02f + 0.5f * unit(rng));
+        box.boundsMin = center - extent;
+        box.boundsMax = center + extent;
+    }
+    return boxes;
+}
+
+// the box is behind the depth of every pixel under its screen rectangle
+static bool isOccludedBruteForce(const std::vector<float>& depth, uint32_t width, uint32_t height,
+                                 const glm::mat4& modelViewProj, const Box& box)
+{
+    glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? box.boundsMax.x : box.boundsMin.x, (i & 2) ? box.boundsMax.y : box.boundsMin.y,
+                         (i & 4) ? box.boundsMax.z : box.boundsMin.z);
+        glm::vec4 clip = modelViewProj * glm::vec4(corner, 1.0f);
+        if (clip.w <= 0.0f || clip.z < -clip.w)
+        {
+            return false;
+        }
+        glm::vec2 screen = (glm::vec2(clip.x, clip.y) / clip.w * 0.5f + 0.5f) * glm::vec2(float(width), float(height));
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearest = std::min(nearest, clip.z / clip.w * 0.5f + 0.5f);
+    }
+    if (screenMin.x < 0.0f || screenMin.y < 0.0f || screenMax.x > float(width) || screenMax.y > float(height))
+    {
+        return false;
+    }
+
+    uint32_t x0 = uint32_t(screenMin.x), y0 = uint32_t(screenMin.y);
+    uint32_t x1 = std::min(uint32_t(screenMax.x), width - 1), y1 = std::min(uint32_t(screenMax.y), height - 1);
+    for (uint32_t y = y0; y <= y1; ++y)
+    {
+        for (uint32_t x = x0; x <= x1; ++x)
+        {
+            if (depth[size_t(y) * width + x] >= nearest)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void checkOcclusion(uint32_t boxCount, bool& failed)
+{
+    const uint32_t width = 1283, height = 721;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), float(width) / float(height), 0.1f, 100.0f);
+
+    std::vector<float> depth = renderWalls(projection, width, height, 7);
+    auto start = std::chrono::high_resolution_clock::now();
+    DepthPyramid pyramid;
+    buildDepthPyramid(depth.data(), width, height, pyramid);
+    double buildSeconds = secondsSince(start);
+
+    std::vector<Box> boxes = makeBoxes(boxCount, 3);
+    std::vector<uint8_t> culled(boxes.size());
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        culled[i] = isOccluded(pyramid, projection, boxes[i].boundsMin, boxes[i].boundsMax);
+    }
+    double testSeconds = secondsSince(start);
+
+    uint32_t wrongCulls = 0, occluded = 0, culledCount = 0;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        bool bruteForce = isOccludedBruteForce(depth, width, height, projection, boxes[i]);
+        occluded += bruteForce;
+        culledCount += culled[i];
+        wrongCulls += culled[i] && !bruteForce;
+    }
+
+    printf("isOccluded, %u boxes in front of %ux%u\n", boxCount, width, height);
+    printf("  occluded %u, culled %u (%.1f%%), wrong culls %u\n", occluded, culledCount,
+           occluded ? 100.0 * culledCount / occluded : 0.0, wrongCulls);
+    printf("  pyramid %.3f ms, boxes %.3f ms\n", buildSeconds * 1000.0, testSeconds * 1000.0);
+    check(wrongCulls == 0, "only boxes behind every pixel under them are culled", failed);
+    check(culledCount > 0, "the walls occlude some boxes", failed);
+}
+
+static void checkPhases(uint32_t boxCount, bool& failed)
+{
+    const uint32_t width = 960, height = 541;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), float(width) / float(height), 0.1f, 100.0f);
+    // the camera moved and turned a little between the frames
+    glm::mat4 oldView = glm::lookAt(glm::vec3(0.3f, 0.1f, 0.5f), glm::vec3(0.2f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 oldViewProj = projection * oldView;
+
+    std::vector<float> oldDepth = renderWalls(projection, width, height, 11);
+    std::vector<float> newDepth = renderWalls(projection, width, height, 12);
+    DepthPyramid oldPyramid, newPyramid;
+    buildDepthPyramid(oldDepth.data(), width, height, oldPyramid);
+    buildDepthPyramid(newDepth.data(), width, height, newPyramid);
+
+    std::vector<Box> boxes = makeBoxes(boxCount, 5);
+    uint32_t counts[4] = {};
+    uint32_t wrongCulls = 0, firstFrameOccluded = 0;
+    for (const Box& box : boxes)
+    {
+        OcclusionResult first = cullFirstPhase(&oldPyramid, oldViewProj, projection, box.boundsMin, box.boundsMax);
+        OcclusionResult result = cullSecondPhase(first, newPyramid, projection, box.boundsMin, box.boundsMax);
+        counts[result]++;
+        wrongCulls += result == OCCLUSION_OCCLUDED && !isOccludedBruteForce(newDepth, width, height, projection, box);
+
+        firstFrameOccluded += cullFirstPhase(nullptr, oldViewProj, projection, box.boundsMin, box.boundsMax) == OCCLUSION_OCCLUDED;
+    }
+
+    printf("cullFirstPhase and cullSecondPhase, %u boxes\n", boxCount);
+    printf("  visible %u, visible late %u, occluded %u, outside %u, wrong culls %u\n", counts[OCCLUSION_VISIBLE],
+           counts[OCCLUSION_VISIBLE_LATE], counts[OCCLUSION_OCCLUDED], counts[OCCLUSION_OUTSIDE_FRUSTUM], wrongCulls);
+    check(wrongCulls == 0, "no box visible in the new depth ends up occluded", failed);
+    check(counts[OCCLUSION_VISIBLE_LATE] > 0, "boxes occluded only in the old depth are drawn late", failed);
+    check(firstFrameOccluded == 0, "without an old pyramid nothing is occluded", failed);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t boxCount = argc > 1 ? uint32_t(std::max(1, atoi(argv[1]))) : 100000;
+    bool failed = false;
+
+    checkPyramid(failed);
+    checkStorage(failed);
+    checkOcclusion(boxCount, failed);
+    checkPhases(boxCount, failed);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
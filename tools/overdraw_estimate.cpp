@@ -0,0 +1,221 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Measures how many samples of the tori pass the depth test in grid order
+// and in the order of the render queue, without a GPU:
+//
+//   overdraw_estimate [width height] [n]
+//
+// Rasterizes the torus mesh of n x n segments (8 by default) at every
+// placement of renderTori() into a depth buffer of the window size
+// (1200 x 900 by default), with the camera and projection of VRSDemo: the
+// default view and "View along the grid". Counted are the samples that
+// pass the depth test, which is what GL_SAMPLES_PASSED reports and what
+// gets shaded with early depth testing. The tori are drawn in grid order,
+// sorted by the keys renderTori() builds (front to back), and sorted with
+// the palette of the green object rule above the depth, which groups the
+// tori by palette. Both faces are drawn, like in the sample. Pixel centers
+// are sampled, without a fill rule.
+//
+
+#include "../RenderQueue.h"
+#include "../SceneTransforms.h"
+#include "../TorusGeometry.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct DepthTarget
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> depth;
+};
+
+// samples of the mesh that pass the depth test, triangles through the near plane are skipped
+static uint64_t drawMesh(DepthTarget& target, const glm::mat4& modelViewProj, const TorusMesh& mesh)
+{
+    std::vector<glm::vec3> screen(mesh.positions.size());
+    std::vector<bool> visible(mesh.positions.size());
+    for (size_t i = 0; i < mesh.positions.size(); ++i)
+    {
+        glm::vec4 clip = modelViewProj * glm::vec4(mesh.positions[i], 1.0f);
+        visible[i] = clip.w > 1.0e-4f;
+        float invW = visible[i] ? 1.0f / clip.w : 0.0f;
+        screen[i] = glm::vec3((clip.x * invW * 0.5f + 0.5f) * float(target.width), (clip.y * invW * 0.5f + 0.5f) * float(target.height),
+            clip.z * invW * 0.5f + 0.5f);
+    }
+
+    uint64_t passed = 0;
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+    {
+        uint32_t i0 = mesh.indices[t];
+        uint32_t i1 = mesh.indices[t + 1];
+        uint32_t i2 = mesh.indices[t + 2];
+        if (!visible[i0] || !visible[i1] || !visible[i2])
+        {
+            continue;
+        }
+        glm::vec3 a = screen[i0];
+        glm::vec3 b = screen[i1];
+        glm::vec3 c = screen[i2];
+
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (area == 0.0f)
+        {
+            continue;
+        }
+        // no culling, either winding
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        float invArea = 1.0f / (area * sign);
+
+        int x0 = std::max(int(std::floor(std::min({ a.x, b.x, c.x }))), 0);
+        int x1 = std::min(int(std::ceil(std::max({ a.x, b.x, c.x }))), target.width - 1);
+        int y0 = std::max(int(std::floor(std::min({ a.y, b.y, c.y }))), 0);
+        int y1 = std::min(int(std::ceil(std::max({ a.y, b.y, c.y }))), target.height - 1);
+        for (int y = y0; y <= y1; ++y)
+        {
+            float py = float(y) + 0.5f;
+            for (int x = x0; x <= x1; ++x)
+            {
+                float px = float(x) + 0.5f;
+                float w0 = sign * ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x));
+                float w1 = sign * ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x));
+                float w2 = sign * ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x));
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                {
+                    continue;
+                }
+                float z = (w0 * a.z + w1 * b.z + w2 * c.z) * invArea;
+                float& stored = target.depth[size_t(y) * target.width + x];
+                if (z >= 0.0f && z <= 1.0f && z < stored)
+                {
+                    stored = z;
+                    ++passed;
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+enum DrawOrder
+{
+    ORDER_GRID,
+    ORDER_FRONT_TO_BACK,
+    ORDER_PALETTE,
+    ORDER_COUNT
+};
+
+struct OverdrawResult
+{
+    uint64_t covered = 0;               // pixels with any torus
+    uint64_t passed[ORDER_COUNT] = {};
+};
+
+static OverdrawResult measure(const TorusMesh& mesh, uint32_t numberOfTori, const glm::mat4& view, int width, int height)
+{
+    const glm::mat4 projection = glm::perspective(45.f, float(width) / float(height), 0.01f, 10.0f);
+
+    std::vector<vertexload::InstanceData> instances;
+    placeTorusGrid(numberOfTori, float(width) / float(height), instances);
+
+    // the keys of renderTori(), and with the palette of the green object rule
+    RenderQueue queues[ORDER_COUNT];
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        const vertexload::InstanceData& instance = instances[i];
+        glm::vec4 center = view * instance.model[3];
+        bool fullRate = instance.color.y > 0.8f && instance.color.x < 0.2f && instance.color.z < 0.2f;
+        queues[ORDER_GRID].push(0, uint32_t(i));
+        queues[ORDER_FRONT_TO_BACK].push(makeDrawKey(DRAW_PASS_OPAQUE, 0, 0, 0, -center.z), uint32_t(i));
+        queues[ORDER_PALETTE].push(makeDrawKey(DRAW_PASS_OPAQUE, 0, 0, fullRate ? 1 : 0, -center.z), uint32_t(i));
+    }
+
+    OverdrawResult result;
+    DepthTarget target;
+    target.width = width;
+    target.height = height;
+    for (int order = 0; order < ORDER_COUNT; ++order)
+    {
+        queues[order].sort();
+        target.depth.assign(size_t(width) * height, 1.0f);
+        for (const RenderQueue::Item& item : queues[order].getItems())
+        {
+            result.passed[order] += drawMesh(target, projection * view * instances[item.index].model, mesh);
+        }
+    }
+    result.covered = uint64_t(std::count_if(target.depth.begin(), target.depth.end(), [](float depth) { return depth < 1.0f; }));
+    return result;
+}
+
+int main(int argc, const char** argv)
+{
+    int width = 1200;
+    int height = 900;
+    uint32_t segments = 8;
+    if (argc >= 3)
+    {
+        width = std::max(atoi(argv[1]), 16);
+        height = std::max(atoi(argv[2]), 16);
+    }
+    if (argc == 2 || argc >= 4)
+    {
+        segments = uint32_t(std::max(atoi(argv[argc == 2 ? 1 : 3]), 3));
+    }
+
+    TorusParams params;
+    params.n = segments;
+    params.m = segments;
+    std::shared_ptr<const TorusMesh> mesh = generateTorusMesh(params);
+
+    // initCameraControl() and "View along the grid"
+    struct View
+    {
+        const char* name;
+        glm::mat4 matrix;
+    };
+    const View views[] = {
+        { "default view", glm::lookAt(-glm::normalize(glm::vec3(1, 0, -1)) * 1.5f, glm::vec3(0.0f), glm::vec3(0, 1, 0)) },
+        { "along the grid", glm::lookAt(glm::vec3(-0.75f, 0.02f, 0.1f), glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(0, 1, 0)) },
+    };
+    const uint32_t toriCounts[] = { 16, 100, 1000 };
+
+    printf("%d x %d, torus %u x %u, samples passing the depth test per covered pixel\n", width, height, segments, segments);
+    printf("%-16s %6s %9s %11s %22s %22s\n", "view", "tori", "covered", "grid order", "front to back", "palette, front to back");
+    for (const View& view : views)
+    {
+        for (uint32_t tori : toriCounts)
+        {
+            OverdrawResult result = measure(*mesh, tori, view.matrix, width, height);
+            double covered = double(std::max<uint64_t>(result.covered, 1));
+            double grid = double(result.passed[ORDER_GRID]) / covered;
+            double frontToBack = double(result.passed[ORDER_FRONT_TO_BACK]) / covered;
+            double palette = double(result.passed[ORDER_PALETTE]) / covered;
+            printf("%-16s %6u %8.1f%% %11.3f %13.3f (%+5.1f%%) %13.3f (%+5.1f%%)\n", view.name, tori,
+                100.0 * double(result.covered) / (double(width) * height), grid, frontToBack, (frontToBack / grid - 1.0) * 100.0,
+                palette, (palette / grid - 1.0) * 100.0);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates stampRateRects (see ShadingRateImage.h) against a per pixel
+// brute force:
+//
+//   rate_stamp_check [iterations]
+//
+// Random panel rects are stamped into images whose framebuffer is not a
+// multiple of the texel size, with most rect edges placed on, just before
+// or just after a texel edge, some of them outside the framebuffer. Every
+// visible pixel of every texel is tested against the rects:
+//
+// - a stamped texel may not have a visible pixel outside all the rects,
+// - a texel is stamped exactly if one rect covers all its visible pixels,
+// - texels without visible pixels and all others keep their rate,
+// - the returned rectangle bounds the stamped texels.
+//
+
+#include "../ShadingRateImage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+// a pixel [x, x + 1) x [y, y + 1) is covered if the rect contains all of it
+static bool coversPixel(const PixelRect& rect, uint32_t x, uint32_t y)
+{
+    return rect.x0 <= float(x) && float(x + 1) <= rect.x1 && rect.y0 <= float(y) && float(y + 1) <= rect.y1;
+}
+
+struct Setup
+{
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+    uint32_t texelWidth;
+    uint32_t texelHeight;
+    uint32_t extraTexels;   // image texels beyond the framebuffer
+};
+
+// an edge coordinate near a texel edge, or anywhere
+static float randomEdge(std::mt19937& rng, uint32_t texelSize, uint32_t framebufferSize)
+{
+    const float offsets[] = { -1.0f, -0.5f, -0.001f, 0.0f, 0.001f, 0.5f, 1.0f };
+    uint32_t tiles = (framebufferSize + texelSize - 1) / texelSize;
+    switch (rng() % 4)
+    {
+    case 0:
+        return float(rng() % (framebufferSize + 40)) - 20.0f + float(rng() % 4) * 0.25f;
+    case 1:
+        // the framebuffer edges
+        return (rng() % 2 ? 0.0f : float(framebufferSize)) + offsets[rng() % 7];
+    default:
+        return float((rng() % (tiles + 2)) * texelSize) + offsets[rng() % 7];
+    }
+}
+
+static void checkSetup(const Setup& setup, uint32_t iterations, std::mt19937& rng, bool& failed)
+{
+    uint32_t tilesX = (setup.framebufferWidth + setup.texelWidth - 1) / setup.texelWidth;
+    uint32_t tilesY = (setup.framebufferHeight + setup.texelHeight - 1) / setup.texelHeight;
+    uint32_t width = tilesX + setup.extraTexels;
+    uint32_t height = tilesY + setup.extraTexels;
+
+    std::vector<uint8_t> before(size_t(width) * height);
+    std::vector<uint8_t> data;
+    std::vector<PixelRect> rects;
+
+    uint32_t stampedTexels = 0;
+    uint32_t uncovered = 0;
+    uint32_t mismatched = 0;
+    uint32_t badBounds = 0;
+    for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        for (uint8_t& rate : before)
+        {
+            rate = uint8_t(RATE_1X1 + rng() % 3);
+        }
+        data = before;
+
+        rects.resize(rng() % 4);
+        for (PixelRect& rect : rects)
+        {
+            float ax = randomEdge(rng, setup.texelWidth, setup.framebufferWidth);
+            float bx = randomEdge(rng, setup.texelWidth, setup.framebufferWidth);
+            float ay = randomEdge(rng, setup.texelHeight, setup.framebufferHeight);
+            float by = randomEdge(rng, setup.texelHeight, setup.framebufferHeight);
+            rect.x0 = std::min(ax, bx);
+            rect.x1 = std::max(ax, bx);
+            rect.y0 = std::min(ay, by);
+            rect.y1 = std::max(ay, by);
+        }
+
+        RateRect stamped = stampRateRects(data.data(), width, height, setup.texelWidth, setup.texelHeight,
+                                          setup.framebufferWidth, setup.framebufferHeight, rects.data(), rects.size(),
+                                          RATE_NO_INVOCATIONS);
+
+        uint32_t minX = width, minY = height, maxX = 0, maxY = 0;
+        bool any = false;
+        for (uint32_t ty = 0; ty < height; ++ty)
+        {
+            for (uint32_t tx = 0; tx < width; ++tx)
+            {
+                // the visible pixels of the texel, none beyond the framebuffer
+                uint32_t px0 = tx * setup.texelWidth;
+                uint32_t py0 = ty * setup.texelHeight;
+                uint32_t px1 = std::min((tx + 1) * setup.texelWidth, setup.framebufferWidth);
+                uint32_t py1 = std::min((ty + 1) * setup.texelHeight, setup.framebufferHeight);
+
+                bool visible = px0 < px1 && py0 < py1;
+                bool unionCovers = visible;
+                bool rectCovers = false;
+                for (const PixelRect& rect : rects)
+                {
+                    bool covers = visible;
+                    for (uint32_t py = py0; py < py1 && covers; ++py)
+                    {
+                        for (uint32_t px = px0; px < px1 && covers; ++px)
+                        {
+                            covers = coversPixel(rect, px, py);
+                        }
+                    }
+                    rectCovers = rectCovers || covers;
+                }
+                for (uint32_t py = py0; py < py1 && unionCovers; ++py)
+                {
+                    for (uint32_t px = px0; px < px1 && unionCovers; ++px)
+                    {
+                        bool pixelCovered = false;
+                        for (const PixelRect& rect : rects)
+                        {
+                            pixelCovered = pixelCovered || coversPixel(rect, px, py);
+                        }
+                        unionCovers = pixelCovered;
+                    }
+                }
+
+                size_t index = size_t(ty) * width + tx;
+                uint8_t expected = rectCovers ? uint8_t(RATE_NO_INVOCATIONS) : before[index];
+                bool wasStamped = data[index] != before[index];
+                uncovered += wasStamped && !unionCovers;
+                mismatched += data[index] != expected;
+                if (rectCovers)
+                {
+                    any = true;
+                    stampedTexels++;
+                    minX = std::min(minX, tx);
+                    minY = std::min(minY, ty);
+                    maxX = std::max(maxX, tx);
+                    maxY = std::max(maxY, ty);
+                }
+            }
+        }
+
+        if (any)
+        {
+            badBounds += stamped.x != minX || stamped.y != minY || stamped.width != maxX - minX + 1
+                         || stamped.height != maxY - minY + 1;
+        }
+        else
+        {
+            badBounds += !stamped.isEmpty();
+        }
+    }
+
+    printf("  framebuffer %4ux%-4u texel %ux%u +%u  stamped %7u  uncovered %u  mismatched %u  bad bounds %u\n",
+           setup.framebufferWidth, setup.framebufferHeight, setup.texelWidth, setup.texelHeight, setup.extraTexels,
+           stampedTexels, uncovered, mismatched, badBounds);
+    check(uncovered == 0, "no stamped texel has a visible pixel outside the rects", failed);
+    check(mismatched == 0, "exactly the texels covered by one rect are stamped", failed);
+    check(badBounds == 0, "the returned rectangle bounds the stamped texels", failed);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = argc > 1 ? uint32_t(atoi(argv[1])) : 2000;
+
+    const Setup setups[] = {
+        { 128, 64, 16, 16, 0 },  // a multiple of the texel size
+        { 131, 67, 16, 16, 0 },  // clipped last row and column
+        { 97, 50, 16, 8, 2 },    // texels beyond the framebuffer
+        { 33, 17, 32, 16, 1 },   // last texel with a single pixel
+        { 45, 45, 8, 8, 3 },
+    };
+
+    bool failed = false;
+    std::mt19937 rng(1);
+    printf("stampRateRects, %u iterations per setup\n", iterations);
+    for (const Setup& setup : setups)
+    {
+        checkSetup(setup, iterations, rng, failed);
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
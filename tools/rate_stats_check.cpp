@@ -0,0 +1,265 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates ShadingRateStats (see ShadingRateStats.h) against a per pixel
+// brute force histogram:
+//
+//   rate_stats_check [iterations]
+//
+// - countRates: the SSE2 path and its scalar tail count the same as a
+//   plain loop, for lengths around 16 and beyond the 255 blocks after which
+//   the byte counters are folded, at unaligned starts, with values outside
+//   the palette and with a single value throughout,
+// - build: every framebuffer pixel counts the entry of the texel it lies
+//   in, for framebuffers that are not a multiple of the texel size and
+//   images with texels beyond the framebuffer,
+// - update: after each of a series of random edits, applied with the dirty
+//   rect around them (often touching the partial last column and row), the
+//   counts still match a full brute force of the new image,
+// - the predicted invocations per pixel and the fraction without
+//   invocations follow from the brute force counts.
+//
+
+#include "../ShadingRateStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+struct Setup
+{
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+    uint32_t texelWidth;
+    uint32_t texelHeight;
+    uint32_t extraTexels;   // image texels beyond the framebuffer
+};
+
+// mostly palette entries, some values outside
+static uint8_t randomRate(std::mt19937& rng)
+{
+    uint32_t r = rng() % 64;
+    return r < 60 ? uint8_t(r % 4) : uint8_t(r % 3 == 0 ? RATE_STATS_MAX_ENTRIES : 200 + r);
+}
+
+static void checkCountRates(std::mt19937& rng, bool& failed)
+{
+    printf("countRates\n");
+    const uint32_t lengths[] = { 0, 1, 15, 16, 17, 31, 33, 255 * 16 - 1, 255 * 16, 255 * 16 + 17, 70001 };
+    std::vector<uint8_t> data(70001 + 16);
+    uint32_t mismatches = 0;
+    uint32_t runs = 0;
+    for (uint32_t length : lengths)
+    {
+        for (uint32_t offset = 0; offset < 5; ++offset)
+        {
+            // the last run is a single entry, which fills the byte counters fastest
+            for (uint8_t& value : data)
+            {
+                value = offset == 4 ? uint8_t(RATE_1X1) : uint8_t(rng() % 4 == 0 ? rng() : rng() % RATE_STATS_MAX_ENTRIES);
+            }
+
+            uint32_t histogram[RATE_STATS_MAX_ENTRIES] = {};
+            uint32_t invalid = countRates(data.data() + offset, length, histogram);
+
+            uint32_t expected[RATE_STATS_MAX_ENTRIES] = {};
+            uint32_t expectedInvalid = 0;
+            for (uint32_t i = offset; i < offset + length; ++i)
+            {
+                if (data[i] < RATE_STATS_MAX_ENTRIES)
+                {
+                    expected[data[i]]++;
+                }
+                else
+                {
+                    expectedInvalid++;
+                }
+            }
+            mismatches += invalid != expectedInvalid || !std::equal(histogram, histogram + RATE_STATS_MAX_ENTRIES, expected);
+            runs++;
+        }
+    }
+    printf("  %u lengths and offsets, %u mismatches\n", runs, mismatches);
+    check(mismatches == 0, "countRates counts like a plain loop", failed);
+}
+
+struct BruteForce
+{
+    uint64_t pixels[RATE_STATS_MAX_ENTRIES] = {};
+    uint64_t invalid = 0;
+};
+
+static BruteForce countPixels(const std::vector<uint8_t>& image, uint32_t width, const Setup& setup)
+{
+    BruteForce counts;
+    for (uint32_t py = 0; py < setup.framebufferHeight; ++py)
+    {
+        for (uint32_t px = 0; px < setup.framebufferWidth; ++px)
+        {
+            uint8_t rate = image[size_t(py / setup.texelHeight) * width + px / setup.texelWidth];
+            if (rate < RATE_STATS_MAX_ENTRIES)
+            {
+                counts.pixels[rate]++;
+            }
+            else
+            {
+                counts.invalid++;
+            }
+        }
+    }
+    return counts;
+}
+
+static bool matches(const ShadingRateStats& stats, const BruteForce& counts)
+{
+    bool same = stats.getInvalidPixels() == counts.invalid;
+    for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+    {
+        same = same && stats.getPixels(e) == counts.pixels[e];
+    }
+    return same;
+}
+
+// a rect near the last column and row more often than not
+static RateRect randomRect(std::mt19937& rng, uint32_t width, uint32_t height)
+{
+    RateRect rect;
+    rect.x = rng() % 2 ? width - 1 - rng() % std::min(width, 3u) : rng() % width;
+    rect.y = rng() % 2 ? height - 1 - rng() % std::min(height, 3u) : rng() % height;
+    rect.width = 1 + rng() % (width - rect.x);
+    rect.height = 1 + rng() % (height - rect.y);
+    return rect;
+}
+
+static void checkSetup(const Setup& setup, uint32_t iterations, std::mt19937& rng, bool& failed)
+{
+    uint32_t width = (setup.framebufferWidth + setup.texelWidth - 1) / setup.texelWidth + setup.extraTexels;
+    uint32_t height = (setup.framebufferHeight + setup.texelHeight - 1) / setup.texelHeight + setup.extraTexels;
+
+    std::vector<uint8_t> image(size_t(width) * height);
+    for (uint8_t& rate : image)
+    {
+        rate = randomRate(rng);
+    }
+
+    ShadingRateStats stats;
+    stats.setLayout(width, height, setup.texelWidth, setup.texelHeight, setup.framebufferWidth, setup.framebufferHeight);
+    stats.build(image.data());
+    bool buildMatches = matches(stats, countPixels(image, width, setup));
+
+    // updates only look at the dirty rect, the texels outside it must not change
+    uint32_t updateMismatches = 0;
+    std::vector<uint8_t> next;
+    for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        next = image;
+        RateRect dirty = randomRect(rng, width, height);
+        for (uint32_t y = dirty.y; y < dirty.y + dirty.height; ++y)
+        {
+            for (uint32_t x = dirty.x; x < dirty.x + dirty.width; ++x)
+            {
+                if (rng() % 3)
+                {
+                    next[size_t(y) * width + x] = randomRate(rng);
+                }
+            }
+        }
+        stats.update(image.data(), next.data(), iteration % 17 == 0 ? RateRect() : dirty);
+        if (iteration % 17 == 0)
+        {
+            // an empty rect changes nothing, the image stays as it was
+            next = image;
+        }
+        image.swap(next);
+        updateMismatches += !matches(stats, countPixels(image, width, setup));
+    }
+
+    //
+    // cost model with a no invocation entry and the usual 1x1, 2x2, 4x4
+    //
+    RateCostModel cost;
+    cost.invocationsPerPixel[RATE_NO_INVOCATIONS] = 0.0f;
+    cost.invocationsPerPixel[RATE_1X1] = 1.0f;
+    cost.invocationsPerPixel[RATE_2X2] = 1.0f / 4.0f;
+    cost.invocationsPerPixel[RATE_4X4] = 1.0f / 16.0f;
+    for (uint32_t e = 4; e < RATE_STATS_MAX_ENTRIES; ++e)
+    {
+        cost.invocationsPerPixel[e] = 0.5f;
+    }
+    BruteForce counts = countPixels(image, width, setup);
+    double total = double(setup.framebufferWidth) * setup.framebufferHeight;
+    double invocations = 0.0;
+    double noInvocations = 0.0;
+    for (uint32_t e = 0; e < RATE_STATS_MAX_ENTRIES; ++e)
+    {
+        invocations += double(counts.pixels[e]) * cost.invocationsPerPixel[e];
+        noInvocations += cost.invocationsPerPixel[e] == 0.0f ? double(counts.pixels[e]) : 0.0;
+    }
+    float predicted = stats.getPredictedInvocationsPerPixel(cost);
+    float noInvocationFraction = stats.getNoInvocationFraction(cost);
+    bool costMatches = std::abs(predicted - invocations / total) <= 1e-6 && std::abs(noInvocationFraction - noInvocations / total) <= 1e-6;
+
+    printf("  framebuffer %4ux%-4u texel %2ux%-2u +%u  build %s  update mismatches %u of %u  predicted %.4f  no invocations %.4f\n",
+           setup.framebufferWidth, setup.framebufferHeight, setup.texelWidth, setup.texelHeight, setup.extraTexels,
+           buildMatches ? "ok" : "wrong", updateMismatches, iterations, predicted, noInvocationFraction);
+    check(buildMatches, "build counts every framebuffer pixel once", failed);
+    check(updateMismatches == 0, "update keeps the counts of a full rebuild", failed);
+    check(costMatches, "the predictions follow from the counts", failed);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = argc > 1 ? uint32_t(std::max(1, atoi(argv[1]))) : 300;
+    bool failed = false;
+    std::mt19937 rng(1);
+
+    checkCountRates(rng, failed);
+
+    printf("build and update, %u updates per setup\n", iterations);
+    const Setup setups[] = {
+        { 1920, 1080, 16, 16, 0 },  // last row partial
+        { 1283, 721, 16, 16, 0 },   // last row and column partial
+        { 517, 300, 16, 8, 2 },     // texels beyond the framebuffer
+        { 33, 17, 32, 16, 1 },      // last texel with a single pixel
+        { 4096, 64, 1, 1, 0 },      // one texel per pixel, rows beyond 255 blocks
+    };
+    for (const Setup& setup : setups)
+    {
+        checkSetup(setup, iterations, rng, failed);
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
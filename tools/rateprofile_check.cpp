@@ -0,0 +1,264 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the resampling of rate profiles (see RateProfile.h):
+//
+//   rateprofile_check [directory]
+//
+// Random masks and density maps are resampled with resampleRateProfileEye
+// to smaller, equal, larger and odd sizes. For every target texel the
+// source texels it overlaps are found again with exact rational arithmetic,
+// and the target must never be coarser than the finest of them (each one at
+// the finer of its mask and its density rate), and may only be
+// RATE_NO_INVOCATIONS if all of them are invisible. Texels outside the
+// region must not be written.
+//
+// A two eye profile is then written to the directory, and RateProfile's
+// getRates has to match resampling it directly while the resolution goes
+// back and forth, keeping the last two resolutions cached.
+//
+
+#include "../RateProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const uint8_t SENTINEL = 0xEE;
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+struct SourceEye
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> mask;
+    std::vector<float> density;
+};
+
+static SourceEye makeSource(uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> rateDist(RATE_1X1, RATE_4X4);
+    std::uniform_real_distribution<float> densityDist(0.0f, 2.0f);
+
+    SourceEye source;
+    source.width = width;
+    source.height = height;
+    source.mask.resize(size_t(width) * height);
+    source.density.resize(size_t(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            size_t index = size_t(y) * width + x;
+            // an invisible corner, an invisible column and scattered holes
+            bool invisible = (x + y < width / 3) || x == width / 2 || rng() % 11 == 0;
+            source.mask[index] = invisible ? uint8_t(RATE_NO_INVOCATIONS) : uint8_t(rateDist(rng));
+            source.density[index] = densityDist(rng);
+        }
+    }
+    return source;
+}
+
+static uint8_t texelRate(uint8_t mask, float density, const float thresholds[2])
+{
+    uint8_t densityRate = density >= thresholds[0] ? RATE_1X1 : density >= thresholds[1] ? RATE_2X2 : RATE_4X4;
+    return std::min(mask, densityRate);
+}
+
+// source texel s of n overlaps target texel t of m if [s/n, (s+1)/n) and [t/m, (t+1)/m) intersect
+static bool overlaps(uint32_t s, uint32_t n, uint32_t t, uint32_t m)
+{
+    return uint64_t(s) * m < uint64_t(t + 1) * n && uint64_t(s + 1) * m > uint64_t(t) * n;
+}
+
+static void checkResample(const SourceEye& source, uint32_t regionWidth, uint32_t height, bool& failed)
+{
+    const float thresholds[2] = { 1.0f, 0.5f };
+    const uint32_t x0 = 3;
+    const uint32_t pitch = x0 + regionWidth + 5;
+    std::vector<uint8_t> rates(size_t(pitch) * height, SENTINEL);
+    resampleRateProfileEye(source.mask.data(), source.density.data(), source.width, source.height, thresholds,
+                           rates.data(), pitch, x0, regionWidth, height);
+
+    uint32_t coarser = 0;
+    uint32_t extraNoInvocations = 0;
+    uint32_t missedNoInvocations = 0;
+    uint32_t outside = 0;
+    uint32_t finerThanNeeded = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < pitch; ++x)
+        {
+            uint8_t rate = rates[size_t(y) * pitch + x];
+            if (x < x0 || x >= x0 + regionWidth)
+            {
+                outside += rate != SENTINEL;
+                continue;
+            }
+
+            uint8_t finest = RATE_NO_INVOCATIONS;
+            for (uint32_t sy = 0; sy < source.height; ++sy)
+            {
+                if (!overlaps(sy, source.height, y, height))
+                {
+                    continue;
+                }
+                for (uint32_t sx = 0; sx < source.width; ++sx)
+                {
+                    size_t index = size_t(sy) * source.width + sx;
+                    if (source.mask[index] == RATE_NO_INVOCATIONS || !overlaps(sx, source.width, x - x0, regionWidth))
+                    {
+                        continue;
+                    }
+                    uint8_t sourceRate = texelRate(source.mask[index], source.density[index], thresholds);
+                    finest = finest == RATE_NO_INVOCATIONS ? sourceRate : std::min(finest, sourceRate);
+                }
+            }
+
+            if (finest == RATE_NO_INVOCATIONS)
+            {
+                missedNoInvocations += rate != RATE_NO_INVOCATIONS;
+            }
+            else if (rate == RATE_NO_INVOCATIONS)
+            {
+                extraNoInvocations++;
+            }
+            else if (rate > finest)
+            {
+                coarser++;
+            }
+            else if (rate < finest)
+            {
+                finerThanNeeded++;
+            }
+        }
+    }
+
+    printf("  %3ux%-3u -> %4ux%-4u  coarser %u  extra no invocations %u  missed no invocations %u  outside %u"
+           "  finer than needed %u\n",
+           source.width, source.height, regionWidth, height, coarser, extraNoInvocations, missedNoInvocations,
+           outside, finerThanNeeded);
+    check(coarser == 0, "no texel is coarser than its source footprint", failed);
+    check(extraNoInvocations == 0, "no invocations only where the whole footprint is invisible", failed);
+    check(missedNoInvocations == 0, "an invisible footprint gets no invocations", failed);
+    check(outside == 0, "nothing is written outside the region", failed);
+}
+
+static void checkProfile(const std::string& directory, bool& failed)
+{
+    printf("RateProfile::getRates\n");
+    std::string filename = directory + "/rateprofile_check.vrp";
+
+    RateProfileHeader header = {};
+    memcpy(header.magic, RATE_PROFILE_MAGIC, sizeof(header.magic));
+    header.version = RATE_PROFILE_VERSION;
+    header.eyeCount = 2;
+    header.width = 41;
+    header.height = 23;
+    header.densityThresholds[0] = 1.0f;
+    header.densityThresholds[1] = 0.5f;
+
+    SourceEye eyes[2] = { makeSource(header.width, header.height, 11), makeSource(header.width, header.height, 12) };
+    std::vector<std::vector<uint8_t>> masks = { eyes[0].mask, eyes[1].mask };
+    std::vector<std::vector<float>> densities = { eyes[0].density, eyes[1].density };
+    std::string error;
+    if (!check(writeRateProfile(filename, header, masks, densities, &error), "the profile can be written", failed))
+    {
+        fprintf(stderr, "  %s\n", error.c_str());
+        return;
+    }
+
+    RateProfile profile;
+    if (!check(profile.open(filename, &error), "the profile can be opened", failed))
+    {
+        fprintf(stderr, "  %s\n", error.c_str());
+        remove(filename.c_str());
+        return;
+    }
+
+    auto direct = [&](uint32_t width, uint32_t height) {
+        std::vector<uint8_t> rates(size_t(width) * height, RATE_NO_INVOCATIONS);
+        for (uint32_t eye = 0; eye < 2; ++eye)
+        {
+            uint32_t x0 = width * eye / 2;
+            uint32_t x1 = width * (eye + 1) / 2;
+            resampleRateProfileEye(eyes[eye].mask.data(), eyes[eye].density.data(), header.width, header.height,
+                                   header.densityThresholds, rates.data(), width, x0, x1 - x0, height);
+        }
+        return rates;
+    };
+
+    // a window being resized back and forth
+    const uint32_t sizes[][2] = { { 160, 90 }, { 161, 90 }, { 160, 90 }, { 161, 90 }, { 33, 7 }, { 160, 90 }, { 161, 90 } };
+    for (const auto& size : sizes)
+    {
+        const std::vector<uint8_t>& rates = profile.getRates(size[0], size[1]);
+        check(rates == direct(size[0], size[1]), "getRates matches resampling directly", failed);
+    }
+
+    // the two most recent resolutions are not resampled again
+    const uint8_t* first = profile.getRates(160, 90).data();
+    profile.getRates(161, 90);
+    check(profile.getRates(160, 90).data() == first, "the previous resolution stays cached", failed);
+    profile.getRates(33, 7);
+    check(profile.getRates(160, 90).data() == first, "a new resolution replaces the older one", failed);
+
+    profile.close();
+    remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    std::string directory = argc > 1 ? argv[1] : ".";
+    bool failed = false;
+
+    printf("resampleRateProfileEye\n");
+    const uint32_t sourceSizes[][2] = { { 37, 29 }, { 64, 64 }, { 5, 3 } };
+    const uint32_t targetSizes[][2] = { { 37, 29 }, { 18, 14 }, { 9, 31 }, { 100, 71 }, { 1, 1 }, { 200, 3 }, { 7, 64 } };
+    for (uint32_t i = 0; i < sizeof(sourceSizes) / sizeof(sourceSizes[0]); ++i)
+    {
+        SourceEye source = makeSource(sourceSizes[i][0], sourceSizes[i][1], i + 1);
+        for (const auto& target : targetSizes)
+        {
+            checkResample(source, target[0], target[1], failed);
+        }
+    }
+
+    checkProfile(directory, failed);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Generates a lens matched shading rate profile (see RateProfile.h) from a
+// radial distortion polynomial:
+//
+//   rateprofile_gen output.vrp [--size N] [--eyes 1|2] [--k1 K1] [--k2 K2]
+//                              [--fov RADIUS] [--lens-offset OFFSET]
+//                              [--thresholds T1X1 T2X2]
+//
+// Per eye, with the lens center at the origin and the eye region spanning
+// [-1, 1] in both directions, a point at display radius d is rendered at
+//   r(d) = d * (1 + k1 d^2 + k2 d^4)
+// so the renderer pre-warps with more pixels towards the edge. The density
+// (display pixels per rendered pixel) at r is the inverse of the area
+// magnification dr/dd * r/d, pixels beyond r(fov) are never seen.
+//
+
+#include "../RateProfile.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Distortion
+{
+    double k1 = 0.22;
+    double k2 = 0.24;
+
+    double radius(double d) const { return d * (1.0 + k1 * d * d + k2 * d * d * d * d); }
+    double derivative(double d) const { return 1.0 + 3.0 * k1 * d * d + 5.0 * k2 * d * d * d * d; }
+
+    // display radius for a rendered radius, Newton iterations on the monotonic polynomial
+    double inverse(double r) const
+    {
+        double d = r;
+        for (int i = 0; i < 16; ++i)
+        {
+            double step = (radius(d) - r) / derivative(d);
+            d -= step;
+            if (std::fabs(step) < 1e-9)
+            {
+                break;
+            }
+        }
+        return d;
+    }
+};
+
+int main(int argc, const char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr,
+            "usage: %s output.vrp [--size N] [--eyes 1|2] [--k1 K1] [--k2 K2] [--fov RADIUS]\n"
+            "       [--lens-offset OFFSET] [--thresholds T1X1 T2X2]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t size = 256;
+    uint32_t eyes = 2;
+    double fov = 0.9;         // visible display radius
+    double lensOffset = 0.1;  // lens centers are moved towards the nose by this much
+    Distortion distortion;
+
+    RateProfileHeader header = {};
+    memcpy(header.magic, RATE_PROFILE_MAGIC, sizeof(header.magic));
+    header.version = RATE_PROFILE_VERSION;
+    header.densityThresholds[0] = 0.7f;
+    header.densityThresholds[1] = 0.35f;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) size = uint32_t(std::max(1, atoi(argv[++i])));
+        else if (arg == "--eyes" && hasValue) eyes = atoi(argv[++i]) == 1 ? 1 : 2;
+        else if (arg == "--k1" && hasValue) distortion.k1 = atof(argv[++i]);
+        else if (arg == "--k2" && hasValue) distortion.k2 = atof(argv[++i]);
+        else if (arg == "--fov" && hasValue) fov = atof(argv[++i]);
+        else if (arg == "--lens-offset" && hasValue) lensOffset = atof(argv[++i]);
+        else if (arg == "--thresholds" && i + 2 < argc)
+        {
+            header.densityThresholds[0] = float(atof(argv[++i]));
+            header.densityThresholds[1] = float(atof(argv[++i]));
+        }
+        else
+        {
+            fprintf(stderr, "unknown or incomplete argument %s\n", arg.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (distortion.k1 < 0.0 || distortion.k2 < 0.0)
+    {
+        fprintf(stderr, "only pincushion pre-warps (k1, k2 >= 0) are monotonic\n");
+        return EXIT_FAILURE;
+    }
+
+    header.eyeCount = eyes;
+    header.width = size;
+    header.height = size;
+
+    const double maxRadius = distortion.radius(fov);
+
+    std::vector<std::vector<uint8_t>> masks(eyes, std::vector<uint8_t>(size_t(size) * size));
+    std::vector<std::vector<float>> densities(eyes, std::vector<float>(size_t(size) * size));
+
+    for (uint32_t eye = 0; eye < eyes; ++eye)
+    {
+        // the left eye's lens center is right of its region center and vice versa
+        double centerX = eyes == 1 ? 0.0 : (eye == 0 ? lensOffset : -lensOffset);
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                double u = (x + 0.5) / size * 2.0 - 1.0 - centerX;
+                double v = (y + 0.5) / size * 2.0 - 1.0;
+                double r = std::sqrt(u * u + v * v);
+
+                size_t index = size_t(y) * size + x;
+                if (r > maxRadius)
+                {
+                    masks[eye][index] = RATE_NO_INVOCATIONS;
+                    densities[eye][index] = 0.0f;
+                    continue;
+                }
+
+                double d = distortion.inverse(r);
+                double magnification = d > 1e-6 ? distortion.derivative(d) * (r / d) : 1.0;
+                masks[eye][index] = RATE_4X4;
+                densities[eye][index] = float(1.0 / magnification);
+            }
+        }
+    }
+
+    std::string error;
+    if (!writeRateProfile(argv[1], header, masks, densities, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %u eye(s), %ux%u, visible render radius %.3f\n", argv[1], eyes, size, size, maxRadius);
+    return EXIT_SUCCESS;
+}
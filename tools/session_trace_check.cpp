@@ -0,0 +1,272 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the session traces of GLDemo without a GL context:
+//
+//   session_trace_check [frames] [directory]
+//
+// Records a synthetic session through SessionTraceWriter, with the settings
+// changing every few frames, and streams it back through the memory mapping
+// of SessionTraceReader. Every frame and its settings have to come back
+// unchanged, also after a rewind, and the settings records may only be
+// written when they changed. Reported are the write and read throughput.
+//
+// Damaged copies of the trace are read as well: a different version has to
+// be rejected by open(), a record cut short, an unknown tag or a frame
+// before the first settings have to stop the replay with an error after the
+// intact frames. Finally clampTraceSetting, which the replay uses on every
+// setting, has to map NaN and out of range values into the range.
+//
+
+#include "../SessionTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+static const uint32_t FRAMES_PER_SETTINGS = 97;
+
+static TraceFrame makeFrame(uint32_t index)
+{
+    TraceFrame frame;
+    frame.frameIndex = index;
+    frame.windowWidth = uint16_t(1280 + index % 7);
+    frame.windowHeight = uint16_t(720 + index % 5);
+    frame.framebufferWidth = frame.windowWidth / 2;
+    frame.framebufferHeight = frame.windowHeight / 2;
+    for (int i = 0; i < 16; ++i)
+    {
+        frame.viewMatrix[i] = float(index) * 0.001f + float(i);
+    }
+    frame.gaze[0] = float(index % 100) / 100.0f;
+    frame.gaze[1] = 1.0f - frame.gaze[0];
+    return frame;
+}
+
+static TraceSettings makeSettings(uint32_t frameIndex)
+{
+    uint32_t change = frameIndex / FRAMES_PER_SETTINGS;
+    TraceSettings settings;
+    settings.numberOfTori = int32_t(16 + change);
+    settings.shadingMode = int32_t(change % 5);
+    settings.foveationRadii[0] = 0.1f + 0.01f * float(change % 10);
+    settings.sortDraws = uint8_t(change & 1);
+    return settings;
+}
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+    std::vector<uint8_t> data;
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (file)
+    {
+        uint8_t buffer[65536];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + count);
+        }
+        fclose(file);
+    }
+    return data;
+}
+
+static bool writeFile(const std::string& filename, const std::vector<uint8_t>& data)
+{
+    FILE* file = fopen(filename.c_str(), "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && ok;
+}
+
+// frames up to the end or the first corrupt record, and the error if there was one
+static uint32_t readAll(const std::string& filename, std::string& error, bool& opened)
+{
+    SessionTraceReader reader;
+    error.clear();
+    opened = reader.open(filename, &error);
+    uint32_t count = 0;
+    TraceFrame frame;
+    TraceSettings settings;
+    while (opened && reader.next(frame, settings, &error))
+    {
+        ++count;
+    }
+    return count;
+}
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, const char** argv)
+{
+    uint32_t frameCount = argc > 1 ? uint32_t(std::max(atoi(argv[1]), 1000)) : 200000;
+    std::string directory = argc > 2 ? argv[2] : ".";
+    std::string filename = directory + "/session_trace_check.vrst";
+    std::string damagedFilename = directory + "/session_trace_check_damaged.vrst";
+    bool failed = false;
+    std::string error;
+
+    // round trip
+    SessionTraceWriter writer;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!writer.open(filename, 1.0f / 60.0f, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        writer.record(makeFrame(i), makeSettings(i));
+    }
+    if (!writer.close(&error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    double writeSeconds = secondsSince(start);
+
+    size_t settingsRecords = (frameCount + FRAMES_PER_SETTINGS - 1) / FRAMES_PER_SETTINGS;
+    size_t expectedSize = sizeof(TraceHeader) + settingsRecords * (1 + sizeof(TraceSettings)) + size_t(frameCount) * (1 + sizeof(TraceFrame));
+    std::vector<uint8_t> data = readFile(filename);
+    if (data.size() != expectedSize)
+    {
+        fprintf(stderr, "trace has %zu bytes, expected %zu with %zu settings records\n", data.size(), expectedSize, settingsRecords);
+        failed = true;
+    }
+
+    SessionTraceReader reader;
+    if (!reader.open(filename, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return EXIT_FAILURE;
+    }
+    start = std::chrono::high_resolution_clock::now();
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        uint32_t count = 0;
+        uint32_t mismatches = 0;
+        TraceFrame frame;
+        TraceSettings settings;
+        while (reader.next(frame, settings, &error))
+        {
+            TraceFrame expectedFrame = makeFrame(count);
+            TraceSettings expectedSettings = makeSettings(count);
+            if (memcmp(&frame, &expectedFrame, sizeof(frame)) != 0 || memcmp(&settings, &expectedSettings, sizeof(settings)) != 0)
+            {
+                ++mismatches;
+            }
+            ++count;
+        }
+        if (pass == 0)
+        {
+            double readSeconds = secondsSince(start);
+            double megabytes = double(data.size()) / (1024.0 * 1024.0);
+            printf("%u frames, %.1f MB: write %.1f MB/s, read %.1f MB/s\n", frameCount, megabytes, megabytes / writeSeconds,
+                megabytes / readSeconds);
+        }
+        if (count != frameCount || mismatches || !error.empty())
+        {
+            fprintf(stderr, "%s: read %u of %u frames, %u differ %s\n", pass ? "after rewind" : "round trip", count, frameCount,
+                mismatches, error.c_str());
+            failed = true;
+        }
+        reader.rewind();
+    }
+    reader.close();
+
+    // damaged copies, the first frame record starts after the header and the first settings
+    struct Damage
+    {
+        const char* name;
+        size_t size;            // bytes kept
+        size_t offset;          // byte to overwrite, if below size
+        uint8_t value;
+        bool opens;
+        uint32_t frames;        // intact frames before the damage
+        bool reportsError;
+    };
+    size_t firstFrame = sizeof(TraceHeader) + 1 + sizeof(TraceSettings);
+    size_t frameRecord = 1 + sizeof(TraceFrame);
+    const Damage damages[] = {
+        { "intact", data.size(), data.size(), 0, true, frameCount, false },
+        { "header only", sizeof(TraceHeader), data.size(), 0, true, 0, false },
+        { "other version", data.size(), offsetof(TraceHeader, version), 0xff, false, 0, true },
+        { "cut in a frame", firstFrame + 3 * frameRecord + 10, data.size(), 0, true, 3, true },
+        { "cut in the settings", sizeof(TraceHeader) + 10, data.size(), 0, true, 0, true },
+        { "unknown tag", data.size(), firstFrame + 5 * frameRecord, 'X', true, 5, true },
+        { "frame before settings", data.size(), sizeof(TraceHeader), TRACE_TAG_FRAME, true, 0, true },
+    };
+    for (const Damage& damage : damages)
+    {
+        std::vector<uint8_t> damaged(data.begin(), data.begin() + std::min(damage.size, data.size()));
+        if (damage.offset < damaged.size())
+        {
+            damaged[damage.offset] = damage.value;
+        }
+        if (!writeFile(damagedFilename, damaged))
+        {
+            fprintf(stderr, "could not write %s\n", damagedFilename.c_str());
+            return EXIT_FAILURE;
+        }
+
+        bool opened = false;
+        uint32_t frames = readAll(damagedFilename, error, opened);
+        bool ok = opened == damage.opens && frames == damage.frames && error.empty() != damage.reportsError;
+        printf("  %-22s %s, %u frames%s%s\n", damage.name, opened ? "opened" : "rejected", frames,
+            error.empty() ? "" : ": ", error.c_str());
+        if (!ok)
+        {
+            fprintf(stderr, "  %s: expected %s, %u frames and %s\n", damage.name, damage.opens ? "to open" : "to be rejected",
+                damage.frames, damage.reportsError ? "an error" : "no error");
+            failed = true;
+        }
+    }
+    remove(damagedFilename.c_str());
+    remove(filename.c_str());
+
+    // the clamp of the replayed settings
+    const float NAN_VALUE = std::numeric_limits<float>::quiet_NaN();
+    const float INF_VALUE = std::numeric_limits<float>::infinity();
+    if (clampTraceSetting(NAN_VALUE, 0.5f, 50.0f) != 0.5f || clampTraceSetting(INF_VALUE, 0.5f, 50.0f) != 50.0f
+        || clampTraceSetting(-INF_VALUE, 0.5f, 50.0f) != 0.5f || clampTraceSetting(8.0f, 0.5f, 50.0f) != 8.0f
+        || clampTraceSetting(int32_t(-7), 3, 64) != 3 || clampTraceSetting(int32_t(0), 1, 16) != 1
+        || clampTraceSetting(uint8_t(200), uint8_t(0), uint8_t(3)) != 3)
+    {
+        fprintf(stderr, "clampTraceSetting lets a value out of its range\n");
+        failed = true;
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the tessellation factors of TessellatedTorus through their CPU
+// reference (see TessellationReference.h):
+//
+//   tessellation_check [repetitions]
+//
+// For a few views (overview, close-up reaching behind the eye, torus half
+// out of the view), patch counts and settings, with and without a
+// foveated shading rate image:
+//
+// - crack free: two patches that are both drawn compute bitwise the same
+//   factor for the edge they share, also across the seams of u and v,
+// - the outer factors are within [1, maxFactor], the inner ones the
+//   larger of the two opposite outer ones, culled patches all 0,
+// - a culled patch is invisible: no point of a dense grid on its surface
+//   lands inside the view on a tile with invocations.
+//
+// Reported is the time of computeTorusFactors for the finest setting.
+//
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../ShadingRateImage.h"
+#include "../TessellationReference.h"
+#include "../tessellation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// points per patch axis tested for the culling
+static const int CULL_SAMPLES = 17;
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+struct ViewSetup
+{
+    const char* name;
+    glm::vec3 eye;
+    glm::vec3 center;
+    float rotation;     // of the torus around its y axis, radians
+};
+
+struct CheckCounts
+{
+    uint32_t patches = 0;
+    uint32_t culled = 0;
+    uint32_t sharedEdges = 0;
+    uint32_t cracks = 0;
+    uint32_t badFactors = 0;
+    uint32_t visibleCulled = 0;
+};
+
+static int rateAt(const TessellationView& view, glm::vec2 pixel)
+{
+    glm::ivec2 tile = tessellation::tessRateTile(pixel, glm::ivec2(view.texelWidth, view.texelHeight),
+                                                 glm::ivec2(view.rateWidth, view.rateHeight));
+    return view.rates[size_t(tile.y) * view.rateWidth + tile.x];
+}
+
+static bool isPatchVisible(const TessellationView& view, const glm::vec2* corners)
+{
+    for (int y = 0; y < CULL_SAMPLES; ++y)
+    {
+        for (int x = 0; x < CULL_SAMPLES; ++x)
+        {
+            glm::vec2 t = glm::vec2(float(x), float(y)) / float(CULL_SAMPLES - 1);
+            glm::vec2 uv = glm::mix(glm::mix(corners[0], corners[1], t.x), glm::mix(corners[3], corners[2], t.x), t.y);
+            glm::vec4 clip = view.modelViewProj * glm::vec4(tessellation::tessTorusPosition(uv, view.radii), 1.0f);
+            if (clip.w <= tessellation::TESS_MIN_W || std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w
+                || std::abs(clip.z) > clip.w)
+            {
+                continue;
+            }
+            if (!view.rates || rateAt(view, tessellation::tessScreenPosition(clip, view.viewport)) != RATE_NO_INVOCATIONS)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void checkFactors(const TessellationView& view, const TessellationSettings& settings, CheckCounts& counts)
+{
+    std::vector<glm::vec2> corners;
+    std::vector<PatchFactors> factors;
+    generatePatchCorners(settings.ringPatches, settings.tubePatches, corners);
+    computeTorusFactors(view, settings, factors);
+
+    const int ring = settings.ringPatches;
+    const int tube = settings.tubePatches;
+    for (int v = 0; v < tube; ++v)
+    {
+        for (int u = 0; u < ring; ++u)
+        {
+            const PatchFactors& patch = factors[size_t(v) * ring + u];
+            counts.patches++;
+
+            if (patch.culled)
+            {
+                counts.culled++;
+                bool zero = patch.outer[0] == 0.0f && patch.outer[1] == 0.0f && patch.outer[2] == 0.0f && patch.outer[3] == 0.0f;
+                counts.badFactors += !zero;
+                counts.visibleCulled += isPatchVisible(view, &corners[(size_t(v) * ring + u) * 4]);
+                continue;
+            }
+
+            for (float outer : patch.outer)
+            {
+                counts.badFactors += !(outer >= 1.0f && outer <= settings.maxFactor);
+            }
+            counts.badFactors += patch.inner[0] != std::max(patch.outer[1], patch.outer[3]);
+            counts.badFactors += patch.inner[1] != std::max(patch.outer[0], patch.outer[2]);
+
+            // the edge u=1 is the edge u=0 of the next patch around the ring, v=1 the v=0 of the next around the tube
+            const PatchFactors& nextU = factors[size_t(v) * ring + (u + 1) % ring];
+            const PatchFactors& nextV = factors[size_t((v + 1) % tube) * ring + u];
+            if (!nextU.culled)
+            {
+                counts.sharedEdges++;
+                counts.cracks += patch.outer[2] != nextU.outer[0];
+            }
+            if (!nextV.culled)
+            {
+                counts.sharedEdges++;
+                counts.cracks += patch.outer[3] != nextV.outer[1];
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? std::max(1, atoi(argv[1])) : 10;
+
+    const glm::vec2 viewport(1280.0f, 720.0f);
+    const int texelSize = 16;
+    const int rateWidth = (int(viewport.x) + texelSize - 1) / texelSize;
+    const int rateHeight = (int(viewport.y) + texelSize - 1) / texelSize;
+    std::vector<uint8_t> rates(size_t(rateWidth) * rateHeight);
+    FoveationParams foveation;
+    // off center, so the right of the view has no invocations
+    fillFoveationRates(rates.data(), uint32_t(rateWidth), uint32_t(rateHeight), 0.25f, 0.55f, foveation);
+
+    const ViewSetup views[] = {
+        { "overview", glm::vec3(0.0f, 1.2f, 2.2f), glm::vec3(0.0f), 0.0f },
+        { "close-up", glm::vec3(-0.75f, 0.02f, 0.1f), glm::vec3(0.5f, 0.0f, 0.0f), 0.3f },
+        { "half out", glm::vec3(0.0f, 0.5f, 2.5f), glm::vec3(1.1f, 0.0f, 0.0f), 1.1f },
+    };
+    struct
+    {
+        int ringPatches, tubePatches;
+        float targetEdgePixels, maxFactor;
+    } const variants[] = { { 16, 8, 8.0f, 32.0f }, { 5, 3, 4.0f, 64.0f }, { 64, 32, 2.0f, 16.0f } };
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), viewport.x / viewport.y, 0.01f, 100.0f);
+
+    bool failed = false;
+    printf("computeTorusFactors, %gx%g with %dx%d tiles\n", viewport.x, viewport.y, texelSize, texelSize);
+    for (const ViewSetup& setup : views)
+    {
+        TessellationView view;
+        glm::mat4 model = glm::rotate(glm::mat4(1.0f), setup.rotation, glm::vec3(0.0f, 1.0f, 0.0f));
+        view.modelViewProj = projection * glm::lookAt(setup.eye, setup.center, glm::vec3(0.0f, 1.0f, 0.0f)) * model;
+        view.viewport = viewport;
+        view.rateWidth = rateWidth;
+        view.rateHeight = rateHeight;
+        view.texelWidth = texelSize;
+        view.texelHeight = texelSize;
+
+        for (const auto& variant : variants)
+        {
+            for (int rateDriven = 0; rateDriven < 2; ++rateDriven)
+            {
+                TessellationSettings settings;
+                settings.ringPatches = variant.ringPatches;
+                settings.tubePatches = variant.tubePatches;
+                settings.targetEdgePixels = variant.targetEdgePixels;
+                settings.maxFactor = variant.maxFactor;
+                settings.rateDriven = rateDriven != 0;
+                view.rates = rateDriven ? rates.data() : nullptr;
+
+                CheckCounts counts;
+                checkFactors(view, settings, counts);
+                printf("  %-8s %2dx%-2d %-11s  patches %4u  culled %4u  shared edges %4u  cracks %u  bad factors %u"
+                       "  visible culled %u\n",
+                       setup.name, settings.ringPatches, settings.tubePatches, rateDriven ? "rate-driven" : "full rate",
+                       counts.patches, counts.culled, counts.sharedEdges, counts.cracks, counts.badFactors,
+                       counts.visibleCulled);
+                check(counts.cracks == 0, "patches sharing an edge compute the same factor for it", failed);
+                check(counts.badFactors == 0, "the factors are in range, culled patches have none", failed);
+                check(counts.visibleCulled == 0, "culled patches are invisible", failed);
+            }
+        }
+    }
+
+    TessellationView view;
+    view.modelViewProj = projection * glm::lookAt(views[0].eye, views[0].center, glm::vec3(0.0f, 1.0f, 0.0f));
+    view.viewport = viewport;
+    view.rates = rates.data();
+    view.rateWidth = rateWidth;
+    view.rateHeight = rateHeight;
+    TessellationSettings settings;
+    settings.ringPatches = 64;
+    settings.tubePatches = 32;
+    std::vector<PatchFactors> factors;
+    double best = 1e30;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        computeTorusFactors(view, settings, factors);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+    printf("computeTorusFactors of %dx%d patches: %.3f ms, best of %d\n", settings.ringPatches, settings.tubePatches,
+           best * 1000.0, repetitions);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
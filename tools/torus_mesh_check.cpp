@@ -0,0 +1,178 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Validates the CPU side of Torus without a GL context:
+//
+//   torus_mesh_check
+//
+// - generateTorusMesh: vertex and index counts of a few tessellations, all
+//   indices in range, and the meshlets cover every triangle once.
+// - TorusMeshCache: a hit becomes the most recently used entry, a full
+//   cache evicts the least recently used one, inserting a cached mesh
+//   again replaces it without growing, a capacity of 0 keeps nothing.
+// - TorusMeshGenerator: a cached request returns right away without work.
+//   While the worker is busy with a large mesh, a burst of requests only
+//   generates the last one and poll() returns it. The worker's mesh is the
+//   same as the one generated on the calling thread.
+//
+
+#include "../TorusGeometry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static TorusParams makeParams(uint32_t n, uint32_t m)
+{
+    TorusParams params;
+    params.n = n;
+    params.m = m;
+    return params;
+}
+
+static bool check(bool condition, const char* what, bool& failed)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "  FAILED: %s\n", what);
+        failed = true;
+    }
+    return condition;
+}
+
+static bool sameMesh(const TorusMesh& a, const TorusMesh& b)
+{
+    return a.params == b.params && a.positions.size() == b.positions.size() && a.indices.size() == b.indices.size()
+           && memcmp(a.positions.data(), b.positions.data(), a.positions.size() * sizeof(a.positions[0])) == 0
+           && memcmp(a.normals.data(), b.normals.data(), a.normals.size() * sizeof(a.normals[0])) == 0
+           && a.indices == b.indices && a.meshlets.meshlets.size() == b.meshlets.meshlets.size();
+}
+
+static void checkMeshes(bool& failed)
+{
+    printf("generateTorusMesh\n");
+    const uint32_t tessellations[][2] = { { 3, 3 }, { 8, 8 }, { 17, 40 }, { 64, 64 } };
+    for (const auto& tessellation : tessellations)
+    {
+        std::shared_ptr<const TorusMesh> mesh = generateTorusMesh(makeParams(tessellation[0], tessellation[1]));
+        size_t vertices = size_t(tessellation[0] + 1) * (tessellation[1] + 1);
+        size_t triangles = size_t(tessellation[0]) * tessellation[1] * 2;
+
+        bool inRange = true;
+        for (uint32_t index : mesh->indices)
+        {
+            inRange = inRange && index < mesh->positions.size();
+        }
+        size_t meshletTriangles = 0;
+        for (const Meshlet& meshlet : mesh->meshlets.meshlets)
+        {
+            meshletTriangles += meshlet.primitiveCount;
+        }
+        printf("  %2u x %2u: %5zu vertices, %5zu triangles, %3zu meshlets\n", tessellation[0], tessellation[1],
+            mesh->positions.size(), mesh->indices.size() / 3, mesh->meshlets.meshlets.size());
+
+        check(mesh->positions.size() == vertices && mesh->normals.size() == vertices && mesh->texcoords.size() == vertices,
+            "vertex count", failed);
+        check(mesh->indices.size() == triangles * 3, "index count", failed);
+        check(inRange, "indices in range", failed);
+        check(meshletTriangles == triangles, "meshlets cover every triangle once", failed);
+    }
+}
+
+static void checkCache(bool& failed)
+{
+    printf("TorusMeshCache\n");
+    std::shared_ptr<const TorusMesh> a = generateTorusMesh(makeParams(3, 3));
+    std::shared_ptr<const TorusMesh> b = generateTorusMesh(makeParams(4, 4));
+    std::shared_ptr<const TorusMesh> c = generateTorusMesh(makeParams(5, 5));
+    std::shared_ptr<const TorusMesh> d = generateTorusMesh(makeParams(6, 6));
+
+    TorusMeshCache cache(3);
+    cache.insert(a);
+    cache.insert(b);
+    cache.insert(c);
+    check(cache.find(a->params) == a, "a hit returns the cached mesh", failed);
+
+    // b is now the least recently used
+    cache.insert(d);
+    check(cache.size() == 3, "a full cache keeps its capacity", failed);
+    check(!cache.find(b->params), "the least recently used mesh is evicted", failed);
+    check(cache.find(a->params) && cache.find(c->params) && cache.find(d->params), "the others stay", failed);
+
+    std::shared_ptr<const TorusMesh> c2 = generateTorusMesh(makeParams(5, 5));
+    cache.insert(c2);
+    check(cache.size() == 3 && cache.find(c->params) == c2, "inserting a cached mesh replaces it", failed);
+
+    check(!cache.find(makeParams(7, 7)), "a miss returns nullptr", failed);
+
+    TorusMeshCache none(0);
+    none.insert(a);
+    check(none.size() == 0 && !none.find(a->params), "a capacity of 0 keeps nothing", failed);
+}
+
+static void checkGenerator(bool& failed)
+{
+    printf("TorusMeshGenerator\n");
+    TorusMeshGenerator generator(8);
+
+    // a large mesh keeps the worker busy while the burst below is requested
+    TorusParams large = makeParams(1500, 1500);
+    check(!generator.request(large), "a new request is generated on the worker", failed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    const uint32_t BURST = 50;
+    TorusParams last;
+    for (uint32_t i = 0; i < BURST; ++i)
+    {
+        last = makeParams(3 + i, 3 + i);
+        generator.request(last);
+    }
+    generator.waitIdle();
+
+    std::shared_ptr<const TorusMesh> finished = generator.poll();
+    size_t generated = generator.getCache().size();
+    printf("  %u requests while busy, %zu meshes generated\n", BURST, generated);
+    check(finished && finished->params == last, "poll returns the latest request", failed);
+    check(generated <= 2, "only the running and the latest request are generated", failed);
+    check(!generator.poll(), "a result is returned once", failed);
+
+    check(finished && sameMesh(*finished, *generateTorusMesh(last)), "the worker's mesh equals a synchronous one", failed);
+
+    std::shared_ptr<const TorusMesh> cached = generator.request(last);
+    generator.waitIdle();
+    check(cached == finished, "a cached request returns right away", failed);
+    check(!generator.poll(), "a cached request does not start the worker", failed);
+}
+
+int main()
+{
+    bool failed = false;
+    checkMeshes(failed);
+    checkCache(failed);
+    checkGenerator(failed);
+
+    if (failed)
+    {
+        fprintf(stderr, "validation failed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Quality and CPU cost of the framebuffer upscaling filters, on the
+// reference implementations in UpscaleReference:
+//
+//   upscale_quality [reference.ppm] [target dB]
+//
+// The reference is a binary PPM (P6), for example a color frame written by
+// "Capture frames" with framebuffer scaling 1, or a synthetic image with
+// fine detail, hard edges and smooth gradients when none or "-" is given. For each
+// framebuffer scaling the reference is reduced by averaging blocks of
+// scaling x scaling pixels, which stands in for rendering at the lower
+// resolution, then upscaled back with every filter. Reported are the PSNR
+// against the reference and the time of the upscale.
+//
+// The filters are listed in the order of their GPU cost. For each scaling
+// the tool names the cheapest filter that reaches the target PSNR, and the
+// largest scaling, that is the fewest shaded pixels, that reaches it at all.
+//
+
+#include "../UpscaleReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgba;
+};
+
+static bool readPPM(const char* path, Image& image)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        return false;
+    }
+    int maxValue = 0;
+    bool ok = fscanf(file, "P6 %d %d %d", &image.width, &image.height, &maxValue) == 3 && maxValue == 255
+              && image.width > 0 && image.height > 0 && fgetc(file) != EOF;
+    if (ok)
+    {
+        std::vector<uint8_t> rgb(size_t(image.width) * image.height * 3);
+        ok = fread(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        image.rgba.resize(size_t(image.width) * image.height * 4);
+        for (size_t i = 0; ok && i < size_t(image.width) * image.height; ++i)
+        {
+            image.rgba[i * 4 + 0] = rgb[i * 3 + 0];
+            image.rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            image.rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            image.rgba[i * 4 + 3] = 255;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+// a zone plate for the fine detail, tilted bars for the edges and a gradient in between
+static Image createSyntheticImage(int width, int height)
+{
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.rgba.resize(size_t(width) * height * 4);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            float u = float(x) / float(width);
+            float v = float(y) / float(height);
+            float r = 0.5f + 0.5f * u;
+            float g = 0.3f + 0.4f * v;
+            float b = 0.5f;
+
+            if (u < 0.5f)
+            {
+                float dx = float(x) - 0.25f * float(width);
+                float dy = float(y) - 0.5f * float(height);
+                float zone = 0.5f + 0.5f * std::cos((dx * dx + dy * dy) * 0.0002f);
+                r = g = b = zone;
+            }
+            else if (std::fmod(float(x) + 0.3f * float(y), 48.0f) < 16.0f)
+            {
+                r *= 0.2f;
+                g *= 0.2f;
+                b = 0.9f;
+            }
+
+            uint8_t* pixel = &image.rgba[(size_t(x) + size_t(y) * width) * 4];
+            pixel[0] = uint8_t(std::min(std::max(r, 0.0f), 1.0f) * 255.0f + 0.5f);
+            pixel[1] = uint8_t(std::min(std::max(g, 0.0f), 1.0f) * 255.0f + 0.5f);
+            pixel[2] = uint8_t(std::min(std::max(b, 0.0f), 1.0f) * 255.0f + 0.5f);
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// the top left part of the reference that is a multiple of the scaling, and its reduction
+static void reduceImage(const Image& reference, int scaling, Image& cropped, Image& reduced)
+{
+    reduced.width = reference.width / scaling;
+    reduced.height = reference.height / scaling;
+    cropped.width = reduced.width * scaling;
+    cropped.height = reduced.height * scaling;
+    cropped.rgba.resize(size_t(cropped.width) * cropped.height * 4);
+    reduced.rgba.resize(size_t(reduced.width) * reduced.height * 4);
+
+    for (int y = 0; y < cropped.height; ++y)
+    {
+        std::copy_n(&reference.rgba[size_t(y) * reference.width * 4], size_t(cropped.width) * 4,
+                    &cropped.rgba[size_t(y) * cropped.width * 4]);
+    }
+
+    for (int y = 0; y < reduced.height; ++y)
+    {
+        for (int x = 0; x < reduced.width; ++x)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                uint32_t sum = 0;
+                for (int sy = 0; sy < scaling; ++sy)
+                {
+                    for (int sx = 0; sx < scaling; ++sx)
+                    {
+                        sum += cropped.rgba[(size_t(x * scaling + sx) + size_t(y * scaling + sy) * cropped.width) * 4 + c];
+                    }
+                }
+                reduced.rgba[(size_t(x) + size_t(y) * reduced.width) * 4 + c] = uint8_t((sum + scaling * scaling / 2) / (scaling * scaling));
+            }
+        }
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    Image reference;
+    bool fromFile = argc > 1 && strcmp(argv[1], "-") != 0;
+    if (fromFile)
+    {
+        if (!readPPM(argv[1], reference))
+        {
+            fprintf(stderr, "could not read %s as a binary PPM with 8 bits per channel\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        reference = createSyntheticImage(1920, 1080);
+    }
+    double target = argc > 2 ? atof(argv[2]) : 28.0;
+
+    printf("%s, %d x %d, target %.1f dB\n", fromFile ? argv[1] : "synthetic", reference.width, reference.height, target);
+    printf("%8s", "scaling");
+    for (int filter = 0; filter < UPSCALE_FILTER_COUNT; ++filter)
+    {
+        printf(" %24s", UPSCALE_FILTER_NAMES[filter]);
+    }
+    printf("   cheapest at the target\n");
+
+    int bestScaling = 0;
+    int bestFilter = -1;
+    const int scalings[] = {2, 3, 4, 6, 8};
+    for (int scaling : scalings)
+    {
+        Image cropped;
+        Image reduced;
+        reduceImage(reference, scaling, cropped, reduced);
+        if (reduced.width < 2 || reduced.height < 2)
+        {
+            continue;
+        }
+
+        printf("%8d", scaling);
+        int cheapest = -1;
+        std::vector<uint8_t> upscaled(cropped.rgba.size());
+        for (int filter = 0; filter < UPSCALE_FILTER_COUNT; ++filter)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            upscaleImage(UpscaleFilter(filter), reduced.rgba.data(), reduced.width, reduced.height, upscaled.data(),
+                         cropped.width, cropped.height);
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+            double psnr = computePSNR(upscaled.data(), cropped.rgba.data(), size_t(cropped.width) * cropped.height);
+            printf(" %8.2f dB %10.2f ms", psnr, seconds * 1000.0);
+            if (cheapest < 0 && psnr >= target)
+            {
+                cheapest = filter;
+            }
+        }
+        printf("   %s\n", cheapest < 0 ? "-" : UPSCALE_FILTER_NAMES[cheapest]);
+
+        if (cheapest >= 0)
+        {
+            bestScaling = scaling;
+            bestFilter = cheapest;
+        }
+    }
+
+    if (bestFilter < 0)
+    {
+        printf("no scaling reaches %.1f dB, render at full resolution\n", target);
+    }
+    else
+    {
+        printf("largest scaling at %.1f dB: %d with %s\n", target, bestScaling, UPSCALE_FILTER_NAMES[bestFilter]);
+    }
+    return EXIT_SUCCESS;
+}
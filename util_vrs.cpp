@@ -20,18 +20,12 @@
 #include "nvgl/base_gl.hpp"
 #include "nvh/nvprint.hpp"
 
-#include <string>
-
 bool isExtensionPresent(const char *extName)
 {
-    GLint numExtensions;
-    bool extFound = false;
+    GLint numExtensions = 0;
     glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
-    for (GLint i = 0; i < numExtensions && !extFound; ++i)
-    {
-        std::string name((const char*)glGetStringi(GL_EXTENSIONS, i));
-        extFound = (name == extName);
-    }
+    bool extFound = findExtension(numExtensions, extName,
+        [](int i) { return reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, GLuint(i))); });
 
     if (!extFound)
     {
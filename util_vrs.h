@@ -17,10 +17,29 @@
 
 #pragma once
 
+#include <cstring>
+
 #ifndef GL_SHADING_RATE_IMAGE_PER_PRIMITIVE_NV
 #define GL_SHADING_RATE_IMAGE_PER_PRIMITIVE_NV 0x95B1
 #endif
 
+// Scan of the extension names, getName(i) returns the i-th one like
+// glGetStringi(GL_EXTENSIONS, i). The names are compared in place, without
+// a copy per name. Kept free of GL for tools/cpu_bench.
+template <class GET_NAME>
+inline bool findExtension(int count, const char* extName, GET_NAME getName)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const char* name = getName(i);
+        if (name && strcmp(name, extName) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool isVRSExtensionPresent();
 
 bool isPerPrimitiveVRSExtensionPresent();